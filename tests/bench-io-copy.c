@@ -0,0 +1,398 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark for the copy engine of thunar-io-copy.c. A file of the
+ * requested size is created and copied within one folder by each of
+ * the strategies the transfer job can pick, with g_file_copy() as the
+ * baseline they replace:
+ *
+ *   bench-io-copy --size=1024 --directory=/mnt/btrfs
+ *
+ * On btrfs or XFS the native copy is a reflink and should not depend
+ * on the size at all; on tmpfs or ext4 it falls back to
+ * copy_file_range(). Loop mounts of those file systems are enough to
+ * compare them. With --sparse the file is mostly holes, which the
+ * native copy keeps while g_file_copy() writes them out.
+ *
+ * The source stays in the page cache after the first run, so the
+ * numbers measure the copy path rather than the disk unless the caches
+ * are dropped between runs by hand.
+ *
+ * With --footprint the source is dropped from the page cache before
+ * each copy instead, and what the copy left cached of the source and
+ * the destination is counted with mincore(). g_file_copy() keeps both
+ * cached, the native copy drops them on the way for files of 64 MiB
+ * and more, and direct I/O should not cache the destination at all.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-io-copy.h>
+#include <thunar/thunar-private.h>
+
+
+
+typedef gboolean (*BenchCopyFunc) (GFile   *source,
+                                   GFile   *destination,
+                                   GError **error);
+
+
+
+static gint      opt_size = 256;
+static gint      opt_runs = 3;
+static gboolean  opt_sparse = FALSE;
+static gboolean  opt_footprint = FALSE;
+static gchar    *opt_directory = NULL;
+
+static GOptionEntry option_entries[] =
+{
+  { "size", 's', 0, G_OPTION_ARG_INT, &opt_size, "Size of the file in MiB (default 256)", "N", },
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &opt_runs, "Number of copies per strategy (default 3)", "N", },
+  { "sparse", 0, 0, G_OPTION_ARG_NONE, &opt_sparse, "Write only every 16th MiB of the file", NULL, },
+  { "footprint", 'f', 0, G_OPTION_ARG_NONE, &opt_footprint, "Report what each copy leaves in the page cache", NULL, },
+  { "directory", 'd', 0, G_OPTION_ARG_FILENAME, &opt_directory, "Create the files below DIR (default the temporary directory)", "DIR", },
+  { NULL, },
+};
+
+
+
+static gboolean
+bench_copy_native (GFile   *source,
+                   GFile   *destination,
+                   GError **error)
+{
+  return thunar_io_copy_file (source, destination, G_FILE_COPY_NONE, FALSE, NULL, NULL, NULL, error);
+}
+
+
+
+static gboolean
+bench_copy_direct (GFile   *source,
+                   GFile   *destination,
+                   GError **error)
+{
+  return thunar_io_copy_file (source, destination, G_FILE_COPY_NONE, TRUE, NULL, NULL, NULL, error);
+}
+
+
+
+static gboolean
+bench_copy_checksum (GFile   *source,
+                     GFile   *destination,
+                     GError **error)
+{
+  gboolean succeed;
+  gchar   *checksum = NULL;
+
+  succeed = thunar_io_copy_file_checksum (source, destination, G_FILE_COPY_NONE, G_CHECKSUM_SHA256,
+                                          NULL, NULL, NULL, &checksum, error);
+  g_free (checksum);
+
+  return succeed;
+}
+
+
+
+static gboolean
+bench_copy_gio (GFile   *source,
+                GFile   *destination,
+                GError **error)
+{
+  return g_file_copy (source, destination, G_FILE_COPY_NONE, NULL, NULL, NULL, error);
+}
+
+
+
+static void
+bench_create (const gchar *path,
+              goffset      size)
+{
+  gchar  *buffer;
+  goffset offset;
+  gint    fd;
+  GRand  *rand;
+  guint   n;
+
+  fd = g_open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      g_printerr ("bench-io-copy: Failed to create \"%s\": %s\n", path, g_strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+
+  /* random data, so neither compression nor deduplication helps */
+  buffer = g_malloc (1 << 20);
+  rand = g_rand_new_with_seed (size);
+  for (offset = 0; offset < size; offset += 1 << 20)
+    {
+      if (opt_sparse && (offset >> 20) % 16 != 0)
+        continue;
+
+      for (n = 0; n < (1 << 20) / sizeof (guint32); ++n)
+        ((guint32 *) buffer)[n] = g_rand_int (rand);
+
+      if (pwrite (fd, buffer, 1 << 20, offset) != 1 << 20)
+        {
+          g_printerr ("bench-io-copy: Failed to write \"%s\": %s\n", path, g_strerror (errno));
+          exit (EXIT_FAILURE);
+        }
+    }
+  g_rand_free (rand);
+  g_free (buffer);
+
+  if (ftruncate (fd, size) < 0 || fsync (fd) < 0)
+    {
+      g_printerr ("bench-io-copy: Failed to write \"%s\": %s\n", path, g_strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+  close (fd);
+}
+
+
+
+static void
+bench_drop (GFile *file)
+{
+#ifdef HAVE_POSIX_FADVISE
+  gint fd;
+
+  /* clean pages only, the source was synced when created */
+  fd = g_open (g_file_peek_path (file), O_RDONLY, 0);
+  if (fd >= 0)
+    {
+      posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+      close (fd);
+    }
+#endif
+}
+
+
+
+static gint64
+bench_resident (GFile *file)
+{
+#if defined (HAVE_SYS_MMAN_H) && defined (HAVE_MINCORE)
+  struct stat statb;
+  gpointer    addr;
+  guchar     *pages;
+  gint64      resident = 0;
+  gsize       page_size;
+  gsize       n_pages;
+  gsize       n;
+  gint        fd;
+
+  fd = g_open (g_file_peek_path (file), O_RDONLY, 0);
+  if (fd < 0)
+    return -1;
+
+  if (fstat (fd, &statb) < 0 || statb.st_size == 0)
+    {
+      close (fd);
+      return 0;
+    }
+
+  /* mapping the file does not read it, the pages stay where they are */
+  addr = mmap (NULL, statb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (addr == MAP_FAILED)
+    return -1;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  n_pages = (statb.st_size + page_size - 1) / page_size;
+  pages = g_malloc (n_pages);
+
+  if (mincore (addr, statb.st_size, (gpointer) pages) == 0)
+    {
+      for (n = 0; n < n_pages; ++n)
+        resident += pages[n] & 1;
+      resident = resident * page_size / 1024;
+    }
+  else
+    {
+      resident = -1;
+    }
+
+  g_free (pages);
+  munmap (addr, statb.st_size);
+
+  return resident;
+#else
+  return -1;
+#endif
+}
+
+
+
+static void
+bench_run (GFile        *source,
+           GFile        *destination,
+           BenchCopyFunc func,
+           const gchar  *what,
+           goffset       size)
+{
+  struct stat statb;
+  GError     *error = NULL;
+  gint64      usec = 0;
+  gint64      start;
+  gint64      blocks = 0;
+  gint64      source_cached = 0;
+  gint64      destination_cached = 0;
+  gint        n;
+
+  for (n = 0; n < MAX (opt_runs, 1); ++n)
+    {
+      g_file_delete (destination, NULL, NULL);
+
+      /* a sync before, so writeback of the last copy is not charged to this one */
+      sync ();
+
+      /* each copy reads the source from the disk, to see what it caches */
+      if (opt_footprint)
+        bench_drop (source);
+
+      start = g_get_monotonic_time ();
+      if (!func (source, destination, &error))
+        {
+          g_print ("%-32s %s\n", what, error->message);
+          g_clear_error (&error);
+          return;
+        }
+      usec += g_get_monotonic_time () - start;
+    }
+
+  if (opt_footprint)
+    {
+      source_cached = bench_resident (source);
+      destination_cached = bench_resident (destination);
+    }
+
+  if (g_stat (g_file_peek_path (destination), &statb) == 0)
+    blocks = statb.st_blocks;
+  g_file_delete (destination, NULL, NULL);
+
+  usec /= MAX (opt_runs, 1);
+  g_print ("%-32s %10.3f ms %10.1f MiB/s %10" G_GINT64_FORMAT " KiB allocated", what, usec / 1000.0,
+           (usec > 0) ? (gdouble) size / (1 << 20) * G_USEC_PER_SEC / usec : 0.0,
+           blocks / 2);
+  if (opt_footprint)
+    g_print (" %10" G_GINT64_FORMAT " KiB source cached %10" G_GINT64_FORMAT " KiB destination cached",
+             source_cached, destination_cached);
+  g_print ("\n");
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError         *error = NULL;
+  GFile          *source;
+  GFile          *destination;
+  gchar          *dirname;
+  gchar          *path;
+  goffset         size;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, option_entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("bench-io-copy: %s\n", error->message);
+      return EXIT_FAILURE;
+    }
+  g_option_context_free (context);
+
+#if !defined (HAVE_SYS_MMAN_H) || !defined (HAVE_MINCORE)
+  if (opt_footprint)
+    {
+      g_printerr ("bench-io-copy: --footprint needs mincore(), which is not available\n");
+      return EXIT_FAILURE;
+    }
+#endif
+
+  if (opt_directory != NULL)
+    {
+      path = g_build_filename (opt_directory, "thunar-bench-XXXXXX", NULL);
+      dirname = g_mkdtemp (path);
+    }
+  else
+    {
+      dirname = g_dir_make_tmp ("thunar-bench-XXXXXX", NULL);
+    }
+
+  if (dirname == NULL)
+    {
+      g_printerr ("bench-io-copy: Failed to create the folder: %s\n", g_strerror (errno));
+      return EXIT_FAILURE;
+    }
+
+  size = (goffset) MAX (opt_size, 1) << 20;
+  path = g_build_filename (dirname, "source", NULL);
+  bench_create (path, size);
+  source = g_file_new_for_path (path);
+  g_free (path);
+
+  path = g_build_filename (dirname, "destination", NULL);
+  destination = g_file_new_for_path (path);
+  g_free (path);
+
+  bench_run (source, destination, bench_copy_gio, "g_file_copy", size);
+  bench_run (source, destination, bench_copy_native, "native copy", size);
+  bench_run (source, destination, bench_copy_direct, "native copy, direct I/O", size);
+  bench_run (source, destination, bench_copy_checksum, "stream copy with SHA-256", size);
+
+  g_file_delete (source, NULL, NULL);
+  g_object_unref (destination);
+  g_object_unref (source);
+
+  g_rmdir (dirname);
+  g_free (dirname);
+
+  return EXIT_SUCCESS;
+}
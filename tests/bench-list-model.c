@@ -0,0 +1,479 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark for the row store of #ThunarListModel. For each of the
+ * requested folder sizes, a folder with that many files is created,
+ * loaded through a #ThunarFolder like the views do, and the model is
+ * timed while it inserts, walks, looks up and sorts its rows:
+ *
+ *   bench-list-model --rows=1000,100000,1000000
+ *
+ * Sorting is timed for each column and sort configuration, reported as
+ * comparisons per second estimated from the n log n comparisons of the
+ * merge sort.
+ *
+ * Next to the time, each step reports the cache misses of the main
+ * thread per operation, as counted by the CPU. They show what the rows
+ * stored in one array, and the packed name prefixes compared before the
+ * collation keys, save. They need perf events, see perf_event_paranoid
+ * in proc(5).
+ *
+ * Name sorting first compares the packed prefixes. Each size is run
+ * once for every length in --prefix-lengths. The names of a run share
+ * a common prefix of that many characters, so with a long one every
+ * comparison falls through to the full collation keys, which is what
+ * the sort cost before the prefixes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#endif
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-file.h>
+#include <thunar/thunar-folder.h>
+#include <thunar/thunar-gobject-extensions.h>
+#include <thunar/thunar-list-model.h>
+#include <thunar/thunar-preferences.h>
+#include <thunar/thunar-private.h>
+
+
+
+static gchar *opt_rows = NULL;
+static gchar *opt_prefix_lengths = NULL;
+static gchar *opt_directory = NULL;
+
+static GOptionEntry option_entries[] =
+{
+  { "rows", 'n', 0, G_OPTION_ARG_STRING, &opt_rows, "Comma-separated numbers of files in the folder (default 1000,100000,1000000)", "N,...", },
+  { "prefix-lengths", 'p', 0, G_OPTION_ARG_STRING, &opt_prefix_lengths, "Comma-separated lengths of a prefix common to all names (default 0,32)", "N,...", },
+  { "directory", 'd', 0, G_OPTION_ARG_FILENAME, &opt_directory, "Create the folder below DIR (default the temporary directory)", "DIR", },
+  { NULL, },
+};
+
+/* the hardware cache miss counter of the main thread, or -1 */
+static gint    counter_fd = -1;
+
+/* the start of the step timed, see bench_begin() */
+static gint64  start_time;
+static guint64 start_misses;
+
+
+
+static void
+bench_open_counter (void)
+{
+#if defined (HAVE_LINUX_PERF_EVENT_H) && defined (SYS_perf_event_open)
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  /* only the calling thread, where the model does its work */
+  counter_fd = syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+
+  if (counter_fd < 0)
+    g_print ("Cache misses are not counted, perf events are not available\n\n");
+}
+
+
+
+static guint64
+bench_read_counter (void)
+{
+  guint64 value;
+
+  if (counter_fd < 0 || read (counter_fd, &value, sizeof (value)) != sizeof (value))
+    return 0;
+
+  return value;
+}
+
+
+
+static void
+bench_begin (void)
+{
+  start_misses = bench_read_counter ();
+  start_time = g_get_monotonic_time ();
+}
+
+
+
+static void
+bench_end (const gchar *what,
+           gdouble      n_ops,
+           const gchar *unit)
+{
+  gint64  usec = g_get_monotonic_time () - start_time;
+  guint64 misses = bench_read_counter () - start_misses;
+
+  g_print ("%-32s %10.3f ms %14.0f %s/s", what, usec / 1000.0,
+           (usec > 0) ? n_ops * G_USEC_PER_SEC / usec : 0.0, unit);
+  if (counter_fd >= 0)
+    g_print (" %10.2f misses/%s", (n_ops > 0) ? misses / n_ops : 0.0, unit);
+  g_print ("\n");
+}
+
+
+
+static GArray *
+bench_parse_list (const gchar *list,
+                  const gchar *fallback)
+{
+  GArray  *values;
+  gchar  **tokens;
+  guint    value;
+  guint    n;
+
+  values = g_array_new (FALSE, FALSE, sizeof (guint));
+  tokens = g_strsplit (list != NULL ? list : fallback, ",", -1);
+  for (n = 0; tokens[n] != NULL; ++n)
+    {
+      value = strtoul (tokens[n], NULL, 10);
+      g_array_append_val (values, value);
+    }
+  g_strfreev (tokens);
+
+  return values;
+}
+
+
+
+static void
+bench_flush (void)
+{
+  /* run the pending change notifications of the model */
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+
+
+static gchar*
+bench_populate (guint n_files,
+                guint prefix_length)
+{
+  struct timeval times[2];
+  gchar         *prefix;
+  gchar         *path;
+  gchar         *dirname;
+  guint          n;
+  gint           fd;
+  GRand         *rand;
+
+  if (opt_directory != NULL)
+    {
+      path = g_build_filename (opt_directory, "thunar-bench-XXXXXX", NULL);
+      dirname = g_mkdtemp (path);
+    }
+  else
+    {
+      dirname = g_dir_make_tmp ("thunar-bench-XXXXXX", NULL);
+    }
+
+  if (dirname == NULL)
+    {
+      g_printerr ("bench-list-model: Failed to create the folder: %s\n", g_strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+
+  /* the names are created in a shuffled order, and the files get
+   * different sizes and times so each sort column has work to do,
+   * with some folders in between for the folders-first sorting */
+  prefix = g_strnfill (MIN (prefix_length, 200), 'x');
+  rand = g_rand_new_with_seed (n_files);
+  for (n = 0; n < n_files; ++n)
+    {
+      path = g_strdup_printf ("%s/%s%sfile-%08x%s", dirname,
+                              (n % 10 == 0) ? "." : "", prefix,
+                              g_rand_int (rand),
+                              (n % 4 == 0) ? ".txt" : (n % 4 == 1) ? ".png" : "");
+      if (n % 50 == 25)
+        {
+          g_mkdir (path, 0755);
+          g_free (path);
+          continue;
+        }
+
+      fd = g_open (path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+      if (G_LIKELY (fd >= 0))
+        {
+          if (ftruncate (fd, g_rand_int_range (rand, 0, 1 << 20)) == 0)
+            {
+              times[0].tv_sec = times[1].tv_sec = g_rand_int_range (rand, 0, G_MAXINT32);
+              times[0].tv_usec = times[1].tv_usec = 0;
+              utimes (path, times);
+            }
+          close (fd);
+        }
+      g_free (path);
+    }
+  g_rand_free (rand);
+  g_free (prefix);
+
+  return dirname;
+}
+
+
+
+static void
+bench_cleanup (const gchar *dirname)
+{
+  const gchar *name;
+  gchar       *path;
+  GDir        *dir;
+
+  dir = g_dir_open (dirname, 0, NULL);
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          path = g_build_filename (dirname, name, NULL);
+          g_remove (path);
+          g_free (path);
+        }
+      g_dir_close (dir);
+    }
+  g_rmdir (dirname);
+}
+
+
+
+static void
+bench_sort (ThunarListModel *store,
+            ThunarColumn     column,
+            const gchar     *what)
+{
+  gboolean folders_first;
+  gboolean case_sensitive;
+  gdouble  n_cmps;
+  gchar   *label;
+  gint     n_rows;
+
+  n_rows = gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL);
+  n_cmps = (gdouble) n_rows * g_bit_storage (n_rows);
+
+  /* each combination selects its own comparator */
+  for (folders_first = FALSE; folders_first <= TRUE; ++folders_first)
+    for (case_sensitive = FALSE; case_sensitive <= TRUE; ++case_sensitive)
+      {
+        g_object_set (G_OBJECT (store),
+                      "folders-first", folders_first,
+                      "case-sensitive", case_sensitive,
+                      NULL);
+
+        /* one sort in each direction */
+        label = g_strdup_printf ("%s %s%s", what,
+                                 folders_first ? "F" : "-",
+                                 case_sensitive ? "C" : "-");
+        bench_begin ();
+        gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), column, GTK_SORT_DESCENDING);
+        gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), column, GTK_SORT_ASCENDING);
+        bench_flush ();
+        bench_end (label, 2 * n_cmps, "cmp");
+        g_free (label);
+      }
+}
+
+
+
+static void
+bench_run (guint n_files,
+           guint prefix_length)
+{
+  ThunarListModel *store;
+  ThunarFolder    *folder;
+  ThunarFile      *file;
+  GtkTreeModel    *model;
+  GtkTreePath     *path;
+  GtkTreeIter      iter;
+  GError          *error = NULL;
+  GFile           *gfile;
+  gchar           *dirname;
+  gint             n_rows;
+  gint             n;
+  GRand           *rand;
+
+  g_print ("%u files, names with a common prefix of %u characters:\n", n_files, prefix_length);
+
+  bench_begin ();
+  dirname = bench_populate (n_files, prefix_length);
+  bench_end ("create files", n_files, "ops");
+
+  /* load the folder like a view would */
+  bench_begin ();
+  gfile = g_file_new_for_path (dirname);
+  file = thunar_file_get (gfile, &error);
+  g_object_unref (gfile);
+  if (file == NULL)
+    {
+      g_printerr ("bench-list-model: %s\n", error->message);
+      bench_cleanup (dirname);
+      exit (EXIT_FAILURE);
+    }
+  folder = thunar_folder_get_for_file (file);
+  while (thunar_folder_get_loading (folder))
+    g_main_context_iteration (NULL, TRUE);
+  bench_end ("load folder", n_files, "ops");
+
+  store = thunar_list_model_new ();
+  model = GTK_TREE_MODEL (store);
+
+  bench_begin ();
+  thunar_list_model_set_folder (store, folder, NULL);
+  bench_flush ();
+  n_rows = gtk_tree_model_iter_n_children (model, NULL);
+  bench_end ("insert rows", n_rows, "ops");
+
+  bench_begin ();
+  n = 0;
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    for (n = 1; gtk_tree_model_iter_next (model, &iter); ++n)
+      ;
+  bench_end ("iterate rows", n, "ops");
+
+  /* random rows, like a scrolled view and the tree view's
+   * path lookups for selections and cursor moves do */
+  rand = g_rand_new_with_seed (n_rows);
+  bench_begin ();
+  for (n = 0; n < n_rows; ++n)
+    {
+      path = gtk_tree_path_new_from_indices (g_rand_int_range (rand, 0, MAX (n_rows, 1)), -1);
+      if (gtk_tree_model_get_iter (model, &iter, path))
+        {
+          gtk_tree_path_free (path);
+          path = gtk_tree_model_get_path (model, &iter);
+        }
+      gtk_tree_path_free (path);
+    }
+  bench_end ("random get_iter/get_path", n_rows, "ops");
+  g_rand_free (rand);
+
+  /* F = folders first, C = case-sensitive, the time is for two sorts */
+  bench_sort (store, THUNAR_COLUMN_NAME, "sort by name");
+  bench_sort (store, THUNAR_COLUMN_SIZE, "sort by size");
+  bench_sort (store, THUNAR_COLUMN_SIZE_IN_BYTES, "sort by size in bytes");
+  bench_sort (store, THUNAR_COLUMN_DATE_MODIFIED, "sort by date modified");
+  bench_sort (store, THUNAR_COLUMN_TYPE, "sort by type");
+  bench_sort (store, THUNAR_COLUMN_PERMISSIONS, "sort by permissions");
+
+  /* inserts and removes the hidden rows in one batch each */
+  bench_begin ();
+  thunar_list_model_set_show_hidden (store, TRUE);
+  bench_flush ();
+  thunar_list_model_set_show_hidden (store, FALSE);
+  bench_flush ();
+  bench_end ("toggle hidden rows", n_files / 10 * 2, "ops");
+
+  bench_begin ();
+  thunar_list_model_set_folder (store, NULL, NULL);
+  bench_flush ();
+  bench_end ("remove rows", n_rows, "ops");
+
+  g_object_unref (store);
+  g_object_unref (folder);
+  g_object_unref (file);
+
+  bench_cleanup (dirname);
+  g_free (dirname);
+
+  g_print ("\n");
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError         *error = NULL;
+  GArray         *sizes;
+  GArray         *prefix_lengths;
+  guint           n;
+  guint           m;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, option_entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("bench-list-model: %s\n", error->message);
+      return EXIT_FAILURE;
+    }
+  g_option_context_free (context);
+
+  /* the benchmark must not touch the settings of the user */
+  thunar_preferences_xfconf_init_failed ();
+  thunar_g_initialize_transformations ();
+
+  bench_open_counter ();
+
+  sizes = bench_parse_list (opt_rows, "1000,100000,1000000");
+  prefix_lengths = bench_parse_list (opt_prefix_lengths, "0,32");
+
+  for (n = 0; n < sizes->len; ++n)
+    for (m = 0; m < prefix_lengths->len; ++m)
+      bench_run (MAX (g_array_index (sizes, guint, n), 1), g_array_index (prefix_lengths, guint, m));
+
+  g_array_free (prefix_lengths, TRUE);
+  g_array_free (sizes, TRUE);
+
+  if (counter_fd >= 0)
+    close (counter_fd);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,317 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests for the chunked checksums of thunar-io-checksum.c. The checksum
+ * of a file hashed by the thread pool must be the one of the same data
+ * fed piece by piece into a #ThunarIoChecksum, which is what the copy
+ * computes while writing, for every length around the chunk size, and
+ * any change of the content must change it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-io-checksum.h>
+
+
+
+/* the chunk size of thunar-io-checksum.c */
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+
+
+static gchar *test_dirname = NULL;
+
+
+
+static guchar *
+test_data_new (gsize length)
+{
+  guchar *data;
+  GRand  *rand;
+  gsize   n;
+
+  data = g_malloc (MAX (length, 1));
+  rand = g_rand_new_with_seed (length);
+  for (n = 0; n < length; ++n)
+    data[n] = g_rand_int (rand);
+  g_rand_free (rand);
+
+  return data;
+}
+
+
+
+static GFile *
+test_file_new (const guchar *data,
+               gsize         length)
+{
+  GError *error = NULL;
+  gchar  *path;
+  GFile  *file;
+
+  path = g_build_filename (test_dirname, "data", NULL);
+  g_file_set_contents (path, (const gchar *) data, length, &error);
+  g_assert_no_error (error);
+  file = g_file_new_for_path (path);
+  g_free (path);
+
+  return file;
+}
+
+
+
+static gchar *
+test_checksum_file (GFile   *file,
+                    gboolean uncached)
+{
+  GError *error = NULL;
+  gchar  *checksum;
+
+  checksum = thunar_io_checksum_file (file, G_CHECKSUM_SHA256, uncached, NULL, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (checksum);
+
+  return checksum;
+}
+
+
+
+static gchar *
+test_checksum_stream (const guchar *data,
+                      gsize         length,
+                      gsize         piece)
+{
+  ThunarIoChecksum *checksum;
+  gsize             n;
+
+  checksum = thunar_io_checksum_new (G_CHECKSUM_SHA256);
+  for (n = 0; n < length; n += piece)
+    thunar_io_checksum_update (checksum, data + n, MIN (piece, length - n));
+
+  return thunar_io_checksum_finish (checksum);
+}
+
+
+
+static gchar *
+test_checksum_reference (const guchar *data,
+                         gsize         length)
+{
+  GChecksum *tree;
+  GChecksum *chunk;
+  guint64    length_le = GUINT64_TO_LE (length);
+  guint8     digest[32];
+  gsize      digest_length;
+  gchar     *result;
+  gsize      n;
+
+  /* the digests of the chunks, then the length in little endian */
+  tree = g_checksum_new (G_CHECKSUM_SHA256);
+  for (n = 0; n < length; n += CHUNK_SIZE)
+    {
+      chunk = g_checksum_new (G_CHECKSUM_SHA256);
+      g_checksum_update (chunk, data + n, MIN (CHUNK_SIZE, length - n));
+      digest_length = sizeof (digest);
+      g_checksum_get_digest (chunk, digest, &digest_length);
+      g_checksum_update (tree, digest, digest_length);
+      g_checksum_free (chunk);
+    }
+  g_checksum_update (tree, (const guchar *) &length_le, sizeof (length_le));
+  result = g_strdup (g_checksum_get_string (tree));
+  g_checksum_free (tree);
+
+  return result;
+}
+
+
+
+static void
+test_lengths (gconstpointer user_data)
+{
+  gsize   length = GPOINTER_TO_SIZE (user_data);
+  guchar *data;
+  GFile  *file;
+  gchar  *expected;
+  gchar  *checksum;
+
+  data = test_data_new (length);
+  file = test_file_new (data, length);
+  expected = test_checksum_reference (data, length);
+
+  checksum = test_checksum_file (file, FALSE);
+  g_assert_cmpstr (checksum, ==, expected);
+  g_free (checksum);
+
+  checksum = test_checksum_file (file, TRUE);
+  g_assert_cmpstr (checksum, ==, expected);
+  g_free (checksum);
+
+  /* the copy writes in pieces that don't line up with the chunks */
+  checksum = test_checksum_stream (data, length, 65537);
+  g_assert_cmpstr (checksum, ==, expected);
+  g_free (checksum);
+
+  checksum = test_checksum_stream (data, length, CHUNK_SIZE);
+  g_assert_cmpstr (checksum, ==, expected);
+  g_free (checksum);
+
+  checksum = test_checksum_stream (data, length, MAX (length, 1));
+  g_assert_cmpstr (checksum, ==, expected);
+  g_free (checksum);
+
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (expected);
+  g_free (data);
+}
+
+
+
+static void
+test_truncated (void)
+{
+  const gsize lengths[] = { 2 * CHUNK_SIZE - 1, CHUNK_SIZE, CHUNK_SIZE - 1, 1, 0 };
+  guchar     *data;
+  GFile      *file;
+  gchar      *full;
+  gchar      *checksum;
+  gchar      *expected;
+  guint       n;
+
+  data = test_data_new (2 * CHUNK_SIZE);
+  file = test_file_new (data, 2 * CHUNK_SIZE);
+  full = test_checksum_file (file, FALSE);
+
+  /* cutting off the end changes the checksum, even at a chunk
+   * boundary where all the remaining chunk digests are unchanged */
+  for (n = 0; n < G_N_ELEMENTS (lengths); ++n)
+    {
+      g_assert_cmpint (truncate (g_file_peek_path (file), lengths[n]), ==, 0);
+
+      checksum = test_checksum_file (file, FALSE);
+      expected = test_checksum_stream (data, lengths[n], 65537);
+      g_assert_cmpstr (checksum, !=, full);
+      g_assert_cmpstr (checksum, ==, expected);
+      g_free (expected);
+      g_free (checksum);
+    }
+
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (full);
+  g_free (data);
+}
+
+
+
+static void
+test_flipped_byte (void)
+{
+  const gsize offsets[] = { 0, CHUNK_SIZE - 1, CHUNK_SIZE, 2 * CHUNK_SIZE + 4 };
+  gsize       length = 2 * CHUNK_SIZE + 5;
+  guchar     *data;
+  GFile      *file;
+  gchar      *full;
+  gchar      *checksum;
+  gchar      *expected;
+  guint       n;
+
+  data = test_data_new (length);
+  file = test_file_new (data, length);
+  full = test_checksum_file (file, FALSE);
+  g_object_unref (file);
+
+  /* a single bit in the first, last or any chunk */
+  for (n = 0; n < G_N_ELEMENTS (offsets); ++n)
+    {
+      data[offsets[n]] ^= 0x01;
+      file = test_file_new (data, length);
+
+      checksum = test_checksum_file (file, FALSE);
+      expected = test_checksum_stream (data, length, 65537);
+      g_assert_cmpstr (checksum, !=, full);
+      g_assert_cmpstr (checksum, ==, expected);
+      g_free (expected);
+      g_free (checksum);
+
+      g_object_unref (file);
+      data[offsets[n]] ^= 0x01;
+    }
+
+  /* and back to the original content */
+  file = test_file_new (data, length);
+  checksum = test_checksum_file (file, FALSE);
+  g_assert_cmpstr (checksum, ==, full);
+  g_free (checksum);
+
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (full);
+  g_free (data);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  const gsize lengths[] = { 0, 1, CHUNK_SIZE - 1, CHUNK_SIZE, CHUNK_SIZE + 1, 2 * CHUNK_SIZE, 3 * CHUNK_SIZE + 7 };
+  gchar      *name;
+  guint       n;
+  gint        result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  test_dirname = g_dir_make_tmp ("thunar-test-XXXXXX", NULL);
+  g_assert_nonnull (test_dirname);
+
+  for (n = 0; n < G_N_ELEMENTS (lengths); ++n)
+    {
+      name = g_strdup_printf ("/io-checksum/length/%" G_GSIZE_FORMAT, lengths[n]);
+      g_test_add_data_func (name, GSIZE_TO_POINTER (lengths[n]), test_lengths);
+      g_free (name);
+    }
+  g_test_add_func ("/io-checksum/truncated", test_truncated);
+  g_test_add_func ("/io-checksum/flipped-byte", test_flipped_byte);
+
+  result = g_test_run ();
+
+  g_rmdir (test_dirname);
+  g_free (test_dirname);
+
+  return result;
+}
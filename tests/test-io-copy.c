@@ -0,0 +1,293 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests for copying sparse files with thunar-io-copy.c. The holes of the
+ * source must be holes in the copy as well, wherever they are, and the
+ * content must read back the same, for the copy in the kernel as well
+ * as for the checksumming copy through user space.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-io-checksum.h>
+#include <thunar/thunar-io-copy.h>
+
+
+
+#define MIB (1024 * 1024)
+
+/* file systems may allocate a little more than the data, say for metadata */
+#define ALLOCATION_SLACK MIB
+
+
+
+typedef struct
+{
+  const gchar *name;
+  goffset      size;
+  goffset      data[4][2]; /* offset and length of the data, ending with 0, 0 */
+}
+TestLayout;
+
+typedef struct
+{
+  gchar *dirname;
+  GFile *source;
+  GFile *destination;
+}
+TestFixture;
+
+
+
+static const TestLayout layouts[] =
+{
+  /* holes at the start, in the middle and at the end */
+  { "holes", 16 * MIB, { { 4 * MIB, MIB }, { 10 * MIB, MIB }, { 0, 0 } } },
+
+  /* data that does not end on a block boundary before a hole */
+  { "unaligned", 8 * MIB, { { 3 * MIB, 5000 }, { 6 * MIB + 4096, 4096 }, { 0, 0 } } },
+
+  /* nothing but a hole */
+  { "hole", 8 * MIB, { { 0, 0 } } },
+};
+
+
+
+static void
+test_setup (TestFixture  *fixture,
+            gconstpointer user_data)
+{
+  const TestLayout *layout = user_data;
+  guchar           *buffer;
+  GRand            *rand;
+  gchar            *path;
+  guint             n;
+  gint              fd;
+  goffset           m;
+
+  fixture->dirname = g_dir_make_tmp ("thunar-test-XXXXXX", NULL);
+  g_assert_nonnull (fixture->dirname);
+
+  path = g_build_filename (fixture->dirname, "source", NULL);
+  fixture->source = g_file_new_for_path (path);
+
+  fd = g_open (path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+  g_assert_cmpint (fd, >=, 0);
+  g_free (path);
+
+  /* random data, so no file system can compress or deduplicate it */
+  rand = g_rand_new_with_seed (layout->size);
+  for (n = 0; layout->data[n][1] > 0; ++n)
+    {
+      buffer = g_malloc (layout->data[n][1]);
+      for (m = 0; m < layout->data[n][1]; ++m)
+        buffer[m] = g_rand_int (rand);
+      g_assert_cmpint (pwrite (fd, buffer, layout->data[n][1], layout->data[n][0]), ==, layout->data[n][1]);
+      g_free (buffer);
+    }
+  g_rand_free (rand);
+
+  g_assert_cmpint (ftruncate (fd, layout->size), ==, 0);
+  g_assert_cmpint (fsync (fd), ==, 0);
+  g_assert_cmpint (close (fd), ==, 0);
+
+  path = g_build_filename (fixture->dirname, "destination", NULL);
+  fixture->destination = g_file_new_for_path (path);
+  g_free (path);
+}
+
+
+
+static void
+test_teardown (TestFixture  *fixture,
+               gconstpointer user_data)
+{
+  g_file_delete (fixture->source, NULL, NULL);
+  g_file_delete (fixture->destination, NULL, NULL);
+  g_rmdir (fixture->dirname);
+
+  g_object_unref (fixture->source);
+  g_object_unref (fixture->destination);
+  g_free (fixture->dirname);
+}
+
+
+
+static gboolean
+test_has_holes (TestFixture      *fixture,
+                const TestLayout *layout)
+{
+  struct stat statb;
+
+  g_assert_cmpint (g_stat (g_file_peek_path (fixture->source), &statb), ==, 0);
+  if ((goffset) statb.st_blocks * 512 >= layout->size)
+    {
+      g_test_skip ("The file system does not support sparse files");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+static void
+test_compare (TestFixture      *fixture,
+              const TestLayout *layout)
+{
+  struct stat source_statb;
+  struct stat destination_statb;
+  GError     *error = NULL;
+  gchar      *source_contents;
+  gchar      *destination_contents;
+  gsize       source_length;
+  gsize       destination_length;
+  gint        fd;
+
+  /* let delayed allocation settle before looking at the blocks */
+  fd = g_open (g_file_peek_path (fixture->destination), O_RDONLY, 0);
+  g_assert_cmpint (fd, >=, 0);
+  g_assert_cmpint (fsync (fd), ==, 0);
+  g_assert_cmpint (fstat (fd, &destination_statb), ==, 0);
+  close (fd);
+
+  g_assert_cmpint (g_stat (g_file_peek_path (fixture->source), &source_statb), ==, 0);
+
+  /* the holes are still there, wherever they were */
+  g_assert_cmpint (destination_statb.st_size, ==, layout->size);
+  g_assert_cmpint ((goffset) destination_statb.st_blocks * 512, <=,
+                   (goffset) source_statb.st_blocks * 512 + ALLOCATION_SLACK);
+  g_assert_cmpint ((goffset) destination_statb.st_blocks * 512, <, layout->size);
+
+  g_file_get_contents (g_file_peek_path (fixture->source), &source_contents, &source_length, &error);
+  g_assert_no_error (error);
+  g_file_get_contents (g_file_peek_path (fixture->destination), &destination_contents, &destination_length, &error);
+  g_assert_no_error (error);
+
+  g_assert_cmpmem (source_contents, source_length, destination_contents, destination_length);
+
+  g_free (source_contents);
+  g_free (destination_contents);
+}
+
+
+
+static void
+test_copy_file (TestFixture  *fixture,
+                gconstpointer user_data)
+{
+  const TestLayout *layout = user_data;
+  GError           *error = NULL;
+
+  if (!test_has_holes (fixture, layout))
+    return;
+
+  if (!thunar_io_copy_file (fixture->source, fixture->destination, G_FILE_COPY_NONE, FALSE,
+                            NULL, NULL, NULL, &error))
+    {
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+      g_test_skip (error->message);
+      g_error_free (error);
+      return;
+    }
+  test_compare (fixture, layout);
+
+  /* the holes are kept when bypassing the page cache as well */
+  g_file_delete (fixture->destination, NULL, NULL);
+  thunar_io_copy_file (fixture->source, fixture->destination, G_FILE_COPY_NONE, TRUE,
+                       NULL, NULL, NULL, &error);
+  g_assert_no_error (error);
+  test_compare (fixture, layout);
+}
+
+
+
+static void
+test_copy_file_checksum (TestFixture  *fixture,
+                         gconstpointer user_data)
+{
+  const TestLayout *layout = user_data;
+  GError           *error = NULL;
+  gchar            *checksum = NULL;
+  gchar            *expected;
+
+  if (!test_has_holes (fixture, layout))
+    return;
+
+  thunar_io_copy_file_checksum (fixture->source, fixture->destination, G_FILE_COPY_NONE,
+                                G_CHECKSUM_SHA256, NULL, NULL, NULL, &checksum, &error);
+  g_assert_no_error (error);
+  test_compare (fixture, layout);
+
+  /* the checksum of the data read is the one the copy is verified with */
+  expected = thunar_io_checksum_file (fixture->destination, G_CHECKSUM_SHA256, FALSE, NULL, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (checksum, ==, expected);
+
+  g_free (expected);
+  g_free (checksum);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *name;
+  guint  n;
+
+  g_test_init (&argc, &argv, NULL);
+
+  for (n = 0; n < G_N_ELEMENTS (layouts); ++n)
+    {
+      name = g_strdup_printf ("/io-copy/sparse/%s", layouts[n].name);
+      g_test_add (name, TestFixture, &layouts[n], test_setup, test_copy_file, test_teardown);
+      g_free (name);
+
+      name = g_strdup_printf ("/io-copy/sparse-checksum/%s", layouts[n].name);
+      g_test_add (name, TestFixture, &layouts[n], test_setup, test_copy_file_checksum, test_teardown);
+      g_free (name);
+    }
+
+  return g_test_run ();
+}
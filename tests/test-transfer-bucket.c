@@ -0,0 +1,176 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests for the token bucket limiting the rate of transfer jobs. The
+ * clock is simulated, so the tests neither sleep nor depend on the load
+ * of the machine: a copy is modelled as taking from the bucket and then
+ * waiting exactly as long as the bucket asks for.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <thunar/thunar-transfer-bucket.h>
+
+
+
+/* takes @amount and advances the simulated clock by the delay */
+static gint64
+test_throttle (ThunarTransferBucket *bucket,
+               gint64               *now,
+               guint64               amount)
+{
+  gint64 delay;
+  gint64 waited = 0;
+
+  thunar_transfer_bucket_take (bucket, amount);
+  while ((delay = thunar_transfer_bucket_get_delay (bucket, *now)) > 0)
+    {
+      *now += delay;
+      waited += delay;
+    }
+
+  return waited;
+}
+
+
+
+static void
+test_unlimited (void)
+{
+  ThunarTransferBucket bucket = { 0, };
+  gint64               now = 1000;
+
+  thunar_transfer_bucket_set_rate (&bucket, 0, now);
+  g_assert_cmpint (test_throttle (&bucket, &now, G_MAXUINT32), ==, 0);
+  g_assert_cmpint (test_throttle (&bucket, &now, 1), ==, 0);
+  g_assert_cmpfloat (bucket.level, ==, 0);
+}
+
+
+
+static void
+test_delay (void)
+{
+  ThunarTransferBucket bucket = { 0, };
+  gint64               now = 0;
+
+  /* starts empty, so the first 500 units take half a second */
+  thunar_transfer_bucket_set_rate (&bucket, 1000, now);
+  thunar_transfer_bucket_take (&bucket, 500);
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), ==, G_USEC_PER_SEC / 2 + 1);
+
+  /* a quarter of a second later, half of it is left */
+  now += G_USEC_PER_SEC / 4;
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), ==, G_USEC_PER_SEC / 4 + 1);
+
+  /* and none once the time is up */
+  now += G_USEC_PER_SEC / 4;
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), ==, 0);
+}
+
+
+
+static void
+test_burst (void)
+{
+  ThunarTransferBucket bucket = { 0, };
+  gint64               now = 0;
+
+  thunar_transfer_bucket_set_rate (&bucket, 1000, now);
+
+  /* idle for a minute, still only one second worth is saved up */
+  now += 60 * G_USEC_PER_SEC;
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), ==, 0);
+  g_assert_cmpfloat (bucket.level, ==, 1000);
+
+  g_assert_cmpint (test_throttle (&bucket, &now, 1000), ==, 0);
+  g_assert_cmpint (test_throttle (&bucket, &now, 1), ==, G_USEC_PER_SEC / 1000 + 1);
+}
+
+
+
+static void
+test_average_rate (void)
+{
+  ThunarTransferBucket bucket = { 0, };
+  guint64              amounts[] = { 1, 4096, 65536, 3 * 1024 * 1024, 17 };
+  guint64              rate = 10 * 1024 * 1024;
+  guint64              total = 0;
+  gdouble              elapsed;
+  gint64               start = 42 * G_USEC_PER_SEC;
+  gint64               now = start;
+  guint                n;
+
+  thunar_transfer_bucket_set_rate (&bucket, rate, now);
+
+  /* a mix of small and large files for a while */
+  for (n = 0; n < 1000; ++n)
+    {
+      test_throttle (&bucket, &now, amounts[n % G_N_ELEMENTS (amounts)]);
+      total += amounts[n % G_N_ELEMENTS (amounts)];
+    }
+
+  /* everything after the (empty) start is paced by the rate, the
+   * rounding of the delays adds at most one microsecond each */
+  elapsed = (gdouble) (now - start) / G_USEC_PER_SEC;
+  g_assert_cmpfloat (elapsed, >=, (gdouble) total / rate);
+  g_assert_cmpfloat (elapsed, <=, (gdouble) total / rate + 2 * n / (gdouble) G_USEC_PER_SEC);
+}
+
+
+
+static void
+test_set_rate (void)
+{
+  ThunarTransferBucket bucket = { 0, };
+  gint64               now = 0;
+
+  /* deep in debt at a low rate */
+  thunar_transfer_bucket_set_rate (&bucket, 10, now);
+  thunar_transfer_bucket_take (&bucket, 1000);
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), >, 99 * G_USEC_PER_SEC);
+
+  /* a new limit forgives the debt of the old one */
+  thunar_transfer_bucket_set_rate (&bucket, 1000, now);
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), ==, 0);
+  g_assert_cmpint (test_throttle (&bucket, &now, 1000), ==, G_USEC_PER_SEC + 1);
+
+  /* and lifting it lets the copy go on right away */
+  thunar_transfer_bucket_take (&bucket, 1000);
+  thunar_transfer_bucket_set_rate (&bucket, 0, now);
+  g_assert_cmpint (thunar_transfer_bucket_get_delay (&bucket, now), ==, 0);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/transfer-bucket/unlimited", test_unlimited);
+  g_test_add_func ("/transfer-bucket/delay", test_delay);
+  g_test_add_func ("/transfer-bucket/burst", test_burst);
+  g_test_add_func ("/transfer-bucket/average-rate", test_average_rate);
+  g_test_add_func ("/transfer-bucket/set-rate", test_set_rate);
+
+  return g_test_run ();
+}
@@ -0,0 +1,333 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests for the transfer journal. A copy continued after an interruption
+ * may only skip or continue the files whose source is still the one
+ * recorded, everything else has to go through the conflict handling.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-transfer-journal.h>
+
+
+
+typedef struct
+{
+  gchar *dirname;
+  GFile *source;
+  GFile *target;
+  GList *source_list;
+  GList *target_list;
+}
+TestFixture;
+
+
+
+static void
+test_write (GFile       *file,
+            const gchar *contents)
+{
+  gsize length = strlen (contents);
+  gint  fd;
+
+  /* in place, g_file_set_contents() would replace the inode */
+  fd = g_open (g_file_peek_path (file), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  g_assert_cmpint (fd, >=, 0);
+  g_assert_cmpint (write (fd, contents, length), ==, length);
+  g_assert_cmpint (close (fd), ==, 0);
+}
+
+
+
+static GFileInfo *
+test_query (GFile *file)
+{
+  GError    *error = NULL;
+  GFileInfo *info;
+
+  info = g_file_query_info (file, THUNAR_TRANSFER_JOURNAL_ATTRIBUTES,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL, &error);
+  g_assert_no_error (error);
+
+  return info;
+}
+
+
+
+static ThunarTransferJournal *
+test_open (TestFixture *fixture)
+{
+  ThunarTransferJournal *journal;
+  GError                *error = NULL;
+
+  journal = thunar_transfer_journal_open (fixture->source_list, fixture->target_list, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (journal);
+
+  return journal;
+}
+
+
+
+static void
+test_setup (TestFixture  *fixture,
+            gconstpointer user_data)
+{
+  gchar *path;
+
+  fixture->dirname = g_dir_make_tmp ("thunar-test-XXXXXX", NULL);
+  g_assert_nonnull (fixture->dirname);
+
+  path = g_build_filename (fixture->dirname, "source", NULL);
+  fixture->source = g_file_new_for_path (path);
+  g_free (path);
+
+  path = g_build_filename (fixture->dirname, "target", NULL);
+  fixture->target = g_file_new_for_path (path);
+  g_free (path);
+
+  test_write (fixture->source, "the content of the source");
+
+  fixture->source_list = g_list_prepend (NULL, fixture->source);
+  fixture->target_list = g_list_prepend (NULL, fixture->target);
+}
+
+
+
+static void
+test_teardown (TestFixture  *fixture,
+               gconstpointer user_data)
+{
+  ThunarTransferJournal *journal;
+
+  /* closing a completed copy removes the journal */
+  journal = test_open (fixture);
+  thunar_transfer_journal_close (journal, TRUE);
+
+  g_file_delete (fixture->source, NULL, NULL);
+  g_file_delete (fixture->target, NULL, NULL);
+  g_rmdir (fixture->dirname);
+
+  g_list_free (fixture->source_list);
+  g_list_free (fixture->target_list);
+  g_object_unref (fixture->source);
+  g_object_unref (fixture->target);
+  g_free (fixture->dirname);
+}
+
+
+
+static void
+test_done (TestFixture  *fixture,
+           gconstpointer user_data)
+{
+  ThunarTransferJournal *journal;
+  struct timeval         times[2];
+  GFileInfo             *info;
+
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_false (thunar_transfer_journal_is_resumed (journal));
+  thunar_transfer_journal_begin (journal, fixture->target, info);
+  thunar_transfer_journal_done (journal, fixture->target, info);
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+
+  /* an unchanged source is not copied again */
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_true (thunar_transfer_journal_is_resumed (journal));
+  g_assert_true (thunar_transfer_journal_is_done (journal, fixture->target, info));
+  g_assert_false (thunar_transfer_journal_is_partial (journal, fixture->target, info));
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+
+  /* the same size and modification time, but written to since; the
+   * change time only moves on with the clock tick of the kernel */
+  info = test_query (fixture->source);
+  g_usleep (G_USEC_PER_SEC / 10);
+  test_write (fixture->source, "the content of the SOURCE");
+  times[0].tv_sec = times[1].tv_sec = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  times[0].tv_usec = times[1].tv_usec = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  g_assert_cmpint (utimes (g_file_peek_path (fixture->source), times), ==, 0);
+  g_object_unref (info);
+
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_true (thunar_transfer_journal_is_resumed (journal));
+  g_assert_false (thunar_transfer_journal_is_done (journal, fixture->target, info));
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+}
+
+
+
+static void
+test_partial (TestFixture  *fixture,
+              gconstpointer user_data)
+{
+  ThunarTransferJournal *journal;
+  GFileInfo             *info;
+
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  thunar_transfer_journal_begin (journal, fixture->target, info);
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+
+  /* begun but not done, from the same source */
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_true (thunar_transfer_journal_is_partial (journal, fixture->target, info));
+  g_assert_false (thunar_transfer_journal_is_done (journal, fixture->target, info));
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+
+  /* a source grown since is not continued */
+  test_write (fixture->source, "the content of the source, and some more");
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_false (thunar_transfer_journal_is_partial (journal, fixture->target, info));
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+}
+
+
+
+static void
+test_unknown_source (TestFixture  *fixture,
+                     gconstpointer user_data)
+{
+  ThunarTransferJournal *journal;
+  GFileInfo             *info;
+
+  journal = test_open (fixture);
+  thunar_transfer_journal_begin (journal, fixture->target, NULL);
+  thunar_transfer_journal_close (journal, FALSE);
+
+  /* a record without the source never counts as unchanged */
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_true (thunar_transfer_journal_is_resumed (journal));
+  g_assert_false (thunar_transfer_journal_is_partial (journal, fixture->target, info));
+  g_assert_false (thunar_transfer_journal_is_partial (journal, fixture->target, NULL));
+
+  thunar_transfer_journal_done (journal, fixture->target, NULL);
+  thunar_transfer_journal_close (journal, FALSE);
+
+  journal = test_open (fixture);
+  g_assert_false (thunar_transfer_journal_is_done (journal, fixture->target, info));
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+}
+
+
+
+static void
+test_replaced (TestFixture  *fixture,
+               gconstpointer user_data)
+{
+  ThunarTransferJournal *journal;
+  GFileInfo             *info;
+  GFile                 *other;
+  gchar                 *path;
+
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  thunar_transfer_journal_begin (journal, fixture->target, info);
+  thunar_transfer_journal_done (journal, fixture->target, info);
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+
+  /* another file moved in under the same name, with another inode */
+  path = g_build_filename (fixture->dirname, "other", NULL);
+  other = g_file_new_for_path (path);
+  test_write (other, "the content of the source");
+  g_assert_true (g_file_move (other, fixture->source, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, NULL));
+  g_object_unref (other);
+  g_free (path);
+
+  /* the copy starts over, nothing is taken from the old journal */
+  info = test_query (fixture->source);
+  journal = test_open (fixture);
+  g_assert_false (thunar_transfer_journal_is_resumed (journal));
+  g_assert_false (thunar_transfer_journal_is_done (journal, fixture->target, info));
+  thunar_transfer_journal_close (journal, FALSE);
+  g_object_unref (info);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *cache_dir;
+  gchar *path;
+  gint   result;
+
+  /* the journals are written to the cache folder */
+  cache_dir = g_dir_make_tmp ("thunar-test-cache-XXXXXX", NULL);
+  g_assert_nonnull (cache_dir);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/transfer-journal/done", TestFixture, NULL, test_setup, test_done, test_teardown);
+  g_test_add ("/transfer-journal/partial", TestFixture, NULL, test_setup, test_partial, test_teardown);
+  g_test_add ("/transfer-journal/unknown-source", TestFixture, NULL, test_setup, test_unknown_source, test_teardown);
+  g_test_add ("/transfer-journal/replaced", TestFixture, NULL, test_setup, test_replaced, test_teardown);
+
+  result = g_test_run ();
+
+  path = g_build_filename (cache_dir, "Thunar", "transfers", NULL);
+  g_rmdir (path);
+  g_free (path);
+  path = g_build_filename (cache_dir, "Thunar", NULL);
+  g_rmdir (path);
+  g_free (path);
+  g_rmdir (cache_dir);
+  g_free (cache_dir);
+
+  return result;
+}
@@ -0,0 +1,345 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests for keeping hard links in copies, see ThunarTransferJob:transfer-preserve-links.
+ * A tree with files linked to each other, in one folder and across
+ * folders, is copied by a #ThunarTransferJob, and the names that were
+ * links to one file in the source must be links to one file in the copy.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-gobject-extensions.h>
+#include <thunar/thunar-job.h>
+#include <thunar/thunar-preferences.h>
+#include <thunar/thunar-transfer-job.h>
+
+
+
+typedef struct
+{
+  gchar *dirname;
+  GFile *source;
+  GFile *target;
+}
+TestFixture;
+
+
+
+/* the files of the source tree, with the file each is a link to */
+static const struct
+{
+  const gchar *name;
+  const gchar *link_to;
+}
+test_files[] =
+{
+  { "a",       NULL, },
+  { "b",       "a",  },
+  { "sub/c",   "a",  },
+  { "d",       NULL, },
+  { "sub/e",   NULL, },
+  { "f",       "sub/e", },
+};
+
+
+
+static gchar *
+test_path (TestFixture *fixture,
+           const gchar *root,
+           const gchar *name)
+{
+  return g_build_filename (fixture->dirname, root, name, NULL);
+}
+
+
+
+static struct stat
+test_stat (TestFixture *fixture,
+           const gchar *root,
+           const gchar *name)
+{
+  struct stat statb;
+  gchar      *path;
+
+  path = test_path (fixture, root, name);
+  g_assert_cmpint (g_lstat (path, &statb), ==, 0);
+  g_free (path);
+
+  return statb;
+}
+
+
+
+static void
+test_setup (TestFixture  *fixture,
+            gconstpointer user_data)
+{
+  GError *error = NULL;
+  gchar  *path;
+  gchar  *link_path;
+  guint   n;
+
+  fixture->dirname = g_dir_make_tmp ("thunar-test-XXXXXX", NULL);
+  g_assert_nonnull (fixture->dirname);
+
+  path = test_path (fixture, "source", "sub");
+  g_assert_cmpint (g_mkdir_with_parents (path, 0755), ==, 0);
+  g_free (path);
+
+  for (n = 0; n < G_N_ELEMENTS (test_files); ++n)
+    {
+      path = test_path (fixture, "source", test_files[n].name);
+      if (test_files[n].link_to != NULL)
+        {
+          link_path = test_path (fixture, "source", test_files[n].link_to);
+          g_assert_cmpint (link (link_path, path), ==, 0);
+          g_free (link_path);
+        }
+      else
+        {
+          /* the name as content, to tell the copies apart */
+          g_file_set_contents (path, test_files[n].name, -1, &error);
+          g_assert_no_error (error);
+        }
+      g_free (path);
+    }
+
+  path = test_path (fixture, "source", NULL);
+  fixture->source = g_file_new_for_path (path);
+  g_free (path);
+
+  path = test_path (fixture, "target", NULL);
+  fixture->target = g_file_new_for_path (path);
+  g_free (path);
+}
+
+
+
+static void
+test_teardown (TestFixture  *fixture,
+               gconstpointer user_data)
+{
+  const gchar *roots[] = { "source", "target" };
+  gchar       *path;
+  guint        n;
+  guint        m;
+
+  for (m = 0; m < G_N_ELEMENTS (roots); ++m)
+    {
+      for (n = 0; n < G_N_ELEMENTS (test_files); ++n)
+        {
+          path = test_path (fixture, roots[m], test_files[n].name);
+          g_remove (path);
+          g_free (path);
+        }
+
+      path = test_path (fixture, roots[m], "sub");
+      g_rmdir (path);
+      g_free (path);
+
+      path = test_path (fixture, roots[m], NULL);
+      g_rmdir (path);
+      g_free (path);
+    }
+  g_rmdir (fixture->dirname);
+
+  g_object_unref (fixture->source);
+  g_object_unref (fixture->target);
+  g_free (fixture->dirname);
+}
+
+
+
+static void
+test_job_error (ExoJob  *job,
+                GError  *error,
+                GError **error_return)
+{
+  if (*error_return == NULL)
+    *error_return = g_error_copy (error);
+}
+
+
+
+static void
+test_copy (TestFixture *fixture,
+           gboolean     preserve_links)
+{
+  ThunarJob *job;
+  GMainLoop *loop;
+  GError    *error = NULL;
+  GList      source_list = { fixture->source, NULL, NULL };
+  GList      target_list = { fixture->target, NULL, NULL };
+
+  job = thunar_transfer_job_new (&source_list, &target_list, THUNAR_TRANSFER_JOB_COPY);
+  thunar_job_set_log_mode (job, THUNAR_OPERATION_LOG_NO_OPERATIONS);
+  g_object_set (job, "transfer-preserve-links", preserve_links, NULL);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (job, "error", G_CALLBACK (test_job_error), &error);
+  g_signal_connect_swapped (job, "finished", G_CALLBACK (g_main_loop_quit), loop);
+
+  exo_job_launch (EXO_JOB (job));
+  g_main_loop_run (loop);
+  g_assert_no_error (error);
+
+  g_main_loop_unref (loop);
+  g_object_unref (job);
+}
+
+
+
+static void
+test_check_contents (TestFixture *fixture)
+{
+  GError      *error = NULL;
+  const gchar *name;
+  gchar       *contents;
+  gchar       *path;
+  guint        n;
+
+  for (n = 0; n < G_N_ELEMENTS (test_files); ++n)
+    {
+      name = test_files[n].link_to != NULL ? test_files[n].link_to : test_files[n].name;
+      path = test_path (fixture, "target", test_files[n].name);
+      g_file_get_contents (path, &contents, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (contents, ==, name);
+      g_free (contents);
+      g_free (path);
+    }
+}
+
+
+
+static void
+test_preserved (TestFixture  *fixture,
+                gconstpointer user_data)
+{
+  struct stat source;
+  struct stat a;
+  struct stat statb;
+  struct stat e;
+
+  test_copy (fixture, TRUE);
+  test_check_contents (fixture);
+
+  /* all the names of a are links to one new file */
+  source = test_stat (fixture, "source", "a");
+  a = test_stat (fixture, "target", "a");
+  g_assert_cmpuint (a.st_ino, !=, source.st_ino);
+  g_assert_cmpuint (a.st_nlink, ==, 3);
+
+  statb = test_stat (fixture, "target", "b");
+  g_assert_cmpuint (statb.st_ino, ==, a.st_ino);
+  statb = test_stat (fixture, "target", "sub/c");
+  g_assert_cmpuint (statb.st_ino, ==, a.st_ino);
+
+  /* the same for a link from the folder above, to another file */
+  e = test_stat (fixture, "target", "sub/e");
+  g_assert_cmpuint (e.st_ino, !=, a.st_ino);
+  g_assert_cmpuint (e.st_nlink, ==, 2);
+  statb = test_stat (fixture, "target", "f");
+  g_assert_cmpuint (statb.st_ino, ==, e.st_ino);
+
+  /* files with a single link are copied as usual */
+  statb = test_stat (fixture, "target", "d");
+  g_assert_cmpuint (statb.st_ino, !=, a.st_ino);
+  g_assert_cmpuint (statb.st_ino, !=, e.st_ino);
+  g_assert_cmpuint (statb.st_nlink, ==, 1);
+}
+
+
+
+static void
+test_not_preserved (TestFixture  *fixture,
+                    gconstpointer user_data)
+{
+  struct stat statb;
+  guint       n;
+
+  test_copy (fixture, FALSE);
+  test_check_contents (fixture);
+
+  /* every name is a copy of its own */
+  for (n = 0; n < G_N_ELEMENTS (test_files); ++n)
+    {
+      statb = test_stat (fixture, "target", test_files[n].name);
+      g_assert_cmpuint (statb.st_nlink, ==, 1);
+    }
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *cache_dir;
+  gchar *path;
+  gint   result;
+
+  /* the journals of the copies are written to the cache folder */
+  cache_dir = g_dir_make_tmp ("thunar-test-cache-XXXXXX", NULL);
+  g_assert_nonnull (cache_dir);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* the tests must not touch the settings of the user */
+  thunar_preferences_xfconf_init_failed ();
+  thunar_g_initialize_transformations ();
+
+  g_test_add ("/transfer-links/preserved", TestFixture, NULL, test_setup, test_preserved, test_teardown);
+  g_test_add ("/transfer-links/not-preserved", TestFixture, NULL, test_setup, test_not_preserved, test_teardown);
+
+  result = g_test_run ();
+
+  path = g_build_filename (cache_dir, "Thunar", "transfers", NULL);
+  g_rmdir (path);
+  g_free (path);
+  path = g_build_filename (cache_dir, "Thunar", NULL);
+  g_rmdir (path);
+  g_free (path);
+  g_rmdir (cache_dir);
+  g_free (cache_dir);
+
+  return result;
+}
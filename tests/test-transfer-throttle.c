@@ -0,0 +1,216 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests for the byte limit of a copy, see ThunarTransferJob:max-byte-rate.
+ * A file of a few chunks is copied by a #ThunarTransferJob on tmpfs,
+ * where the copy itself takes no time, so the time the job takes is the
+ * time the limit makes it wait, and the measured rate must be the limit.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-gobject-extensions.h>
+#include <thunar/thunar-io-copy.h>
+#include <thunar/thunar-job.h>
+#include <thunar/thunar-preferences.h>
+#include <thunar/thunar-transfer-job.h>
+
+
+
+/* two and a half chunks, too large for the copy workers */
+#define TEST_FILE_SIZE (THUNAR_IO_COPY_CHUNK_SIZE * 5 / 2)
+
+/* the limit, so the copy takes more than a second */
+#define TEST_BYTE_RATE (16 * 1024 * 1024)
+
+/* how far the measured rate may be off the limit, in percent */
+#define TEST_TOLERANCE 25
+
+
+
+typedef struct
+{
+  gchar *dirname;
+  GFile *source;
+  GFile *target;
+}
+TestFixture;
+
+
+
+static void
+test_setup (TestFixture  *fixture,
+            gconstpointer user_data)
+{
+  GError *error = NULL;
+  gchar  *contents;
+  gchar  *path;
+  gsize   n;
+
+  /* tmpfs if there is one, so the limit is all the copy waits for */
+  if (g_access ("/dev/shm", W_OK) == 0)
+    {
+      path = g_build_filename ("/dev/shm", "thunar-test-XXXXXX", NULL);
+      fixture->dirname = g_mkdtemp (path);
+    }
+  else
+    {
+      fixture->dirname = g_dir_make_tmp ("thunar-test-XXXXXX", NULL);
+    }
+  g_assert_nonnull (fixture->dirname);
+
+  /* written out, a sparse file would be copied without reading the holes */
+  contents = g_malloc (TEST_FILE_SIZE);
+  for (n = 0; n < TEST_FILE_SIZE; ++n)
+    contents[n] = (gchar) (n % 251);
+
+  path = g_build_filename (fixture->dirname, "source", NULL);
+  g_file_set_contents (path, contents, TEST_FILE_SIZE, &error);
+  g_assert_no_error (error);
+  fixture->source = g_file_new_for_path (path);
+  g_free (path);
+  g_free (contents);
+
+  path = g_build_filename (fixture->dirname, "target", NULL);
+  fixture->target = g_file_new_for_path (path);
+  g_free (path);
+}
+
+
+
+static void
+test_teardown (TestFixture  *fixture,
+               gconstpointer user_data)
+{
+  g_file_delete (fixture->source, NULL, NULL);
+  g_file_delete (fixture->target, NULL, NULL);
+  g_rmdir (fixture->dirname);
+
+  g_object_unref (fixture->source);
+  g_object_unref (fixture->target);
+  g_free (fixture->dirname);
+}
+
+
+
+static void
+test_job_error (ExoJob  *job,
+                GError  *error,
+                GError **error_return)
+{
+  if (*error_return == NULL)
+    *error_return = g_error_copy (error);
+}
+
+
+
+static void
+test_byte_rate (TestFixture  *fixture,
+                gconstpointer user_data)
+{
+  ThunarJob *job;
+  GMainLoop *loop;
+  GFileInfo *info;
+  GError    *error = NULL;
+  GList      source_list = { fixture->source, NULL, NULL };
+  GList      target_list = { fixture->target, NULL, NULL };
+  gint64     start_time;
+  gint64     elapsed;
+  gdouble    rate;
+
+  job = thunar_transfer_job_new (&source_list, &target_list, THUNAR_TRANSFER_JOB_COPY);
+  thunar_job_set_log_mode (job, THUNAR_OPERATION_LOG_NO_OPERATIONS);
+  g_object_set (job, "max-byte-rate", (guint64) TEST_BYTE_RATE, NULL);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (job, "error", G_CALLBACK (test_job_error), &error);
+  g_signal_connect_swapped (job, "finished", G_CALLBACK (g_main_loop_quit), loop);
+
+  start_time = g_get_monotonic_time ();
+  exo_job_launch (EXO_JOB (job));
+  g_main_loop_run (loop);
+  elapsed = g_get_monotonic_time () - start_time;
+  g_assert_no_error (error);
+
+  g_main_loop_unref (loop);
+  g_object_unref (job);
+
+  info = g_file_query_info (fixture->target, G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_file_info_get_size (info), ==, TEST_FILE_SIZE);
+  g_object_unref (info);
+
+  /* the copy takes as long as the limit allows for the size */
+  rate = (gdouble) TEST_FILE_SIZE * G_USEC_PER_SEC / elapsed;
+  g_test_message ("copied %d bytes in %" G_GINT64_FORMAT " us, %.0f bytes/s",
+                  TEST_FILE_SIZE, elapsed, rate);
+  g_assert_cmpfloat (rate, <=, TEST_BYTE_RATE * (100.0 + TEST_TOLERANCE) / 100.0);
+  g_assert_cmpfloat (rate, >=, TEST_BYTE_RATE * (100.0 - TEST_TOLERANCE) / 100.0);
+}
+
+
+
+int
+main (int argc, char **argv)
+{
+  gchar *cache_dir;
+  gchar *path;
+  gint   result;
+
+  /* the journals of the copies are written to the cache folder */
+  cache_dir = g_dir_make_tmp ("thunar-test-cache-XXXXXX", NULL);
+  g_assert_nonnull (cache_dir);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* the tests must not touch the settings of the user */
+  thunar_preferences_xfconf_init_failed ();
+  thunar_g_initialize_transformations ();
+
+  g_test_add ("/transfer-throttle/byte-rate", TestFixture, NULL, test_setup, test_byte_rate, test_teardown);
+
+  result = g_test_run ();
+
+  path = g_build_filename (cache_dir, "Thunar", "transfers", NULL);
+  g_rmdir (path);
+  g_free (path);
+  path = g_build_filename (cache_dir, "Thunar", NULL);
+  g_rmdir (path);
+  g_free (path);
+  g_rmdir (cache_dir);
+  g_free (cache_dir);
+
+  return result;
+}
@@ -48,6 +48,7 @@
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-browser.h>
 #include <thunar/thunar-dialogs.h>
+#include <thunar/thunar-folder.h>
 #include <thunar/thunar-gdk-extensions.h>
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-io-jobs.h>
@@ -60,6 +61,7 @@
 #include <thunar/thunar-transfer-job.h>
 #include <thunar/thunar-util.h>
 #include <thunar/thunar-view.h>
+#include <thunar/thunar-watch-registry.h>
 #include <thunar/thunar-session-client.h>
 #include <thunar/thunar-dbus-service.h>
 
@@ -134,6 +136,8 @@ static gboolean       thunar_application_dbus_register          (GApplication
                                                                  GError                **error);
 static void           thunar_application_load_css               (void);
 static void           thunar_application_accel_map_changed      (ThunarApplication      *application);
+static void           thunar_application_file_watch_budget_changed (ThunarApplication *application);
+static void           thunar_application_virtual_listing_threshold_changed (ThunarApplication *application);
 static gboolean       thunar_application_accel_map_save         (gpointer                user_data);
 static gboolean       thunar_application_accel_map_load         (gpointer                user_data);
 static void           thunar_application_collect_and_launch     (ThunarApplication      *application,
@@ -362,6 +366,16 @@ thunar_application_startup (GApplication *gapp)
   /* initialize the application */
   application->preferences = thunar_preferences_get ();
 
+  /* apply the file watch budget and keep it in sync */
+  thunar_application_file_watch_budget_changed (application);
+  g_signal_connect_swapped (G_OBJECT (application->preferences), "notify::misc-file-watch-budget",
+                            G_CALLBACK (thunar_application_file_watch_budget_changed), application);
+
+  /* same for the size above which folders are listed virtually */
+  thunar_application_virtual_listing_threshold_changed (application);
+  g_signal_connect_swapped (G_OBJECT (application->preferences), "notify::misc-virtual-listing-threshold",
+                            G_CALLBACK (thunar_application_virtual_listing_threshold_changed), application);
+
 #ifdef HAVE_GUDEV
   /* establish connection with udev */
   application->udev_client = g_udev_client_new (subsystems);
@@ -437,6 +451,8 @@ thunar_application_shutdown (GApplication *gapp)
     g_object_unref (G_OBJECT (application->thumbnail_cache));
 
   /* disconnect from the preferences */
+  g_signal_handlers_disconnect_by_func (application->preferences, thunar_application_file_watch_budget_changed, application);
+  g_signal_handlers_disconnect_by_func (application->preferences, thunar_application_virtual_listing_threshold_changed, application);
   g_object_unref (G_OBJECT (application->preferences));
 
   /* disconnect from the session manager */
@@ -778,6 +794,40 @@ thunar_application_accel_map_load (gpointer user_data)
 
 
 
+static void
+thunar_application_file_watch_budget_changed (ThunarApplication *application)
+{
+  guint budget;
+  guint n_monitored;
+  guint n_polled;
+  guint n_watches;
+
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+
+  g_object_get (G_OBJECT (application->preferences), "misc-file-watch-budget", &budget, NULL);
+  thunar_watch_registry_set_budget (budget);
+
+  /* so the effect of a new budget can be checked */
+  thunar_watch_registry_get_usage (&n_monitored, &n_polled, &n_watches);
+  g_debug ("Watch budget set to %u: %u watches on %u monitored and %u polled locations",
+           budget, n_watches, n_monitored, n_polled);
+}
+
+
+
+static void
+thunar_application_virtual_listing_threshold_changed (ThunarApplication *application)
+{
+  guint threshold;
+
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+
+  g_object_get (G_OBJECT (application->preferences), "misc-virtual-listing-threshold", &threshold, NULL);
+  thunar_folder_set_virtual_threshold (threshold);
+}
+
+
+
 static void
 thunar_application_accel_map_changed (ThunarApplication *application)
 {
@@ -241,6 +241,7 @@ thunar_details_view_init (ThunarDetailsView *details_view)
 
   /* configure general aspects of the details view */
   gtk_tree_view_set_enable_search (GTK_TREE_VIEW (tree_view), TRUE);
+  gtk_tree_view_set_search_equal_func (GTK_TREE_VIEW (tree_view), thunar_list_model_search_equal, NULL, NULL);
 
   /* enable rubberbanding (if supported) */
   gtk_tree_view_set_rubber_banding (GTK_TREE_VIEW (tree_view), TRUE);
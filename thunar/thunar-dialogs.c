@@ -42,6 +42,7 @@
 #include <thunar/thunar-pango-extensions.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-transfer-job.h>
 #include <thunar/thunar-util.h>
 
 
@@ -978,6 +979,321 @@ thunar_dialogs_show_job_ask_replace (GtkWindow  *parent,
 
 
 
+/* columns of the list in thunar_dialogs_show_job_ask_conflicts() */
+enum
+{
+  CONFLICTS_COLUMN_CONFLICT,
+  CONFLICTS_COLUMN_NAME,
+  CONFLICTS_COLUMN_FOLDER,
+  CONFLICTS_COLUMN_SOURCE,
+  CONFLICTS_COLUMN_TARGET,
+  CONFLICTS_COLUMN_ACTION,
+  CONFLICTS_N_COLUMNS,
+};
+
+
+
+/* names of the #ThunarConflictRule<!---->s, in the same order */
+static const gchar *conflict_rule_names[] =
+{
+  N_("Ask"),
+  N_("Replace"),
+  N_("Replace if newer"),
+  N_("Replace if larger"),
+  N_("Skip"),
+  N_("Rename"),
+};
+
+
+
+static const gchar *
+thunar_dialogs_conflict_action (const ThunarTransferConflict *conflict)
+{
+  switch (thunar_transfer_conflict_get_response (conflict))
+    {
+    case THUNAR_JOB_RESPONSE_REPLACE:
+      return _("Replace");
+
+    case THUNAR_JOB_RESPONSE_SKIP:
+      return _("Skip");
+
+    case THUNAR_JOB_RESPONSE_RENAME:
+      return _("Rename");
+
+    default:
+      return _("Ask");
+    }
+}
+
+
+
+static gchar *
+thunar_dialogs_conflict_describe (GFileType       type,
+                                  guint64         size,
+                                  guint64         mtime,
+                                  gboolean        file_size_binary,
+                                  ThunarDateStyle date_style,
+                                  const gchar    *date_custom_style)
+{
+  gchar *size_string;
+  gchar *date_string;
+  gchar *text;
+
+  if (type == G_FILE_TYPE_DIRECTORY)
+    size_string = g_strdup (_("Folder"));
+  else
+    size_string = g_format_size_full (size, file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
+  date_string = thunar_util_humanize_file_time (mtime, date_style, date_custom_style);
+
+  text = g_strdup_printf ("%s, %s", size_string, date_string);
+
+  g_free (size_string);
+  g_free (date_string);
+
+  return text;
+}
+
+
+
+static void
+thunar_dialogs_show_job_ask_conflicts_apply (GtkWidget    *button,
+                                             GtkListStore *store)
+{
+  ThunarTransferConflict *conflict;
+  ThunarConflictRule      rule;
+  GtkTreeModel           *model = GTK_TREE_MODEL (store);
+  GtkTreeIter             iter;
+  GtkWidget              *entry;
+  GtkWidget              *combo;
+  const gchar            *pattern;
+  gchar                  *name;
+  gboolean                valid;
+
+  entry = g_object_get_data (G_OBJECT (button), "pattern-entry");
+  combo = g_object_get_data (G_OBJECT (button), "rule-combo");
+
+  rule = gtk_combo_box_get_active (GTK_COMBO_BOX (combo));
+  pattern = gtk_entry_get_text (GTK_ENTRY (entry));
+
+  /* an empty pattern applies the rule to all files */
+  for (valid = gtk_tree_model_get_iter_first (model, &iter); valid; valid = gtk_tree_model_iter_next (model, &iter))
+    {
+      gtk_tree_model_get (model, &iter,
+                          CONFLICTS_COLUMN_CONFLICT, &conflict,
+                          CONFLICTS_COLUMN_NAME, &name,
+                          -1);
+
+      if (*pattern == '\0' || g_pattern_match_simple (pattern, name))
+        {
+          conflict->rule = rule;
+          gtk_list_store_set (store, &iter, CONFLICTS_COLUMN_ACTION, thunar_dialogs_conflict_action (conflict), -1);
+        }
+
+      g_free (name);
+    }
+}
+
+
+
+/**
+ * thunar_dialogs_show_job_ask_conflicts:
+ * @parent    : the parent #GtkWindow or %NULL.
+ * @conflicts : a list of #ThunarTransferConflict<!---->s.
+ *
+ * Lists all files of a copy that already exist in the destination
+ * and lets the user pick how to resolve them, by rules applied to
+ * the files matching a pattern. The rules are stored in @conflicts.
+ *
+ * Return value: %THUNAR_JOB_RESPONSE_YES to copy the files, or
+ *               %THUNAR_JOB_RESPONSE_CANCEL.
+ **/
+ThunarJobResponse
+thunar_dialogs_show_job_ask_conflicts (GtkWindow *parent,
+                                       GList     *conflicts)
+{
+  ThunarTransferConflict *conflict;
+  ThunarPreferences      *preferences;
+  ThunarDateStyle         date_style;
+  GtkListStore           *store;
+  GtkTreeViewColumn      *column;
+  GtkCellRenderer        *renderer;
+  GtkTreeIter             iter;
+  GtkWidget              *dialog;
+  GtkWidget              *grid;
+  GtkWidget              *label;
+  GtkWidget              *swin;
+  GtkWidget              *tree_view;
+  GtkWidget              *entry;
+  GtkWidget              *combo;
+  GtkWidget              *button;
+  GFile                  *parent_file;
+  GList                  *lp;
+  gchar                  *date_custom_style;
+  gchar                  *name;
+  gchar                  *folder;
+  gchar                  *source_text;
+  gchar                  *target_text;
+  gchar                  *text;
+  gboolean                file_size_binary;
+  guint                   n_conflicts;
+  guint                   n;
+  gint                    response;
+  gint                    row = 0;
+
+  _thunar_return_val_if_fail (parent == NULL || GTK_IS_WINDOW (parent), THUNAR_JOB_RESPONSE_CANCEL);
+  _thunar_return_val_if_fail (conflicts != NULL, THUNAR_JOB_RESPONSE_CANCEL);
+
+  /* determine the style used to format dates */
+  preferences = thunar_preferences_get ();
+  g_object_get (G_OBJECT (preferences), "misc-date-style", &date_style, NULL);
+  g_object_get (G_OBJECT (preferences), "misc-date-custom-style", &date_custom_style, NULL);
+  g_object_get (G_OBJECT (preferences), "misc-file-size-binary", &file_size_binary, NULL);
+  g_object_unref (G_OBJECT (preferences));
+
+  dialog = gtk_dialog_new_with_buttons (_("Confirm to replace files"),
+                                        parent,
+                                        GTK_DIALOG_MODAL
+                                        | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                        _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                        _("C_ontinue"), GTK_RESPONSE_OK,
+                                        NULL);
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_OK);
+  gtk_window_set_default_size (GTK_WINDOW (dialog), 700, 450);
+
+  grid = gtk_grid_new ();
+  gtk_grid_set_column_spacing (GTK_GRID (grid), 6);
+  gtk_grid_set_row_spacing (GTK_GRID (grid), 6);
+  gtk_container_set_border_width (GTK_CONTAINER (grid), 10);
+  gtk_box_pack_start (GTK_BOX (gtk_dialog_get_content_area (GTK_DIALOG (dialog))), grid, TRUE, TRUE, 0);
+  gtk_widget_show (grid);
+
+  n_conflicts = g_list_length (conflicts);
+  text = g_strdup_printf (ngettext ("%u file already exists in the destination.",
+                                    "%u files already exist in the destination.",
+                                    n_conflicts), n_conflicts);
+  label = gtk_label_new (text);
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0f);
+  gtk_label_set_attributes (GTK_LABEL (label), thunar_pango_attr_list_big ());
+  gtk_widget_set_hexpand (label, TRUE);
+  gtk_grid_attach (GTK_GRID (grid), label, 0, row, 4, 1);
+  gtk_widget_show (label);
+  g_free (text);
+
+  /* next row */
+  row++;
+
+  label = gtk_label_new (_("Choose a rule for the files matching a pattern, like \"*.jpg\", or for all of them. "
+                           "Files left to \"Ask\" are asked about while copying."));
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0f);
+  gtk_label_set_line_wrap (GTK_LABEL (label), TRUE);
+  gtk_grid_attach (GTK_GRID (grid), label, 0, row, 4, 1);
+  gtk_widget_show (label);
+
+  /* next row */
+  row++;
+
+  store = gtk_list_store_new (CONFLICTS_N_COLUMNS, G_TYPE_POINTER, G_TYPE_STRING, G_TYPE_STRING,
+                              G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+  for (lp = conflicts; lp != NULL; lp = lp->next)
+    {
+      conflict = lp->data;
+
+      /* merging big trees is what this is for, replace what is outdated by default */
+      conflict->rule = THUNAR_CONFLICT_RULE_REPLACE_NEWER;
+
+      name = thunar_g_file_get_display_name (conflict->target_file);
+      parent_file = g_file_get_parent (conflict->target_file);
+      folder = parent_file != NULL ? g_file_get_parse_name (parent_file) : g_strdup ("");
+      source_text = thunar_dialogs_conflict_describe (conflict->source_type, conflict->source_size, conflict->source_mtime,
+                                                      file_size_binary, date_style, date_custom_style);
+      target_text = thunar_dialogs_conflict_describe (conflict->target_type, conflict->target_size, conflict->target_mtime,
+                                                      file_size_binary, date_style, date_custom_style);
+
+      gtk_list_store_insert_with_values (store, &iter, -1,
+                                         CONFLICTS_COLUMN_CONFLICT, conflict,
+                                         CONFLICTS_COLUMN_NAME, name,
+                                         CONFLICTS_COLUMN_FOLDER, folder,
+                                         CONFLICTS_COLUMN_SOURCE, source_text,
+                                         CONFLICTS_COLUMN_TARGET, target_text,
+                                         CONFLICTS_COLUMN_ACTION, thunar_dialogs_conflict_action (conflict),
+                                         -1);
+
+      if (parent_file != NULL)
+        g_object_unref (parent_file);
+      g_free (name);
+      g_free (folder);
+      g_free (source_text);
+      g_free (target_text);
+    }
+
+  swin = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (swin), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+  gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (swin), GTK_SHADOW_IN);
+  gtk_widget_set_hexpand (swin, TRUE);
+  gtk_widget_set_vexpand (swin, TRUE);
+  gtk_grid_attach (GTK_GRID (grid), swin, 0, row, 4, 1);
+  gtk_widget_show (swin);
+
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_container_add (GTK_CONTAINER (swin), tree_view);
+  gtk_widget_show (tree_view);
+
+  /* append the text columns */
+  for (n = CONFLICTS_COLUMN_NAME; n < CONFLICTS_N_COLUMNS; ++n)
+    {
+      static const gchar *titles[] = { NULL, N_("Name"), N_("Folder"), N_("New"), N_("Existing"), N_("Action") };
+
+      renderer = gtk_cell_renderer_text_new ();
+      g_object_set (G_OBJECT (renderer), "ellipsize", PANGO_ELLIPSIZE_MIDDLE, NULL);
+      column = gtk_tree_view_column_new_with_attributes (_(titles[n]), renderer, "text", n, NULL);
+      gtk_tree_view_column_set_resizable (column, TRUE);
+      gtk_tree_view_column_set_expand (column, (n == CONFLICTS_COLUMN_NAME || n == CONFLICTS_COLUMN_FOLDER));
+      gtk_tree_view_append_column (GTK_TREE_VIEW (tree_view), column);
+    }
+
+  /* next row */
+  row++;
+
+  label = gtk_label_new_with_mnemonic (_("_Files:"));
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0f);
+  gtk_grid_attach (GTK_GRID (grid), label, 0, row, 1, 1);
+  gtk_widget_show (label);
+
+  entry = gtk_entry_new ();
+  gtk_entry_set_placeholder_text (GTK_ENTRY (entry), _("All files"));
+  gtk_widget_set_hexpand (entry, TRUE);
+  gtk_grid_attach (GTK_GRID (grid), entry, 1, row, 1, 1);
+  thunar_gtk_label_set_a11y_relation (GTK_LABEL (label), entry);
+  gtk_label_set_mnemonic_widget (GTK_LABEL (label), entry);
+  gtk_widget_show (entry);
+
+  combo = gtk_combo_box_text_new ();
+  for (n = 0; n < G_N_ELEMENTS (conflict_rule_names); ++n)
+    gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (combo), _(conflict_rule_names[n]));
+  gtk_combo_box_set_active (GTK_COMBO_BOX (combo), THUNAR_CONFLICT_RULE_REPLACE_NEWER);
+  gtk_grid_attach (GTK_GRID (grid), combo, 2, row, 1, 1);
+  gtk_widget_show (combo);
+
+  button = gtk_button_new_with_mnemonic (_("_Apply"));
+  g_object_set_data (G_OBJECT (button), "pattern-entry", entry);
+  g_object_set_data (G_OBJECT (button), "rule-combo", combo);
+  g_signal_connect (button, "clicked", G_CALLBACK (thunar_dialogs_show_job_ask_conflicts_apply), store);
+  gtk_grid_attach (GTK_GRID (grid), button, 3, row, 1, 1);
+  gtk_widget_show (button);
+
+  /* run the dialog */
+  response = gtk_dialog_run (GTK_DIALOG (dialog));
+  gtk_widget_destroy (dialog);
+
+  /* cleanup */
+  g_object_unref (store);
+  g_free (date_custom_style);
+
+  return (response == GTK_RESPONSE_OK) ? THUNAR_JOB_RESPONSE_YES : THUNAR_JOB_RESPONSE_CANCEL;
+}
+
+
+
 /**
  * thunar_dialogs_show_job_error:
  * @parent : the parent #GtkWindow or %NULL.
@@ -47,6 +47,8 @@ ThunarJobResponse  thunar_dialogs_show_job_ask          (GtkWindow            *p
 ThunarJobResponse  thunar_dialogs_show_job_ask_replace  (GtkWindow            *parent,
                                                          ThunarFile           *src_file,
                                                          ThunarFile           *dst_file);
+ThunarJobResponse  thunar_dialogs_show_job_ask_conflicts (GtkWindow           *parent,
+                                                          GList               *conflicts);
 void               thunar_dialogs_show_job_error        (GtkWindow            *parent,
                                                          GError               *error);
 gboolean           thunar_dialogs_show_insecure_program (gpointer              parent,
@@ -648,6 +648,30 @@ thunar_verify_file_get_type (void)
 
 
 
+GType
+thunar_verify_checksum_get_type (void)
+{
+  static GType type = G_TYPE_INVALID;
+
+  if (G_UNLIKELY (type == G_TYPE_INVALID))
+    {
+      static const GEnumValue values[] =
+      {
+        { THUNAR_VERIFY_CHECKSUM_MD5,    "THUNAR_VERIFY_CHECKSUM_MD5",    N_("MD5"),},
+        { THUNAR_VERIFY_CHECKSUM_SHA1,   "THUNAR_VERIFY_CHECKSUM_SHA1",   N_("SHA-1"),},
+        { THUNAR_VERIFY_CHECKSUM_SHA256, "THUNAR_VERIFY_CHECKSUM_SHA256", N_("SHA-256"),},
+        { THUNAR_VERIFY_CHECKSUM_SHA512, "THUNAR_VERIFY_CHECKSUM_SHA512", N_("SHA-512"),},
+        { 0,                             NULL,                            NULL,},
+      };
+
+      type = g_enum_register_static (I_("ThunarVerifyChecksum"), values);
+    }
+
+  return type;
+}
+
+
+
 /**
  * thunar_status_bar_info_toggle_bit:
  * @info   : a #guint.
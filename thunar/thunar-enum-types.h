@@ -412,6 +412,29 @@ GType thunar_verify_file_get_type (void) G_GNUC_CONST;
 
 
 
+#define THUNAR_TYPE_VERIFY_CHECKSUM (thunar_verify_checksum_get_type ())
+
+/**
+ * ThunarVerifyChecksum:
+ * @THUNAR_VERIFY_CHECKSUM_MD5    : Verify copies with MD5
+ * @THUNAR_VERIFY_CHECKSUM_SHA1   : Verify copies with SHA-1
+ * @THUNAR_VERIFY_CHECKSUM_SHA256 : Verify copies with SHA-256
+ * @THUNAR_VERIFY_CHECKSUM_SHA512 : Verify copies with SHA-512
+ *
+ * The hash used to verify copies, the values match #GChecksumType.
+ **/
+typedef enum
+{
+  THUNAR_VERIFY_CHECKSUM_MD5    = G_CHECKSUM_MD5,
+  THUNAR_VERIFY_CHECKSUM_SHA1   = G_CHECKSUM_SHA1,
+  THUNAR_VERIFY_CHECKSUM_SHA256 = G_CHECKSUM_SHA256,
+  THUNAR_VERIFY_CHECKSUM_SHA512 = G_CHECKSUM_SHA512,
+} ThunarVerifyChecksum;
+
+GType thunar_verify_checksum_get_type (void) G_GNUC_CONST;
+
+
+
 /**
  * ThunarNewTabBehavior:
  * @THUNAR_NEW_TAB_BEHAVIOR_FOLLOW_PREFERENCE   : switching to the new tab or not is controlled by a preference.
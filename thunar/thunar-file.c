@@ -69,12 +69,16 @@
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-user.h>
 #include <thunar/thunar-util.h>
+#include <thunar/thunar-watch-registry.h>
 
 
 
 /* Dump the file cache every X second, set to 0 to disable */
 #define DUMP_FILE_CACHE 0
 
+/* Dump the content type statistics every X second, set to 0 to disable */
+#define DUMP_CONTENT_TYPE_STATS 0
+
 
 
 /* Signal identifiers */
@@ -107,8 +111,7 @@ static gboolean           thunar_file_denies_access_permission (const ThunarFile
                                                                 ThunarFileMode          usr_permissions,
                                                                 ThunarFileMode          grp_permissions,
                                                                 ThunarFileMode          oth_permissions);
-static void               thunar_file_monitor                  (GFileMonitor           *monitor,
-                                                                GFile                  *path,
+static void               thunar_file_monitor                  (GFile                  *path,
                                                                 GFile                  *other_path,
                                                                 GFileMonitorEvent       event_type,
                                                                 gpointer                user_data);
@@ -127,15 +130,29 @@ G_LOCK_DEFINE_STATIC (file_cache_mutex);
 G_LOCK_DEFINE_STATIC (file_content_type_mutex);
 G_LOCK_DEFINE_STATIC (file_rename_mutex);
 G_LOCK_DEFINE_STATIC (file_trash_loaded_mutex);
+G_LOCK_DEFINE_STATIC (desktop_entry_cache_mutex);
 
 
 
 static ThunarUserManager *user_manager;
 static GHashTable        *file_cache;
+static GHashTable        *desktop_entry_cache;
+static GHashTable        *desktop_entry_loads;
 static guint32            effective_user_id;
 static GQuark             thunar_file_watch_quark;
 static guint              file_signals[LAST_SIGNAL];
 
+/* content type statistics, protected by file_content_type_mutex */
+static struct
+{
+  guint  n_glob;         /* resolved by the file name only */
+  guint  n_sniffed;      /* resolved by reading the file */
+  guint  n_background;   /* of which were sniffed in the background */
+  gint64 glob_time;      /* in microseconds */
+  gint64 sniff_time;
+}
+content_type_stats;
+
 
 
 #define FLAG_SET_THUMB_STATE(file,new_state) G_STMT_START{ (file)->flags = ((file)->flags & ~THUNAR_FILE_FLAG_THUMB_MASK) | (new_state); }G_STMT_END
@@ -146,6 +163,13 @@ static guint              file_signals[LAST_SIGNAL];
 
 #define DEFAULT_CONTENT_TYPE "application/octet-stream"
 
+/* drop the parsed .desktop file cache once it holds this many entries */
+#define DESKTOP_ENTRY_CACHE_MAX 8192
+
+/* threads sniffing content types in the background, so opening a large
+ * folder does not flood the thread pool shared with all the other I/O */
+#define SNIFF_THREADS 2
+
 
 
 typedef enum
@@ -154,6 +178,7 @@ typedef enum
   THUNAR_FILE_FLAG_IN_DESTRUCTION = 1 << 2, /* for avoiding recursion during destroy */
   THUNAR_FILE_FLAG_IS_MOUNTED     = 1 << 3, /* whether this file is mounted */
   THUNAR_FILE_FLAG_TRASH_LOADED   = 1 << 4, /* whether the trash info has been loaded */
+  THUNAR_FILE_FLAG_SNIFFING       = 1 << 5, /* the content type is a guess, sniffing it in the background */
 }
 ThunarFileFlags;
 
@@ -191,6 +216,9 @@ struct _ThunarFile
   /* flags for thumbnail state etc */
   ThunarFileFlags       flags;
 
+  /* bumped on reload, so results of older sniffs are dropped */
+  guint                 sniff_generation;
+
   /* tells whether the file watch is not set */
   gboolean              no_file_watch;
 
@@ -207,7 +235,7 @@ struct _ThunarFile
 
 typedef struct
 {
-  GFileMonitor  *monitor;
+  ThunarWatch   *watch;
   guint          watch_count;
 }
 ThunarFileWatch;
@@ -220,6 +248,28 @@ typedef struct
 }
 ThunarFileGetData;
 
+typedef struct
+{
+  /* the .desktop file and the state it was parsed in */
+  GFile   *gfile;
+  guint64  mtime;
+  goffset  size;
+
+  /* parsed keys */
+  gchar   *icon_name;
+}
+ThunarFileDesktopEntry;
+
+typedef struct
+{
+  ThunarFile *file;
+  GFile      *gfile;
+  gboolean    is_symlink;
+  guint       generation;
+  gchar      *content_type;
+}
+ThunarFileSniffData;
+
 static struct
 {
   GUserDirectory  type;
@@ -345,6 +395,26 @@ thunar_file_cache_dump (gpointer user_data)
 
 
 
+#if DUMP_CONTENT_TYPE_STATS
+static gboolean
+thunar_file_content_type_stats_dump (gpointer user_data)
+{
+  G_LOCK (file_content_type_mutex);
+
+  g_print ("--- Content types: %u by name in %" G_GINT64_FORMAT " us, "
+           "%u sniffed (%u in background) in %" G_GINT64_FORMAT " us\n\n",
+           content_type_stats.n_glob, content_type_stats.glob_time,
+           content_type_stats.n_sniffed, content_type_stats.n_background,
+           content_type_stats.sniff_time);
+
+  G_UNLOCK (file_content_type_mutex);
+
+  return TRUE;
+}
+#endif
+
+
+
 static void
 thunar_file_class_init (ThunarFileClass *klass)
 {
@@ -364,6 +434,10 @@ thunar_file_class_init (ThunarFileClass *klass)
   g_timeout_add_seconds (DUMP_FILE_CACHE, thunar_file_cache_dump, NULL);
 #endif
 
+#if DUMP_CONTENT_TYPE_STATS
+  g_timeout_add_seconds (DUMP_CONTENT_TYPE_STATS, thunar_file_content_type_stats_dump, NULL);
+#endif
+
   /* pre-allocate the required quarks */
   thunar_file_watch_quark = g_quark_from_static_string ("thunar-file-watch");
 
@@ -827,8 +901,7 @@ thunar_file_reload_parent (ThunarFile *file)
 
 
 static void
-thunar_file_monitor (GFileMonitor     *monitor,
-                     GFile            *event_path,
+thunar_file_monitor (GFile            *event_path,
                      GFile            *other_path,
                      GFileMonitorEvent event_type,
                      gpointer          user_data)
@@ -837,7 +910,6 @@ thunar_file_monitor (GFileMonitor     *monitor,
   ThunarFile *other_file;
   gboolean    reload_ok = TRUE;
 
-  _thunar_return_if_fail (G_IS_FILE_MONITOR (monitor));
   _thunar_return_if_fail (G_IS_FILE (event_path));
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
@@ -896,16 +968,24 @@ thunar_file_monitor (GFileMonitor     *monitor,
 }
 
 
+static gboolean
+thunar_file_watch_is_directory (const ThunarFile *file)
+{
+  /* only regular files can share the watch on their parent, anything
+   * else, including files we don't know the type of yet, is watched
+   * on its own */
+  return file->kind != G_FILE_TYPE_REGULAR;
+}
+
+
+
 static void
 thunar_file_watch_destroyed (gpointer data)
 {
   ThunarFileWatch *file_watch = data;
 
-  if (G_LIKELY (file_watch->monitor != NULL))
-    {
-      g_file_monitor_cancel (file_watch->monitor);
-      g_object_unref (file_watch->monitor);
-    }
+  if (G_LIKELY (file_watch->watch != NULL))
+    thunar_watch_registry_remove (file_watch->watch);
 
   g_slice_free (ThunarFileWatch, file_watch);
 }
@@ -921,20 +1001,13 @@ thunar_file_watch_reconnect (ThunarFile *file)
   file_watch = g_object_get_qdata (G_OBJECT (file), thunar_file_watch_quark);
   if (file_watch != NULL)
     {
-      /* reset the old monitor */
-      if (G_LIKELY (file_watch->monitor != NULL))
-        {
-          g_file_monitor_cancel (file_watch->monitor);
-          g_object_unref (file_watch->monitor);
-        }
+      /* reset the old watch */
+      if (G_LIKELY (file_watch->watch != NULL))
+        thunar_watch_registry_remove (file_watch->watch);
 
-      /* create a file or directory monitor */
-      file_watch->monitor = g_file_monitor (file->gfile, G_FILE_MONITOR_WATCH_MOUNTS | G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
-      if (G_LIKELY (file_watch->monitor != NULL))
-        {
-          /* watch monitor for file changes */
-          g_signal_connect (file_watch->monitor, "changed", G_CALLBACK (thunar_file_monitor), file);
-        }
+      /* watch the file or directory for changes */
+      file_watch->watch = thunar_watch_registry_add (file->gfile, thunar_file_watch_is_directory (file),
+                                                     NULL, thunar_file_monitor, file, NULL);
     }
 }
 
@@ -992,6 +1065,8 @@ thunar_file_info_clear (ThunarFile *file)
   file->content_type = NULL;
   g_free (file->icon_name);
   file->icon_name = NULL;
+  FLAG_UNSET (file, THUNAR_FILE_FLAG_SNIFFING);
+  g_atomic_int_inc (&file->sniff_generation);
 
   /* device type */
   file->device_type = NULL;
@@ -1017,16 +1092,211 @@ thunar_file_info_clear (ThunarFile *file)
 
 
 
+static void
+thunar_file_desktop_entry_free (gpointer data)
+{
+  ThunarFileDesktopEntry *entry = data;
+
+  if (entry->gfile != NULL)
+    g_object_unref (entry->gfile);
+  g_free (entry->icon_name);
+  g_slice_free (ThunarFileDesktopEntry, entry);
+}
+
+
+
+static ThunarFileDesktopEntry *
+thunar_file_desktop_entry_new (ThunarFile *file)
+{
+  ThunarFileDesktopEntry *entry;
+
+  entry = g_slice_new0 (ThunarFileDesktopEntry);
+  entry->gfile = g_object_ref (file->gfile);
+  entry->mtime = g_file_info_get_attribute_uint64 (file->info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+                 + g_file_info_get_attribute_uint32 (file->info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  entry->size = g_file_info_get_size (file->info);
+
+  return entry;
+}
+
+
+
+/**
+ * thunar_file_desktop_entry_lookup:
+ * @entry : a #ThunarFileDesktopEntry with the gfile, mtime and size set.
+ *
+ * Fills the parsed keys of @entry from the shared cache of .desktop
+ * files. A cached entry is only used if the modification time and the
+ * size of the file did not change since it was parsed.
+ *
+ * Return value: %TRUE on a cache hit, %FALSE otherwise.
+ **/
+static gboolean
+thunar_file_desktop_entry_lookup (ThunarFileDesktopEntry *entry)
+{
+  ThunarFileDesktopEntry *cached;
+  gboolean                found = FALSE;
+
+  G_LOCK (desktop_entry_cache_mutex);
+
+  if (desktop_entry_cache != NULL)
+    {
+      cached = g_hash_table_lookup (desktop_entry_cache, entry->gfile);
+      if (cached != NULL && cached->mtime == entry->mtime && cached->size == entry->size)
+        {
+          g_free (entry->icon_name);
+          entry->icon_name = g_strdup (cached->icon_name);
+          found = TRUE;
+        }
+    }
+
+  G_UNLOCK (desktop_entry_cache_mutex);
+
+  return found;
+}
+
+
+
+/**
+ * thunar_file_desktop_entry_load:
+ * @entry       : a #ThunarFileDesktopEntry with the gfile, mtime and size set.
+ * @cancellable : a #GCancellable or %NULL.
+ *
+ * Parses the .desktop file of @entry, fills in its keys and stores a
+ * copy in the shared cache. This is a blocking call, so it should be
+ * run from a worker thread if possible.
+ **/
+static void
+thunar_file_desktop_entry_load (ThunarFileDesktopEntry *entry,
+                                GCancellable           *cancellable)
+{
+  ThunarFileDesktopEntry *cached;
+  GKeyFile               *key_file;
+  gchar                  *p;
+
+  /* query a key file for the .desktop file */
+  key_file = thunar_g_file_query_key_file (entry->gfile, cancellable, NULL);
+  if (key_file != NULL)
+    {
+      /* read the icon name from the .desktop file */
+      entry->icon_name = g_key_file_get_string (key_file,
+                                                G_KEY_FILE_DESKTOP_GROUP,
+                                                G_KEY_FILE_DESKTOP_KEY_ICON,
+                                                NULL);
+
+      if (G_UNLIKELY (xfce_str_is_empty (entry->icon_name)))
+        {
+          /* make sure we set null if the string is empty else the assertion in
+           * thunar_icon_factory_lookup_icon() will fail */
+          g_free (entry->icon_name);
+          entry->icon_name = NULL;
+        }
+      else
+        {
+          /* drop freedesktop.org supported suffixes from themed icons, if any */
+          if (!g_path_is_absolute (entry->icon_name))
+            {
+              p = strrchr (entry->icon_name, '.');
+              if(g_strcmp0(p, ".png") == 0 || g_strcmp0(p, ".xpm") == 0 || g_strcmp0(p, ".svg") == 0)
+                *p = '\0';
+            }
+        }
+      /* free the key file */
+      g_key_file_free (key_file);
+    }
+
+  /* an interrupted parse is not worth remembering */
+  if (g_cancellable_is_cancelled (cancellable))
+    return;
+
+  cached = g_slice_new0 (ThunarFileDesktopEntry);
+  cached->mtime = entry->mtime;
+  cached->size = entry->size;
+  cached->icon_name = g_strdup (entry->icon_name);
+
+  G_LOCK (desktop_entry_cache_mutex);
+
+  /* allocate the cache on-demand, and keep it bounded */
+  if (G_UNLIKELY (desktop_entry_cache == NULL))
+    {
+      desktop_entry_cache = g_hash_table_new_full (g_file_hash,
+                                                   (GEqualFunc) g_file_equal,
+                                                   (GDestroyNotify) g_object_unref,
+                                                   thunar_file_desktop_entry_free);
+    }
+  else if (g_hash_table_size (desktop_entry_cache) >= DESKTOP_ENTRY_CACHE_MAX)
+    {
+      g_hash_table_remove_all (desktop_entry_cache);
+    }
+
+  g_hash_table_replace (desktop_entry_cache, g_object_ref (entry->gfile), cached);
+
+  G_UNLOCK (desktop_entry_cache_mutex);
+}
+
+
+
+static void
+thunar_file_desktop_entry_load_thread (GTask        *task,
+                                       gpointer      source_object,
+                                       gpointer      task_data,
+                                       GCancellable *cancellable)
+{
+  thunar_file_desktop_entry_load (task_data, cancellable);
+  if (!g_task_return_error_if_cancelled (task))
+    g_task_return_boolean (task, TRUE);
+}
+
+
+
+static void
+thunar_file_desktop_entry_loaded (GObject      *object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data)
+{
+  ThunarFileDesktopEntry *entry = g_task_get_task_data (G_TASK (result));
+  ThunarFileDesktopEntry *current;
+  ThunarFile             *file = THUNAR_FILE (object);
+
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  /* a parse replaced by a newer one leaves the entry of that one alone */
+  if (g_hash_table_lookup (desktop_entry_loads, entry->gfile) == result)
+    g_hash_table_remove (desktop_entry_loads, entry->gfile);
+
+  if (g_task_had_error (G_TASK (result))
+      || entry->icon_name == NULL
+      || file->info == NULL
+      || file->custom_icon_name != NULL
+      || !g_file_equal (file->gfile, entry->gfile))
+    return;
+
+  /* only apply the result if the file was not modified while parsing */
+  current = thunar_file_desktop_entry_new (file);
+  if (current->mtime == entry->mtime && current->size == entry->size)
+    {
+      file->custom_icon_name = g_strdup (entry->icon_name);
+
+      /* tell everybody that the icon changed */
+      thunar_file_changed (file);
+    }
+  thunar_file_desktop_entry_free (current);
+}
+
+
+
 static void
 thunar_file_info_reload (ThunarFile   *file,
                          GCancellable *cancellable)
 {
-  const gchar *target_uri;
-  GKeyFile    *key_file;
-  gchar       *p;
-  const gchar *display_name;
-  gchar       *casefold;
-  gchar       *path;
+  ThunarFileDesktopEntry *entry;
+  ThunarFileDesktopEntry *loading;
+  const gchar            *target_uri;
+  const gchar            *display_name;
+  GCancellable           *load_cancellable;
+  gchar                  *casefold;
+  gchar                  *path;
+  GTask                  *task;
 
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
   _thunar_return_if_fail (file->info == NULL || G_IS_FILE_INFO (file->info));
@@ -1064,37 +1334,56 @@ thunar_file_info_reload (ThunarFile   *file,
   /* check if this file is a desktop entry and we have the permission to execute it */
   if (thunar_file_is_desktop_file (file) && thunar_file_can_execute (file))
     {
-      /* determine the custom icon and display name for .desktop files */
-
-      /* query a key file for the .desktop file */
-      key_file = thunar_g_file_query_key_file (file->gfile, cancellable, NULL);
-      if (key_file != NULL)
+      /* determine the custom icon for .desktop files, parsing them
+       * only if they are not in the cache or changed since */
+      entry = thunar_file_desktop_entry_new (file);
+      if (thunar_file_desktop_entry_lookup (entry))
         {
-          /* read the icon name from the .desktop file */
-          file->custom_icon_name = g_key_file_get_string (key_file,
-                                                          G_KEY_FILE_DESKTOP_GROUP,
-                                                          G_KEY_FILE_DESKTOP_KEY_ICON,
-                                                          NULL);
-
-          if (G_UNLIKELY (xfce_str_is_empty (file->custom_icon_name)))
-            {
-              /* make sure we set null if the string is empty else the assertion in
-               * thunar_icon_factory_lookup_icon() will fail */
-              g_free (file->custom_icon_name);
-              file->custom_icon_name = NULL;
-            }
-          else
+          file->custom_icon_name = g_steal_pointer (&entry->icon_name);
+          thunar_file_desktop_entry_free (entry);
+        }
+      else if (g_main_context_is_owner (g_main_context_default ()))
+        {
+          if (G_UNLIKELY (desktop_entry_loads == NULL))
+            desktop_entry_loads = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                                         g_object_unref, g_object_unref);
+
+          /* reloads while the file is parsed join the running parse, unless
+           * the file changed since, then that parse is outdated */
+          task = g_hash_table_lookup (desktop_entry_loads, file->gfile);
+          if (task != NULL)
             {
-              /* drop freedesktop.org supported suffixes from themed icons, if any */
-              if (!g_path_is_absolute (file->custom_icon_name))
+              loading = g_task_get_task_data (task);
+              if (loading->mtime == entry->mtime && loading->size == entry->size)
                 {
-                  p = strrchr (file->custom_icon_name, '.');
-                  if(g_strcmp0(p, ".png") == 0 || g_strcmp0(p, ".xpm") == 0 || g_strcmp0(p, ".svg") == 0)
-                    *p = '\0';
+                  thunar_file_desktop_entry_free (entry);
+                  entry = NULL;
                 }
+              else
+                {
+                  g_cancellable_cancel (g_task_get_cancellable (task));
+                  g_hash_table_remove (desktop_entry_loads, file->gfile);
+                }
+            }
+
+          /* don't block the main loop, the icon is applied when the parsing is done */
+          if (entry != NULL)
+            {
+              load_cancellable = g_cancellable_new ();
+              task = g_task_new (file, load_cancellable, thunar_file_desktop_entry_loaded, NULL);
+              g_task_set_task_data (task, entry, thunar_file_desktop_entry_free);
+              g_hash_table_insert (desktop_entry_loads, g_object_ref (file->gfile), g_object_ref (task));
+              g_task_run_in_thread (task, thunar_file_desktop_entry_load_thread);
+              g_object_unref (load_cancellable);
+              g_object_unref (task);
             }
-          /* free the key file */
-          g_key_file_free (key_file);
+        }
+      else
+        {
+          /* we are already running in a worker thread */
+          thunar_file_desktop_entry_load (entry, cancellable);
+          file->custom_icon_name = g_steal_pointer (&entry->icon_name);
+          thunar_file_desktop_entry_free (entry);
         }
     }
 
@@ -2541,22 +2830,171 @@ thunar_file_get_user (const ThunarFile *file)
 
 
 
+static gchar *
+thunar_file_sniff_content_type (GFile    *gfile,
+                                gboolean  is_symlink)
+{
+  GFile       *target = NULL;
+  GFileInfo   *info = NULL;
+  GError      *err = NULL;
+  const gchar *content_type;
+  gchar       *result = NULL;
+  gchar       *display_name;
+
+  if (G_UNLIKELY (is_symlink))
+    target = thunar_g_file_new_for_symlink_target (gfile);
+  else
+    target = g_object_ref (gfile);
+
+  if (G_LIKELY (target != NULL))
+    {
+      info = g_file_query_info (target,
+                                G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
+                                G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE,
+                                G_FILE_QUERY_INFO_NONE,
+                                NULL, &err);
+      g_object_unref (target);
+    }
+
+  if (G_LIKELY (info != NULL))
+    {
+      /* store the new content type */
+      content_type = g_file_info_get_content_type (info);
+      if (G_UNLIKELY (content_type == NULL))
+        content_type = g_file_info_get_attribute_string (info,
+                                                         G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE);
+      result = g_strdup (content_type);
+      g_object_unref (G_OBJECT (info));
+    }
+  else
+    {
+      /* If gfile retrieved above is NULL, then g_file_query_info won't be called, thus keeping info NULL.
+       * In this case, err will also be NULL. So it will fallback to "unknown" mime-type */
+      if (G_LIKELY (err != NULL))
+        {
+          /* The mime-type 'inode/symlink' is  only used for broken links.
+           * When the link is functional, the mime-type of the link target will be used */
+          if (G_LIKELY (is_symlink && err->code == G_IO_ERROR_NOT_FOUND))
+            result = g_strdup ("inode/symlink");
+          else
+            {
+              display_name = thunar_g_file_get_display_name (gfile);
+              g_warning ("Content type loading failed for %s: %s",
+                         display_name,
+                         err->message);
+              g_free (display_name);
+            }
+
+          g_error_free (err);
+        }
+    }
+
+  return result;
+}
+
+
+
+static void
+thunar_file_sniff_data_free (ThunarFileSniffData *sniff_data)
+{
+  g_object_unref (sniff_data->file);
+  g_object_unref (sniff_data->gfile);
+  g_free (sniff_data->content_type);
+  g_slice_free (ThunarFileSniffData, sniff_data);
+}
+
+
+
+static gboolean
+thunar_file_sniff_content_type_finished (gpointer user_data)
+{
+  ThunarFileSniffData *sniff_data = user_data;
+  ThunarFile          *file = sniff_data->file;
+  gboolean             changed = FALSE;
+
+  G_LOCK (file_content_type_mutex);
+
+  /* only replace the guess if the file was not reloaded in the meantime */
+  if (FLAG_IS_SET (file, THUNAR_FILE_FLAG_SNIFFING)
+      && sniff_data->generation == (guint) g_atomic_int_get (&file->sniff_generation)
+      && g_file_equal (file->gfile, sniff_data->gfile))
+    {
+      FLAG_UNSET (file, THUNAR_FILE_FLAG_SNIFFING);
+
+      if (sniff_data->content_type != NULL && g_strcmp0 (sniff_data->content_type, file->content_type) != 0)
+        {
+          g_free (file->content_type);
+          file->content_type = g_steal_pointer (&sniff_data->content_type);
+
+          /* the icon is based on the content type */
+          g_free (file->icon_name);
+          file->icon_name = NULL;
+
+          changed = TRUE;
+        }
+    }
+
+  G_UNLOCK (file_content_type_mutex);
+
+  /* tell everybody about the new type */
+  if (changed)
+    thunar_file_changed (file);
+
+  thunar_file_sniff_data_free (sniff_data);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_file_sniff_content_type_thread (gpointer data,
+                                       gpointer user_data)
+{
+  ThunarFileSniffData *sniff_data = data;
+  gint64               start_time;
+
+  /* skip files reloaded while this was queued, the result would be dropped */
+  if (sniff_data->generation == (guint) g_atomic_int_get (&sniff_data->file->sniff_generation))
+    {
+      start_time = g_get_monotonic_time ();
+      sniff_data->content_type = thunar_file_sniff_content_type (sniff_data->gfile, sniff_data->is_symlink);
+
+      G_LOCK (file_content_type_mutex);
+      content_type_stats.n_sniffed++;
+      content_type_stats.n_background++;
+      content_type_stats.sniff_time += g_get_monotonic_time () - start_time;
+      G_UNLOCK (file_content_type_mutex);
+    }
+
+  /* apply the result in the main loop, where the guess was made and
+   * where the file reference is released */
+  g_idle_add (thunar_file_sniff_content_type_finished, sniff_data);
+}
+
+
+
 /**
  * thunar_file_get_content_type:
  * @file : a #ThunarFile.
  *
  * Returns the content type of @file.
  *
+ * If the file name does not tell the content type for sure, this
+ * returns a guess when called from the main thread, and sniffs the
+ * file in the background. @file emits "changed" once that is done.
+ *
  * Return value: content type of @file.
  **/
 const gchar *
 thunar_file_get_content_type (ThunarFile *file)
 {
-  gboolean     is_symlink;
-  GFile       *gfile;
-  GFileInfo   *info = NULL;
-  GError      *err = NULL;
-  const gchar *content_type = NULL;
+  static GThreadPool  *sniff_pool = NULL;
+  ThunarFileSniffData *sniff_data;
+  gboolean             is_symlink;
+  gboolean             uncertain = TRUE;
+  gchar               *guess = NULL;
+  gint64               start_time;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
 
@@ -2581,52 +3019,49 @@ thunar_file_get_content_type (ThunarFile *file)
         {
           is_symlink = thunar_file_is_symlink (file);
 
-          if (G_UNLIKELY (is_symlink))
-            gfile = thunar_g_file_new_for_symlink_target (thunar_file_get_file (file));
-          else
-            gfile = g_object_ref (file->gfile);
+          /* for most files the extension is unambiguous, so ask the
+           * shared-mime-info glob database first, which needs no I/O */
+          start_time = g_get_monotonic_time ();
+          guess = g_content_type_guess (file->basename, NULL, 0, &uncertain);
+          content_type_stats.glob_time += g_get_monotonic_time () - start_time;
 
-          /* async load the content-type */
-          if (G_LIKELY (gfile != NULL))
+          /* symlinks are sniffed to tell broken ones apart */
+          if (G_LIKELY (!uncertain && !is_symlink && !g_content_type_is_unknown (guess)))
             {
-              info = g_file_query_info (gfile,
-                                        G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
-                                        G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE,
-                                        G_FILE_QUERY_INFO_NONE,
-                                        NULL, &err);
-              g_object_unref (gfile);
+              file->content_type = g_steal_pointer (&guess);
+              content_type_stats.n_glob++;
             }
-
-          if (G_LIKELY (info != NULL))
+          else if (g_main_context_is_owner (g_main_context_default ()))
             {
-              /* store the new content type */
-              content_type = g_file_info_get_content_type (info);
-              if (G_UNLIKELY (content_type == NULL))
-                content_type = g_file_info_get_attribute_string (info,
-                                                                 G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE);
-              if (G_LIKELY (content_type != NULL))
-                file->content_type = g_strdup (content_type);
-              g_object_unref (G_OBJECT (info));
+              /* don't block the main loop, use the guess until the
+               * content type was sniffed in the background */
+              file->content_type = g_steal_pointer (&guess);
+              FLAG_SET (file, THUNAR_FILE_FLAG_SNIFFING);
+
+              if (G_UNLIKELY (sniff_pool == NULL))
+                sniff_pool = g_thread_pool_new (thunar_file_sniff_content_type_thread, NULL,
+                                                SNIFF_THREADS, FALSE, NULL);
+
+              sniff_data = g_slice_new0 (ThunarFileSniffData);
+              sniff_data->file = g_object_ref (file);
+              sniff_data->gfile = g_object_ref (file->gfile);
+              sniff_data->is_symlink = is_symlink;
+              sniff_data->generation = g_atomic_int_get (&file->sniff_generation);
+
+              /* the pool runs a few sniffs at a time, the rest wait in its queue */
+              g_thread_pool_push (sniff_pool, sniff_data, NULL);
             }
           else
             {
-              /* If gfile retrieved above is NULL, then g_file_query_info won't be called, thus keeping info NULL.
-               * In this case, err will also be NULL. So it will fallback to "unknown" mime-type */
-              if (G_LIKELY (err != NULL))
-                {
-                  /* The mime-type 'inode/symlink' is  only used for broken links.
-                   * When the link is functional, the mime-type of the link target will be used */
-                  if (G_LIKELY (is_symlink && err->code == G_IO_ERROR_NOT_FOUND))
-                    file->content_type = g_strdup ("inode/symlink");
-                  else
-                    g_warning ("Content type loading failed for %s: %s",
-                              thunar_file_get_display_name (file),
-                              err->message);
-
-                  g_error_free (err);
-                }
+              /* we are in a worker thread, sniff right away */
+              start_time = g_get_monotonic_time ();
+              file->content_type = thunar_file_sniff_content_type (file->gfile, is_symlink);
+              content_type_stats.n_sniffed++;
+              content_type_stats.sniff_time += g_get_monotonic_time () - start_time;
             }
 
+          g_free (guess);
+
           /* always provide a fallback */
           if (file->content_type == NULL)
             file->content_type = g_strdup (DEFAULT_CONTENT_TYPE);
@@ -4347,21 +4782,16 @@ thunar_file_watch_ex (ThunarFile *file, GCancellable *cancellable)
       file_watch = g_slice_new (ThunarFileWatch);
       file_watch->watch_count = 1;
 
-      /* create a file or directory monitor */
-      file_watch->monitor = g_file_monitor (file->gfile, G_FILE_MONITOR_WATCH_MOUNTS |
-                                            G_FILE_MONITOR_WATCH_MOVES, cancellable, &error);
+      /* watch the file or directory for changes */
+      file_watch->watch = thunar_watch_registry_add (file->gfile, thunar_file_watch_is_directory (file),
+                                                     cancellable, thunar_file_monitor, file, &error);
 
-      if (G_UNLIKELY (file_watch->monitor == NULL))
+      if (G_UNLIKELY (file_watch->watch == NULL))
         {
           g_debug ("Failed to create file monitor: %s", error->message);
           g_error_free (error);
           file->no_file_watch = TRUE;
         }
-      else
-        {
-          /* watch monitor for file changes */
-          g_signal_connect (file_watch->monitor, "changed", G_CALLBACK (thunar_file_monitor), file);
-        }
 
       /* attach to file */
       g_object_set_qdata_full (G_OBJECT (file), thunar_file_watch_quark, file_watch, thunar_file_watch_destroyed);
@@ -4369,7 +4799,7 @@ thunar_file_watch_ex (ThunarFile *file, GCancellable *cancellable)
   else if (G_LIKELY (!file->no_file_watch))
     {
       /* increase watch count */
-      _thunar_return_if_fail (G_IS_FILE_MONITOR (file_watch->monitor));
+      _thunar_return_if_fail (file_watch->watch != NULL);
       file_watch->watch_count++;
     }
 }
@@ -4656,6 +5086,26 @@ thunar_file_compare_by_name (const ThunarFile *file_a,
 
 
 
+/**
+ * thunar_file_get_collate_key:
+ * @file           : a #ThunarFile instance.
+ * @case_sensitive : whether to return the case-sensitive key.
+ *
+ * Returns the collation key thunar_file_compare_by_name() compares
+ * first for @file, so callers can cache parts of it.
+ *
+ * Return value: the collation key of @file's display name, or %NULL.
+ **/
+const gchar *
+thunar_file_get_collate_key (const ThunarFile *file,
+                             gboolean          case_sensitive)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
+  return case_sensitive ? file->collate_key : file->collate_key_nocase;
+}
+
+
+
 static gboolean
 thunar_file_same_filesystem (const ThunarFile *file_a,
                              const ThunarFile *file_b)
@@ -283,6 +283,8 @@ gint              thunar_file_compare_by_type            (ThunarFile
 gint              thunar_file_compare_by_name            (const ThunarFile        *file_a,
                                                           const ThunarFile        *file_b,
                                                           gboolean                 case_sensitive) G_GNUC_PURE;
+const gchar      *thunar_file_get_collate_key            (const ThunarFile        *file,
+                                                          gboolean                 case_sensitive);
 
 ThunarFile       *thunar_file_cache_lookup               (const GFile             *file);
 gchar            *thunar_file_cached_display_name        (const GFile             *file);
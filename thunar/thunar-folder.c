@@ -22,6 +22,10 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include <libxfce4util/libxfce4util.h>
 
 #include <thunar/thunar-file-monitor.h>
@@ -30,6 +34,8 @@
 #include <thunar/thunar-io-jobs.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-simple-job.h>
+#include <thunar/thunar-watch-registry.h>
 
 #define DEBUG_FILE_CHANGES FALSE
 
@@ -50,6 +56,8 @@ enum
   ERROR,
   FILES_ADDED,
   FILES_REMOVED,
+  ENTRIES_ADDED,
+  ENTRIES_REMOVED,
   LAST_SIGNAL,
 };
 
@@ -81,11 +89,22 @@ static void     thunar_folder_file_changed                (ThunarFileMonitor
 static void     thunar_folder_file_destroyed              (ThunarFileMonitor      *file_monitor,
                                                            ThunarFile             *file,
                                                            ThunarFolder           *folder);
-static void     thunar_folder_monitor                     (GFileMonitor           *monitor,
-                                                           GFile                  *file,
+static void     thunar_folder_monitor                     (GFile                  *event_file,
                                                            GFile                  *other_file,
                                                            GFileMonitorEvent       event_type,
                                                            gpointer                user_data);
+static void     thunar_folder_merge_entries               (ThunarFolder           *folder,
+                                                           GPtrArray              *entries);
+static void     thunar_folder_drop_entries                (ThunarFolder           *folder);
+static void     thunar_folder_add_entry                   (ThunarFolder           *folder,
+                                                           GFile                  *file);
+static void     thunar_folder_add_entry_finish            (GObject                *object,
+                                                           GAsyncResult           *result,
+                                                           gpointer                user_data);
+static gboolean thunar_folder_monitor_entry               (ThunarFolder           *folder,
+                                                           GFile                  *event_file,
+                                                           GFile                  *other_file,
+                                                           GFileMonitorEvent       event_type);
 
 
 
@@ -101,6 +120,10 @@ struct _ThunarFolderClass
                          GList        *files);
   void (*files_removed) (ThunarFolder *folder,
                          GList        *files);
+  void (*entries_added)   (ThunarFolder *folder,
+                           GList        *entries);
+  void (*entries_removed) (ThunarFolder *folder,
+                           GList        *entries);
 };
 
 struct _ThunarFolder
@@ -114,6 +137,18 @@ struct _ThunarFolder
   GList             *files;
   gboolean           reload_info;
 
+  /* the folder was empty when the job started, so the files
+   * reported by the job are added right away, not when it ends */
+  gboolean           stream_files;
+
+  /* index of the non-directory children (name -> ThunarFolderEntry)
+   * if the folder has more children than the virtual threshold,
+   * otherwise %NULL */
+  GHashTable        *entries;
+
+  /* names of the new children being queried, see thunar_folder_add_entry() */
+  GHashTable        *pending_entries;
+
   GList             *content_type_ptr;
   guint              content_type_idle_id;
 
@@ -121,7 +156,7 @@ struct _ThunarFolder
 
   ThunarFileMonitor *file_monitor;
 
-  GFileMonitor      *monitor;
+  ThunarWatch       *watch;
   GCancellable      *watch_cancellable;
   gulong             reload_idle_id;
 };
@@ -130,6 +165,7 @@ struct _ThunarFolder
 
 static guint  folder_signals[LAST_SIGNAL];
 static GQuark thunar_folder_quark;
+static guint  folder_virtual_threshold = 0;
 G_LOCK_DEFINE_STATIC (folder_watch_mutex);
 static GCond folder_watch_cond;
 
@@ -145,12 +181,10 @@ create_folder_watch (GTask *task, gpointer source_object, gpointer user_data, GC
   ThunarFolder *folder = THUNAR_FOLDER (source_object);
   GError       *error  = NULL;
 
-  folder->monitor = g_file_monitor_directory (thunar_file_get_file (folder->corresponding_file),
-                                              G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+  folder->watch = thunar_watch_registry_add (thunar_file_get_file (folder->corresponding_file), TRUE,
+                                             cancellable, thunar_folder_monitor, folder, &error);
 
-  if (G_LIKELY (folder->monitor != NULL))
-    g_signal_connect (folder->monitor, "changed", G_CALLBACK (thunar_folder_monitor), folder);
-  else
+  if (G_UNLIKELY (folder->watch == NULL))
     {
       g_debug ("Could not create folder monitor: %s", error->message);
       g_error_free (error);
@@ -285,6 +319,37 @@ thunar_folder_class_init (ThunarFolderClass *klass)
                   NULL, NULL,
                   g_cclosure_marshal_VOID__POINTER,
                   G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+  /**
+   * ThunarFolder::entries-added:
+   *
+   * Emitted by a virtual #ThunarFolder whenever #ThunarFolderEntry<!---->s
+   * have been added to its index.
+   **/
+  folder_signals[ENTRIES_ADDED] =
+    g_signal_new (I_("entries-added"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ThunarFolderClass, entries_added),
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__POINTER,
+                  G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+  /**
+   * ThunarFolder::entries-removed:
+   *
+   * Emitted by the #ThunarFolder right before #ThunarFolderEntry<!---->s
+   * are removed from its index and released. If the folder is no longer
+   * virtual, thunar_folder_get_virtual() returns %FALSE already.
+   **/
+  folder_signals[ENTRIES_REMOVED] =
+    g_signal_new (I_("entries-removed"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ThunarFolderClass, entries_removed),
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__POINTER,
+                  G_TYPE_NONE, 1, G_TYPE_POINTER);
 }
 
 
@@ -297,7 +362,7 @@ thunar_folder_init (ThunarFolder *folder)
   g_signal_connect (G_OBJECT (folder->file_monitor), "file-changed", G_CALLBACK (thunar_folder_file_changed), folder);
   g_signal_connect (G_OBJECT (folder->file_monitor), "file-destroyed", G_CALLBACK (thunar_folder_file_destroyed), folder);
 
-  folder->monitor = NULL;
+  folder->watch = NULL;
   folder->reload_info = FALSE;
 }
 
@@ -349,12 +414,8 @@ thunar_folder_finalize (GObject *object)
     }
 
   /* disconnect from the file alteration monitor */
-  if (G_LIKELY (folder->monitor != NULL))
-    {
-      g_signal_handlers_disconnect_matched (folder->monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, folder);
-      g_file_monitor_cancel (folder->monitor);
-      g_object_unref (folder->monitor);
-    }
+  if (G_LIKELY (folder->watch != NULL))
+    thunar_watch_registry_remove (folder->watch);
 
   /* cancel the pending job (if any) */
   if (G_UNLIKELY (folder->job != NULL))
@@ -382,6 +443,12 @@ thunar_folder_finalize (GObject *object)
   /* release references to the current files */
   thunar_g_list_free_full (folder->files);
 
+  /* release the index */
+  if (folder->entries != NULL)
+    g_hash_table_destroy (folder->entries);
+  if (folder->pending_entries != NULL)
+    g_hash_table_destroy (folder->pending_entries);
+
   (*G_OBJECT_CLASS (thunar_folder_parent_class)->finalize) (object);
 }
 
@@ -471,8 +538,18 @@ thunar_folder_files_ready (ThunarJob    *job,
   _thunar_return_val_if_fail (THUNAR_IS_FOLDER (folder), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
 
-  /* merge the list with the existing list of new files */
-  folder->new_files = g_list_concat (folder->new_files, files);
+  if (folder->stream_files)
+    {
+      /* show the files, e.g. resolved `recent:///` targets, while the
+       * job is still waiting for others; nothing to merge with */
+      g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, files);
+      folder->files = g_list_concat (files, folder->files);
+    }
+  else
+    {
+      /* merge the list with the existing list of new files */
+      folder->new_files = g_list_concat (folder->new_files, files);
+    }
 
   /* indicate that we took over ownership of the file list */
   return TRUE;
@@ -541,6 +618,7 @@ thunar_folder_finished (ExoJob       *job,
                         ThunarFolder *folder)
 {
   ThunarFile *file;
+  GPtrArray  *entries;
   GList      *files;
   GList      *lp;
 
@@ -549,8 +627,15 @@ thunar_folder_finished (ExoJob       *job,
   _thunar_return_if_fail (THUNAR_IS_FILE (folder->corresponding_file));
   _thunar_return_if_fail (folder->content_type_idle_id == 0);
 
+  /* folders above the virtual threshold come with an index of
+   * their non-directory children, drop the old index otherwise
+   * before the files are merged, so no file is listed twice */
+  entries = g_value_get_boxed (&g_array_index (thunar_simple_job_get_param_values (THUNAR_SIMPLE_JOB (job)), GValue, 2));
+  if (entries == NULL)
+    thunar_folder_drop_entries (folder);
+
   /* check if we need to merge new files with existing files */
-  if (G_UNLIKELY (folder->files != NULL))
+  if (G_UNLIKELY (folder->files != NULL && !folder->stream_files))
     {
       /* determine all added files (files on new_files, but not on files) */
       for (files = NULL, lp = folder->new_files; lp != NULL; lp = lp->next)
@@ -608,17 +693,24 @@ thunar_folder_finished (ExoJob       *job,
       thunar_g_list_free_full (folder->new_files);
       folder->new_files = NULL;
     }
-  else
+  else if (folder->new_files != NULL)
     {
-      /* just use the new files for the files list */
-      folder->files = folder->new_files;
+      /* emit a "files-added" signal for the new files */
+      g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, folder->new_files);
+
+      /* just add the new files to the files list, which
+       * only has the files streamed by the job, if any */
+      folder->files = g_list_concat (folder->new_files, folder->files);
       folder->new_files = NULL;
+    }
+  folder->stream_files = FALSE;
 
-      if (folder->files != NULL)
-        {
-          /* emit a "files-added" signal for the new files */
-          g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, folder->files);
-        }
+  /* merge the new index, taking over the entries */
+  if (entries != NULL)
+    {
+      g_ptr_array_set_free_func (entries, NULL);
+      thunar_folder_merge_entries (folder, entries);
+      g_ptr_array_set_size (entries, 0);
     }
 
   /* schedule a reload of the file information of all files if requested */
@@ -783,8 +875,7 @@ thunar_file_infos_equal (ThunarFile *file,
 
 
 static void
-thunar_folder_monitor (GFileMonitor     *monitor,
-                       GFile            *event_file,
+thunar_folder_monitor (GFile            *event_file,
                        GFile            *other_file,
                        GFileMonitorEvent event_type,
                        gpointer          user_data)
@@ -796,9 +887,7 @@ thunar_folder_monitor (GFileMonitor     *monitor,
   GList         list;
   gboolean      restart = FALSE;
 
-  _thunar_return_if_fail (G_IS_FILE_MONITOR (monitor));
   _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
-  _thunar_return_if_fail (folder->monitor == monitor);
   _thunar_return_if_fail (THUNAR_IS_FILE (folder->corresponding_file));
   _thunar_return_if_fail (G_IS_FILE (event_file));
 
@@ -814,8 +903,13 @@ thunar_folder_monitor (GFileMonitor     *monitor,
       if (folder->content_type_idle_id != 0)
         restart = g_source_remove (folder->content_type_idle_id);
 
+      /* virtual folders track their non-directory children in the index */
+      if (lp == NULL && thunar_folder_monitor_entry (folder, event_file, other_file, event_type))
+        {
+          /* nothing to do */
+        }
       /* if we don't have it, add it if the event is not an "deleted" event */
-      if (G_UNLIKELY (lp == NULL && event_type != G_FILE_MONITOR_EVENT_DELETED))
+      else if (G_UNLIKELY (lp == NULL && event_type != G_FILE_MONITOR_EVENT_DELETED))
         {
           /* allocate a file for the path */
           file = thunar_file_get (event_file, NULL);
@@ -912,6 +1006,244 @@ thunar_folder_monitor (GFileMonitor     *monitor,
 
 
 
+static void
+thunar_folder_merge_entries (ThunarFolder *folder,
+                             GPtrArray    *entries)
+{
+  ThunarFolderEntry *entry;
+  ThunarFolderEntry *old_entry;
+  GHashTable        *old_entries = folder->entries;
+  GList             *added = NULL;
+  GList             *removed;
+  guint              n;
+
+  folder->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) thunar_folder_entry_free);
+
+  for (n = 0; n < entries->len; ++n)
+    {
+      entry = g_ptr_array_index (entries, n);
+
+      /* keep the old entry if nothing changed, so consumers holding it stay valid */
+      old_entry = (old_entries != NULL) ? g_hash_table_lookup (old_entries, entry->name) : NULL;
+      if (old_entry != NULL && old_entry->type == entry->type && old_entry->is_hidden == entry->is_hidden)
+        {
+          g_hash_table_steal (old_entries, old_entry->name);
+          g_hash_table_insert (folder->entries, old_entry->name, old_entry);
+          thunar_folder_entry_free (entry);
+        }
+      else
+        {
+          g_hash_table_insert (folder->entries, entry->name, entry);
+          added = g_list_prepend (added, entry);
+        }
+    }
+
+  /* whatever is left in the old index is gone now */
+  if (old_entries != NULL)
+    {
+      removed = g_hash_table_get_values (old_entries);
+      if (removed != NULL)
+        g_signal_emit (G_OBJECT (folder), folder_signals[ENTRIES_REMOVED], 0, removed);
+      g_list_free (removed);
+      g_hash_table_destroy (old_entries);
+    }
+
+  if (added != NULL)
+    {
+      g_signal_emit (G_OBJECT (folder), folder_signals[ENTRIES_ADDED], 0, added);
+      g_list_free (added);
+    }
+}
+
+
+
+static void
+thunar_folder_drop_entries (ThunarFolder *folder)
+{
+  GHashTable *entries = folder->entries;
+  GList      *removed;
+
+  if (G_LIKELY (entries == NULL))
+    return;
+
+  /* the folder is no longer virtual while the consumers are notified */
+  folder->entries = NULL;
+
+  removed = g_hash_table_get_values (entries);
+  if (removed != NULL)
+    g_signal_emit (G_OBJECT (folder), folder_signals[ENTRIES_REMOVED], 0, removed);
+  g_list_free (removed);
+  g_hash_table_destroy (entries);
+}
+
+
+
+/**
+ * thunar_folder_add_entry:
+ * @folder : a virtual #ThunarFolder.
+ * @file   : a new child of @folder.
+ *
+ * Queries @file in the background and adds it to the index of @folder,
+ * or as a #ThunarFile if it is a directory or @folder is no longer
+ * virtual by then. Events for a child being queried are covered by
+ * that query.
+ **/
+static void
+thunar_folder_add_entry (ThunarFolder *folder,
+                         GFile        *file)
+{
+  if (G_UNLIKELY (folder->pending_entries == NULL))
+    folder->pending_entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  if (!g_hash_table_add (folder->pending_entries, g_file_get_basename (file)))
+    return;
+
+  g_file_query_info_async (file, THUNARX_FILE_INFO_NAMESPACE,
+                           G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT, NULL,
+                           thunar_folder_add_entry_finish, g_object_ref (folder));
+}
+
+
+
+static void
+thunar_folder_add_entry_finish (GObject      *object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  ThunarFolderEntry *entry;
+  ThunarFolder      *folder = THUNAR_FOLDER (user_data);
+  ThunarFile        *file;
+  GFileInfo         *info;
+  GList              list;
+  gchar             *name;
+
+  name = g_file_get_basename (G_FILE (object));
+  g_hash_table_remove (folder->pending_entries, name);
+  g_free (name);
+
+  /* the file is gone already, nothing to add */
+  info = g_file_query_info_finish (G_FILE (object), result, NULL);
+  if (G_UNLIKELY (info == NULL))
+    {
+      g_object_unref (folder);
+      return;
+    }
+
+  if (folder->entries != NULL && g_file_info_get_file_type (info) != G_FILE_TYPE_DIRECTORY)
+    {
+      entry = thunar_folder_entry_new (g_file_info_get_name (info),
+                                       g_file_info_get_display_name (info),
+                                       g_file_info_get_file_type (info),
+                                       g_file_info_get_is_hidden (info) || g_file_info_get_is_backup (info));
+
+      /* the name might be known already if events got merged */
+      if (g_hash_table_lookup (folder->entries, entry->name) != NULL)
+        {
+          thunar_folder_entry_free (entry);
+        }
+      else
+        {
+          g_hash_table_insert (folder->entries, entry->name, entry);
+
+          list.data = entry; list.next = list.prev = NULL;
+          g_signal_emit (G_OBJECT (folder), folder_signals[ENTRIES_ADDED], 0, &list);
+        }
+    }
+  else
+    {
+      /* directories are always loaded as files, and so is everything
+       * once the folder is no longer virtual, from the info at hand */
+      file = thunar_file_get_with_info (G_FILE (object), info, NULL, FALSE);
+      if (g_list_find (folder->files, file) == NULL)
+        {
+          folder->files = g_list_prepend (folder->files, file);
+
+          list.data = file; list.next = list.prev = NULL;
+          g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, &list);
+        }
+      else
+        {
+          g_object_unref (file);
+        }
+    }
+
+  g_object_unref (info);
+  g_object_unref (folder);
+}
+
+
+
+static gboolean
+thunar_folder_monitor_entry (ThunarFolder     *folder,
+                             GFile            *event_file,
+                             GFile            *other_file,
+                             GFileMonitorEvent event_type)
+{
+  ThunarFolderEntry *entry;
+  ThunarFile        *file;
+  GFile             *other_parent;
+  gchar             *name;
+  GList              list;
+
+  if (G_LIKELY (folder->entries == NULL))
+    return FALSE;
+
+  name = g_file_get_basename (event_file);
+  entry = g_hash_table_lookup (folder->entries, name);
+  g_free (name);
+
+  if (entry == NULL)
+    {
+      /* unknown children are queried in the background and added then */
+      if (event_type != G_FILE_MONITOR_EVENT_DELETED && event_type != G_FILE_MONITOR_EVENT_MOVED_OUT)
+        thunar_folder_add_entry (folder, event_file);
+      return TRUE;
+    }
+
+  if (event_type == G_FILE_MONITOR_EVENT_DELETED ||
+      event_type == G_FILE_MONITOR_EVENT_RENAMED ||
+      event_type == G_FILE_MONITOR_EVENT_MOVED_OUT)
+    {
+      /* drop the entry from the index */
+      g_hash_table_steal (folder->entries, entry->name);
+      list.data = entry; list.next = list.prev = NULL;
+      g_signal_emit (G_OBJECT (folder), folder_signals[ENTRIES_REMOVED], 0, &list);
+      thunar_folder_entry_free (entry);
+
+      /* destroy the file if someone loaded it */
+      file = thunar_file_cache_lookup (event_file);
+      if (file != NULL)
+        {
+          thunar_file_destroy (file);
+          g_object_unref (file);
+        }
+
+      /* a rename within the folder shows up under the new name */
+      if (event_type == G_FILE_MONITOR_EVENT_RENAMED && other_file != NULL)
+        {
+          other_parent = g_file_get_parent (other_file);
+          if (other_parent != NULL && g_file_equal (other_parent, thunar_file_get_file (folder->corresponding_file)))
+            thunar_folder_add_entry (folder, other_file);
+          if (other_parent != NULL)
+            g_object_unref (other_parent);
+        }
+    }
+  else
+    {
+      /* reload the file if someone loaded it */
+      file = thunar_file_cache_lookup (event_file);
+      if (file != NULL)
+        {
+          thunar_file_reload (file);
+          g_object_unref (file);
+        }
+    }
+
+  return TRUE;
+}
+
+
+
 /**
  * thunar_folder_get_for_file:
  * @file : a #ThunarFile.
@@ -1027,6 +1359,159 @@ thunar_folder_get_loading (const ThunarFolder *folder)
 
 
 
+/**
+ * thunar_folder_get_virtual:
+ * @folder : a #ThunarFolder instance.
+ *
+ * Tells whether the @folder has more children than the virtual
+ * threshold. Virtual folders only ship their directories as
+ * #ThunarFile<!---->s, the other children are listed as lightweight
+ * #ThunarFolderEntry<!---->s, see thunar_folder_get_entries().
+ *
+ * Return value: %TRUE if @folder is virtual, else %FALSE.
+ **/
+gboolean
+thunar_folder_get_virtual (const ThunarFolder *folder)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_FOLDER (folder), FALSE);
+  return (folder->entries != NULL);
+}
+
+
+
+/**
+ * thunar_folder_get_entries:
+ * @folder : a #ThunarFolder instance.
+ *
+ * Returns the #ThunarFolderEntry<!---->s of a virtual @folder. The
+ * entries are owned by the @folder and stay valid until they are
+ * announced by the "entries-removed" signal.
+ *
+ * The caller is responsible to free the returned list using
+ * g_list_free() when no longer needed.
+ *
+ * Return value: the list of #ThunarFolderEntry<!---->s.
+ **/
+GList *
+thunar_folder_get_entries (const ThunarFolder *folder)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_FOLDER (folder), NULL);
+
+  if (folder->entries == NULL)
+    return NULL;
+
+  return g_hash_table_get_values (folder->entries);
+}
+
+
+
+/**
+ * thunar_folder_lookup_entry:
+ * @folder : a #ThunarFolder instance.
+ * @name   : the file name of the child.
+ *
+ * Looks up the child @name in the index of a virtual @folder.
+ *
+ * Return value: the #ThunarFolderEntry for @name or %NULL.
+ **/
+ThunarFolderEntry *
+thunar_folder_lookup_entry (const ThunarFolder *folder,
+                            const gchar        *name)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_FOLDER (folder), NULL);
+  _thunar_return_val_if_fail (name != NULL, NULL);
+
+  if (folder->entries == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (folder->entries, name);
+}
+
+
+
+/**
+ * thunar_folder_set_virtual_threshold:
+ * @threshold : number of children, or 0 to disable virtual folders.
+ *
+ * Folders with more children than @threshold are loaded as virtual
+ * folders the next time they are reloaded.
+ **/
+void
+thunar_folder_set_virtual_threshold (guint threshold)
+{
+  folder_virtual_threshold = threshold;
+}
+
+
+
+/**
+ * thunar_folder_entry_new:
+ * @name         : the file name.
+ * @display_name : the display name, or %NULL.
+ * @type         : the #GFileType.
+ * @is_hidden    : whether the file is hidden or a backup.
+ *
+ * Allocates a new #ThunarFolderEntry. The collation key is
+ * computed here, so entries can be created off the main loop.
+ *
+ * Return value: the newly allocated #ThunarFolderEntry.
+ **/
+ThunarFolderEntry *
+thunar_folder_entry_new (const gchar *name,
+                         const gchar *display_name,
+                         GFileType    type,
+                         gboolean     is_hidden)
+{
+  ThunarFolderEntry *entry;
+  gchar             *display;
+  gchar             *casefold;
+
+  _thunar_return_val_if_fail (name != NULL, NULL);
+
+  entry = g_slice_new (ThunarFolderEntry);
+  entry->name = g_strdup (name);
+  entry->type = type;
+  entry->is_hidden = is_hidden;
+
+  /* share the name if it is displayed as is, which is the common case */
+  display = (display_name != NULL) ? g_strdup (display_name) : g_filename_display_name (name);
+  if (strcmp (display, name) == 0)
+    {
+      entry->display_name = entry->name;
+      g_free (display);
+    }
+  else
+    {
+      entry->display_name = display;
+    }
+
+  casefold = g_utf8_casefold (entry->display_name, -1);
+  entry->collate_key = g_utf8_collate_key_for_filename (casefold, -1);
+  g_free (casefold);
+
+  return entry;
+}
+
+
+
+/**
+ * thunar_folder_entry_free:
+ * @entry : a #ThunarFolderEntry.
+ *
+ * Releases the @entry.
+ **/
+void
+thunar_folder_entry_free (ThunarFolderEntry *entry)
+{
+  if (entry->display_name != entry->name)
+    g_free (entry->display_name);
+  g_free (entry->name);
+  g_free (entry->collate_key);
+  g_slice_free (ThunarFolderEntry, entry);
+}
+
+
+
 static gboolean
 thunar_folder_reload_idle (gpointer user_data)
 {
@@ -1040,7 +1525,7 @@ thunar_folder_reload_idle (gpointer user_data)
       return TRUE;
     }
 
-  if (folder->monitor == NULL)
+  if (folder->watch == NULL)
     thunar_folder_reload (folder, FALSE);
   G_UNLOCK (folder_watch_mutex);
 
@@ -1064,7 +1549,7 @@ thunar_folder_reload_if_needed (ThunarFolder *folder)
       return;
     }
 
-  if (folder->monitor == NULL)
+  if (folder->watch == NULL)
     thunar_folder_reload (folder, FALSE);
   G_UNLOCK (folder_watch_mutex);
 }
@@ -1105,8 +1590,13 @@ thunar_folder_reload (ThunarFolder *folder,
   thunar_g_list_free_full (folder->new_files);
   folder->new_files = NULL;
 
+  /* an empty folder has nothing to merge, it can show the files
+   * as they come in; the index of a virtual folder is merged at
+   * the end, so the files don't appear in both for a while */
+  folder->stream_files = (folder->files == NULL && folder->entries == NULL);
+
   /* start a new job */
-  folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file));
+  folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file), folder_virtual_threshold);
   exo_job_launch (EXO_JOB (folder->job));
   g_signal_connect (folder->job, "error", G_CALLBACK (thunar_folder_error), folder);
   g_signal_connect (folder->job, "finished", G_CALLBACK (thunar_folder_finished), folder);
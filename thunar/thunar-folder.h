@@ -26,6 +26,7 @@ G_BEGIN_DECLS;
 
 typedef struct _ThunarFolderClass ThunarFolderClass;
 typedef struct _ThunarFolder      ThunarFolder;
+typedef struct _ThunarFolderEntry ThunarFolderEntry;
 
 #define THUNAR_TYPE_FOLDER            (thunar_folder_get_type ())
 #define THUNAR_FOLDER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_FOLDER, ThunarFolder))
@@ -34,17 +35,50 @@ typedef struct _ThunarFolder      ThunarFolder;
 #define THUNAR_IS_FOLDER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_FOLDER))
 #define THUNAR_FOLDER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_FOLDER, ThunarFolderClass))
 
-GType         thunar_folder_get_type               (void) G_GNUC_CONST;
+/**
+ * ThunarFolderEntry:
+ * @name         : the file name, relative to the folder.
+ * @display_name : the name to show in the user interface.
+ * @collate_key  : case-insensitive collation key for @display_name.
+ * @type         : the #GFileType of the file.
+ * @is_hidden    : whether the file is hidden or a backup file.
+ *
+ * Lightweight index entry for a non-directory child of a folder
+ * whose size exceeds the virtual listing threshold, used instead
+ * of a #ThunarFile. See thunar_folder_set_virtual_threshold().
+ **/
+struct _ThunarFolderEntry
+{
+  gchar     *name;
+  gchar     *display_name;
+  gchar     *collate_key;
+  GFileType  type;
+  gboolean   is_hidden;
+};
+
+GType              thunar_folder_get_type               (void) G_GNUC_CONST;
+
+ThunarFolder      *thunar_folder_get_for_file           (ThunarFile         *file);
+
+ThunarFile        *thunar_folder_get_corresponding_file (const ThunarFolder *folder);
+GList             *thunar_folder_get_files              (const ThunarFolder *folder);
+gboolean           thunar_folder_get_loading            (const ThunarFolder *folder);
+void               thunar_folder_reload_if_needed       (ThunarFolder       *folder);
 
-ThunarFolder *thunar_folder_get_for_file           (ThunarFile         *file);
+void               thunar_folder_reload                 (ThunarFolder       *folder,
+                                                         gboolean            reload_info);
 
-ThunarFile   *thunar_folder_get_corresponding_file (const ThunarFolder *folder);
-GList        *thunar_folder_get_files              (const ThunarFolder *folder);
-gboolean      thunar_folder_get_loading            (const ThunarFolder *folder);
-void          thunar_folder_reload_if_needed       (ThunarFolder       *folder);
+gboolean           thunar_folder_get_virtual            (const ThunarFolder *folder);
+GList             *thunar_folder_get_entries            (const ThunarFolder *folder) G_GNUC_WARN_UNUSED_RESULT;
+ThunarFolderEntry *thunar_folder_lookup_entry           (const ThunarFolder *folder,
+                                                         const gchar        *name);
+void               thunar_folder_set_virtual_threshold  (guint               threshold);
 
-void          thunar_folder_reload                 (ThunarFolder       *folder,
-                                                    gboolean            reload_info);
+ThunarFolderEntry *thunar_folder_entry_new              (const gchar        *name,
+                                                         const gchar        *display_name,
+                                                         GFileType           type,
+                                                         gboolean            is_hidden) G_GNUC_MALLOC;
+void               thunar_folder_entry_free             (ThunarFolderEntry  *entry);
 
 G_END_DECLS;
 
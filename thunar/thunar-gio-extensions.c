@@ -22,6 +22,13 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gio/gio.h>
 
 #ifdef HAVE_GIO_UNIX
@@ -33,6 +40,8 @@
 
 #include <thunar/thunar-file.h>
 #include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-io-checksum.h>
+#include <thunar/thunar-io-copy.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-util.h>
@@ -700,12 +709,50 @@ thunar_g_file_list_get_type (void)
 
 
 
+static gboolean
+thunar_g_file_copy_data (GFile                *source,
+                         GFile                *destination,
+                         GFileCopyFlags        flags,
+                         gboolean              direct_io,
+                         GChecksumType         checksum_type,
+                         gchar               **checksum_return,
+                         GCancellable         *cancellable,
+                         GFileProgressCallback progress_callback,
+                         gpointer              progress_callback_data,
+                         GError              **error)
+{
+  GError *err = NULL;
+
+  /* the data has to pass through user space to be hashed */
+  if (checksum_return != NULL)
+    return thunar_io_copy_file_checksum (source, destination, flags, checksum_type, cancellable,
+                                         progress_callback, progress_callback_data, checksum_return, error);
+
+  /* copy local files in the kernel if possible */
+  if (thunar_io_copy_file (source, destination, flags, direct_io, cancellable, progress_callback, progress_callback_data, &err))
+    return TRUE;
+
+  if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+  g_error_free (err);
+
+  return g_file_copy (source, destination, flags, cancellable, progress_callback, progress_callback_data, error);
+}
+
+
+
 /**
  * thunar_g_file_copy:
  * @source                 : input #GFile
  * @destination            : destination #GFile
  * @flags                  : set of #GFileCopyFlags
  * @use_partial            : option to use *.partial~
+ * @direct_io              : option to write large files with O_DIRECT
+ * @checksum_type          : the #GChecksumType for @checksum_return
+ * @checksum_return        : (nullable): return location for the checksum of @source
  * @cancellable            : (nullable): optional #GCancellable object
  * @progress_callback      : (nullable) (scope call): function to callback with progress information
  * @progress_callback_data : (clousure): user data to pass to @progress_callback
@@ -715,6 +762,16 @@ thunar_g_file_list_get_type (void)
  * If enabled, copies files to *.partial~ first and then
  * renames *.partial~ into its original name.
  *
+ * Local regular files are cloned or copied in the kernel
+ * where the file system supports it, see thunar_io_copy_file().
+ * Large files are kept out of the page cache, and with @direct_io
+ * also written past it.
+ *
+ * If @checksum_return is not %NULL, regular files are hashed
+ * while being copied, so the copy can be checked with
+ * thunar_g_file_compare_checksum() without reading @source
+ * again. It is set to %NULL for other files.
+ *
  * Return value: %TRUE on success, %FALSE otherwise.
  **/
 gboolean
@@ -722,6 +779,9 @@ thunar_g_file_copy (GFile                *source,
                     GFile                *destination,
                     GFileCopyFlags        flags,
                     gboolean              use_partial,
+                    gboolean              direct_io,
+                    GChecksumType         checksum_type,
+                    gchar               **checksum_return,
                     GCancellable         *cancellable,
                     GFileProgressCallback progress_callback,
                     gpointer              progress_callback_data,
@@ -737,7 +797,10 @@ thunar_g_file_copy (GFile                *source,
 
   _thunar_return_val_if_fail (g_file_has_parent (destination, NULL), FALSE);
 
-  if (use_partial)
+  if (checksum_return != NULL)
+    *checksum_return = NULL;
+
+  if (use_partial || checksum_return != NULL)
     {
       query_flags = (flags & G_FILE_COPY_NOFOLLOW_SYMLINKS) ? G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS : G_FILE_QUERY_INFO_NONE;
       info = g_file_query_info (source,
@@ -747,20 +810,17 @@ thunar_g_file_copy (GFile                *source,
                                 NULL);
     }
 
-  /* directory does not need .partial */
-  if (info == NULL)
+  /* directory does not need .partial nor a checksum */
+  if (info == NULL || g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR)
     {
       use_partial = FALSE;
+      checksum_return = NULL;
     }
-  else
-    {
-      use_partial = g_file_info_get_file_type (info) == G_FILE_TYPE_REGULAR;
-      g_clear_object (&info);
-    }
+  g_clear_object (&info);
 
   if (!use_partial)
     {
-      success = g_file_copy (source, destination, flags, cancellable, progress_callback, progress_callback_data, error);
+      success = thunar_g_file_copy_data (source, destination, flags, direct_io, checksum_type, checksum_return, cancellable, progress_callback, progress_callback_data, error);
       return success;
     }
 
@@ -808,7 +868,7 @@ thunar_g_file_copy (GFile                *source,
     g_file_delete (partial, NULL, error);
 
   /* copy file to .partial */
-  success = g_file_copy (source, partial, flags, cancellable, progress_callback, progress_callback_data, error);
+  success = thunar_g_file_copy_data (source, partial, flags, direct_io, checksum_type, checksum_return, cancellable, progress_callback, progress_callback_data, error);
 
   if (success)
     {
@@ -834,40 +894,98 @@ thunar_g_file_copy (GFile                *source,
 
 /**
  * thunar_g_file_compare_checksum:
- * @file_a      : a #GFile
- * @file_b      : a #GFile
- * @cancellable : (nullalble): optional #GCancellable object
- * @error       : (nullalble): optional #GError
+ * @file                   : a #GFile
+ * @checksum               : the expected checksum of @file
+ * @checksum_type          : the #GChecksumType of @checksum
+ * @cancellable            : (nullable): optional #GCancellable object
+ * @progress_callback      : (nullable) (scope call): function to callback with progress information
+ * @progress_callback_data : (closure): user data to pass to @progress_callback
+ * @error                  : (nullable): optional #GError
  *
- * Compare @file_a and @file_b with checksum.
+ * Compare the content of @file with @checksum, as returned by
+ * thunar_g_file_copy(). Local files are read from the disk rather than
+ * from the page cache, and large ones are hashed on several cores,
+ * see thunar_io_checksum_file().
  *
  * Return value: %TRUE if a checksum matches, %FALSE if not.
  **/
 gboolean
-thunar_g_file_compare_checksum (GFile        *file_a,
-                                GFile        *file_b,
-                                GCancellable *cancellable,
-                                GError      **error)
+thunar_g_file_compare_checksum (GFile                *file,
+                                const gchar          *checksum,
+                                GChecksumType         checksum_type,
+                                GCancellable         *cancellable,
+                                GFileProgressCallback progress_callback,
+                                gpointer              progress_callback_data,
+                                GError              **error)
 {
-  gchar   *str_a;
-  gchar   *str_b;
+  gchar   *file_checksum;
   gboolean is_equal;
 
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-  str_a = xfce_g_file_create_checksum (file_a, cancellable, error);
-  str_b = xfce_g_file_create_checksum (file_b, cancellable, error);
+  file_checksum = thunar_io_checksum_file (file, checksum_type, TRUE, cancellable,
+                                           progress_callback, progress_callback_data, error);
 
-  is_equal = g_strcmp0 (str_a, str_b) == 0;
+  is_equal = g_strcmp0 (file_checksum, checksum) == 0;
 
-  g_free (str_a);
-  g_free (str_b);
+  g_free (file_checksum);
 
   return is_equal;
 }
 
 
 
+/**
+ * thunar_g_file_make_hard_link:
+ * @file     : the #GFile to create.
+ * @existing : the local #GFile @file should be another name of.
+ * @error    : (nullable): optional #GError
+ *
+ * Creates @file as a hard link to @existing, so both names refer
+ * to the same data. This fails with %G_IO_ERROR_EXISTS if @file
+ * exists, and with %G_IO_ERROR_NOT_SUPPORTED if either file is
+ * not local. Other errors, like @file being on another file
+ * system, are reported as the #GIOErrorEnum matching errno.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
+gboolean
+thunar_g_file_make_hard_link (GFile   *file,
+                              GFile   *existing,
+                              GError **error)
+{
+  const gchar *path;
+  const gchar *existing_path;
+  gchar       *display_name;
+  gint         errsv;
+
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (existing), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  path = g_file_peek_path (file);
+  existing_path = g_file_peek_path (existing);
+  if (path == NULL || existing_path == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Hard links are only supported for local files"));
+      return FALSE;
+    }
+
+  if (link (existing_path, path) == 0)
+    return TRUE;
+
+  errsv = errno;
+  display_name = g_file_get_parse_name (file);
+  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+               _("Failed to link \"%s\": %s"), display_name, g_strerror (errsv));
+  g_free (display_name);
+
+  return FALSE;
+}
+
+
+
 /**
  * thunar_g_file_list_new_from_string:
  * @string : a string representation of an URI list.
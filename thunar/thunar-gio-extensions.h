@@ -73,14 +73,24 @@ gboolean     thunar_g_file_copy                     (GFile                *sourc
                                                      GFile                *destination,
                                                      GFileCopyFlags        flags,
                                                      gboolean              use_partial,
+                                                     gboolean              direct_io,
+                                                     GChecksumType         checksum_type,
+                                                     gchar               **checksum_return,
                                                      GCancellable         *cancellable,
                                                      GFileProgressCallback progress_callback,
                                                      gpointer              progress_callback_data,
                                                      GError              **error);
 
-gboolean     thunar_g_file_compare_checksum         (GFile                *file_a,
-                                                     GFile                *file_b,
+gboolean     thunar_g_file_compare_checksum         (GFile                *file,
+                                                     const gchar          *checksum,
+                                                     GChecksumType         checksum_type,
                                                      GCancellable         *cancellable,
+                                                     GFileProgressCallback progress_callback,
+                                                     gpointer              progress_callback_data,
+                                                     GError              **error);
+
+gboolean     thunar_g_file_make_hard_link           (GFile                *file,
+                                                     GFile                *existing,
                                                      GError              **error);
 
 /**
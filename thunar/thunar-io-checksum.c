@@ -0,0 +1,521 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checksums used to verify copies. A single hash over a large file is
+ * limited to one core, so the content is split into chunks of a fixed
+ * size, each chunk is hashed on its own, and the result is the hash of
+ * the chunk digests followed by the length of the content.
+ *
+ * The chunks of local files are hashed in parallel by a thread pool,
+ * streams are hashed chunk after chunk with a #ThunarIoChecksum. Both
+ * give the same result for the same content.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-io-checksum.h>
+#include <thunar/thunar-private.h>
+
+
+
+/* bytes hashed into one chunk digest */
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+/* threads hashing the chunks of a single file */
+#define MAX_THREADS 8
+
+/* large enough for the digests of all GChecksumType */
+#define MAX_DIGEST_LENGTH 64
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+
+
+typedef struct _ThunarIoChecksumFile ThunarIoChecksumFile;
+
+
+
+struct _ThunarIoChecksum
+{
+  GChecksumType type;
+  GChecksum    *tree;
+  GChecksum    *chunk;
+  gsize         chunk_length;
+  guint64       length;
+};
+
+struct _ThunarIoChecksumFile
+{
+  gint           fd;
+  GChecksumType  type;
+  gsize          digest_length;
+  GCancellable  *cancellable;
+
+  /* per chunk, written by the workers */
+  guint8        *digests;
+  gssize        *lengths;
+  gint          *errors;
+
+  /* indices of the finished chunks */
+  GAsyncQueue   *finished;
+
+  /* read buffers, one per thread at most, released with the file */
+  GAsyncQueue   *buffers;
+};
+
+
+
+static void
+thunar_io_checksum_end_chunk (ThunarIoChecksum *checksum)
+{
+  guint8 digest[MAX_DIGEST_LENGTH];
+  gsize  digest_length = sizeof (digest);
+
+  g_checksum_get_digest (checksum->chunk, digest, &digest_length);
+  g_checksum_update (checksum->tree, digest, digest_length);
+
+  g_checksum_reset (checksum->chunk);
+  checksum->chunk_length = 0;
+}
+
+
+
+static gchar *
+thunar_io_checksum_finish_tree (GChecksum *tree,
+                                guint64    length)
+{
+  guint64 length_le = GUINT64_TO_LE (length);
+  gchar  *result;
+
+  /* the length tells apart contents ending on a chunk boundary */
+  g_checksum_update (tree, (const guchar *) &length_le, sizeof (length_le));
+  result = g_strdup (g_checksum_get_string (tree));
+  g_checksum_free (tree);
+
+  return result;
+}
+
+
+
+/**
+ * thunar_io_checksum_new:
+ * @checksum_type : the #GChecksumType to use.
+ *
+ * Allocates a checksum to which data can be added piece by piece
+ * using thunar_io_checksum_update().
+ *
+ * Return value: the new #ThunarIoChecksum, to be released with
+ *               thunar_io_checksum_finish().
+ **/
+ThunarIoChecksum *
+thunar_io_checksum_new (GChecksumType checksum_type)
+{
+  ThunarIoChecksum *checksum;
+
+  checksum = g_slice_new0 (ThunarIoChecksum);
+  checksum->type = checksum_type;
+  checksum->tree = g_checksum_new (checksum_type);
+  checksum->chunk = g_checksum_new (checksum_type);
+
+  return checksum;
+}
+
+
+
+/**
+ * thunar_io_checksum_update:
+ * @checksum : a #ThunarIoChecksum.
+ * @data     : the data to add.
+ * @length   : the length of @data in bytes.
+ *
+ * Adds @data to @checksum.
+ **/
+void
+thunar_io_checksum_update (ThunarIoChecksum *checksum,
+                           const guchar     *data,
+                           gsize             length)
+{
+  gsize n;
+
+  _thunar_return_if_fail (checksum != NULL);
+
+  while (length > 0)
+    {
+      n = MIN (length, CHUNK_SIZE - checksum->chunk_length);
+      g_checksum_update (checksum->chunk, data, n);
+
+      checksum->chunk_length += n;
+      checksum->length += n;
+      data += n;
+      length -= n;
+
+      if (checksum->chunk_length == CHUNK_SIZE)
+        thunar_io_checksum_end_chunk (checksum);
+    }
+}
+
+
+
+/**
+ * thunar_io_checksum_finish:
+ * @checksum : a #ThunarIoChecksum.
+ *
+ * Releases @checksum and returns the checksum of all the data added.
+ *
+ * Return value: the checksum as a hexadecimal string, which has to be
+ *               released with g_free().
+ **/
+gchar *
+thunar_io_checksum_finish (ThunarIoChecksum *checksum)
+{
+  gchar *result;
+
+  _thunar_return_val_if_fail (checksum != NULL, NULL);
+
+  if (checksum->chunk_length > 0)
+    thunar_io_checksum_end_chunk (checksum);
+
+  result = thunar_io_checksum_finish_tree (checksum->tree, checksum->length);
+
+  g_checksum_free (checksum->chunk);
+  g_slice_free (ThunarIoChecksum, checksum);
+
+  return result;
+}
+
+
+
+static void
+thunar_io_checksum_chunk (gpointer data,
+                          gpointer user_data)
+{
+  ThunarIoChecksumFile *file = user_data;
+  GChecksum            *checksum;
+  guint                 index = GPOINTER_TO_UINT (data) - 1;
+  guint8               *buffer;
+  gsize                 digest_length = file->digest_length;
+  gssize                length = 0;
+  gssize                n;
+
+  if (!g_cancellable_is_cancelled (file->cancellable))
+    {
+      /* the pool threads are shared with GLib, so the buffers stay with
+       * the file instead of the threads and are freed when it is done */
+      buffer = g_async_queue_try_pop (file->buffers);
+      if (G_UNLIKELY (buffer == NULL))
+        buffer = g_malloc (CHUNK_SIZE);
+
+      while (length < CHUNK_SIZE)
+        {
+          n = pread (file->fd, buffer + length, CHUNK_SIZE - length, (off_t) index * CHUNK_SIZE + length);
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n < 0)
+            {
+              file->errors[index] = errno;
+              break;
+            }
+          if (n == 0)
+            break;
+          length += n;
+        }
+
+      checksum = g_checksum_new (file->type);
+      g_checksum_update (checksum, buffer, length);
+      g_checksum_get_digest (checksum, file->digests + index * file->digest_length, &digest_length);
+      g_checksum_free (checksum);
+
+      g_async_queue_push (file->buffers, buffer);
+    }
+
+  file->lengths[index] = length;
+  g_async_queue_push (file->finished, data);
+}
+
+
+
+static gchar *
+thunar_io_checksum_fd (gint                   fd,
+                       GFile                 *file,
+                       GChecksumType          checksum_type,
+                       GCancellable          *cancellable,
+                       GFileProgressCallback  progress_callback,
+                       gpointer               progress_callback_data,
+                       GError               **error)
+{
+  ThunarIoChecksumFile checksum_file;
+  struct stat          statb;
+  GThreadPool         *pool;
+  GChecksum           *tree;
+  guint64              length = 0;
+  gchar               *display_name;
+  guint                n_chunks;
+  guint                n_threads;
+  guint                n;
+  gint                 errsv = 0;
+
+  if (fstat (fd, &statb) < 0)
+    {
+      errsv = errno;
+      display_name = g_file_get_parse_name (file);
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   _("Error reading file \"%s\": %s"), display_name, g_strerror (errsv));
+      g_free (display_name);
+      return NULL;
+    }
+
+  n_chunks = (statb.st_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  n_threads = MIN (MIN (g_get_num_processors (), MAX_THREADS), MAX (n_chunks, 1));
+
+  checksum_file.fd = fd;
+  checksum_file.type = checksum_type;
+  checksum_file.digest_length = g_checksum_type_get_length (checksum_type);
+  checksum_file.cancellable = cancellable;
+  checksum_file.digests = g_malloc0 (MAX (n_chunks, 1) * checksum_file.digest_length);
+  checksum_file.lengths = g_new0 (gssize, MAX (n_chunks, 1));
+  checksum_file.errors = g_new0 (gint, MAX (n_chunks, 1));
+  checksum_file.finished = g_async_queue_new ();
+  checksum_file.buffers = g_async_queue_new_full (g_free);
+
+  pool = g_thread_pool_new (thunar_io_checksum_chunk, &checksum_file, n_threads, FALSE, NULL);
+  for (n = 0; n < n_chunks; ++n)
+    {
+      if (pool != NULL)
+        g_thread_pool_push (pool, GUINT_TO_POINTER (n + 1), NULL);
+      else
+        thunar_io_checksum_chunk (GUINT_TO_POINTER (n + 1), &checksum_file);
+    }
+
+  /* report the progress in the calling thread, as the chunks complete */
+  for (n = 0; n < n_chunks; ++n)
+    {
+      g_async_queue_pop (checksum_file.finished);
+      if (progress_callback != NULL)
+        {
+          /* the finished chunks aren't necessarily the first ones */
+          length = MIN ((guint64) (n + 1) * CHUNK_SIZE, (guint64) statb.st_size);
+          (*progress_callback) (length, statb.st_size, progress_callback_data);
+        }
+    }
+
+  if (pool != NULL)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  /* combine the chunk digests in order */
+  tree = g_checksum_new (checksum_type);
+  for (n = 0, length = 0; n < n_chunks && errsv == 0; ++n)
+    {
+      errsv = checksum_file.errors[n];
+      g_checksum_update (tree, checksum_file.digests + n * checksum_file.digest_length,
+                         checksum_file.digest_length);
+      length += checksum_file.lengths[n];
+
+      /* the file was truncated while reading, the rest is empty */
+      if (checksum_file.lengths[n] < CHUNK_SIZE)
+        break;
+    }
+
+  g_free (checksum_file.digests);
+  g_free (checksum_file.lengths);
+  g_free (checksum_file.errors);
+  g_async_queue_unref (checksum_file.finished);
+  g_async_queue_unref (checksum_file.buffers);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    {
+      g_checksum_free (tree);
+      return NULL;
+    }
+
+  if (G_UNLIKELY (errsv != 0))
+    {
+      g_checksum_free (tree);
+      display_name = g_file_get_parse_name (file);
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   _("Error reading file \"%s\": %s"), display_name, g_strerror (errsv));
+      g_free (display_name);
+      return NULL;
+    }
+
+  return thunar_io_checksum_finish_tree (tree, length);
+}
+
+
+
+static gchar *
+thunar_io_checksum_stream (GFile                 *file,
+                           GChecksumType          checksum_type,
+                           GCancellable          *cancellable,
+                           GFileProgressCallback  progress_callback,
+                           gpointer               progress_callback_data,
+                           GError               **error)
+{
+  ThunarIoChecksum *checksum;
+  GFileInputStream *input_stream;
+  GFileInfo        *info;
+  GError           *err = NULL;
+  goffset           size = 0;
+  goffset           offset = 0;
+  guchar           *buffer;
+  gchar            *result;
+  gssize            n;
+
+  input_stream = g_file_read (file, cancellable, error);
+  if (input_stream == NULL)
+    return NULL;
+
+  /* the size is only needed for the progress */
+  info = g_file_input_stream_query_info (input_stream, G_FILE_ATTRIBUTE_STANDARD_SIZE, cancellable, NULL);
+  if (info != NULL)
+    {
+      size = g_file_info_get_size (info);
+      g_object_unref (info);
+    }
+
+  checksum = thunar_io_checksum_new (checksum_type);
+  buffer = g_malloc (CHUNK_SIZE);
+
+  while ((n = g_input_stream_read (G_INPUT_STREAM (input_stream), buffer, CHUNK_SIZE, cancellable, &err)) > 0)
+    {
+      thunar_io_checksum_update (checksum, buffer, n);
+
+      offset += n;
+      if (progress_callback != NULL)
+        (*progress_callback) (offset, MAX (offset, size), progress_callback_data);
+    }
+
+  g_free (buffer);
+  g_input_stream_close (G_INPUT_STREAM (input_stream), NULL, NULL);
+  g_object_unref (input_stream);
+
+  result = thunar_io_checksum_finish (checksum);
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      g_clear_pointer (&result, g_free);
+    }
+
+  return result;
+}
+
+
+
+static void
+thunar_io_checksum_drop_cache (gint fd)
+{
+#if defined (HAVE_POSIX_FADVISE) && defined (POSIX_FADV_DONTNEED)
+  /* dirty pages can't be dropped, write them to disk first */
+#ifdef HAVE_FDATASYNC
+  fdatasync (fd);
+#else
+  fsync (fd);
+#endif
+  posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+
+
+/**
+ * thunar_io_checksum_file:
+ * @file                   : a #GFile.
+ * @checksum_type          : the #GChecksumType to use.
+ * @uncached               : whether to read local files from the disk.
+ * @cancellable            : (nullable): optional #GCancellable object.
+ * @progress_callback      : (nullable) (scope call): function to callback with progress information.
+ * @progress_callback_data : (closure): user data to pass to @progress_callback.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Computes the checksum of the content of @file, the same one as a
+ * #ThunarIoChecksum computes. The chunks of local files are hashed in
+ * parallel.
+ *
+ * If @uncached is %TRUE, local files are dropped from the page cache
+ * first, so the data is read from the disk rather than from memory, and
+ * again afterwards, so checking a copy does not evict more useful data
+ * from the cache.
+ *
+ * Return value: the checksum as a hexadecimal string, which has to be
+ *               released with g_free(), or %NULL on error.
+ **/
+gchar *
+thunar_io_checksum_file (GFile                 *file,
+                         GChecksumType          checksum_type,
+                         gboolean               uncached,
+                         GCancellable          *cancellable,
+                         GFileProgressCallback  progress_callback,
+                         gpointer               progress_callback_data,
+                         GError               **error)
+{
+  const gchar *path;
+  gchar       *result;
+  gint         fd;
+
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return NULL;
+
+  /* errors opening the file are reported by the stream */
+  path = g_file_peek_path (file);
+  fd = (path != NULL) ? g_open (path, O_RDONLY | O_CLOEXEC, 0) : -1;
+  if (fd < 0)
+    {
+      return thunar_io_checksum_stream (file, checksum_type, cancellable,
+                                        progress_callback, progress_callback_data, error);
+    }
+
+  if (uncached)
+    thunar_io_checksum_drop_cache (fd);
+
+  result = thunar_io_checksum_fd (fd, file, checksum_type, cancellable,
+                                  progress_callback, progress_callback_data, error);
+
+  if (uncached)
+    thunar_io_checksum_drop_cache (fd);
+
+  close (fd);
+
+  return result;
+}
@@ -0,0 +1,44 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THUNAR_IO_CHECKSUM_H__
+#define __THUNAR_IO_CHECKSUM_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarIoChecksum ThunarIoChecksum;
+
+ThunarIoChecksum *thunar_io_checksum_new    (GChecksumType          checksum_type);
+void              thunar_io_checksum_update (ThunarIoChecksum      *checksum,
+                                             const guchar          *data,
+                                             gsize                  length);
+gchar            *thunar_io_checksum_finish (ThunarIoChecksum      *checksum);
+
+gchar            *thunar_io_checksum_file   (GFile                 *file,
+                                             GChecksumType          checksum_type,
+                                             gboolean               uncached,
+                                             GCancellable          *cancellable,
+                                             GFileProgressCallback  progress_callback,
+                                             gpointer               progress_callback_data,
+                                             GError               **error);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_IO_CHECKSUM_H__ */
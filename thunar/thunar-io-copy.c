@@ -0,0 +1,1121 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Copies the content of local regular files in the kernel. The destination
+ * is cloned if the file system supports reflinks (btrfs, XFS), otherwise
+ * the space is reserved up front and the data is transferred with
+ * copy_file_range(), which lets network and copy-offload capable file
+ * systems copy on the server side. Sparse files are copied range by range
+ * as lseek(SEEK_DATA/SEEK_HOLE) reports them, so their holes are recreated
+ * instead of being filled with zeros.
+ *
+ * Large files are kept out of the page cache: what was copied is dropped
+ * from it on the way, so copying a huge file does not evict everything
+ * else. On request, they are copied with O_DIRECT instead, bypassing the
+ * cache completely.
+ *
+ * Everything this cannot handle (remote locations, symlinks, special files,
+ * existing destinations, file systems without copy_file_range()) is left
+ * to g_file_copy(), see thunar_g_file_copy().
+ *
+ * Copies that are verified afterwards go through user space instead: the
+ * source is hashed while it is copied, so only the destination has to be
+ * read again, see thunar_io_checksum_file(). The same way, interrupted
+ * copies are continued by appending the rest of the source. Blocks of
+ * zeros read from a sparse source are skipped in the destination there.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_IOCTL_H
+#include <sys/ioctl.h>
+#endif
+#ifdef HAVE_LINUX_FS_H
+#include <linux/fs.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#ifdef HAVE_GIO_UNIX
+#include <gio/gfiledescriptorbased.h>
+#endif
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-io-checksum.h>
+#include <thunar/thunar-io-copy.h>
+#include <thunar/thunar-private.h>
+
+
+
+/* bytes transferred per copy_file_range() call, between two progress updates */
+#define COPY_CHUNK_SIZE THUNAR_IO_COPY_CHUNK_SIZE
+
+/* bytes read at once when copying through streams */
+#define STREAM_BUFFER_SIZE (256 * 1024)
+
+/* bytes moved through user space at once, if the kernel cannot copy a range */
+#define RANGE_BUFFER_SIZE (1024 * 1024)
+
+/* files from this size on are kept out of the page cache */
+#define UNCACHED_COPY_SIZE (64 * 1024 * 1024)
+
+/* bytes transferred per read() and write() with O_DIRECT */
+#define DIRECT_IO_BUFFER_SIZE (8 * 1024 * 1024)
+
+/* alignment of the buffer, offsets and sizes for O_DIRECT */
+#define DIRECT_IO_ALIGNMENT 4096
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+
+
+typedef enum
+{
+  THUNAR_IO_COPY_DONE,
+  THUNAR_IO_COPY_UNSUPPORTED,
+  THUNAR_IO_COPY_FAILED,
+} ThunarIoCopyResult;
+
+typedef struct
+{
+  gint    source_fd;      /* -1 if the files are left in the cache */
+  gint    destination_fd;
+  goffset written;        /* writeback started up to here */
+  goffset dropped;        /* dropped from the cache up to here */
+} ThunarIoCopyCache;
+
+
+
+static void
+thunar_io_copy_set_error (GError     **error,
+                          gint         errsv,
+                          const gchar *format,
+                          GFile       *file)
+{
+  gchar *display_name;
+
+  display_name = g_file_get_parse_name (file);
+  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+               format, display_name, g_strerror (errsv));
+  g_free (display_name);
+}
+
+
+
+static gint
+thunar_io_copy_get_fd (gpointer stream)
+{
+#ifdef HAVE_GIO_UNIX
+  if (G_IS_FILE_DESCRIPTOR_BASED (stream))
+    return g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (stream));
+#endif
+  return -1;
+}
+
+
+
+static void
+thunar_io_copy_cache_init (ThunarIoCopyCache *cache,
+                           gint               source_fd,
+                           gint               destination_fd,
+                           goffset            offset,
+                           goffset            size)
+{
+  cache->source_fd = -1;
+  cache->destination_fd = -1;
+  cache->written = offset;
+  cache->dropped = offset;
+
+#if defined (HAVE_POSIX_FADVISE) && defined (POSIX_FADV_DONTNEED)
+  if (size < UNCACHED_COPY_SIZE || source_fd < 0 || destination_fd < 0)
+    return;
+
+  cache->source_fd = source_fd;
+  cache->destination_fd = destination_fd;
+
+  /* the source is read once from start to end, let the kernel read ahead further */
+  posix_fadvise (source_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+
+
+static void
+thunar_io_copy_cache_drop (ThunarIoCopyCache *cache,
+                           goffset            offset)
+{
+  if (cache->source_fd < 0 || offset - cache->written < COPY_CHUNK_SIZE)
+    return;
+
+#if defined (HAVE_POSIX_FADVISE) && defined (POSIX_FADV_DONTNEED)
+  /* the source pages copied are clean and can go right away */
+  posix_fadvise (cache->source_fd, cache->written, offset - cache->written, POSIX_FADV_DONTNEED);
+
+#ifdef HAVE_SYNC_FILE_RANGE
+  /* dirty pages can't be dropped: the range started last time is written
+   * by now, while this one is only started, so copying does not wait */
+  if (cache->written > cache->dropped)
+    {
+      sync_file_range (cache->destination_fd, cache->dropped, cache->written - cache->dropped,
+                       SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+      posix_fadvise (cache->destination_fd, cache->dropped, cache->written - cache->dropped, POSIX_FADV_DONTNEED);
+    }
+  sync_file_range (cache->destination_fd, cache->written, offset - cache->written, SYNC_FILE_RANGE_WRITE);
+  cache->dropped = cache->written;
+#endif
+#endif
+
+  cache->written = offset;
+}
+
+
+
+static void
+thunar_io_copy_cache_finish (ThunarIoCopyCache *cache)
+{
+  if (cache->source_fd < 0)
+    return;
+
+#if defined (HAVE_POSIX_FADVISE) && defined (POSIX_FADV_DONTNEED)
+  posix_fadvise (cache->source_fd, 0, 0, POSIX_FADV_DONTNEED);
+
+  /* write what is still dirty, to drop it as well */
+#ifdef HAVE_FDATASYNC
+  fdatasync (cache->destination_fd);
+#else
+  fsync (cache->destination_fd);
+#endif
+  posix_fadvise (cache->destination_fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+
+
+static gboolean
+thunar_io_copy_clone (gint source_fd,
+                      gint destination_fd)
+{
+#ifdef FICLONE
+  return (ioctl (destination_fd, FICLONE, source_fd) == 0);
+#else
+  return FALSE;
+#endif
+}
+
+
+
+static gssize
+thunar_io_copy_range (gint      source_fd,
+                      gint      destination_fd,
+                      goffset   offset,
+                      gsize     length,
+                      guchar  **buffer)
+{
+  gssize n;
+  gssize written;
+  gssize m;
+
+#ifdef HAVE_COPY_FILE_RANGE
+  loff_t source_offset = offset;
+  loff_t destination_offset = offset;
+
+  /* once the kernel refused, the rest goes through the buffer as well */
+  if (*buffer == NULL)
+    {
+      n = copy_file_range (source_fd, &source_offset, destination_fd, &destination_offset, length, 0);
+      if (n >= 0 || (errno != ENOSYS && errno != EXDEV && errno != EOPNOTSUPP && errno != EINVAL))
+        return n;
+    }
+#endif
+
+  if (*buffer == NULL)
+    *buffer = g_malloc (RANGE_BUFFER_SIZE);
+
+  n = pread (source_fd, *buffer, MIN (length, RANGE_BUFFER_SIZE), offset);
+  for (written = 0; written < n; written += m)
+    {
+      m = pwrite (destination_fd, *buffer + written, n - written, offset + written);
+      if (m < 0 && errno != EINTR)
+        return -1;
+      m = MAX (m, 0);
+    }
+
+  return n;
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_sparse (gint                  source_fd,
+                       gint                  destination_fd,
+                       goffset               size,
+                       GFile                *source,
+                       GFile                *destination,
+                       GCancellable         *cancellable,
+                       GFileProgressCallback progress_callback,
+                       gpointer              progress_callback_data,
+                       GError              **error)
+{
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+  ThunarIoCopyResult result = THUNAR_IO_COPY_DONE;
+  ThunarIoCopyCache  cache;
+  goffset            offset = 0;
+  goffset            data_offset;
+  goffset            hole_offset;
+  guchar            *buffer = NULL;
+  gssize             n;
+
+  thunar_io_copy_cache_init (&cache, source_fd, destination_fd, 0, size);
+
+  while (offset < size && result == THUNAR_IO_COPY_DONE)
+    {
+      /* ENXIO means there is only a hole left up to the end */
+      data_offset = lseek (source_fd, offset, SEEK_DATA);
+      if (data_offset < 0 && errno == ENXIO)
+        break;
+
+      hole_offset = data_offset < 0 ? -1 : lseek (source_fd, data_offset, SEEK_HOLE);
+      if (G_UNLIKELY (hole_offset < 0))
+        {
+          /* file systems without support copy the whole file instead */
+          if (offset == 0 && errno == EINVAL)
+            return THUNAR_IO_COPY_UNSUPPORTED;
+
+          /* looking for the data failed on the source, not on the copy */
+          thunar_io_copy_set_error (error, errno, _("Error reading file \"%s\": %s"), source);
+          result = THUNAR_IO_COPY_FAILED;
+          break;
+        }
+
+      /* the hole skipped counts as copied */
+      for (offset = MIN (data_offset, size); offset < MIN (hole_offset, size); offset += n)
+        {
+          if (g_cancellable_set_error_if_cancelled (cancellable, error))
+            {
+              result = THUNAR_IO_COPY_FAILED;
+              break;
+            }
+
+          n = thunar_io_copy_range (source_fd, destination_fd, offset,
+                                    MIN (MIN (hole_offset, size) - offset, COPY_CHUNK_SIZE), &buffer);
+          if (G_UNLIKELY (n < 0))
+            {
+              if (errno == EINTR)
+                {
+                  n = 0;
+                  continue;
+                }
+
+              thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+              result = THUNAR_IO_COPY_FAILED;
+              break;
+            }
+
+          /* the source shrunk while copying */
+          if (n == 0)
+            {
+              size = offset;
+              break;
+            }
+
+          thunar_io_copy_cache_drop (&cache, offset + n);
+
+          if (progress_callback != NULL)
+            (*progress_callback) (offset + n, size, progress_callback_data);
+        }
+    }
+
+  g_free (buffer);
+
+  if (result != THUNAR_IO_COPY_DONE)
+    return result;
+
+  /* holes at the end only exist through the size of the file */
+  if (ftruncate (destination_fd, size) < 0)
+    {
+      thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+      return THUNAR_IO_COPY_FAILED;
+    }
+
+  thunar_io_copy_cache_finish (&cache);
+
+  if (progress_callback != NULL)
+    (*progress_callback) (size, size, progress_callback_data);
+
+  return THUNAR_IO_COPY_DONE;
+#else
+  return THUNAR_IO_COPY_UNSUPPORTED;
+#endif
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_direct (gint                  direct_fd,
+                       gint                  source_fd,
+                       gint                  destination_fd,
+                       goffset               size,
+                       GFile                *destination,
+                       GCancellable         *cancellable,
+                       GFileProgressCallback progress_callback,
+                       gpointer              progress_callback_data,
+                       GError              **error)
+{
+#if defined (O_DIRECT) && defined (HAVE_POSIX_MEMALIGN)
+  ThunarIoCopyResult result = THUNAR_IO_COPY_DONE;
+  gpointer           buffer;
+  guchar            *tail_buffer = NULL;
+  goffset            offset = 0;
+  goffset            aligned_size = size - size % DIRECT_IO_ALIGNMENT;
+  gssize             written;
+  gssize             n;
+  gssize             m;
+  gint               flags;
+
+  /* writing through the cache would fill it all the same */
+  flags = fcntl (destination_fd, F_GETFL);
+  if (flags < 0 || fcntl (destination_fd, F_SETFL, flags | O_DIRECT) < 0)
+    return THUNAR_IO_COPY_UNSUPPORTED;
+
+  if (posix_memalign (&buffer, DIRECT_IO_ALIGNMENT, DIRECT_IO_BUFFER_SIZE) != 0)
+    {
+      fcntl (destination_fd, F_SETFL, flags);
+      return THUNAR_IO_COPY_UNSUPPORTED;
+    }
+
+  while (offset < aligned_size && result == THUNAR_IO_COPY_DONE)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        {
+          result = THUNAR_IO_COPY_FAILED;
+          break;
+        }
+
+      n = pread (direct_fd, buffer, MIN (DIRECT_IO_BUFFER_SIZE, aligned_size - offset), offset);
+
+      /* a short read means the source shrunk, the rest is copied below */
+      if (n > 0)
+        n -= n % DIRECT_IO_ALIGNMENT;
+      if (n == 0)
+        break;
+
+      for (written = 0; n > 0 && written < n; written += m)
+        {
+          m = pwrite (destination_fd, (guchar *) buffer + written, n - written, offset + written);
+          if (m < 0 && errno == EINTR)
+            m = 0;
+          else if (m < 0)
+            n = -1;
+        }
+
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            continue;
+
+          /* file systems not supporting it refuse the first block */
+          if (offset == 0 && errno == EINVAL)
+            result = THUNAR_IO_COPY_UNSUPPORTED;
+          else
+            {
+              thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+              result = THUNAR_IO_COPY_FAILED;
+            }
+          break;
+        }
+
+      offset += n;
+      if (progress_callback != NULL)
+        (*progress_callback) (offset, size, progress_callback_data);
+    }
+
+  free (buffer);
+  fcntl (destination_fd, F_SETFL, flags);
+
+  /* the end of the file is not a whole block, which O_DIRECT can't write */
+  for (; result == THUNAR_IO_COPY_DONE && offset < size; offset += n)
+    {
+      n = thunar_io_copy_range (source_fd, destination_fd, offset, size - offset, &tail_buffer);
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            {
+              n = 0;
+              continue;
+            }
+
+          thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+          result = THUNAR_IO_COPY_FAILED;
+        }
+
+      if (n <= 0)
+        break;
+
+      if (progress_callback != NULL)
+        (*progress_callback) (offset + n, size, progress_callback_data);
+    }
+
+  g_free (tail_buffer);
+
+  return result;
+#else
+  return THUNAR_IO_COPY_UNSUPPORTED;
+#endif
+}
+
+
+
+static ThunarIoCopyResult
+thunar_io_copy_data (gint                  source_fd,
+                     gint                  direct_fd,
+                     gint                  destination_fd,
+                     goffset               size,
+                     gboolean              sparse,
+                     GFile                *source,
+                     GFile                *destination,
+                     GCancellable         *cancellable,
+                     GFileProgressCallback progress_callback,
+                     gpointer              progress_callback_data,
+                     GError              **error)
+{
+  ThunarIoCopyResult result;
+  ThunarIoCopyCache  cache;
+  goffset            offset = 0;
+  gssize             n;
+
+  /* a reflink shares the extents of the source, nothing to copy at all */
+  if (thunar_io_copy_clone (source_fd, destination_fd))
+    {
+      if (progress_callback != NULL)
+        (*progress_callback) (size, size, progress_callback_data);
+      return THUNAR_IO_COPY_DONE;
+    }
+
+  /* don't fill the holes of sparse files, neither by allocating them */
+  if (sparse)
+    {
+      result = thunar_io_copy_sparse (source_fd, destination_fd, size, source, destination,
+                                      cancellable, progress_callback, progress_callback_data, error);
+      if (result != THUNAR_IO_COPY_UNSUPPORTED)
+        return result;
+    }
+
+  /* bypass the page cache, if asked to and possible */
+  if (direct_fd >= 0)
+    {
+      result = thunar_io_copy_direct (direct_fd, source_fd, destination_fd, size, destination,
+                                      cancellable, progress_callback, progress_callback_data, error);
+      if (result != THUNAR_IO_COPY_UNSUPPORTED)
+        return result;
+    }
+
+#ifdef HAVE_FALLOCATE
+  /* reserve the space, so a full disk is noticed before copying anything
+   * and the file system can allocate the destination in one piece */
+  if (fallocate (destination_fd, 0, 0, size) < 0 && errno == ENOSPC)
+    {
+      thunar_io_copy_set_error (error, ENOSPC, _("Error writing to file \"%s\": %s"), destination);
+      return THUNAR_IO_COPY_FAILED;
+    }
+#endif
+
+  thunar_io_copy_cache_init (&cache, source_fd, destination_fd, 0, size);
+
+  for (;;)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return THUNAR_IO_COPY_FAILED;
+
+#ifdef HAVE_COPY_FILE_RANGE
+      n = copy_file_range (source_fd, NULL, destination_fd, NULL, COPY_CHUNK_SIZE, 0);
+#else
+      n = -1;
+      errno = ENOSYS;
+#endif
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            continue;
+
+          /* let g_file_copy() handle file systems without support */
+          if (offset == 0 && (errno == ENOSYS || errno == EXDEV || errno == EOPNOTSUPP || errno == EINVAL))
+            return THUNAR_IO_COPY_UNSUPPORTED;
+
+          thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+          return THUNAR_IO_COPY_FAILED;
+        }
+
+      if (n == 0)
+        break;
+
+      offset += n;
+      thunar_io_copy_cache_drop (&cache, offset);
+
+      if (progress_callback != NULL)
+        (*progress_callback) (offset, MAX (offset, size), progress_callback_data);
+    }
+
+  /* the source shrunk while copying, drop the space reserved for the rest */
+  if (offset < size && ftruncate (destination_fd, offset) < 0)
+    {
+      thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+      return THUNAR_IO_COPY_FAILED;
+    }
+
+  thunar_io_copy_cache_finish (&cache);
+
+  return THUNAR_IO_COPY_DONE;
+}
+
+
+
+static gboolean
+thunar_io_copy_is_zero (const guchar *buffer,
+                        gsize         length)
+{
+  return (length > 0 && buffer[0] == 0 && memcmp (buffer, buffer + 1, length - 1) == 0);
+}
+
+
+
+static gboolean
+thunar_io_copy_is_sparse (GFileInfo *info)
+{
+  if (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE))
+    return FALSE;
+
+  return (g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE)
+          < (guint64) g_file_info_get_size (info));
+}
+
+
+
+/**
+ * thunar_io_copy_has_holes:
+ * @fd    : a descriptor of the source, at offset 0.
+ * @statb : the status of @fd.
+ *
+ * Fewer blocks allocated than the size needs means there are holes, or
+ * the file system compresses the data (btrfs, ZFS). Only the latter is
+ * a file without holes, where the first hole is the end of the file.
+ *
+ * Return value: %TRUE if @fd has holes, or it cannot be told.
+ **/
+static gboolean
+thunar_io_copy_has_holes (gint               fd,
+                          const struct stat *statb)
+{
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+  goffset hole_offset;
+#endif
+
+  if ((goffset) statb->st_blocks * 512 >= (goffset) statb->st_size)
+    return FALSE;
+
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+  hole_offset = lseek (fd, 0, SEEK_HOLE);
+
+  /* the copy starts from the offset of the descriptor */
+  if (lseek (fd, 0, SEEK_SET) < 0 || hole_offset < 0)
+    return TRUE;
+
+  return hole_offset < (goffset) statb->st_size;
+#else
+  return TRUE;
+#endif
+}
+
+
+
+static void
+thunar_io_copy_stream (GInputStream         *input_stream,
+                       GOutputStream        *output_stream,
+                       ThunarIoChecksum     *checksum,
+                       gboolean              sparse,
+                       goffset               offset,
+                       goffset               size,
+                       GCancellable         *cancellable,
+                       GFileProgressCallback progress_callback,
+                       gpointer              progress_callback_data,
+                       GError              **error)
+{
+  ThunarIoCopyCache cache;
+  gboolean          skipped = FALSE;
+  guchar           *buffer;
+  gssize            n;
+
+  /* holes can only be left by seeking over them and setting the size at the end */
+  sparse = sparse
+           && G_IS_SEEKABLE (output_stream)
+           && g_seekable_can_seek (G_SEEKABLE (output_stream))
+           && g_seekable_can_truncate (G_SEEKABLE (output_stream));
+
+  thunar_io_copy_cache_init (&cache, thunar_io_copy_get_fd (input_stream),
+                             thunar_io_copy_get_fd (output_stream), offset, size);
+
+  buffer = g_malloc (STREAM_BUFFER_SIZE);
+
+  for (;;)
+    {
+      n = g_input_stream_read (input_stream, buffer, STREAM_BUFFER_SIZE, cancellable, error);
+      if (n <= 0)
+        break;
+
+      if (checksum != NULL)
+        thunar_io_checksum_update (checksum, buffer, n);
+
+      skipped = sparse && thunar_io_copy_is_zero (buffer, n);
+      if (skipped)
+        {
+          if (!g_seekable_seek (G_SEEKABLE (output_stream), n, G_SEEK_CUR, cancellable, error))
+            break;
+        }
+      else if (!g_output_stream_write_all (output_stream, buffer, n, NULL, cancellable, error))
+        break;
+
+      offset += n;
+      thunar_io_copy_cache_drop (&cache, offset);
+
+      if (progress_callback != NULL)
+        (*progress_callback) (offset, MAX (offset, size), progress_callback_data);
+    }
+
+  /* a hole at the end is not part of the file until its size is set */
+  if (skipped && (error == NULL || *error == NULL))
+    g_seekable_truncate (G_SEEKABLE (output_stream), offset, cancellable, error);
+
+  if (error == NULL || *error == NULL)
+    thunar_io_copy_cache_finish (&cache);
+
+  g_free (buffer);
+}
+
+
+
+/**
+ * thunar_io_copy_file:
+ * @source                 : the #GFile to copy.
+ * @destination            : the #GFile to create.
+ * @flags                  : set of #GFileCopyFlags.
+ * @direct_io              : whether large files may bypass the page cache.
+ * @cancellable            : (nullable): optional #GCancellable object.
+ * @progress_callback      : (nullable) (scope call): function to callback with progress information.
+ * @progress_callback_data : (closure): user data to pass to @progress_callback.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Copies the local regular file @source to the new file @destination
+ * without moving the data through user space, and copies the attributes
+ * like g_file_copy() does.
+ *
+ * If this cannot be done for @source or @destination, %FALSE is returned
+ * with %G_IO_ERROR_NOT_SUPPORTED, before anything was created. The caller
+ * should use g_file_copy() then. On any other error, nothing is left at
+ * @destination.
+ *
+ * Large files are kept out of the page cache. With @direct_io, their data
+ * is written with O_DIRECT where the file system allows it.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_copy_file (GFile                *source,
+                     GFile                *destination,
+                     GFileCopyFlags        flags,
+                     gboolean              direct_io,
+                     GCancellable         *cancellable,
+                     GFileProgressCallback progress_callback,
+                     gpointer              progress_callback_data,
+                     GError              **error)
+{
+  ThunarIoCopyResult result;
+  const gchar       *source_path;
+  const gchar       *destination_path;
+  struct stat        source_stat;
+  gint               source_flags = O_RDONLY | O_CLOEXEC;
+  gint               source_fd;
+  gint               destination_fd;
+  gint               direct_fd = -1;
+  gint               mode;
+  gboolean           sparse;
+
+  _thunar_return_val_if_fail (G_IS_FILE (source), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (destination), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  source_path = g_file_peek_path (source);
+  destination_path = g_file_peek_path (destination);
+  if (source_path == NULL || destination_path == NULL)
+    goto unsupported;
+
+#ifdef O_NOFOLLOW
+  /* symlinks are copied as links by g_file_copy() */
+  if ((flags & G_FILE_COPY_NOFOLLOW_SYMLINKS) != 0)
+    source_flags |= O_NOFOLLOW;
+#endif
+
+  /* errors opening the source are reported by g_file_copy() */
+  source_fd = g_open (source_path, source_flags, 0);
+  if (source_fd < 0)
+    goto unsupported;
+
+  /* empty files are not worth it, and files in /proc or /sys claim to be */
+  if (fstat (source_fd, &source_stat) < 0
+      || !S_ISREG (source_stat.st_mode)
+      || source_stat.st_size == 0)
+    {
+      close (source_fd);
+      goto unsupported;
+    }
+
+  /* never replace anything here, overwriting is up to g_file_copy(). The
+   * permissions are applied with the other attributes once done */
+  mode = (flags & G_FILE_COPY_TARGET_DEFAULT_PERMS) != 0 ? 0666 : 0600;
+  destination_fd = g_open (destination_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+  if (destination_fd < 0)
+    {
+      close (source_fd);
+      goto unsupported;
+    }
+
+  /* compressed files without holes can still bypass the page cache */
+  sparse = thunar_io_copy_has_holes (source_fd, &source_stat);
+
+#ifdef O_DIRECT
+  /* a second descriptor, so the plain one stays usable if O_DIRECT is refused */
+  if (direct_io && !sparse && source_stat.st_size >= UNCACHED_COPY_SIZE)
+    direct_fd = g_open (source_path, source_flags | O_DIRECT, 0);
+#endif
+
+  result = thunar_io_copy_data (source_fd, direct_fd, destination_fd, source_stat.st_size, sparse, source, destination,
+                                cancellable, progress_callback, progress_callback_data, error);
+
+  if (direct_fd >= 0)
+    close (direct_fd);
+  close (source_fd);
+  if (close (destination_fd) < 0 && result == THUNAR_IO_COPY_DONE)
+    {
+      thunar_io_copy_set_error (error, errno, _("Error writing to file \"%s\": %s"), destination);
+      result = THUNAR_IO_COPY_FAILED;
+    }
+
+  if (result != THUNAR_IO_COPY_DONE)
+    {
+      /* don't leave an incomplete copy behind */
+      g_unlink (destination_path);
+
+      if (result == THUNAR_IO_COPY_UNSUPPORTED)
+        goto unsupported;
+
+      return FALSE;
+    }
+
+  /* like g_file_copy(), file systems not supporting some
+   * of the attributes don't make the copy fail */
+  g_file_copy_attributes (source, destination, flags, cancellable, NULL);
+
+  return TRUE;
+
+unsupported:
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       "Native copy not supported");
+  return FALSE;
+}
+
+
+
+/**
+ * thunar_io_copy_file_checksum:
+ * @source                 : the #GFile to copy.
+ * @destination            : the #GFile to create or replace.
+ * @flags                  : set of #GFileCopyFlags.
+ * @checksum_type          : the #GChecksumType to compute.
+ * @cancellable            : (nullable): optional #GCancellable object.
+ * @progress_callback      : (nullable) (scope call): function to callback with progress information.
+ * @progress_callback_data : (closure): user data to pass to @progress_callback.
+ * @checksum_return        : return location for the checksum of @source.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Copies the regular file @source to @destination through its streams and
+ * computes the checksum of the data on the way, the same one as
+ * thunar_io_checksum_file() computes for checking the copy.
+ *
+ * The destination is only replaced if @flags contains
+ * %G_FILE_COPY_OVERWRITE. On errors, an incomplete copy is removed.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_copy_file_checksum (GFile                *source,
+                              GFile                *destination,
+                              GFileCopyFlags        flags,
+                              GChecksumType         checksum_type,
+                              GCancellable         *cancellable,
+                              GFileProgressCallback progress_callback,
+                              gpointer              progress_callback_data,
+                              gchar               **checksum_return,
+                              GError              **error)
+{
+  GFileOutputStream *output_stream;
+  GFileInputStream  *input_stream;
+  GCancellable      *abort_cancellable;
+  GFileInfo         *info;
+  ThunarIoChecksum  *checksum;
+  GError            *err = NULL;
+  goffset            size = 0;
+  gboolean           sparse = FALSE;
+
+  _thunar_return_val_if_fail (G_IS_FILE (source), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (destination), FALSE);
+  _thunar_return_val_if_fail (checksum_return != NULL, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  input_stream = g_file_read (source, cancellable, error);
+  if (input_stream == NULL)
+    return FALSE;
+
+  /* the size is needed for the progress, the allocated size tells about holes */
+  info = g_file_input_stream_query_info (input_stream, G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                         G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE, cancellable, NULL);
+  if (info != NULL)
+    {
+      size = g_file_info_get_size (info);
+      sparse = thunar_io_copy_is_sparse (info);
+      g_object_unref (info);
+    }
+
+  /* like g_file_copy(), replace the destination once the copy is complete */
+  if ((flags & G_FILE_COPY_OVERWRITE) != 0)
+    output_stream = g_file_replace (destination, NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, cancellable, &err);
+  else
+    output_stream = g_file_create (destination, G_FILE_CREATE_NONE, cancellable, &err);
+
+  if (output_stream == NULL)
+    {
+      g_object_unref (input_stream);
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  checksum = thunar_io_checksum_new (checksum_type);
+
+  thunar_io_copy_stream (G_INPUT_STREAM (input_stream), G_OUTPUT_STREAM (output_stream), checksum, sparse,
+                         0, size, cancellable, progress_callback, progress_callback_data, &err);
+
+  if (G_LIKELY (err == NULL))
+    {
+      g_output_stream_close (G_OUTPUT_STREAM (output_stream), cancellable, &err);
+    }
+  else
+    {
+      /* closing a stream cancelled keeps an existing destination as it was */
+      abort_cancellable = g_cancellable_new ();
+      g_cancellable_cancel (abort_cancellable);
+      g_output_stream_close (G_OUTPUT_STREAM (output_stream), abort_cancellable, NULL);
+      g_object_unref (abort_cancellable);
+    }
+
+  g_input_stream_close (G_INPUT_STREAM (input_stream), NULL, NULL);
+  g_object_unref (input_stream);
+  g_object_unref (output_stream);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      /* newly created files are left behind by g_file_create() */
+      if ((flags & G_FILE_COPY_OVERWRITE) == 0)
+        g_file_delete (destination, NULL, NULL);
+
+      g_free (thunar_io_checksum_finish (checksum));
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  /* like g_file_copy(), file systems not supporting some
+   * of the attributes don't make the copy fail */
+  g_file_copy_attributes (source, destination, flags, cancellable, NULL);
+
+  *checksum_return = thunar_io_checksum_finish (checksum);
+
+  return TRUE;
+}
+
+
+
+
+/**
+ * thunar_io_copy_file_resume:
+ * @source                 : the #GFile to copy.
+ * @destination            : the partial copy of @source.
+ * @offset                 : the number of bytes of @destination to keep.
+ * @flags                  : set of #GFileCopyFlags.
+ * @checksum_type          : the #GChecksumType to compute.
+ * @cancellable            : (nullable): optional #GCancellable object.
+ * @progress_callback      : (nullable) (scope call): function to callback with progress information.
+ * @progress_callback_data : (closure): user data to pass to @progress_callback.
+ * @checksum_return        : (nullable): return location for the checksum of @source.
+ * @error                  : return location for errors or %NULL.
+ *
+ * Continues an interrupted copy of the regular file @source: @destination
+ * is cut to @offset bytes and the rest of @source is appended. The caller
+ * must make sure @source did not change since the copy began.
+ *
+ * If @checksum_return is not %NULL, the checksum of the whole @source is
+ * computed like thunar_io_copy_file_checksum() does, which means that the
+ * first @offset bytes of @source are read as well.
+ *
+ * On errors, @destination is kept to be continued later.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
+gboolean
+thunar_io_copy_file_resume (GFile                *source,
+                            GFile                *destination,
+                            goffset               offset,
+                            GFileCopyFlags        flags,
+                            GChecksumType         checksum_type,
+                            GCancellable         *cancellable,
+                            GFileProgressCallback progress_callback,
+                            gpointer              progress_callback_data,
+                            gchar               **checksum_return,
+                            GError              **error)
+{
+  GFileInputStream *input_stream;
+  GFileIOStream    *io_stream;
+  GFileInfo        *info;
+  ThunarIoChecksum *checksum = NULL;
+  GError           *err = NULL;
+  goffset           size = 0;
+  gboolean          sparse = FALSE;
+  goffset           hashed;
+  guchar           *buffer;
+  gssize            n;
+
+  _thunar_return_val_if_fail (G_IS_FILE (source), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (destination), FALSE);
+  _thunar_return_val_if_fail (offset >= 0, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  input_stream = g_file_read (source, cancellable, error);
+  if (input_stream == NULL)
+    return FALSE;
+
+  info = g_file_input_stream_query_info (input_stream, G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                         G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE, cancellable, NULL);
+  if (info != NULL)
+    {
+      size = g_file_info_get_size (info);
+      sparse = thunar_io_copy_is_sparse (info);
+      g_object_unref (info);
+    }
+  offset = MIN (offset, size);
+
+  io_stream = g_file_open_readwrite (destination, cancellable, &err);
+  if (io_stream == NULL)
+    {
+      g_object_unref (input_stream);
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  /* drop whatever might not have made it to the disk completely */
+  if (g_seekable_truncate (G_SEEKABLE (io_stream), offset, cancellable, &err)
+      && g_seekable_seek (G_SEEKABLE (io_stream), offset, G_SEEK_SET, cancellable, &err))
+    {
+      if (checksum_return != NULL)
+        {
+          /* the checksum covers the data copied before as well */
+          checksum = thunar_io_checksum_new (checksum_type);
+          buffer = g_malloc (STREAM_BUFFER_SIZE);
+          for (hashed = 0; hashed < offset; hashed += n)
+            {
+              n = g_input_stream_read (G_INPUT_STREAM (input_stream), buffer,
+                                       MIN (STREAM_BUFFER_SIZE, offset - hashed), cancellable, &err);
+              if (n <= 0)
+                break;
+              thunar_io_checksum_update (checksum, buffer, n);
+            }
+          g_free (buffer);
+
+          if (err == NULL && hashed < offset)
+            g_set_error_literal (&err, G_IO_ERROR, G_IO_ERROR_FAILED, "Source file shrunk while copying");
+        }
+      else
+        {
+          g_seekable_seek (G_SEEKABLE (input_stream), offset, G_SEEK_SET, cancellable, &err);
+        }
+
+      if (err == NULL)
+        {
+          if (progress_callback != NULL)
+            (*progress_callback) (offset, size, progress_callback_data);
+
+          thunar_io_copy_stream (G_INPUT_STREAM (input_stream),
+                                 g_io_stream_get_output_stream (G_IO_STREAM (io_stream)), checksum, sparse,
+                                 offset, size, cancellable, progress_callback, progress_callback_data, &err);
+        }
+    }
+
+  g_io_stream_close (G_IO_STREAM (io_stream), cancellable, err == NULL ? &err : NULL);
+  g_input_stream_close (G_INPUT_STREAM (input_stream), NULL, NULL);
+  g_object_unref (input_stream);
+  g_object_unref (io_stream);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      if (checksum != NULL)
+        g_free (thunar_io_checksum_finish (checksum));
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  /* like g_file_copy(), file systems not supporting some
+   * of the attributes don't make the copy fail */
+  g_file_copy_attributes (source, destination, flags, cancellable, NULL);
+
+  if (checksum_return != NULL)
+    *checksum_return = thunar_io_checksum_finish (checksum);
+
+  return TRUE;
+}
@@ -0,0 +1,61 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THUNAR_IO_COPY_H__
+#define __THUNAR_IO_COPY_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* most bytes copied between two progress callbacks */
+#define THUNAR_IO_COPY_CHUNK_SIZE (8 * 1024 * 1024)
+
+gboolean thunar_io_copy_file          (GFile                *source,
+                                       GFile                *destination,
+                                       GFileCopyFlags        flags,
+                                       gboolean              direct_io,
+                                       GCancellable         *cancellable,
+                                       GFileProgressCallback progress_callback,
+                                       gpointer              progress_callback_data,
+                                       GError              **error);
+
+gboolean thunar_io_copy_file_checksum (GFile                *source,
+                                       GFile                *destination,
+                                       GFileCopyFlags        flags,
+                                       GChecksumType         checksum_type,
+                                       GCancellable         *cancellable,
+                                       GFileProgressCallback progress_callback,
+                                       gpointer              progress_callback_data,
+                                       gchar               **checksum_return,
+                                       GError              **error);
+
+gboolean thunar_io_copy_file_resume   (GFile                *source,
+                                       GFile                *destination,
+                                       goffset               offset,
+                                       GFileCopyFlags        flags,
+                                       GChecksumType         checksum_type,
+                                       GCancellable         *cancellable,
+                                       GFileProgressCallback progress_callback,
+                                       gpointer              progress_callback_data,
+                                       gchar               **checksum_return,
+                                       GError              **error);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_IO_COPY_H__ */
@@ -1291,13 +1291,15 @@ _thunar_io_jobs_ls (ThunarJob  *job,
                     GArray     *param_values,
                     GError    **error)
 {
-  GError *err = NULL;
-  GFile  *directory;
-  GList  *file_list = NULL;
+  GError    *err = NULL;
+  GFile     *directory;
+  GList     *file_list = NULL;
+  GPtrArray *entries = NULL;
+  guint      virtual_threshold;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
-  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
+  _thunar_return_val_if_fail (param_values->len == 3, FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
@@ -1305,14 +1307,25 @@ _thunar_io_jobs_ls (ThunarJob  *job,
 
   /* determine the directory to list */
   directory = g_value_get_object (&g_array_index (param_values, GValue, 0));
+  virtual_threshold = g_value_get_uint (&g_array_index (param_values, GValue, 1));
 
   /* make sure the object is valid */
   _thunar_assert (G_IS_FILE (directory));
 
-  /* collect directory contents (non-recursively) */
-  file_list = thunar_io_scan_directory (job, directory,
-                                        G_FILE_QUERY_INFO_NONE,
-                                        FALSE, FALSE, TRUE, &err);
+  /* collect directory contents (non-recursively), the index of
+   * large directories is handed back in the third parameter */
+  if (virtual_threshold > 0 && !g_file_has_uri_scheme (directory, "recent"))
+    {
+      file_list = thunar_io_scan_directory_indexed (job, directory, virtual_threshold, &entries, &err);
+      if (entries != NULL)
+        g_value_take_boxed (&g_array_index (param_values, GValue, 2), entries);
+    }
+  else
+    {
+      file_list = thunar_io_scan_directory (job, directory,
+                                            G_FILE_QUERY_INFO_NONE,
+                                            FALSE, FALSE, TRUE, &err);
+    }
 
   /* abort on errors or cancellation */
   if (err != NULL)
@@ -1354,11 +1367,15 @@ _thunar_io_jobs_ls (ThunarJob  *job,
 
 
 ThunarJob *
-thunar_io_jobs_list_directory (GFile *directory)
+thunar_io_jobs_list_directory (GFile *directory,
+                               guint  virtual_threshold)
 {
   _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
 
-  return thunar_simple_job_new (_thunar_io_jobs_ls, 1, G_TYPE_FILE, directory);
+  return thunar_simple_job_new (_thunar_io_jobs_ls, 3,
+                                G_TYPE_FILE, directory,
+                                G_TYPE_UINT, virtual_threshold,
+                                G_TYPE_PTR_ARRAY, NULL);
 }
 
 
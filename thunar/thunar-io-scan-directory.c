@@ -26,6 +26,7 @@
 
 #include <exo/exo.h>
 
+#include <thunar/thunar-folder.h>
 #include <thunar/thunar-gio-extensions.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-private.h>
@@ -33,6 +34,311 @@
 
 
 
+/* maximum number of recent:// targets queried at the same time */
+#define THUNAR_IO_SCAN_RECENT_MAX_QUERIES 16
+
+/* seconds after which a recent:// target is considered unreachable */
+#define THUNAR_IO_SCAN_RECENT_TIMEOUT 5
+
+
+
+typedef struct _ThunarIoRecentResolver ThunarIoRecentResolver;
+typedef struct _ThunarIoRecentQuery    ThunarIoRecentQuery;
+
+struct _ThunarIoRecentResolver
+{
+  ThunarJob          *job;
+  GCancellable       *cancellable;
+  const gchar        *namespace;
+  GFileQueryInfoFlags flags;
+  gboolean            recursively;
+  gboolean            unlinking;
+  gboolean            return_thunar_files;
+
+  /* private context of the calling thread, the queries complete in */
+  GMainContext       *context;
+
+  /* queries waiting for a free slot */
+  GQueue              pending;
+  guint               n_running;
+
+  /* queries given up after the timeout, which still have to
+   * return before the context can be released */
+  guint               n_abandoned;
+
+  /* the resolved children, in order of arrival, handed to the
+   * job's "files-ready" handlers as they arrive if streaming */
+  GList              *files;
+  gboolean            streaming;
+};
+
+struct _ThunarIoRecentQuery
+{
+  ThunarIoRecentResolver *resolver;
+  gboolean                timed_out;
+
+  GFile                  *file;
+  GFileInfo              *recent_info;
+  GCancellable           *cancellable;
+  GSource                *timeout_source;
+  gulong                  cancelled_id;
+};
+
+
+
+static void thunar_io_recent_resolver_start (ThunarIoRecentResolver *resolver);
+
+
+
+static void
+thunar_io_recent_query_free (ThunarIoRecentQuery *query)
+{
+  g_object_unref (query->file);
+  g_object_unref (query->recent_info);
+  if (query->cancellable != NULL)
+    g_object_unref (query->cancellable);
+  g_slice_free (ThunarIoRecentQuery, query);
+}
+
+
+
+static void
+thunar_io_recent_query_finish (ThunarIoRecentQuery *query,
+                               GFileInfo           *info)
+{
+  ThunarIoRecentResolver *resolver = query->resolver;
+  ThunarFile             *thunar_file;
+  GList                  *child_files;
+
+  if (query->cancelled_id != 0)
+    g_cancellable_disconnect (resolver->cancellable, query->cancelled_id);
+  query->cancelled_id = 0;
+
+  g_source_destroy (query->timeout_source);
+  g_source_unref (query->timeout_source);
+  query->timeout_source = NULL;
+
+  resolver->n_running--;
+
+  if (resolver->job == NULL || !exo_job_is_cancelled (EXO_JOB (resolver->job)))
+    {
+      if (resolver->return_thunar_files)
+        {
+          /* unreachable targets are listed with the info from the
+           * recent list and marked as not mounted */
+          if (info != NULL)
+            thunar_file = thunar_file_get_with_info (query->file, info, query->recent_info, FALSE);
+          else
+            thunar_file = thunar_file_get_with_info (query->file, query->recent_info, query->recent_info, TRUE);
+          resolver->files = thunar_g_list_prepend_deep (resolver->files, thunar_file);
+          g_object_unref (G_OBJECT (thunar_file));
+        }
+      else
+        {
+          resolver->files = thunar_g_list_prepend_deep (resolver->files, query->file);
+        }
+
+      /* if the target is a directory and we need to recurse ... just do so */
+      if (resolver->recursively
+          && info != NULL
+          && g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        {
+          child_files = thunar_io_scan_directory (resolver->job, query->file, resolver->flags, resolver->recursively,
+                                                  resolver->unlinking, resolver->return_thunar_files, NULL);
+          resolver->files = g_list_concat (child_files, resolver->files);
+        }
+    }
+
+  /* let the next query take the slot */
+  thunar_io_recent_resolver_start (resolver);
+}
+
+
+
+static void
+thunar_io_recent_query_ready (GObject      *object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  ThunarIoRecentQuery *query = user_data;
+  GFileInfo           *info;
+
+  info = g_file_query_info_finish (G_FILE (object), result, NULL);
+
+  /* nothing to do if the target was already given up */
+  if (query->timed_out)
+    query->resolver->n_abandoned--;
+  else
+    thunar_io_recent_query_finish (query, info);
+
+  if (info != NULL)
+    g_object_unref (info);
+  thunar_io_recent_query_free (query);
+}
+
+
+
+static gboolean
+thunar_io_recent_query_timeout (gpointer user_data)
+{
+  ThunarIoRecentQuery *query = user_data;
+
+  /* don't wait for the target any longer, the query is
+   * cancelled and released once its callback returns */
+  query->timed_out = TRUE;
+  query->resolver->n_abandoned++;
+  g_cancellable_cancel (query->cancellable);
+  thunar_io_recent_query_finish (query, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+
+static void
+thunar_io_recent_query_cancelled (GCancellable *job_cancellable,
+                                  GCancellable *cancellable)
+{
+  g_cancellable_cancel (cancellable);
+}
+
+
+
+static void
+thunar_io_recent_resolver_init (ThunarIoRecentResolver *resolver,
+                                ThunarJob              *job,
+                                GCancellable           *cancellable,
+                                const gchar            *namespace,
+                                GFileQueryInfoFlags     flags,
+                                gboolean                recursively,
+                                gboolean                unlinking,
+                                gboolean                return_thunar_files)
+{
+  resolver->job = job;
+  resolver->cancellable = cancellable;
+  resolver->namespace = namespace;
+  resolver->flags = flags;
+  resolver->recursively = recursively;
+  resolver->unlinking = unlinking;
+  resolver->return_thunar_files = return_thunar_files;
+  resolver->n_running = 0;
+  resolver->n_abandoned = 0;
+  resolver->files = NULL;
+  g_queue_init (&resolver->pending);
+
+  /* a plain listing of `recent:///` reports the targets as they are
+   * resolved, instead of waiting for the slowest one */
+  resolver->streaming = (job != NULL && return_thunar_files && !recursively && !unlinking);
+
+  /* the queries complete in the calling (job) thread */
+  resolver->context = g_main_context_new ();
+  g_main_context_push_thread_default (resolver->context);
+}
+
+
+
+static void
+thunar_io_recent_resolver_start (ThunarIoRecentResolver *resolver)
+{
+  ThunarIoRecentQuery *query;
+
+  while (resolver->n_running < THUNAR_IO_SCAN_RECENT_MAX_QUERIES
+         && !g_queue_is_empty (&resolver->pending)
+         && (resolver->job == NULL || !exo_job_is_cancelled (EXO_JOB (resolver->job))))
+    {
+      query = g_queue_pop_head (&resolver->pending);
+      query->resolver = resolver;
+      query->cancellable = g_cancellable_new ();
+
+      /* forward cancellation of the job to the query */
+      if (resolver->cancellable != NULL)
+        query->cancelled_id = g_cancellable_connect (resolver->cancellable, G_CALLBACK (thunar_io_recent_query_cancelled),
+                                                     query->cancellable, NULL);
+
+      query->timeout_source = g_timeout_source_new_seconds (THUNAR_IO_SCAN_RECENT_TIMEOUT);
+      g_source_set_callback (query->timeout_source, thunar_io_recent_query_timeout, query, NULL);
+      g_source_attach (query->timeout_source, resolver->context);
+
+      resolver->n_running++;
+
+      g_file_query_info_async (query->file, resolver->namespace, resolver->flags, G_PRIORITY_DEFAULT,
+                               query->cancellable, thunar_io_recent_query_ready, query);
+    }
+}
+
+
+
+static void
+thunar_io_recent_resolver_flush (ThunarIoRecentResolver *resolver)
+{
+  if (!resolver->streaming || resolver->files == NULL)
+    return;
+
+  /* nobody took the files, so they are returned at the end */
+  if (thunar_job_files_ready (resolver->job, resolver->files))
+    resolver->files = NULL;
+  else
+    resolver->streaming = FALSE;
+}
+
+
+
+static void
+thunar_io_recent_resolver_push (ThunarIoRecentResolver *resolver,
+                                GFileInfo              *recent_info)
+{
+  ThunarIoRecentQuery *query;
+  const gchar         *target_uri;
+
+  target_uri = g_file_info_get_attribute_string (recent_info, G_FILE_ATTRIBUTE_STANDARD_TARGET_URI);
+  if (G_UNLIKELY (target_uri == NULL))
+    {
+      g_object_unref (recent_info);
+      return;
+    }
+
+  query = g_slice_new0 (ThunarIoRecentQuery);
+  query->file = g_file_new_for_uri (target_uri);
+  query->recent_info = recent_info;
+  g_queue_push_tail (&resolver->pending, query);
+
+  /* start the query if there is a free slot and
+   * collect the results which arrived meanwhile */
+  thunar_io_recent_resolver_start (resolver);
+  while (g_main_context_iteration (resolver->context, FALSE))
+    ;
+  thunar_io_recent_resolver_flush (resolver);
+}
+
+
+
+static GList *
+thunar_io_recent_resolver_finish (ThunarIoRecentResolver *resolver)
+{
+  /* wait for the remaining queries, each ends after the timeout at last */
+  thunar_io_recent_resolver_start (resolver);
+  while (resolver->n_running > 0)
+    {
+      g_main_context_iteration (resolver->context, TRUE);
+      thunar_io_recent_resolver_flush (resolver);
+    }
+
+  /* the callbacks of cancelled queries are dispatched in the
+   * context, so it must live until they all returned */
+  while (resolver->n_abandoned > 0)
+    g_main_context_iteration (resolver->context, TRUE);
+
+  g_main_context_pop_thread_default (resolver->context);
+  g_main_context_unref (resolver->context);
+
+  /* drop the queries that never started, because the job was cancelled */
+  g_queue_clear_full (&resolver->pending, (GDestroyNotify) thunar_io_recent_query_free);
+
+  return resolver->files;
+}
+
+
+
 GList *
 thunar_io_scan_directory (ThunarJob          *job,
                           GFile              *file,
@@ -42,18 +348,19 @@ thunar_io_scan_directory (ThunarJob          *job,
                           gboolean            return_thunar_files,
                           GError            **error)
 {
-  GFileEnumerator *enumerator;
-  GFileInfo       *info;
-  GFileInfo       *recent_info;
-  GFileType        type;
-  GError          *err = NULL;
-  GFile           *child_file;
-  GList           *child_files = NULL;
-  GList           *files = NULL;
-  const gchar     *namespace;
-  ThunarFile      *thunar_file;
-  gboolean         is_mounted;
-  GCancellable    *cancellable = NULL;
+  GFileEnumerator        *enumerator;
+  GFileInfo              *info;
+  GFileType               type;
+  GError                 *err = NULL;
+  GFile                  *child_file;
+  GList                  *child_files = NULL;
+  GList                  *files = NULL;
+  const gchar            *namespace;
+  ThunarFile             *thunar_file;
+  gboolean                is_mounted;
+  gboolean                is_recent;
+  GCancellable           *cancellable = NULL;
+  ThunarIoRecentResolver  resolver;
 
   _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
@@ -106,6 +413,13 @@ thunar_io_scan_directory (ThunarJob          *job,
       return NULL;
     }
 
+  /* the targets of `recent:///` are queried concurrently while the
+   * recent list is read, so slow or unmounted targets don't block */
+  is_recent = g_file_has_uri_scheme (file, "recent");
+  if (is_recent)
+    thunar_io_recent_resolver_init (&resolver, job, cancellable, namespace, flags,
+                                    recursively, unlinking, return_thunar_files);
+
   /* iterate over children one by one */
   while (job == NULL || !exo_job_is_cancelled (EXO_JOB (job)))
     {
@@ -147,32 +461,20 @@ thunar_io_scan_directory (ThunarJob          *job,
         }
 
       /* check if we are scanning `recent:///` */
-      if (g_file_has_uri_scheme (file, "recent"))
+      if (is_recent)
         {
-          /* create Gfile using the target URI */
-          child_file = g_file_new_for_uri (g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_TARGET_URI));
-
-          /* create new file info using Gfile*/
-          recent_info = info;
-          info = g_file_query_info (child_file, namespace, flags, cancellable, &err);
-
-          if (G_UNLIKELY (info == NULL))
-            {
-              g_object_unref (recent_info);
-              break;
-            }
-        }
-      else
-        {
-          /* create GFile for the child */
-          child_file = g_file_get_child (file, g_file_info_get_name (info));
-          recent_info = NULL;
+          /* hand the entry over to the resolver */
+          thunar_io_recent_resolver_push (&resolver, info);
+          continue;
         }
 
+      /* create GFile for the child */
+      child_file = g_file_get_child (file, g_file_info_get_name (info));
+
       if (return_thunar_files)
         {
           /* Prepend the ThunarFile */
-          thunar_file = thunar_file_get_with_info (child_file, info, recent_info, !is_mounted);
+          thunar_file = thunar_file_get_with_info (child_file, info, NULL, !is_mounted);
           files = thunar_g_list_prepend_deep (files, thunar_file);
           g_object_unref (G_OBJECT (thunar_file));
         }
@@ -202,6 +504,9 @@ thunar_io_scan_directory (ThunarJob          *job,
   /* release the enumerator */
   g_object_unref (enumerator);
 
+  if (is_recent)
+    files = g_list_concat (thunar_io_recent_resolver_finish (&resolver), files);
+
   if (G_UNLIKELY (err != NULL))
     {
       g_propagate_error (error, err);
@@ -217,3 +522,136 @@ thunar_io_scan_directory (ThunarJob          *job,
 
   return files;
 }
+
+
+
+/**
+ * thunar_io_scan_directory_indexed:
+ * @job       : a #ThunarJob, or %NULL.
+ * @file      : the directory to list.
+ * @threshold : the number of children above which @file is indexed.
+ * @entries   : return location for the index, set to %NULL if @file
+ *              has no more than @threshold children.
+ * @error     : return location for errors or %NULL.
+ *
+ * Lists the children of @file as #ThunarFile<!---->s, like
+ * thunar_io_scan_directory() does. Once more than @threshold children
+ * were found, only the directories are kept as #ThunarFile<!---->s, all
+ * other children are collected in @entries as #ThunarFolderEntry<!---->s.
+ *
+ * Return value: the list of #ThunarFile<!---->s.
+ **/
+GList *
+thunar_io_scan_directory_indexed (ThunarJob  *job,
+                                  GFile      *file,
+                                  guint       threshold,
+                                  GPtrArray **entries,
+                                  GError    **error)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo       *info;
+  GError          *err = NULL;
+  GFile           *child_file;
+  GList           *files = NULL;
+  GList           *lp;
+  GList           *next;
+  GCancellable    *cancellable = NULL;
+  guint            n_children = 0;
+
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (entries != NULL, NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  *entries = NULL;
+
+  /* abort if the job was cancelled */
+  if (job != NULL && exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return NULL;
+
+  if (job != NULL)
+    cancellable = exo_job_get_cancellable (EXO_JOB (job));
+
+  /* try to read from the directory */
+  enumerator = g_file_enumerate_children (file, THUNARX_FILE_INFO_NAMESPACE,
+                                          G_FILE_QUERY_INFO_NONE, cancellable, &err);
+  if (err != NULL)
+    {
+      g_propagate_error (error, err);
+      return NULL;
+    }
+
+  /* iterate over children one by one */
+  while (job == NULL || !exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      info = g_file_enumerator_next_file (enumerator, cancellable, &err);
+      if (G_UNLIKELY (err != NULL))
+        {
+          /* skip children we cannot query, break on other errors */
+          if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_FAILED)
+              || g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_MOUNTED))
+            {
+              g_clear_error (&err);
+              g_clear_object (&info);
+              continue;
+            }
+          g_clear_object (&info);
+          break;
+        }
+
+      /* break when end of enumerator is reached */
+      if (G_UNLIKELY (info == NULL))
+        break;
+
+      /* too many children, index everything but the directories from now on */
+      if (G_UNLIKELY (++n_children > threshold && *entries == NULL))
+        {
+          *entries = g_ptr_array_new_with_free_func ((GDestroyNotify) thunar_folder_entry_free);
+          for (lp = files; lp != NULL; lp = next)
+            {
+              next = lp->next;
+              if (thunar_file_is_directory (lp->data))
+                continue;
+
+              g_ptr_array_add (*entries, thunar_folder_entry_new (thunar_file_get_basename (lp->data),
+                                                                  thunar_file_get_display_name (lp->data),
+                                                                  thunar_file_get_kind (lp->data),
+                                                                  thunar_file_is_hidden (lp->data)));
+              g_object_unref (lp->data);
+              files = g_list_delete_link (files, lp);
+            }
+        }
+
+      if (*entries != NULL && g_file_info_get_file_type (info) != G_FILE_TYPE_DIRECTORY)
+        {
+          g_ptr_array_add (*entries, thunar_folder_entry_new (g_file_info_get_name (info),
+                                                              g_file_info_get_display_name (info),
+                                                              g_file_info_get_file_type (info),
+                                                              g_file_info_get_is_hidden (info)
+                                                              || g_file_info_get_is_backup (info)));
+        }
+      else
+        {
+          child_file = g_file_get_child (file, g_file_info_get_name (info));
+          files = g_list_prepend (files, thunar_file_get_with_info (child_file, info, NULL, FALSE));
+          g_object_unref (child_file);
+        }
+
+      g_object_unref (info);
+    }
+
+  /* release the enumerator */
+  g_object_unref (enumerator);
+
+  if (G_UNLIKELY (err != NULL)
+      || (job != NULL && exo_job_set_error_if_cancelled (EXO_JOB (job), &err)))
+    {
+      g_propagate_error (error, err);
+      thunar_g_list_free_full (files);
+      if (*entries != NULL)
+        g_ptr_array_unref (*entries);
+      *entries = NULL;
+      return NULL;
+    }
+
+  return files;
+}
@@ -35,6 +35,11 @@ GList *thunar_io_scan_directory (ThunarJob          *job,
                                  gboolean            unlinking,
                                  gboolean            return_thunar_files,
                                  GError            **error);
+GList *thunar_io_scan_directory_indexed (ThunarJob   *job,
+                                         GFile       *file,
+                                         guint        threshold,
+                                         GPtrArray  **entries,
+                                         GError     **error);
 
 G_END_DECLS
 
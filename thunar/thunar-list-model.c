@@ -75,6 +75,41 @@ typedef gint (*ThunarSortFunc) (const ThunarFile *a,
                                 const ThunarFile *b,
                                 gboolean          case_sensitive);
 
+typedef struct _ThunarListModelRow ThunarListModelRow;
+
+typedef gint (*ThunarListModelRowCmpFunc) (const ThunarListModelRow *a,
+                                           const ThunarListModelRow *b,
+                                           ThunarListModel          *store);
+
+/* Values pre-extracted into the rows for the active sort column */
+typedef enum
+{
+  THUNAR_LIST_MODEL_SORT_KEY_NONE,
+  THUNAR_LIST_MODEL_SORT_KEY_SIZE,
+  THUNAR_LIST_MODEL_SORT_KEY_DATE,
+} ThunarListModelSortKey;
+
+/* Properties structured search terms like "size:>1g" filter on */
+typedef enum
+{
+  THUNAR_LIST_MODEL_SEARCH_KEY_SIZE,
+  THUNAR_LIST_MODEL_SEARCH_KEY_MODIFIED,
+  THUNAR_LIST_MODEL_SEARCH_KEY_TYPE,
+} ThunarListModelSearchKey;
+
+typedef struct
+{
+  ThunarListModelSearchKey key;
+
+  /* inclusive range of sizes or modification times (in seconds) */
+  gint64                   min;
+  gint64                   max;
+
+  /* for THUNAR_LIST_MODEL_SEARCH_KEY_TYPE, a file kind like
+   * "folder" or a (partial) content type like "video" */
+  gchar                   *type;
+} ThunarListModelSearchPredicate;
+
 static void               thunar_list_model_tree_model_init             (GtkTreeModelIface            *iface);
 static void               thunar_list_model_drag_dest_init              (GtkTreeDragDestIface         *iface);
 static void               thunar_list_model_sortable_init               (GtkTreeSortableIface         *iface);
@@ -139,14 +174,22 @@ static void               thunar_list_model_set_sort_func               (GtkTree
                                                                          gpointer                      data,
                                                                          GDestroyNotify                destroy);
 static gboolean           thunar_list_model_has_default_sort_func       (GtkTreeSortable              *sortable);
-static gint               thunar_list_model_cmp_func                    (gconstpointer                 a,
+static gint               thunar_list_model_row_cmp_func                (gconstpointer                 a,
                                                                          gconstpointer                 b,
                                                                          gpointer                      user_data);
+static void               thunar_list_model_update_sort                 (ThunarListModel              *store);
+static void               thunar_list_model_row_update_keys             (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
 static void               thunar_list_model_sort                        (ThunarListModel              *store);
 static void               thunar_list_model_file_changed                (ThunarFileMonitor            *file_monitor,
                                                                          ThunarFile                   *file,
                                                                          gint                          reason,
                                                                          ThunarListModel              *store);
+static void               thunar_list_model_queue_changed_rows          (ThunarListModel              *store);
+static void               thunar_list_model_flush_changed_rows          (ThunarListModel              *store);
+static gboolean           thunar_list_model_changed_rows_idle           (gpointer                      user_data);
+static void               thunar_list_model_frame_clock_update          (GdkFrameClock                *frame_clock,
+                                                                         ThunarListModel              *store);
 static void               thunar_list_model_folder_destroy              (ThunarFolder                 *folder,
                                                                          ThunarListModel              *store);
 static void               thunar_list_model_folder_error                (ThunarFolder                 *folder,
@@ -160,6 +203,49 @@ static void               thunar_list_model_files_removed               (ThunarF
                                                                          ThunarListModel              *store);
 static void               thunar_list_model_insert_files                (ThunarListModel              *store,
                                                                          GList                        *files);
+static void               thunar_list_model_entries_added               (ThunarFolder                 *folder,
+                                                                         GList                        *entries,
+                                                                         ThunarListModel              *store);
+static void               thunar_list_model_entries_removed             (ThunarFolder                 *folder,
+                                                                         GList                        *entries,
+                                                                         ThunarListModel              *store);
+static void               thunar_list_model_update_virtual              (ThunarListModel              *store);
+static ThunarListModelRow *thunar_list_model_row_new                    (ThunarListModel              *store,
+                                                                         ThunarFile                   *file);
+static ThunarListModelRow *thunar_list_model_row_new_for_entry          (ThunarListModel              *store,
+                                                                         ThunarFolderEntry            *entry);
+static ThunarFile        *thunar_list_model_row_peek_file               (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static ThunarFile        *thunar_list_model_row_lookup_file             (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static GFile             *thunar_list_model_row_get_location            (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static void               thunar_list_model_queue_load                  (ThunarListModel              *store);
+static gboolean           thunar_list_model_load_rows_idle              (gpointer                      user_data);
+static void               thunar_list_model_load_ready                  (GFile                        *location,
+                                                                         ThunarFile                   *file,
+                                                                         GError                       *error,
+                                                                         gpointer                      user_data);
+static void               thunar_list_model_row_free                    (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static gint               thunar_list_model_row_get_index               (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static guint              thunar_list_model_find_position               (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static void               thunar_list_model_insert_row                  (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static void               thunar_list_model_merge_rows                  (ThunarListModel              *store,
+                                                                         GPtrArray                    *rows);
+static void               thunar_list_model_remove_row                  (ThunarListModel              *store,
+                                                                         guint                         position);
+static void               thunar_list_model_remove_marked_rows          (ThunarListModel              *store);
+static void               thunar_list_model_search_index_insert         (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static void               thunar_list_model_search_index_remove         (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static void               thunar_list_model_search_index_update         (ThunarListModel              *store,
+                                                                         ThunarListModelRow           *row);
+static void               thunar_list_model_search_index_drop           (ThunarListModel              *store);
 static gint               sort_by_date                                  (const ThunarFile             *a,
                                                                          const ThunarFile             *b,
                                                                          gboolean                      case_sensitive,
@@ -228,6 +314,7 @@ static void               thunar_list_model_search_folder               (ThunarL
                                                                          ThunarJob                    *job,
                                                                          gchar                        *uri,
                                                                          gchar                       **search_query_c_terms,
+                                                                         GArray                       *search_predicates,
                                                                          enum ThunarListModelSearch    search_type,
                                                                          gboolean                      show_hidden);
 static void               thunar_list_model_cancel_search_job           (ThunarListModel              *model);
@@ -235,11 +322,25 @@ static gchar**            thunar_list_model_split_search_query          (const g
                                                                          GError                      **error);
 static gboolean           thunar_list_model_search_terms_match          (gchar                       **terms,
                                                                          gchar                        *str);
+static GArray            *thunar_list_model_parse_search_predicates     (gchar                       **terms);
+static gboolean           thunar_list_model_search_predicates_match     (GArray                       *predicates,
+                                                                         GFileType                     kind,
+                                                                         guint64                       size,
+                                                                         guint64                       modified,
+                                                                         const gchar                  *content_type);
+static gboolean           thunar_list_model_search_info_match           (GArray                       *predicates,
+                                                                         GFileInfo                    *info);
 
 static void               thunar_list_model_search_error                (ThunarJob                    *job);
 static void               thunar_list_model_search_finished             (ThunarJob                    *job,
                                                                          ThunarListModel              *store);
 static gboolean           thunar_list_model_add_search_files            (gpointer user_data);
+static void               thunar_list_model_push_search_files           (ThunarListModel              *model,
+                                                                         ThunarJob                    *job,
+                                                                         GList                        *files,
+                                                                         guint                         n_files);
+static void               thunar_list_model_clear_search_files          (ThunarListModel              *model);
+static GList             *thunar_list_model_get_search_statistics       (ThunarListModel              *store);
 
 static gint               thunar_list_model_get_folder_item_count       (ThunarListModel              *store);
 static void               thunar_list_model_set_folder_item_count       (ThunarListModel              *store,
@@ -270,8 +371,50 @@ struct _ThunarListModel
   gint           stamp;
 #endif
 
-  GSequence               *rows;
-  GSList                  *hidden;
+  /* the visible rows in sort order; every ThunarListModelRow
+   * caches its own position, which is trusted only below
+   * rows_valid and refreshed on demand for the rest.
+   */
+  GPtrArray               *rows;
+  GHashTable              *row_for_file;
+  guint                    rows_valid;
+
+  /* rows of the entries of a virtual folder, the rows whose files
+   * were loaded on demand, least recently used first, and the rows
+   * waiting for their files to be loaded, most recent request last */
+  GHashTable              *row_for_entry;
+  GQueue                   loaded_rows;
+  GQueue                   load_queue;
+  GCancellable            *load_cancellable;
+  guint                    load_idle_id;
+  guint                    n_loading;
+
+  /* rows whose files are kept loaded: the shown
+   * range of rows and the rows in pinned_rows */
+  gint                     visible_first;
+  gint                     visible_last;
+  GPtrArray               *pinned_rows;
+
+  /* type-ahead index: the rows sorted by their search keys, built
+   * on the first lookup and dropped on bulk changes; every row caches
+   * its position like in rows, trusted only below search_valid */
+  GPtrArray               *search_index;
+  guint                    search_valid;
+
+  /* range of search_index matching the last type-ahead key */
+  gchar                   *search_text;
+  guint                    search_lower;
+  guint                    search_upper;
+  gboolean                 search_range_valid;
+
+  /* rows whose files changed since the last flush, which runs in
+   * the update phase of the view's frame clock, or from an idle
+   * source while the model is not shown */
+  GHashTable              *changed_rows;
+  guint                    changed_rows_idle_id;
+  GdkFrameClock           *frame_clock;
+  gulong                   frame_clock_update_id;
+  GHashTable              *hidden;
   ThunarFolder            *folder;
   gboolean                 show_hidden : 1;
   ThunarFolderItemCount    folder_item_count;
@@ -285,6 +428,10 @@ struct _ThunarListModel
    */
   gchar **search_terms;
 
+  /* ThunarListModelSearchPredicate's parsed from the
+   * search terms, NULL if the search has none */
+  GArray *search_predicates;
+
   /* Use the shared ThunarFileMonitor instance, so we
    * do not need to connect "changed" handler to every
    * file in the model.
@@ -302,6 +449,16 @@ struct _ThunarListModel
   gint           sort_sign;   /* 1 = ascending, -1 descending */
   ThunarSortFunc sort_func;
 
+  /* the folder is virtual, so the rows are sorted by name only */
+  gboolean       sort_virtual;
+
+  /* comparator specialized for the settings above, and the
+   * value it expects to find pre-extracted in every row
+   */
+  ThunarListModelRowCmpFunc sort_row_func;
+  ThunarListModelSortKey    sort_key;
+  ThunarFileDateType        sort_date_type;
+
   /* searching runs in a separate thread which incrementally inserts results (files)
    * in the files_to_add list.
    * Periodically the main thread takes all the files in the files_to_add list
@@ -309,12 +466,59 @@ struct _ThunarListModel
    */
   ThunarJob     *recursive_search_job;
   GList         *files_to_add;
+  guint          n_files_to_add;
   GMutex         mutex_files_to_add;
+  GCond          cond_files_to_add;  /* signalled when files_to_add was drained */
+
+  /* statistics of the current search, updated atomically by the
+   * search job; the job stops once search_limit files matched */
+  guint          search_limit;
+  gint           search_n_visited;
+  gint           search_n_matched;
+  gint           search_n_skipped;
+  gint           search_truncated;
 
   /* used to stop the periodic call to thunar_list_model_add_search_files when the search is finished/canceled */
   guint          update_search_results_timeout_id;
 };
 
+struct _ThunarListModelRow
+{
+  ThunarFile        *file;         /* %NULL for entries until loaded */
+  ThunarFolderEntry *entry;        /* set for virtual folder entries */
+  GList             *link;         /* link in load_queue while loading, else in loaded_rows */
+  gint               index;        /* -1 while marked for removal */
+  gchar             *search_key;   /* normalized name for type-ahead, or %NULL */
+  guint              search_pos;   /* position in search_index */
+  gboolean           is_directory;
+  gboolean           loading : 1;  /* file requested, but not loaded yet */
+  gboolean           pinned : 1;   /* in pinned_rows */
+  guint64            key;          /* size or date, see ThunarListModelSortKey */
+  guint64            prefix;       /* first bytes of the name collation key, big-endian */
+};
+
+#define THUNAR_LIST_MODEL_ROW(store, n) ((ThunarListModelRow *) g_ptr_array_index ((store)->rows, (n)))
+
+/* maximum number of entry files kept loaded at the same time */
+#define THUNAR_LIST_MODEL_MAX_LOADED_ROWS 4096
+
+/* maximum number of entry files loaded in parallel */
+#define THUNAR_LIST_MODEL_MAX_LOADING 16
+
+/* maximum number of selected rows kept loaded, larger selections
+ * are loaded by the view and only drawn like the other rows */
+#define THUNAR_LIST_MODEL_MAX_PINNED_ROWS 1024
+
+/* maximum number of loaded rows checked for pinning per eviction */
+#define THUNAR_LIST_MODEL_MAX_EVICT_SCAN 64
+
+/* maximum number of search results waiting to be inserted, the
+ * search job pauses until the main loop caught up */
+#define THUNAR_LIST_MODEL_MAX_PENDING_SEARCH_FILES 8192
+
+/* number of matches collected by the search job before handing them over */
+#define THUNAR_LIST_MODEL_SEARCH_CHUNK_SIZE 256
+
 
 
 static guint       list_model_signals[LAST_SIGNAL];
@@ -546,8 +750,18 @@ thunar_list_model_init (ThunarListModel *store)
   store->sort_folders_first = TRUE;
   store->sort_sign = 1;
   store->sort_func = thunar_file_compare_by_name;
-  store->rows = g_sequence_new (g_object_unref);
+  thunar_list_model_update_sort (store);
+  store->rows = g_ptr_array_new ();
+  store->row_for_file = g_hash_table_new (g_direct_hash, g_direct_equal);
+  store->row_for_entry = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_queue_init (&store->loaded_rows);
+  g_queue_init (&store->load_queue);
+  store->visible_last = -1;
+  store->pinned_rows = g_ptr_array_new ();
+  store->changed_rows = g_hash_table_new (g_direct_hash, g_direct_equal);
+  store->hidden = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
   g_mutex_init (&store->mutex_files_to_add);
+  g_cond_init (&store->cond_files_to_add);
 
   /* connect to the shared ThunarFileMonitor, so we don't need to
    * connect "changed" to every single ThunarFile we own.
@@ -574,6 +788,7 @@ static void
 thunar_list_model_finalize (GObject *object)
 {
   ThunarListModel *store = THUNAR_LIST_MODEL (object);
+  guint            n;
 
   thunar_list_model_cancel_search_job (store);
 
@@ -582,11 +797,28 @@ thunar_list_model_finalize (GObject *object)
       g_source_remove (store->update_search_results_timeout_id);
       store->update_search_results_timeout_id = 0;
     }
-  thunar_g_list_free_full (store->files_to_add);
-  store->files_to_add = NULL;
-
-  g_sequence_free (store->rows);
+  thunar_list_model_clear_search_files (store);
+
+  /* may fall back to the idle source, so drop the clock first */
+  thunar_list_model_set_frame_clock (store, NULL);
+  if (store->changed_rows_idle_id != 0)
+    g_source_remove (store->changed_rows_idle_id);
+  if (store->load_idle_id != 0)
+    g_source_remove (store->load_idle_id);
+
+  thunar_list_model_search_index_drop (store);
+  g_free (store->search_text);
+
+  for (n = 0; n < store->rows->len; ++n)
+    thunar_list_model_row_free (store, THUNAR_LIST_MODEL_ROW (store, n));
+  g_ptr_array_free (store->rows, TRUE);
+  g_hash_table_destroy (store->row_for_file);
+  g_hash_table_destroy (store->row_for_entry);
+  g_hash_table_destroy (store->changed_rows);
+  g_hash_table_destroy (store->hidden);
+  g_ptr_array_free (store->pinned_rows, TRUE);
   g_mutex_clear (&store->mutex_files_to_add);
+  g_cond_clear (&store->cond_files_to_add);
 
   /* disconnect from the file monitor */
   g_signal_handlers_disconnect_by_func (G_OBJECT (store->file_monitor), thunar_list_model_file_changed, store);
@@ -595,6 +827,8 @@ thunar_list_model_finalize (GObject *object)
   g_free (store->date_custom_style);
 
   g_strfreev (store->search_terms);
+  if (store->search_predicates != NULL)
+    g_array_unref (store->search_predicates);
 
   (*G_OBJECT_CLASS (thunar_list_model_parent_class)->finalize) (object);
 }
@@ -791,7 +1025,6 @@ thunar_list_model_get_iter (GtkTreeModel *model,
                             GtkTreePath  *path)
 {
   ThunarListModel *store = THUNAR_LIST_MODEL (model);
-  GSequenceIter   *row;
   gint             offset;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), FALSE);
@@ -799,11 +1032,9 @@ thunar_list_model_get_iter (GtkTreeModel *model,
 
   /* determine the row for the path */
   offset = gtk_tree_path_get_indices (path)[0];
-  row = g_sequence_get_iter_at_pos (store->rows, offset);
-
-  if (!g_sequence_iter_is_end (row))
+  if (offset >= 0 && (guint) offset < store->rows->len)
     {
-      GTK_TREE_ITER_INIT (*iter, store->stamp, row);
+      GTK_TREE_ITER_INIT (*iter, store->stamp, THUNAR_LIST_MODEL_ROW (store, offset));
       return TRUE;
     }
 
@@ -821,7 +1052,7 @@ thunar_list_model_get_path (GtkTreeModel *model,
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (model), NULL);
   _thunar_return_val_if_fail (iter->stamp == THUNAR_LIST_MODEL (model)->stamp, NULL);
 
-  idx = g_sequence_iter_get_position (iter->user_data);
+  idx = thunar_list_model_row_get_index (THUNAR_LIST_MODEL (model), iter->user_data);
   if (G_LIKELY (idx >= 0))
     return gtk_tree_path_new_from_indices (idx, -1);
 
@@ -836,23 +1067,38 @@ thunar_list_model_get_value (GtkTreeModel *model,
                              gint          column,
                              GValue       *value)
 {
-  ThunarGroup  *group;
-  const gchar  *device_type;
-  const gchar  *name;
-  const gchar  *real_name;
-  ThunarUser   *user;
-  ThunarFile   *file;
-  ThunarFolder *folder;
-  gchar        *str;
-  guint32       item_count;
-  GFile        *g_file;
-  GFile        *g_file_parent;
+  ThunarListModelRow *row;
+  ThunarGroup        *group;
+  const gchar        *device_type;
+  const gchar        *name;
+  const gchar        *real_name;
+  ThunarUser         *user;
+  ThunarFile         *file;
+  ThunarFolder       *folder;
+  gchar              *str;
+  guint32             item_count;
+  GFile              *g_file;
+  GFile              *g_file_parent;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (model));
   _thunar_return_if_fail (iter->stamp == (THUNAR_LIST_MODEL (model))->stamp);
 
-  file = g_sequence_get (iter->user_data);
-  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+  /* the names of virtual folder entries are known without loading the file */
+  row = iter->user_data;
+  if (row->entry != NULL && (column == THUNAR_COLUMN_NAME || column == THUNAR_COLUMN_FILE_NAME))
+    {
+      g_value_init (value, G_TYPE_STRING);
+      g_value_set_static_string (value, row->entry->display_name);
+      return;
+    }
+
+  /* the other columns stay empty until the file is loaded */
+  file = thunar_list_model_row_peek_file (THUNAR_LIST_MODEL (model), row);
+  if (G_UNLIKELY (file == NULL))
+    {
+      g_value_init (value, thunar_list_model_get_column_type (model, column));
+      return;
+    }
 
   switch (column)
     {
@@ -1079,11 +1325,21 @@ static gboolean
 thunar_list_model_iter_next (GtkTreeModel *model,
                              GtkTreeIter  *iter)
 {
+  ThunarListModel *store = THUNAR_LIST_MODEL (model);
+  guint            idx;
+
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (model), FALSE);
   _thunar_return_val_if_fail (iter->stamp == (THUNAR_LIST_MODEL (model))->stamp, FALSE);
 
-  iter->user_data = g_sequence_iter_next (iter->user_data);
-  return !g_sequence_iter_is_end (iter->user_data);
+  idx = thunar_list_model_row_get_index (store, iter->user_data) + 1;
+  if (idx >= store->rows->len)
+    {
+      iter->user_data = NULL;
+      return FALSE;
+    }
+
+  iter->user_data = THUNAR_LIST_MODEL_ROW (store, idx);
+  return TRUE;
 }
 
 
@@ -1098,9 +1354,9 @@ thunar_list_model_iter_children (GtkTreeModel *model,
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), FALSE);
 
   if (G_LIKELY (parent == NULL
-      && g_sequence_get_length (store->rows) > 0))
+      && store->rows->len > 0))
     {
-      GTK_TREE_ITER_INIT (*iter, store->stamp, g_sequence_get_begin_iter (store->rows));
+      GTK_TREE_ITER_INIT (*iter, store->stamp, THUNAR_LIST_MODEL_ROW (store, 0));
       return TRUE;
     }
 
@@ -1126,7 +1382,7 @@ thunar_list_model_iter_n_children (GtkTreeModel *model,
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), 0);
 
-  return (iter == NULL) ? g_sequence_get_length (store->rows) : 0;
+  return (iter == NULL) ? (gint) store->rows->len : 0;
 }
 
 
@@ -1138,17 +1394,15 @@ thunar_list_model_iter_nth_child (GtkTreeModel *model,
                                   gint          n)
 {
   ThunarListModel *store = THUNAR_LIST_MODEL (model);
-  GSequenceIter   *row;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), FALSE);
 
   if (G_LIKELY (parent == NULL))
     {
-      row = g_sequence_get_iter_at_pos (store->rows, n);
-      if (g_sequence_iter_is_end (row))
+      if (n < 0 || (guint) n >= store->rows->len)
         return FALSE;
 
-      GTK_TREE_ITER_INIT (*iter, store->stamp, row);
+      GTK_TREE_ITER_INIT (*iter, store->stamp, THUNAR_LIST_MODEL_ROW (store, n));
       return TRUE;
     }
 
@@ -1361,27 +1615,179 @@ thunar_list_model_has_default_sort_func (GtkTreeSortable *sortable)
 
 
 
+/* The row comparators below are generated once for every sort
+ * configuration, so that comparing two rows doesn't need to check
+ * the sort settings or query the files for sizes and dates.
+ */
+#define THUNAR_LIST_MODEL_CMP_NAME(a, b, case_sensitive) \
+  ((a)->prefix < (b)->prefix ? -1 : ((a)->prefix > (b)->prefix ? 1 : thunar_file_compare_by_name ((a)->file, (b)->file, case_sensitive)))
+#define THUNAR_LIST_MODEL_CMP_KEY(a, b, case_sensitive) \
+  ((a)->key < (b)->key ? -1 : ((a)->key > (b)->key ? 1 : THUNAR_LIST_MODEL_CMP_NAME (a, b, case_sensitive)))
+#define THUNAR_LIST_MODEL_CMP_OTHER(a, b, case_sensitive) \
+  ((*store->sort_func) ((a)->file, (b)->file, case_sensitive))
+#define THUNAR_LIST_MODEL_CMP_VIRTUAL(a, b, case_sensitive) \
+  ((a)->prefix < (b)->prefix ? -1 : ((a)->prefix > (b)->prefix ? 1 : thunar_list_model_row_compare_names (a, b)))
+
+/* rows of virtual folders may not have a file, so they are
+ * compared by the case-insensitive keys of the entries, which
+ * the files share for the directories */
+static inline gint
+thunar_list_model_row_compare_names (const ThunarListModelRow *a,
+                                     const ThunarListModelRow *b)
+{
+  gint result;
+
+  result = g_strcmp0 ((a->entry != NULL) ? a->entry->collate_key : thunar_file_get_collate_key (a->file, FALSE),
+                      (b->entry != NULL) ? b->entry->collate_key : thunar_file_get_collate_key (b->file, FALSE));
+  if (G_UNLIKELY (result == 0))
+    result = strcmp ((a->entry != NULL) ? a->entry->name : thunar_file_get_basename (a->file),
+                     (b->entry != NULL) ? b->entry->name : thunar_file_get_basename (b->file));
+
+  return result;
+}
+
+#define THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC(name, CMP, case_sensitive, folders_first, sign) \
+static gint                                                                                   \
+name (const ThunarListModelRow *a,                                                            \
+      const ThunarListModelRow *b,                                                            \
+      ThunarListModel          *store)                                                        \
+{                                                                                             \
+  if ((folders_first) && a->is_directory != b->is_directory)                                  \
+    return a->is_directory ? -1 : 1;                                                          \
+                                                                                              \
+  return (sign) * CMP (a, b, case_sensitive);                                                 \
+}
+
+#define THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNCS(kind, CMP)                                                  \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_ci_asc,     CMP, FALSE, FALSE, 1)  \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_ci_desc,    CMP, FALSE, FALSE, -1) \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_ci_ff_asc,  CMP, FALSE, TRUE,  1)  \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_ci_ff_desc, CMP, FALSE, TRUE,  -1) \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_cs_asc,     CMP, TRUE,  FALSE, 1)  \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_cs_desc,    CMP, TRUE,  FALSE, -1) \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_cs_ff_asc,  CMP, TRUE,  TRUE,  1)  \
+  THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNC (thunar_list_model_row_cmp_##kind##_cs_ff_desc, CMP, TRUE,  TRUE,  -1)
+
+/* [case_sensitive][folders_first][descending] */
+#define THUNAR_LIST_MODEL_ROW_CMP_FUNCS(kind)                                                            \
+  { { { thunar_list_model_row_cmp_##kind##_ci_asc,    thunar_list_model_row_cmp_##kind##_ci_desc    },   \
+      { thunar_list_model_row_cmp_##kind##_ci_ff_asc, thunar_list_model_row_cmp_##kind##_ci_ff_desc } }, \
+    { { thunar_list_model_row_cmp_##kind##_cs_asc,    thunar_list_model_row_cmp_##kind##_cs_desc    },   \
+      { thunar_list_model_row_cmp_##kind##_cs_ff_asc, thunar_list_model_row_cmp_##kind##_cs_ff_desc } } }
+
+THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNCS (name, THUNAR_LIST_MODEL_CMP_NAME)
+THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNCS (key, THUNAR_LIST_MODEL_CMP_KEY)
+THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNCS (other, THUNAR_LIST_MODEL_CMP_OTHER)
+THUNAR_LIST_MODEL_DEFINE_ROW_CMP_FUNCS (virtual, THUNAR_LIST_MODEL_CMP_VIRTUAL)
+
+static const ThunarListModelRowCmpFunc row_cmp_funcs_name[2][2][2] = THUNAR_LIST_MODEL_ROW_CMP_FUNCS (name);
+static const ThunarListModelRowCmpFunc row_cmp_funcs_key[2][2][2] = THUNAR_LIST_MODEL_ROW_CMP_FUNCS (key);
+static const ThunarListModelRowCmpFunc row_cmp_funcs_other[2][2][2] = THUNAR_LIST_MODEL_ROW_CMP_FUNCS (other);
+static const ThunarListModelRowCmpFunc row_cmp_funcs_virtual[2][2][2] = THUNAR_LIST_MODEL_ROW_CMP_FUNCS (virtual);
+
+
+
 static gint
-thunar_list_model_cmp_func (gconstpointer a,
-                            gconstpointer b,
-                            gpointer      user_data)
+thunar_list_model_row_cmp_func (gconstpointer a,
+                                gconstpointer b,
+                                gpointer      user_data)
 {
   ThunarListModel *store = THUNAR_LIST_MODEL (user_data);
-  gboolean         isdir_a;
-  gboolean         isdir_b;
 
-  _thunar_return_val_if_fail (THUNAR_IS_FILE (a), 0);
-  _thunar_return_val_if_fail (THUNAR_IS_FILE (b), 0);
+  return (*store->sort_row_func) (*((ThunarListModelRow **) a), *((ThunarListModelRow **) b), store);
+}
+
+
+
+static void
+thunar_list_model_update_sort (ThunarListModel *store)
+{
+  const ThunarListModelRowCmpFunc (*funcs)[2][2];
+  guint                             n;
+
+  /* determine the value to pre-extract for the sort column */
+  store->sort_key = THUNAR_LIST_MODEL_SORT_KEY_DATE;
+  if (store->sort_func == sort_by_size || store->sort_func == sort_by_size_in_bytes)
+    store->sort_key = THUNAR_LIST_MODEL_SORT_KEY_SIZE;
+  else if (store->sort_func == sort_by_date_created)
+    store->sort_date_type = THUNAR_FILE_DATE_CREATED;
+  else if (store->sort_func == sort_by_date_accessed)
+    store->sort_date_type = THUNAR_FILE_DATE_ACCESSED;
+  else if (store->sort_func == sort_by_date_modified)
+    store->sort_date_type = THUNAR_FILE_DATE_MODIFIED;
+  else if (store->sort_func == sort_by_date_changed)
+    store->sort_date_type = THUNAR_FILE_DATE_CHANGED;
+  else if (store->sort_func == sort_by_date_deleted)
+    store->sort_date_type = THUNAR_FILE_DATE_DELETED;
+  else if (store->sort_func == sort_by_recency)
+    store->sort_date_type = THUNAR_FILE_RECENCY;
+  else
+    store->sort_key = THUNAR_LIST_MODEL_SORT_KEY_NONE;
+
+  /* virtual folders are sorted by name, without loading the files */
+  if (store->sort_virtual)
+    store->sort_key = THUNAR_LIST_MODEL_SORT_KEY_NONE;
+
+  /* pick the comparator for the current settings */
+  if (store->sort_virtual)
+    funcs = row_cmp_funcs_virtual;
+  else if (store->sort_key != THUNAR_LIST_MODEL_SORT_KEY_NONE)
+    funcs = row_cmp_funcs_key;
+  else if (store->sort_func == thunar_file_compare_by_name)
+    funcs = row_cmp_funcs_name;
+  else
+    funcs = row_cmp_funcs_other;
+
+  store->sort_row_func = funcs[store->sort_case_sensitive ? 1 : 0]
+                              [store->sort_folders_first ? 1 : 0]
+                              [store->sort_sign < 0 ? 1 : 0];
+
+  /* refresh the pre-extracted values */
+  if (store->rows != NULL)
+    for (n = 0; n < store->rows->len; ++n)
+      thunar_list_model_row_update_keys (store, THUNAR_LIST_MODEL_ROW (store, n));
+}
+
 
-  if (G_LIKELY (store->sort_folders_first))
+
+static void
+thunar_list_model_row_update_keys (ThunarListModel    *store,
+                                   ThunarListModelRow *row)
+{
+  const gchar *collate_key;
+  guint        n;
+
+  if (row->entry != NULL)
+    row->is_directory = (row->entry->type == G_FILE_TYPE_DIRECTORY);
+  else
+    row->is_directory = thunar_file_is_directory (row->file);
+
+  /* pack the start of the collation key so that comparing the
+   * prefixes as integers matches strcmp() on the whole keys,
+   * unless the prefixes are equal */
+  row->prefix = 0;
+  if (row->entry != NULL)
+    collate_key = row->entry->collate_key;
+  else
+    collate_key = thunar_file_get_collate_key (row->file, store->sort_case_sensitive && !store->sort_virtual);
+  if (G_LIKELY (collate_key != NULL))
+    for (n = 0; n < sizeof (row->prefix) && collate_key[n] != '\0'; ++n)
+      row->prefix |= (guint64) (guchar) collate_key[n] << (8 * (sizeof (row->prefix) - 1 - n));
+
+  switch (store->sort_key)
     {
-      isdir_a = thunar_file_is_directory (a);
-      isdir_b = thunar_file_is_directory (b);
-      if (isdir_a != isdir_b)
-        return isdir_a ? -1 : 1;
-    }
+    case THUNAR_LIST_MODEL_SORT_KEY_SIZE:
+      row->key = thunar_file_get_size (row->file);
+      break;
+
+    case THUNAR_LIST_MODEL_SORT_KEY_DATE:
+      row->key = thunar_file_get_date (row->file, store->sort_date_type);
+      break;
 
-  return (*store->sort_func) (a, b, store->sort_case_sensitive) * store->sort_sign;
+    default:
+      row->key = 0;
+      break;
+    }
 }
 
 
@@ -1389,45 +1795,36 @@ thunar_list_model_cmp_func (gconstpointer a,
 static void
 thunar_list_model_sort (ThunarListModel *store)
 {
-  GtkTreePath    *path;
-  GSequenceIter **old_order;
-  gint           *new_order;
-  gint            n;
-  gint            length;
-  GSequenceIter  *row;
+  GtkTreePath *path;
+  gint        *new_order;
+  guint        length;
+  guint        n;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
 
-  length = g_sequence_get_length (store->rows);
+  /* the sort settings changed */
+  thunar_list_model_update_sort (store);
+
+  length = store->rows->len;
   if (G_UNLIKELY (length <= 1))
     return;
 
   /* be sure to not overuse the stack */
   if (G_LIKELY (length < 2000))
-    {
-      old_order = g_newa (GSequenceIter *, length);
-      new_order = g_newa (gint, length);
-    }
+    new_order = g_newa (gint, length);
   else
-    {
-      old_order = g_new (GSequenceIter *, length);
-      new_order = g_new (gint, length);
-    }
+    new_order = g_new (gint, length);
 
-  /* store old order */
-  row = g_sequence_get_begin_iter (store->rows);
-  for (n = 0; n < length; ++n)
-    {
-      old_order[n] = row;
-      row = g_sequence_iter_next (row);
-    }
+  /* make sure all rows know their old position */
+  thunar_list_model_row_get_index (store, THUNAR_LIST_MODEL_ROW (store, length - 1));
 
   /* sort */
-  g_sequence_sort (store->rows, thunar_list_model_cmp_func, store);
+  g_ptr_array_sort_with_data (store->rows, thunar_list_model_row_cmp_func, store);
 
   /* new_order[newpos] = oldpos */
   for (n = 0; n < length; ++n)
-    new_order[g_sequence_iter_get_position (old_order[n])] = n;
+    new_order[n] = THUNAR_LIST_MODEL_ROW (store, n)->index;
+  store->rows_valid = 0;
 
   /* tell the view about the new item order */
   path = gtk_tree_path_new_first ();
@@ -1436,10 +1833,7 @@ thunar_list_model_sort (ThunarListModel *store)
 
   /* clean up if we used the heap */
   if (G_UNLIKELY (length >= 2000))
-    {
-      g_free (old_order);
-      g_free (new_order);
-    }
+    g_free (new_order);
 }
 
 
@@ -1450,79 +1844,146 @@ thunar_list_model_file_changed (ThunarFileMonitor *file_monitor,
                                 gint               reason,
                                 ThunarListModel   *store)
 {
-  GSequenceIter *row;
-  GSequenceIter *end;
-  gint           pos_after;
-  gint           pos_before = 0;
-  gint          *new_order;
-  gint           length;
-  gint           i, j;
-  GtkTreePath   *path;
-  GtkTreeIter    iter;
+  ThunarListModelRow *row;
 
   _thunar_return_if_fail (THUNAR_IS_FILE_MONITOR (file_monitor) || file_monitor == NULL);
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
-  row = g_sequence_get_begin_iter (store->rows);
-  end = g_sequence_get_end_iter (store->rows);
+  /* hidden files and files of other folders have no row to update */
+  row = g_hash_table_lookup (store->row_for_file, file);
+  if (row == NULL)
+    return;
 
-  while (row != end)
-    {
-      if (G_UNLIKELY (g_sequence_get (row) == file))
-        {
-          /* generate the iterator for this row */
-          GTK_TREE_ITER_INIT (iter, store->stamp, row);
+  /* changes often arrive in storms (thumbnails, content types, builds),
+   * so collect them and notify the view(s) once before the next redraw */
+  g_hash_table_add (store->changed_rows, row);
+  thunar_list_model_queue_changed_rows (store);
+}
 
-          _thunar_assert (pos_before == g_sequence_iter_get_position (row));
 
-          /* check if the sorting changed */
-          g_sequence_sort_changed (row, thunar_list_model_cmp_func, store);
-          pos_after = g_sequence_iter_get_position (row);
-          if (pos_after != pos_before)
-            {
-              /* do swap sorting here since its much faster than a complete sort */
-              length = g_sequence_get_length (store->rows);
-              if (G_LIKELY (length < 2000))
-                new_order = g_newa (gint, length);
-              else
-                new_order = g_new (gint, length);
 
-              /* new_order[newpos] = oldpos */
-              for (i = 0, j = 0; i < length; ++i)
-                {
-                  if (G_UNLIKELY (i == pos_after))
-                    {
-                      new_order[i] = pos_before;
-                    }
-                  else
-                    {
-                      if (G_UNLIKELY (j == pos_before))
-                        j++;
-                      new_order[i] = j++;
-                    }
-                }
+static void
+thunar_list_model_queue_changed_rows (ThunarListModel *store)
+{
+  /* flush right before the next frame is laid out, or as soon
+   * as possible if there is no frame to wait for */
+  if (store->frame_clock != NULL)
+    gdk_frame_clock_request_phase (store->frame_clock, GDK_FRAME_CLOCK_PHASE_UPDATE);
+  else if (store->changed_rows_idle_id == 0)
+    store->changed_rows_idle_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, thunar_list_model_changed_rows_idle, store, NULL);
+}
 
-              /* tell the view about the new item order */
-              path = gtk_tree_path_new_first ();
-              gtk_tree_model_rows_reordered (GTK_TREE_MODEL (store), path, NULL, new_order);
-              gtk_tree_path_free (path);
 
-              /* clean up if we used the heap */
-              if (G_UNLIKELY (length >= 2000))
-                g_free (new_order);
-            }
 
-          /* notify the view that it has to redraw the file */
-          path = gtk_tree_path_new_from_indices (pos_before, -1);
-          gtk_tree_model_row_changed (GTK_TREE_MODEL (store), path, &iter);
-          gtk_tree_path_free (path);
-          break;
+static gboolean
+thunar_list_model_changed_rows_idle (gpointer user_data)
+{
+  ThunarListModel *store = THUNAR_LIST_MODEL (user_data);
+
+  store->changed_rows_idle_id = 0;
+  thunar_list_model_flush_changed_rows (store);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_list_model_frame_clock_update (GdkFrameClock   *frame_clock,
+                                      ThunarListModel *store)
+{
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+  _thunar_return_if_fail (store->frame_clock == frame_clock);
+
+  /* the clock also ticks for animations and other widgets */
+  if (g_hash_table_size (store->changed_rows) > 0)
+    thunar_list_model_flush_changed_rows (store);
+}
+
+
+
+static void
+thunar_list_model_flush_changed_rows (ThunarListModel *store)
+{
+  ThunarListModelRow *row;
+  GHashTableIter      hash_iter;
+  GtkTreePath        *path;
+  GtkTreeIter         iter;
+  GPtrArray          *moved;
+  gboolean            resort = FALSE;
+  gpointer            key;
+  GList              *rows;
+  GList              *lp;
+  gint               *new_order;
+  guint               length;
+  guint               n;
+  guint               m;
+
+  /* refresh the sort values and search keys of all changed rows */
+  g_hash_table_iter_init (&hash_iter, store->changed_rows);
+  while (g_hash_table_iter_next (&hash_iter, &key, NULL))
+    {
+      thunar_list_model_row_update_keys (store, key);
+      thunar_list_model_search_index_update (store, key);
+    }
+
+  /* the rows are still sorted, unless one of the changed rows
+   * now sorts differently compared to one of its neighbours */
+  length = store->rows->len;
+  g_hash_table_iter_init (&hash_iter, store->changed_rows);
+  while (!resort && g_hash_table_iter_next (&hash_iter, &key, NULL))
+    {
+      n = thunar_list_model_row_get_index (store, key);
+      resort = ((n > 0 && (*store->sort_row_func) (THUNAR_LIST_MODEL_ROW (store, n - 1), key, store) > 0)
+                || (n + 1 < length && (*store->sort_row_func) (key, THUNAR_LIST_MODEL_ROW (store, n + 1), store) > 0));
+    }
+
+  if (resort)
+    {
+      /* make sure all rows know their old position */
+      thunar_list_model_row_get_index (store, THUNAR_LIST_MODEL_ROW (store, length - 1));
+
+      /* take the changed rows out, the others stay sorted... */
+      moved = g_ptr_array_sized_new (g_hash_table_size (store->changed_rows));
+      for (n = 0, m = 0; n < length; ++n)
+        {
+          row = THUNAR_LIST_MODEL_ROW (store, n);
+          if (g_hash_table_contains (store->changed_rows, row))
+            g_ptr_array_add (moved, row);
+          else
+            store->rows->pdata[m++] = row;
         }
+      g_ptr_array_set_size (store->rows, m);
+      store->rows_valid = 0;
+
+      /* ...and merge them back in at their new positions */
+      thunar_list_model_merge_rows (store, moved);
+      g_ptr_array_free (moved, TRUE);
+
+      /* new_order[newpos] = oldpos */
+      new_order = g_new (gint, length);
+      for (n = 0; n < length; ++n)
+        new_order[n] = THUNAR_LIST_MODEL_ROW (store, n)->index;
+
+      /* tell the view about all position changes at once */
+      path = gtk_tree_path_new_first ();
+      gtk_tree_model_rows_reordered (GTK_TREE_MODEL (store), path, NULL, new_order);
+      gtk_tree_path_free (path);
+      g_free (new_order);
+    }
 
-      row = g_sequence_iter_next (row);
-      pos_before++;
+  /* notify the view that it has to redraw the files */
+  rows = g_hash_table_get_keys (store->changed_rows);
+  g_hash_table_steal_all (store->changed_rows);
+  for (lp = rows; lp != NULL; lp = lp->next)
+    {
+      GTK_TREE_ITER_INIT (iter, store->stamp, lp->data);
+      path = gtk_tree_path_new_from_indices (thunar_list_model_row_get_index (store, lp->data), -1);
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (store), path, &iter);
+      gtk_tree_path_free (path);
     }
+  g_list_free (rows);
 }
 
 
@@ -1585,6 +2046,17 @@ thunar_list_model_files_added (ThunarFolder    *folder,
       file = THUNAR_FILE (g_object_ref (G_OBJECT (lp->data)));
       _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
+      if (store->search_predicates != NULL
+          && !thunar_list_model_search_predicates_match (store->search_predicates,
+                                                         thunar_file_get_kind (file),
+                                                         thunar_file_get_size (file),
+                                                         thunar_file_get_date (file, THUNAR_FILE_DATE_MODIFIED),
+                                                         thunar_file_get_content_type (file)))
+        {
+          g_object_unref (file);
+          continue;
+        }
+
       name_n = (gchar *)thunar_file_get_display_name (file);
       name_n = thunar_g_utf8_normalize_for_search (name_n, TRUE, TRUE);
       matched = thunar_list_model_search_terms_match (store->search_terms, name_n);
@@ -1604,64 +2076,78 @@ static void
 thunar_list_model_insert_files (ThunarListModel *store,
                                 GList           *files)
 {
-  GtkTreePath   *path;
-  GtkTreeIter    iter;
-  ThunarFile    *file;
-  gint          *indices;
-  GSequenceIter *row;
-  GList         *lp;
-  gboolean       has_handler;
-  gboolean       search_mode;
-
-  /* we use a simple trick here to avoid allocating
-   * GtkTreePath's again and again, by simply accessing
-   * the indices directly and only modifying the first
-   * item in the integer array... looks a hack, eh?
+  ThunarListModelRow *row;
+  ThunarFile         *file;
+  GtkTreePath        *path;
+  GtkTreeIter         iter;
+  GPtrArray          *batch = NULL;
+  GList              *lp;
+  gboolean            search_mode;
+  gboolean            has_handler;
+  guint               n;
+
+  /* without anyone listening for "row-inserted", all new
+   * rows are sorted at once and merged into the model. The
+   * same is done for search results, which arrive in large
+   * chunks, the view is told about them after the merge
    */
-  path = gtk_tree_path_new_first ();
-  indices = gtk_tree_path_get_indices (path);
-
-  /* check if we have any handlers connected for "row-inserted" */
   has_handler = g_signal_has_handler_pending (G_OBJECT (store), store->row_inserted_id, 0, FALSE);
+  search_mode = (store->search_terms != NULL);
+  if (!has_handler || search_mode)
+    batch = g_ptr_array_new ();
 
   /* process all added files */
-  search_mode = (store->search_terms != NULL);
   for (lp = files; lp != NULL; lp = lp->next)
     {
+      _thunar_assert (THUNAR_IS_FILE (lp->data));
+
+      /* every file gets at most one row */
+      if (G_UNLIKELY (g_hash_table_contains (store->row_for_file, lp->data)))
+        continue;
+
       /* take a reference on that file */
       file = THUNAR_FILE (g_object_ref (G_OBJECT (lp->data)));
-      _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
-      /* check if the file should be stashed in the hidden list */
-      /* The ->hidden list is an optimization used by the model when
+      /* check if the file should be stashed in the hidden set */
+      /* The ->hidden set is an optimization used by the model when
        * it is not being used to store search results. In the search
        * case, we simply restart the search, */
       if (!store->show_hidden && thunar_file_is_hidden (file))
         {
           if (search_mode == FALSE)
-            store->hidden = g_slist_prepend (store->hidden, file);
+            g_hash_table_add (store->hidden, file);
           else
             g_object_unref (file);
         }
+      else if (batch != NULL)
+        {
+          g_ptr_array_add (batch, thunar_list_model_row_new (store, file));
+        }
       else
         {
-          /* insert the file */
-          row = g_sequence_insert_sorted (store->rows, file,
-                                          thunar_list_model_cmp_func, store);
+          thunar_list_model_insert_row (store, thunar_list_model_row_new (store, file));
+        }
+    }
 
-          if (has_handler)
-            {
-              /* generate an iterator for the new item */
-              GTK_TREE_ITER_INIT (iter, store->stamp, row);
+  if (batch != NULL)
+    {
+      /* rebuild the search index on the next lookup */
+      thunar_list_model_search_index_drop (store);
+      thunar_list_model_merge_rows (store, batch);
 
-              indices[0] = g_sequence_iter_get_position (row);
-              gtk_tree_model_row_inserted (GTK_TREE_MODEL (store), path, &iter);
-            }
+      /* the merged rows are sorted, so announcing them in that order
+       * matches the model state the view sees at every signal */
+      for (n = 0; has_handler && n < batch->len; ++n)
+        {
+          row = g_ptr_array_index (batch, n);
+          GTK_TREE_ITER_INIT (iter, store->stamp, row);
+          path = gtk_tree_path_new_from_indices (thunar_list_model_row_get_index (store, row), -1);
+          gtk_tree_model_row_inserted (GTK_TREE_MODEL (store), path, &iter);
+          gtk_tree_path_free (path);
         }
-    }
 
-  /* release the path */
-  gtk_tree_path_free (path);
+      g_ptr_array_free (batch, TRUE);
+    }
 
   /* number of visible files may have changed */
   g_object_notify_by_pspec (G_OBJECT (store), list_model_props[PROP_NUM_FILES]);
@@ -1674,111 +2160,893 @@ thunar_list_model_files_removed (ThunarFolder    *folder,
                                  GList           *files,
                                  ThunarListModel *store)
 {
-  GList         *lp;
-  GSequenceIter *row;
-  GSequenceIter *end;
-  GSequenceIter *next;
-  GtkTreePath   *path;
-  gboolean       found;
-  gboolean       search_mode;
+  ThunarListModelRow *row;
+  GList              *lp;
+  gboolean            has_handler;
+  gboolean            search_mode;
+  guint               n_marked = 0;
+
+  /* check if we have any handlers connected for "row-deleted" */
+  has_handler = g_signal_has_handler_pending (G_OBJECT (store), store->row_deleted_id, 0, FALSE);
 
   /* drop all the referenced files from the model */
   search_mode = (store->search_terms != NULL);
   for (lp = files; lp != NULL; lp = lp->next)
     {
-      row = g_sequence_get_begin_iter (store->rows);
-      end = g_sequence_get_end_iter (store->rows);
+      /* hidden files don't have a row, no need to look for one */
+      /* this only makes sense when not storing search results */
+      if (search_mode == FALSE && g_hash_table_remove (store->hidden, lp->data))
+        continue;
 
-      found = FALSE;
+      row = g_hash_table_lookup (store->row_for_file, lp->data);
+      if (G_UNLIKELY (row == NULL))
+        continue;
 
-      while (row != end)
+      /* the view(s) need one "row-deleted" per row, otherwise
+       * the rows are dropped together in a single pass below
+       */
+      if (G_LIKELY (has_handler))
         {
-          next = g_sequence_iter_next (row);
-
-          if (g_sequence_get (row) == lp->data)
-            {
-              /* setup path for "row-deleted" */
-              path = gtk_tree_path_new_from_indices (g_sequence_iter_get_position (row), -1);
-
-              /* remove file from the model */
-              g_sequence_remove (row);
-
-              /* notify the view(s) */
-              gtk_tree_model_row_deleted (GTK_TREE_MODEL (store), path);
-              gtk_tree_path_free (path);
-
-              /* no need to look in the hidden files */
-              found = TRUE;
-
-              break;
-            }
-
-          row = next;
+          thunar_list_model_remove_row (store, thunar_list_model_row_get_index (store, row));
         }
-
-      /* check if the file was found */
-      if (!found)
+      else
         {
-          if (search_mode == FALSE)
-            {
-              /* file is hidden */
-              /* this only makes sense when not storing search results */
-              _thunar_assert (g_slist_find (store->hidden, lp->data) != NULL);
-              store->hidden = g_slist_remove (store->hidden, lp->data);
-              g_object_unref (G_OBJECT (lp->data));
-            }
+          row->index = -1;
+          n_marked++;
         }
     }
 
+  if (n_marked > 0)
+    thunar_list_model_remove_marked_rows (store);
+
   /* this probably changed */
   g_object_notify_by_pspec (G_OBJECT (store), list_model_props[PROP_NUM_FILES]);
 }
 
 
 
-static gint
-sort_by_date         (const ThunarFile *a,
-                      const ThunarFile *b,
-                      gboolean          case_sensitive,
-                      gint              type)
+static void
+thunar_list_model_entries_added (ThunarFolder    *folder,
+                                 GList           *entries,
+                                 ThunarListModel *store)
 {
-  guint64 date_a;
-  guint64 date_b;
+  ThunarFolderEntry *entry;
+  GPtrArray         *batch = NULL;
+  GList             *lp;
 
-  date_a = thunar_file_get_date (a, type);
-  date_b = thunar_file_get_date (b, type);
+  /* search results are made of files only */
+  if (store->search_terms != NULL)
+    return;
 
-  if (date_a < date_b)
-    return -1;
-  else if (date_a > date_b)
-    return 1;
+  /* the folder may just have turned virtual */
+  thunar_list_model_update_virtual (store);
 
-  return thunar_file_compare_by_name (a, b, case_sensitive);
-}
+  if (!g_signal_has_handler_pending (G_OBJECT (store), store->row_inserted_id, 0, FALSE))
+    batch = g_ptr_array_new ();
 
+  for (lp = entries; lp != NULL; lp = lp->next)
+    {
+      entry = lp->data;
 
+      /* hidden entries are looked up in the folder when shown again */
+      if (!store->show_hidden && entry->is_hidden)
+        continue;
 
-static gint
-sort_by_date_created (const ThunarFile *a,
-                      const ThunarFile *b,
-                      gboolean          case_sensitive)
-{
-  return sort_by_date (a, b, case_sensitive, THUNAR_FILE_DATE_CREATED);
-}
+      if (G_UNLIKELY (g_hash_table_contains (store->row_for_entry, entry)))
+        continue;
 
+      if (batch != NULL)
+        g_ptr_array_add (batch, thunar_list_model_row_new_for_entry (store, entry));
+      else
+        thunar_list_model_insert_row (store, thunar_list_model_row_new_for_entry (store, entry));
+    }
 
+  if (batch != NULL)
+    {
+      /* rebuild the search index on the next lookup */
+      thunar_list_model_search_index_drop (store);
+      thunar_list_model_merge_rows (store, batch);
+      g_ptr_array_free (batch, TRUE);
+    }
 
-static gint
-sort_by_date_accessed (const ThunarFile *a,
-                       const ThunarFile *b,
-                       gboolean          case_sensitive)
-{
-  return sort_by_date (a, b, case_sensitive, THUNAR_FILE_DATE_ACCESSED);
+  /* number of visible files may have changed */
+  g_object_notify_by_pspec (G_OBJECT (store), list_model_props[PROP_NUM_FILES]);
 }
 
 
 
-static gint
+static void
+thunar_list_model_entries_removed (ThunarFolder    *folder,
+                                   GList           *entries,
+                                   ThunarListModel *store)
+{
+  ThunarListModelRow *row;
+  GList              *lp;
+  gboolean            has_handler;
+  guint               n_marked = 0;
+
+  has_handler = g_signal_has_handler_pending (G_OBJECT (store), store->row_deleted_id, 0, FALSE);
+
+  for (lp = entries; lp != NULL; lp = lp->next)
+    {
+      row = g_hash_table_lookup (store->row_for_entry, lp->data);
+      if (row == NULL)
+        continue;
+
+      if (G_LIKELY (has_handler))
+        {
+          thunar_list_model_remove_row (store, thunar_list_model_row_get_index (store, row));
+        }
+      else
+        {
+          row->index = -1;
+          n_marked++;
+        }
+    }
+
+  if (n_marked > 0)
+    thunar_list_model_remove_marked_rows (store);
+
+  /* the folder may no longer be virtual */
+  thunar_list_model_update_virtual (store);
+
+  g_object_notify_by_pspec (G_OBJECT (store), list_model_props[PROP_NUM_FILES]);
+}
+
+
+
+static void
+thunar_list_model_update_virtual (ThunarListModel *store)
+{
+  gboolean sort_virtual;
+
+  sort_virtual = (store->folder != NULL
+                  && store->search_terms == NULL
+                  && thunar_folder_get_virtual (store->folder));
+
+  /* switch the comparators if the folder started or stopped being virtual */
+  if (store->sort_virtual != sort_virtual)
+    {
+      store->sort_virtual = sort_virtual;
+      thunar_list_model_sort (store);
+    }
+}
+
+
+
+static ThunarListModelRow*
+thunar_list_model_row_new (ThunarListModel *store,
+                           ThunarFile      *file)
+{
+  ThunarListModelRow *row;
+
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
+
+  /* the row takes over the reference on the file */
+  row = g_slice_new (ThunarListModelRow);
+  row->file = file;
+  row->entry = NULL;
+  row->link = NULL;
+  row->loading = FALSE;
+  row->pinned = FALSE;
+  row->index = G_MAXINT;
+  row->search_key = NULL;
+  row->search_pos = G_MAXUINT;
+  thunar_list_model_row_update_keys (store, row);
+
+  g_hash_table_insert (store->row_for_file, file, row);
+
+  return row;
+}
+
+
+
+static ThunarListModelRow*
+thunar_list_model_row_new_for_entry (ThunarListModel   *store,
+                                     ThunarFolderEntry *entry)
+{
+  ThunarListModelRow *row;
+
+  /* the entry is owned by the folder, which tells us before releasing it */
+  row = g_slice_new (ThunarListModelRow);
+  row->file = NULL;
+  row->entry = entry;
+  row->link = NULL;
+  row->loading = FALSE;
+  row->pinned = FALSE;
+  row->index = G_MAXINT;
+  row->search_key = NULL;
+  row->search_pos = G_MAXUINT;
+  thunar_list_model_row_update_keys (store, row);
+
+  g_hash_table_insert (store->row_for_entry, entry, row);
+
+  return row;
+}
+
+
+
+static void
+thunar_list_model_row_unload (ThunarListModel    *store,
+                              ThunarListModelRow *row)
+{
+  if (g_hash_table_lookup (store->row_for_file, row->file) == row)
+    g_hash_table_remove (store->row_for_file, row->file);
+  g_object_unref (row->file);
+  row->file = NULL;
+}
+
+
+
+static gboolean
+thunar_list_model_row_is_pinned (ThunarListModel    *store,
+                                 ThunarListModelRow *row)
+{
+  gint index;
+
+  if (row->pinned)
+    return TRUE;
+
+  if (store->visible_last < 0)
+    return FALSE;
+
+  index = thunar_list_model_row_get_index (store, row);
+  return (index >= store->visible_first && index <= store->visible_last);
+}
+
+
+
+static void
+thunar_list_model_row_attach_file (ThunarListModel    *store,
+                                   ThunarListModelRow *row,
+                                   ThunarFile         *file)
+{
+  ThunarListModelRow *oldest;
+  guint               n;
+
+  /* the row takes over the reference on the file */
+  row->file = file;
+  row->loading = FALSE;
+
+  /* forward changes of the file to the row */
+  if (!g_hash_table_contains (store->row_for_file, row->file))
+    g_hash_table_insert (store->row_for_file, row->file, row);
+
+  /* keep a bounded number of entry files around, dropping the least
+   * recently used ones that are neither shown nor selected; if only
+   * pinned rows are found, the limit is exceeded for a while */
+  g_queue_push_tail (&store->loaded_rows, row);
+  row->link = store->loaded_rows.tail;
+  for (n = 0; n < THUNAR_LIST_MODEL_MAX_EVICT_SCAN && store->loaded_rows.length > THUNAR_LIST_MODEL_MAX_LOADED_ROWS; ++n)
+    {
+      oldest = g_queue_pop_head (&store->loaded_rows);
+      if (thunar_list_model_row_is_pinned (store, oldest))
+        {
+          g_queue_push_tail (&store->loaded_rows, oldest);
+          oldest->link = store->loaded_rows.tail;
+        }
+      else
+        {
+          oldest->link = NULL;
+          thunar_list_model_row_unload (store, oldest);
+        }
+    }
+}
+
+
+
+static inline void
+thunar_list_model_row_touch (ThunarListModel    *store,
+                             ThunarListModelRow *row)
+{
+  GQueue *queue;
+
+  /* move the row to the recently used end of its queue */
+  if (row->link != NULL)
+    {
+      queue = row->loading ? &store->load_queue : &store->loaded_rows;
+      if (row->link != queue->tail)
+        {
+          g_queue_unlink (queue, row->link);
+          g_queue_push_tail_link (queue, row->link);
+        }
+    }
+}
+
+
+
+static ThunarFile*
+thunar_list_model_row_peek_file (ThunarListModel    *store,
+                                 ThunarListModelRow *row)
+{
+  ThunarListModelRow *oldest;
+
+  thunar_list_model_row_touch (store, row);
+
+  if (G_LIKELY (row->file != NULL || row->loading))
+    return row->file;
+
+  _thunar_return_val_if_fail (row->entry != NULL, NULL);
+
+  /* load the file of the entry in the background */
+  row->loading = TRUE;
+  g_queue_push_tail (&store->load_queue, row);
+  row->link = store->load_queue.tail;
+
+  /* forget requests for rows that were scrolled past long ago */
+  if (store->load_queue.length > THUNAR_LIST_MODEL_MAX_LOADED_ROWS)
+    {
+      oldest = g_queue_pop_head (&store->load_queue);
+      oldest->link = NULL;
+      oldest->loading = FALSE;
+    }
+
+  thunar_list_model_queue_load (store);
+
+  return NULL;
+}
+
+
+
+static ThunarFile*
+thunar_list_model_row_lookup_file (ThunarListModel    *store,
+                                   ThunarListModelRow *row)
+{
+  ThunarFile *file;
+  GFile      *gfile;
+
+  if (G_LIKELY (row->file != NULL || row->entry == NULL))
+    return thunar_list_model_row_peek_file (store, row);
+
+  /* the file may have been loaded elsewhere already, e.g. for the
+   * selection; only attach it here, outside of drawing the rows */
+  gfile = thunar_list_model_row_get_location (store, row);
+  file = thunar_file_cache_lookup (gfile);
+  g_object_unref (gfile);
+  if (file == NULL)
+    return thunar_list_model_row_peek_file (store, row);
+
+  if (row->loading && row->link != NULL)
+    {
+      g_queue_delete_link (&store->load_queue, row->link);
+      row->link = NULL;
+    }
+  thunar_list_model_row_attach_file (store, row, file);
+
+  return row->file;
+}
+
+
+
+static GFile*
+thunar_list_model_row_get_location (ThunarListModel    *store,
+                                    ThunarListModelRow *row)
+{
+  if (row->file != NULL)
+    return g_object_ref (thunar_file_get_file (row->file));
+
+  _thunar_return_val_if_fail (row->entry != NULL, NULL);
+  _thunar_return_val_if_fail (THUNAR_IS_FOLDER (store->folder), NULL);
+
+  return g_file_get_child (thunar_file_get_file (thunar_folder_get_corresponding_file (store->folder)), row->entry->name);
+}
+
+
+
+static void
+thunar_list_model_queue_load (ThunarListModel *store)
+{
+  /* start the loads from the main loop, as cached files are attached
+   * right away and the rows must not change while they are drawn */
+  if (store->load_idle_id == 0
+      && store->load_queue.length > 0
+      && store->n_loading < THUNAR_LIST_MODEL_MAX_LOADING)
+    store->load_idle_id = g_idle_add (thunar_list_model_load_rows_idle, store);
+}
+
+
+
+static void
+thunar_list_model_row_loaded (ThunarListModel    *store,
+                              ThunarListModelRow *row,
+                              ThunarFile         *file)
+{
+  thunar_list_model_row_attach_file (store, row, file);
+
+  /* redraw the row with the next batch of changes */
+  g_hash_table_add (store->changed_rows, row);
+  thunar_list_model_queue_changed_rows (store);
+}
+
+
+
+typedef struct
+{
+  ThunarListModel *store;
+  GCancellable    *cancellable;
+} ThunarListModelLoad;
+
+
+
+static gboolean
+thunar_list_model_load_rows_idle (gpointer user_data)
+{
+  ThunarListModel     *store = THUNAR_LIST_MODEL (user_data);
+  ThunarListModelLoad *load;
+  ThunarListModelRow  *row;
+  ThunarFile          *file;
+  GFile               *parent;
+  GFile               *gfile;
+
+  store->load_idle_id = 0;
+
+  if (G_UNLIKELY (store->folder == NULL))
+    return FALSE;
+
+  parent = thunar_file_get_file (thunar_folder_get_corresponding_file (store->folder));
+  while (store->n_loading < THUNAR_LIST_MODEL_MAX_LOADING && store->load_queue.length > 0)
+    {
+      /* the latest requests are for the rows shown right now */
+      row = g_queue_pop_tail (&store->load_queue);
+      row->link = NULL;
+
+      gfile = g_file_get_child (parent, row->entry->name);
+      file = thunar_file_cache_lookup (gfile);
+      if (file != NULL)
+        {
+          thunar_list_model_row_loaded (store, row, file);
+        }
+      else
+        {
+          if (store->load_cancellable == NULL)
+            store->load_cancellable = g_cancellable_new ();
+
+          load = g_slice_new (ThunarListModelLoad);
+          load->store = g_object_ref (store);
+          load->cancellable = g_object_ref (store->load_cancellable);
+
+          store->n_loading++;
+          thunar_file_get_async (gfile, store->load_cancellable, thunar_list_model_load_ready, load);
+        }
+      g_object_unref (gfile);
+    }
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_list_model_load_ready (GFile      *location,
+                              ThunarFile *file,
+                              GError     *error,
+                              gpointer    user_data)
+{
+  ThunarListModelLoad *load = user_data;
+  ThunarListModel     *store = load->store;
+  ThunarListModelRow  *row = NULL;
+  ThunarFolderEntry   *entry;
+  gchar               *name;
+
+  /* loads of a previous folder are cancelled and not counted */
+  if (load->cancellable == store->load_cancellable)
+    {
+      store->n_loading--;
+
+      if (G_LIKELY (store->folder != NULL))
+        {
+          name = g_file_get_basename (location);
+          entry = thunar_folder_lookup_entry (store->folder, name);
+          if (entry != NULL)
+            row = g_hash_table_lookup (store->row_for_entry, entry);
+          g_free (name);
+        }
+
+      /* the row may have been removed or loaded by now */
+      if (row != NULL && row->file == NULL && row->loading && row->link == NULL)
+        {
+          if (G_LIKELY (error == NULL && file != NULL))
+            thunar_list_model_row_loaded (store, row, g_object_ref (file));
+          else
+            row->loading = FALSE;
+        }
+
+      thunar_list_model_queue_load (store);
+    }
+
+  g_object_unref (load->cancellable);
+  g_object_unref (load->store);
+  g_slice_free (ThunarListModelLoad, load);
+}
+
+
+
+static void
+thunar_list_model_row_free (ThunarListModel    *store,
+                            ThunarListModelRow *row)
+{
+  if (row->entry != NULL)
+    g_hash_table_remove (store->row_for_entry, row->entry);
+  if (row->link != NULL)
+    g_queue_delete_link (row->loading ? &store->load_queue : &store->loaded_rows, row->link);
+  if (row->pinned)
+    g_ptr_array_remove_fast (store->pinned_rows, row);
+  if (row->file != NULL)
+    thunar_list_model_row_unload (store, row);
+  if (store->search_index != NULL)
+    thunar_list_model_search_index_remove (store, row);
+  g_hash_table_remove (store->changed_rows, row);
+  g_free (row->search_key);
+  g_slice_free (ThunarListModelRow, row);
+}
+
+
+
+static gint
+thunar_list_model_row_get_index (ThunarListModel    *store,
+                                 ThunarListModelRow *row)
+{
+  guint n;
+
+  /* positions behind the first change since the last
+   * lookup are stale, refresh them in one go */
+  if (G_UNLIKELY ((guint) row->index >= store->rows_valid))
+    {
+      for (n = store->rows_valid; n < store->rows->len; ++n)
+        THUNAR_LIST_MODEL_ROW (store, n)->index = n;
+      store->rows_valid = store->rows->len;
+    }
+
+  _thunar_assert (THUNAR_LIST_MODEL_ROW (store, row->index) == row);
+
+  return row->index;
+}
+
+
+
+static guint
+thunar_list_model_find_position (ThunarListModel    *store,
+                                 ThunarListModelRow *row)
+{
+  guint lower = 0;
+  guint upper = store->rows->len;
+  guint middle;
+
+  /* binary search for the first row sorted after row */
+  while (lower < upper)
+    {
+      middle = lower + (upper - lower) / 2;
+      if ((*store->sort_row_func) (THUNAR_LIST_MODEL_ROW (store, middle), row, store) > 0)
+        upper = middle;
+      else
+        lower = middle + 1;
+    }
+
+  return lower;
+}
+
+
+
+static void
+thunar_list_model_insert_row (ThunarListModel    *store,
+                              ThunarListModelRow *row)
+{
+  GtkTreePath *path;
+  GtkTreeIter  iter;
+  guint        position;
+
+  position = thunar_list_model_find_position (store, row);
+  g_ptr_array_insert (store->rows, position, row);
+  store->rows_valid = MIN (store->rows_valid, position);
+  thunar_list_model_search_index_insert (store, row);
+
+  /* tell the view(s) about the new row */
+  GTK_TREE_ITER_INIT (iter, store->stamp, row);
+  path = gtk_tree_path_new_from_indices (position, -1);
+  gtk_tree_model_row_inserted (GTK_TREE_MODEL (store), path, &iter);
+  gtk_tree_path_free (path);
+}
+
+
+
+static void
+thunar_list_model_merge_rows (ThunarListModel *store,
+                              GPtrArray       *rows)
+{
+  guint i, j, k;
+
+  if (rows->len == 0)
+    return;
+
+  g_ptr_array_sort_with_data (rows, thunar_list_model_row_cmp_func, store);
+
+  /* merge the sorted rows from the back, so the
+   * rows sorted before all new ones stay in place
+   */
+  i = store->rows->len;
+  j = rows->len;
+  k = i + j;
+  g_ptr_array_set_size (store->rows, k);
+  while (j > 0)
+    {
+      if (i > 0 && (*store->sort_row_func) (THUNAR_LIST_MODEL_ROW (store, i - 1), g_ptr_array_index (rows, j - 1), store) > 0)
+        store->rows->pdata[--k] = store->rows->pdata[--i];
+      else
+        store->rows->pdata[--k] = rows->pdata[--j];
+    }
+
+  store->rows_valid = MIN (store->rows_valid, k);
+}
+
+
+
+static void
+thunar_list_model_remove_row (ThunarListModel *store,
+                              guint            position)
+{
+  GtkTreePath *path;
+
+  thunar_list_model_row_free (store, g_ptr_array_remove_index (store->rows, position));
+  store->rows_valid = MIN (store->rows_valid, position);
+
+  /* notify the view(s) */
+  path = gtk_tree_path_new_from_indices (position, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (store), path);
+  gtk_tree_path_free (path);
+}
+
+
+
+static void
+thunar_list_model_remove_marked_rows (ThunarListModel *store)
+{
+  ThunarListModelRow *row;
+  guint               n;
+  guint               m;
+
+  /* cheaper to rebuild than to remove the rows one by one */
+  thunar_list_model_search_index_drop (store);
+
+  /* compact the rows in a single pass, dropping
+   * all rows with a negative index
+   */
+  for (n = 0, m = 0; n < store->rows->len; ++n)
+    {
+      row = THUNAR_LIST_MODEL_ROW (store, n);
+      if (row->index < 0)
+        {
+          store->rows_valid = MIN (store->rows_valid, m);
+          thunar_list_model_row_free (store, row);
+        }
+      else
+        {
+          store->rows->pdata[m++] = row;
+        }
+    }
+
+  g_ptr_array_set_size (store->rows, m);
+}
+
+
+
+static gchar*
+thunar_list_model_row_dup_search_key (ThunarListModelRow *row)
+{
+  const gchar *name;
+  gchar       *key;
+
+  name = (row->entry != NULL) ? row->entry->display_name : thunar_file_get_display_name (row->file);
+  key = thunar_g_utf8_normalize_for_search (name, FALSE, TRUE);
+
+  return (key != NULL) ? key : g_strdup (name);
+}
+
+
+
+static gint
+thunar_list_model_search_index_cmp (gconstpointer a,
+                                    gconstpointer b)
+{
+  return strcmp ((*((ThunarListModelRow **) a))->search_key, (*((ThunarListModelRow **) b))->search_key);
+}
+
+
+
+static void
+thunar_list_model_search_index_build (ThunarListModel *store)
+{
+  ThunarListModelRow *row;
+  guint               n;
+
+  if (store->search_index != NULL)
+    return;
+
+  store->search_index = g_ptr_array_sized_new (store->rows->len);
+  for (n = 0; n < store->rows->len; ++n)
+    {
+      row = THUNAR_LIST_MODEL_ROW (store, n);
+      if (row->search_key == NULL)
+        row->search_key = thunar_list_model_row_dup_search_key (row);
+      g_ptr_array_add (store->search_index, row);
+    }
+
+  g_ptr_array_sort (store->search_index, thunar_list_model_search_index_cmp);
+  store->search_valid = 0;
+  store->search_range_valid = FALSE;
+}
+
+
+
+static void
+thunar_list_model_search_index_drop (ThunarListModel *store)
+{
+  if (store->search_index == NULL)
+    return;
+
+  g_ptr_array_free (store->search_index, TRUE);
+  store->search_index = NULL;
+  store->search_range_valid = FALSE;
+}
+
+
+
+static guint
+thunar_list_model_row_get_search_pos (ThunarListModel    *store,
+                                      ThunarListModelRow *row)
+{
+  guint n;
+
+  /* same lazy refresh as for the row positions */
+  if (G_UNLIKELY (row->search_pos >= store->search_valid))
+    {
+      for (n = store->search_valid; n < store->search_index->len; ++n)
+        ((ThunarListModelRow *) g_ptr_array_index (store->search_index, n))->search_pos = n;
+      store->search_valid = store->search_index->len;
+    }
+
+  _thunar_assert (g_ptr_array_index (store->search_index, row->search_pos) == row);
+
+  return row->search_pos;
+}
+
+
+
+static guint
+thunar_list_model_search_index_bound (ThunarListModel *store,
+                                      const gchar     *prefix,
+                                      gsize            length,
+                                      gboolean         upper)
+{
+  ThunarListModelRow *row;
+  guint               lower = 0;
+  guint               limit = store->search_index->len;
+  guint               middle;
+  gint                result;
+
+  /* the search keys are sorted, so comparing only their first
+   * length bytes still gives a sorted sequence */
+  while (lower < limit)
+    {
+      middle = lower + (limit - lower) / 2;
+      row = g_ptr_array_index (store->search_index, middle);
+      result = strncmp (row->search_key, prefix, length);
+      if (result < 0 || (upper && result == 0))
+        lower = middle + 1;
+      else
+        limit = middle;
+    }
+
+  return lower;
+}
+
+
+
+static void
+thunar_list_model_search_index_insert (ThunarListModel    *store,
+                                       ThunarListModelRow *row)
+{
+  guint position;
+
+  if (store->search_index == NULL)
+    return;
+
+  if (row->search_key == NULL)
+    row->search_key = thunar_list_model_row_dup_search_key (row);
+
+  position = thunar_list_model_search_index_bound (store, row->search_key, strlen (row->search_key) + 1, TRUE);
+  g_ptr_array_insert (store->search_index, position, row);
+  store->search_valid = MIN (store->search_valid, position);
+  store->search_range_valid = FALSE;
+}
+
+
+
+static void
+thunar_list_model_search_index_remove (ThunarListModel    *store,
+                                       ThunarListModelRow *row)
+{
+  guint position;
+
+  if (store->search_index == NULL)
+    return;
+
+  position = thunar_list_model_row_get_search_pos (store, row);
+  g_ptr_array_remove_index (store->search_index, position);
+  store->search_valid = MIN (store->search_valid, position);
+  store->search_range_valid = FALSE;
+}
+
+
+
+static void
+thunar_list_model_search_index_update (ThunarListModel    *store,
+                                       ThunarListModelRow *row)
+{
+  gchar *search_key;
+
+  /* nothing to update if the key was never needed */
+  if (row->search_key == NULL)
+    return;
+
+  /* renamed files move in the index */
+  search_key = thunar_list_model_row_dup_search_key (row);
+  if (strcmp (search_key, row->search_key) == 0)
+    {
+      g_free (search_key);
+      return;
+    }
+
+  thunar_list_model_search_index_remove (store, row);
+  g_free (row->search_key);
+  row->search_key = search_key;
+  thunar_list_model_search_index_insert (store, row);
+}
+
+
+
+static gint
+sort_by_date         (const ThunarFile *a,
+                      const ThunarFile *b,
+                      gboolean          case_sensitive,
+                      gint              type)
+{
+  guint64 date_a;
+  guint64 date_b;
+
+  date_a = thunar_file_get_date (a, type);
+  date_b = thunar_file_get_date (b, type);
+
+  if (date_a < date_b)
+    return -1;
+  else if (date_a > date_b)
+    return 1;
+
+  return thunar_file_compare_by_name (a, b, case_sensitive);
+}
+
+
+
+static gint
+sort_by_date_created (const ThunarFile *a,
+                      const ThunarFile *b,
+                      gboolean          case_sensitive)
+{
+  return sort_by_date (a, b, case_sensitive, THUNAR_FILE_DATE_CREATED);
+}
+
+
+
+static gint
+sort_by_date_accessed (const ThunarFile *a,
+                       const ThunarFile *b,
+                       gboolean          case_sensitive)
+{
+  return sort_by_date (a, b, case_sensitive, THUNAR_FILE_DATE_ACCESSED);
+}
+
+
+
+static gint
 sort_by_date_modified (const ThunarFile *a,
                        const ThunarFile *b,
                        gboolean          case_sensitive)
@@ -2296,19 +3564,70 @@ static gboolean
 thunar_list_model_add_search_files (gpointer user_data)
 {
   ThunarListModel *model = THUNAR_LIST_MODEL (user_data);
+  GList           *files;
 
+  /* take the pending files and let the search job continue */
   g_mutex_lock (&model->mutex_files_to_add);
-
-  thunar_list_model_insert_files (model, model->files_to_add);
-  g_list_free (model->files_to_add);
+  files = model->files_to_add;
   model->files_to_add = NULL;
-
+  model->n_files_to_add = 0;
+  g_cond_broadcast (&model->cond_files_to_add);
   g_mutex_unlock (&model->mutex_files_to_add);
 
+  /* this also refreshes the search statistics in the statusbar */
+  thunar_list_model_insert_files (model, files);
+  thunar_g_list_free_full (files);
+
   return TRUE;
 }
 
 
+
+static void
+thunar_list_model_push_search_files (ThunarListModel *model,
+                                     ThunarJob       *job,
+                                     GList           *files,
+                                     guint            n_files)
+{
+  g_mutex_lock (&model->mutex_files_to_add);
+
+  /* keep the number of pending files bounded, the main
+   * loop wakes us up whenever it drained the list */
+  while (model->n_files_to_add >= THUNAR_LIST_MODEL_MAX_PENDING_SEARCH_FILES
+         && !exo_job_is_cancelled (EXO_JOB (job)))
+    g_cond_wait_until (&model->cond_files_to_add, &model->mutex_files_to_add,
+                       g_get_monotonic_time () + G_TIME_SPAN_SECOND / 10);
+
+  if (G_LIKELY (!exo_job_is_cancelled (EXO_JOB (job))))
+    {
+      model->files_to_add = g_list_concat (files, model->files_to_add);
+      model->n_files_to_add += n_files;
+      files = NULL;
+    }
+
+  g_mutex_unlock (&model->mutex_files_to_add);
+
+  thunar_g_list_free_full (files);
+}
+
+
+
+static void
+thunar_list_model_clear_search_files (ThunarListModel *model)
+{
+  GList *files;
+
+  g_mutex_lock (&model->mutex_files_to_add);
+  files = model->files_to_add;
+  model->files_to_add = NULL;
+  model->n_files_to_add = 0;
+  g_cond_broadcast (&model->cond_files_to_add);
+  g_mutex_unlock (&model->mutex_files_to_add);
+
+  thunar_g_list_free_full (files);
+}
+
+
 /**
  * thunar_list_model_split_search_query:
  * @search_query: The search query to split.
@@ -2365,6 +3684,338 @@ thunar_list_model_search_terms_match (gchar **terms,
 
 
 
+static const gchar*
+thunar_list_model_parse_search_range (const gchar *str,
+                                      gboolean    *less,
+                                      gboolean    *greater,
+                                      gboolean    *equal)
+{
+  *less = (*str == '<');
+  *greater = (*str == '>');
+  if (*less || *greater)
+    ++str;
+
+  *equal = (*str == '=');
+  if (*equal)
+    ++str;
+
+  /* a value without operator matches itself */
+  if (!*less && !*greater)
+    *equal = TRUE;
+
+  return str;
+}
+
+
+
+static void
+thunar_list_model_search_predicate_set_range (ThunarListModelSearchPredicate *predicate,
+                                              gboolean                        less,
+                                              gboolean                        greater,
+                                              gboolean                        equal,
+                                              gint64                          lower,
+                                              gint64                          upper)
+{
+  /* [lower, upper] is the range the value itself stands for,
+   * e.g. all seconds of a day for a date */
+  predicate->min = G_MININT64;
+  predicate->max = G_MAXINT64;
+
+  if (less)
+    predicate->max = equal ? upper : lower - 1;
+  else if (greater)
+    predicate->min = equal ? lower : upper + 1;
+  else
+    {
+      predicate->min = lower;
+      predicate->max = upper;
+    }
+}
+
+
+
+static gboolean
+thunar_list_model_parse_search_size (const gchar                    *str,
+                                     ThunarListModelSearchPredicate *predicate)
+{
+  gboolean less, greater, equal;
+  gdouble  value;
+  gdouble  factor = 1.0;
+  gchar   *end;
+
+  str = thunar_list_model_parse_search_range (str, &less, &greater, &equal);
+  if (!g_ascii_isdigit (*str))
+    return FALSE;
+
+  value = g_ascii_strtod (str, &end);
+
+  /* binary units, the search query is already case folded */
+  switch (*end)
+    {
+    case 't': factor *= 1024.0; /* fall through */
+    case 'g': factor *= 1024.0; /* fall through */
+    case 'm': factor *= 1024.0; /* fall through */
+    case 'k': factor *= 1024.0;
+      if (*++end == 'i')
+        ++end;
+      break;
+    }
+  if (*end == 'b')
+    ++end;
+  if (*end != '\0')
+    return FALSE;
+
+  value = MIN (value * factor, (gdouble) G_MAXINT64 / 2);
+  thunar_list_model_search_predicate_set_range (predicate, less, greater, equal, (gint64) value, (gint64) value);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_list_model_parse_search_modified (const gchar                    *str,
+                                         ThunarListModelSearchPredicate *predicate)
+{
+  GDateTime *date;
+  GDateTime *next_date;
+  gboolean   less, greater, equal;
+  gint64     age;
+  gint64     factor;
+  gint64     time;
+  gchar     *end;
+  gint64     year, month, day;
+
+  str = thunar_list_model_parse_search_range (str, &less, &greater, &equal);
+  if (!g_ascii_isdigit (*str))
+    return FALSE;
+
+  /* an absolute date like "2024-01-31", matching the whole day */
+  year = g_ascii_strtoll (str, &end, 10);
+  if (*end == '-' && g_ascii_isdigit (end[1]))
+    {
+      month = g_ascii_strtoll (end + 1, &end, 10);
+      if (*end != '-' || !g_ascii_isdigit (end[1]))
+        return FALSE;
+      day = g_ascii_strtoll (end + 1, &end, 10);
+      if (*end != '\0' || year < 1 || year > 9999 || month < 1 || month > 12 || day < 1 || day > 31)
+        return FALSE;
+
+      date = g_date_time_new_local (year, month, day, 0, 0, 0);
+      if (date == NULL)
+        return FALSE;
+
+      next_date = g_date_time_add_days (date, 1);
+      thunar_list_model_search_predicate_set_range (predicate, less, greater, equal,
+                                                    g_date_time_to_unix (date),
+                                                    g_date_time_to_unix (next_date) - 1);
+      g_date_time_unref (next_date);
+      g_date_time_unref (date);
+
+      return TRUE;
+    }
+
+  /* otherwise an age like "7d", in days if no unit is given */
+  switch (*end)
+    {
+    case 'h': factor = 60 * 60; ++end; break;
+    case 'w': factor = 7 * 24 * 60 * 60; ++end; break;
+    case 'y': factor = 365 * 24 * 60 * 60; ++end; break;
+    case 'd': ++end; /* fall through */
+    default:  factor = 24 * 60 * 60; break;
+    }
+  if (*end != '\0')
+    return FALSE;
+
+  /* ages beyond the epoch match all files alike, don't overflow on them */
+  age = MIN (year, G_MAXINT64 / factor) * factor;
+
+  /* younger files were modified later, "modified:7d" without
+   * operator means modified within the last 7 days */
+  time = g_get_real_time () / G_USEC_PER_SEC - age;
+  if (equal && !less && !greater)
+    thunar_list_model_search_predicate_set_range (predicate, FALSE, TRUE, TRUE, time, time);
+  else
+    thunar_list_model_search_predicate_set_range (predicate, greater, less, equal, time, time);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_list_model_search_predicate_clear (gpointer data)
+{
+  ThunarListModelSearchPredicate *predicate = data;
+
+  g_free (predicate->type);
+}
+
+
+
+/**
+ * thunar_list_model_parse_search_predicates:
+ * @terms: The search terms, prepared with thunar_list_model_split_search_query().
+ *
+ * Moves the structured terms "size:", "modified:" and "type:" out of
+ * @terms, so only the terms matched against file names remain. Terms
+ * which cannot be parsed are left in place as name terms.
+ *
+ *  - size:>1g, size:<=100k - file size, with binary units k, m, g and t
+ *  - modified:<7d, modified:>=2024-01-31 - modification time, given
+ *    as age in hours, days, weeks or years, or as local date
+ *  - type:folder, type:file, type:link, type:video, type:image/png - file
+ *    kind, content type family or content type
+ *
+ * Return value: an array of #ThunarListModelSearchPredicate's to free with
+ *               g_array_unref(), or %NULL if @terms contained none.
+ **/
+static GArray*
+thunar_list_model_parse_search_predicates (gchar **terms)
+{
+  ThunarListModelSearchPredicate predicate;
+  GArray                        *predicates = NULL;
+  gboolean                       parsed;
+  guint                          i, j;
+
+  for (i = 0, j = 0; terms[i] != NULL; ++i)
+    {
+      memset (&predicate, 0, sizeof (predicate));
+
+      if (g_str_has_prefix (terms[i], "size:"))
+        {
+          predicate.key = THUNAR_LIST_MODEL_SEARCH_KEY_SIZE;
+          parsed = thunar_list_model_parse_search_size (terms[i] + 5, &predicate);
+        }
+      else if (g_str_has_prefix (terms[i], "modified:"))
+        {
+          predicate.key = THUNAR_LIST_MODEL_SEARCH_KEY_MODIFIED;
+          parsed = thunar_list_model_parse_search_modified (terms[i] + 9, &predicate);
+        }
+      else if (g_str_has_prefix (terms[i], "type:") && terms[i][5] != '\0')
+        {
+          predicate.key = THUNAR_LIST_MODEL_SEARCH_KEY_TYPE;
+          predicate.type = g_strdup (terms[i] + 5);
+          parsed = TRUE;
+        }
+      else
+        {
+          parsed = FALSE;
+        }
+
+      if (!parsed)
+        {
+          terms[j++] = terms[i];
+          continue;
+        }
+
+      if (predicates == NULL)
+        {
+          predicates = g_array_new (FALSE, FALSE, sizeof (ThunarListModelSearchPredicate));
+          g_array_set_clear_func (predicates, thunar_list_model_search_predicate_clear);
+        }
+      g_array_append_val (predicates, predicate);
+      g_free (terms[i]);
+    }
+  terms[j] = NULL;
+
+  return predicates;
+}
+
+
+
+static gboolean
+thunar_list_model_search_type_match (const gchar *type,
+                                     GFileType    kind,
+                                     const gchar *content_type)
+{
+  gsize length;
+
+  if (strcmp (type, "folder") == 0 || strcmp (type, "directory") == 0)
+    return (kind == G_FILE_TYPE_DIRECTORY);
+  if (strcmp (type, "file") == 0)
+    return (kind == G_FILE_TYPE_REGULAR);
+  if (strcmp (type, "link") == 0 || strcmp (type, "symlink") == 0)
+    return (kind == G_FILE_TYPE_SYMBOLIC_LINK);
+
+  if (content_type == NULL)
+    return FALSE;
+
+  /* "image/png", also matching subclasses */
+  if (strchr (type, '/') != NULL)
+    return g_content_type_is_a (content_type, type);
+
+  /* "video", matching "video/mp4", "video/webm", ... */
+  length = strlen (type);
+  return (strncmp (content_type, type, length) == 0 && content_type[length] == '/');
+}
+
+
+
+/**
+ * thunar_list_model_search_predicates_match:
+ * @predicates   : predicates from thunar_list_model_parse_search_predicates().
+ * @kind         : the #GFileType of the file.
+ * @size         : the size of the file in bytes.
+ * @modified     : the modification time of the file.
+ * @content_type : the content type of the file or %NULL.
+ *
+ * Return value: TRUE if the file matches all @predicates, FALSE otherwise.
+ **/
+static gboolean
+thunar_list_model_search_predicates_match (GArray      *predicates,
+                                           GFileType    kind,
+                                           guint64      size,
+                                           guint64      modified,
+                                           const gchar *content_type)
+{
+  ThunarListModelSearchPredicate *predicate;
+  guint                           n;
+
+  for (n = 0; n < predicates->len; ++n)
+    {
+      predicate = &g_array_index (predicates, ThunarListModelSearchPredicate, n);
+      switch (predicate->key)
+        {
+        case THUNAR_LIST_MODEL_SEARCH_KEY_SIZE:
+          /* the size of a folder says nothing about its content */
+          if (kind == G_FILE_TYPE_DIRECTORY
+              || (gint64) size < predicate->min
+              || (gint64) size > predicate->max)
+            return FALSE;
+          break;
+
+        case THUNAR_LIST_MODEL_SEARCH_KEY_MODIFIED:
+          if ((gint64) modified < predicate->min || (gint64) modified > predicate->max)
+            return FALSE;
+          break;
+
+        case THUNAR_LIST_MODEL_SEARCH_KEY_TYPE:
+          if (!thunar_list_model_search_type_match (predicate->type, kind, content_type))
+            return FALSE;
+          break;
+        }
+    }
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_list_model_search_info_match (GArray    *predicates,
+                                     GFileInfo *info)
+{
+  /* all attributes were queried by the enumerator */
+  return thunar_list_model_search_predicates_match (predicates,
+                                                    g_file_info_get_file_type (info),
+                                                    g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_SIZE),
+                                                    g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+                                                    g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE));
+}
+
+
+
 static gboolean
 _thunar_job_search_directory (ThunarJob  *job,
                                GArray     *param_values,
@@ -2374,6 +4025,7 @@ _thunar_job_search_directory (ThunarJob  *job,
   ThunarFile                 *directory;
   const char                 *search_query_c;
   gchar                     **search_query_c_terms;
+  GArray                     *search_predicates;
   ThunarPreferences          *preferences;
   gboolean                    is_source_device_local;
   ThunarRecursiveSearchMode   mode;
@@ -2406,9 +4058,14 @@ _thunar_job_search_directory (ThunarJob  *job,
   if (mode == THUNAR_RECURSIVE_SEARCH_ALWAYS || (mode == THUNAR_RECURSIVE_SEARCH_LOCAL && is_source_device_local))
     search_type = THUNAR_LIST_MODEL_SEARCH_RECURSIVE;
 
-  thunar_list_model_search_folder (model, job, thunar_file_dup_uri (directory), search_query_c_terms, search_type, show_hidden);
+  /* structured terms are checked against the enumerated file infos */
+  search_predicates = thunar_list_model_parse_search_predicates (search_query_c_terms);
+
+  thunar_list_model_search_folder (model, job, thunar_file_dup_uri (directory), search_query_c_terms, search_predicates, search_type, show_hidden);
 
   g_strfreev (search_query_c_terms);
+  if (search_predicates != NULL)
+    g_array_unref (search_predicates);
 
   return TRUE;
 }
@@ -2470,8 +4127,7 @@ thunar_list_model_search_finished (ThunarJob       *job,
       store->update_search_results_timeout_id = 0;
     }
 
-  thunar_g_list_free_full (store->files_to_add);
-  store->files_to_add = NULL;
+  thunar_list_model_clear_search_files (store);
 
   g_signal_emit_by_name (store, "search-done");
 }
@@ -2483,6 +4139,7 @@ thunar_list_model_search_folder (ThunarListModel           *model,
                                  ThunarJob                 *job,
                                  gchar                     *uri,
                                  gchar                    **search_query_c_terms,
+                                 GArray                    *search_predicates,
                                  enum ThunarListModelSearch search_type,
                                  gboolean                   show_hidden)
 {
@@ -2490,6 +4147,8 @@ thunar_list_model_search_folder (ThunarListModel           *model,
   GFileEnumerator *enumerator;
   GFile           *directory;
   GList           *files_found = NULL; /* contains the matching files in this folder only */
+  guint            n_files_found = 0;
+  ThunarFile      *found;
   const gchar     *namespace;
   const gchar     *display_name;
   gchar           *display_name_c; /* converted to ignore case */
@@ -2504,6 +4163,18 @@ thunar_list_model_search_folder (ThunarListModel           *model,
               G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
               G_FILE_ATTRIBUTE_STANDARD_NAME ", recent::*";
 
+  /* predicates only need attributes the enumerator gets without extra I/O */
+  if (search_predicates != NULL)
+    namespace = G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                G_FILE_ATTRIBUTE_STANDARD_TARGET_URI ","
+                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP ","
+                G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
+                G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE ","
+                G_FILE_ATTRIBUTE_TIME_MODIFIED ", recent::*";
+
   /* The directory enumerator MUST NOT follow symlinks itself, meaning that any symlinks that
    * g_file_enumerator_next_file() emits are the actual symlink entries. This prevents one
    * possible source of infinitely deep recursion.
@@ -2512,10 +4183,16 @@ thunar_list_model_search_folder (ThunarListModel           *model,
    * which allows them to appear in the search results. */
   enumerator = g_file_enumerate_children (directory, namespace, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, cancellable, NULL);
   if (enumerator == NULL)
-    return;
+    {
+      g_atomic_int_inc (&model->search_n_skipped);
+      g_object_unref (directory);
+      return;
+    }
 
-  /* go through every file in the folder and check if it matches */
-  while (exo_job_is_cancelled (EXO_JOB (job)) == FALSE)
+  /* go through every file in the folder and check if it matches,
+   * until enough matches were found */
+  while (exo_job_is_cancelled (EXO_JOB (job)) == FALSE
+         && g_atomic_int_get (&model->search_truncated) == FALSE)
     {
       GFile     *file;
       GFileInfo *info;
@@ -2537,6 +4214,8 @@ thunar_list_model_search_folder (ThunarListModel           *model,
       else
         file = g_file_get_child (directory, g_file_info_get_name (info));
 
+      g_atomic_int_inc (&model->search_n_visited);
+
       /* respect last-show-hidden */
       if (show_hidden == FALSE)
         {
@@ -2554,7 +4233,15 @@ thunar_list_model_search_folder (ThunarListModel           *model,
       /* handle directories */
       if (type == G_FILE_TYPE_DIRECTORY && search_type == THUNAR_LIST_MODEL_SEARCH_RECURSIVE)
         {
-          thunar_list_model_search_folder (model, job, g_file_get_uri (file), search_query_c_terms, search_type, show_hidden);
+          thunar_list_model_search_folder (model, job, g_file_get_uri (file), search_query_c_terms, search_predicates, search_type, show_hidden);
+        }
+
+      /* filter on the predicates first, it is cheaper than normalizing the name */
+      if (search_predicates != NULL && !thunar_list_model_search_info_match (search_predicates, info))
+        {
+          g_object_unref (file);
+          g_object_unref (info);
+          continue;
         }
 
       /* prepare entry display name */
@@ -2562,8 +4249,23 @@ thunar_list_model_search_folder (ThunarListModel           *model,
       display_name_c = thunar_g_utf8_normalize_for_search (display_name, TRUE, TRUE);
 
       /* search for all substrings */
-      if (thunar_list_model_search_terms_match (search_query_c_terms, display_name_c))
-        files_found = g_list_prepend (files_found, thunar_file_get (file, NULL));
+      if (thunar_list_model_search_terms_match (search_query_c_terms, display_name_c)
+          && (found = thunar_file_get (file, NULL)) != NULL)
+        {
+          files_found = g_list_prepend (files_found, found);
+
+          /* stop the whole search once the result limit is reached */
+          if ((guint) g_atomic_int_add (&model->search_n_matched, 1) + 1 == model->search_limit)
+            g_atomic_int_set (&model->search_truncated, TRUE);
+
+          /* hand over the matches in chunks, so huge folders show up progressively */
+          if (++n_files_found == THUNAR_LIST_MODEL_SEARCH_CHUNK_SIZE)
+            {
+              thunar_list_model_push_search_files (model, job, files_found, n_files_found);
+              files_found = NULL;
+              n_files_found = 0;
+            }
+        }
 
       /* free memory */
       g_free (display_name_c);
@@ -2574,12 +4276,8 @@ thunar_list_model_search_folder (ThunarListModel           *model,
   g_object_unref (enumerator);
   g_object_unref (directory);
 
-  if (exo_job_is_cancelled (EXO_JOB (job)))
-    return;
-
-  g_mutex_lock (&model->mutex_files_to_add);
-  model->files_to_add = g_list_concat (model->files_to_add, files_found);
-  g_mutex_unlock (&model->mutex_files_to_add);
+  if (files_found != NULL)
+    thunar_list_model_push_search_files (model, job, files_found, n_files_found);
 }
 
 
@@ -2611,12 +4309,9 @@ thunar_list_model_set_folder (ThunarListModel *store,
                               ThunarFolder    *folder,
                               gchar           *search_query)
 {
-  GtkTreePath   *path;
   gboolean       has_handler;
   GList         *files;
-  GSequenceIter *row;
-  GSequenceIter *end;
-  GSequenceIter *next;
+  guint          n;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
   _thunar_return_if_fail (folder == NULL || THUNAR_IS_FOLDER (folder));
@@ -2631,35 +4326,41 @@ thunar_list_model_set_folder (ThunarListModel *store,
           g_source_remove (store->update_search_results_timeout_id);
           store->update_search_results_timeout_id = 0;
         }
-      thunar_g_list_free_full (store->files_to_add);
-      store->files_to_add = NULL;
+      thunar_list_model_clear_search_files (store);
 
       /* check if we have any handlers connected for "row-deleted" */
       has_handler = g_signal_has_handler_pending (G_OBJECT (store), store->row_deleted_id, 0, FALSE);
 
-      row = g_sequence_get_begin_iter (store->rows);
-      end = g_sequence_get_end_iter (store->rows);
+      /* all rows are going away */
+      thunar_list_model_search_index_drop (store);
 
-      /* remove existing entries */
-      path = gtk_tree_path_new_first ();
-      while (row != end)
+      /* remove existing entries, from the back so the
+       * remaining rows never have to be moved around
+       */
+      if (G_LIKELY (has_handler))
         {
-          /* remove the row from the list */
-          next = g_sequence_iter_next (row);
-          g_sequence_remove (row);
-          row = next;
+          while (store->rows->len > 0)
+            thunar_list_model_remove_row (store, store->rows->len - 1);
+        }
+      else
+        {
+          for (n = 0; n < store->rows->len; ++n)
+            thunar_list_model_row_free (store, THUNAR_LIST_MODEL_ROW (store, n));
+          g_ptr_array_set_size (store->rows, 0);
+        }
+      store->rows_valid = 0;
 
-          /* notify the view(s) if they're actually
-           * interested in the "row-deleted" signal.
-           */
-          if (G_LIKELY (has_handler))
-            gtk_tree_model_row_deleted (GTK_TREE_MODEL (store), path);
+      /* stop loading the files of entries */
+      if (store->load_cancellable != NULL)
+        {
+          g_cancellable_cancel (store->load_cancellable);
+          g_clear_object (&store->load_cancellable);
         }
-      gtk_tree_path_free (path);
+      store->n_loading = 0;
+      store->visible_last = -1;
 
       /* remove hidden entries */
-      g_slist_free_full (store->hidden, g_object_unref);
-      store->hidden = NULL;
+      g_hash_table_remove_all (store->hidden);
 
       /* unregister signals and drop the reference */
       g_signal_handlers_disconnect_matched (G_OBJECT (store->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, store);
@@ -2667,7 +4368,9 @@ thunar_list_model_set_folder (ThunarListModel *store,
     }
 
   /* ... just to be sure! */
-  _thunar_assert (g_sequence_get_length (store->rows) == 0);
+  _thunar_assert (store->rows->len == 0);
+  _thunar_assert (g_hash_table_size (store->row_for_file) == 0);
+  _thunar_assert (g_hash_table_size (store->row_for_entry) == 0);
 
 #ifndef NDEBUG
   /* new stamp since the model changed */
@@ -2697,16 +4400,30 @@ thunar_list_model_set_folder (ThunarListModel *store,
               g_strfreev (store->search_terms);
               store->search_terms = NULL;
             }
+          g_clear_pointer (&store->search_predicates, g_array_unref);
         }
       else
         {
-          gchar *search_query_c;  /* normalized */
+          ThunarPreferences *preferences;
+          gchar             *search_query_c;  /* normalized */
 
           search_query_c = thunar_g_utf8_normalize_for_search (search_query, TRUE, TRUE);
           g_strfreev (store->search_terms);
+          g_clear_pointer (&store->search_predicates, g_array_unref);
           store->search_terms = thunar_list_model_split_search_query (search_query_c, NULL);
           if (store->search_terms != NULL)
             {
+              store->search_predicates = thunar_list_model_parse_search_predicates (store->search_terms);
+
+              /* reset the statistics of the previous search */
+              preferences = thunar_preferences_get ();
+              g_object_get (G_OBJECT (preferences), "misc-search-result-limit", &store->search_limit, NULL);
+              g_object_unref (preferences);
+              store->search_n_visited = 0;
+              store->search_n_matched = 0;
+              store->search_n_skipped = 0;
+              store->search_truncated = FALSE;
+
               /* search the current folder
                * start a new recursive_search_job */
               store->recursive_search_job = thunar_list_model_job_search_directory (store, search_query_c, thunar_folder_get_corresponding_file (folder));
@@ -2722,15 +4439,32 @@ thunar_list_model_set_folder (ThunarListModel *store,
           files = NULL;
         }
 
+      /* large folders are sorted by name only */
+      thunar_list_model_update_virtual (store);
+
       /* insert the files */
       if (files != NULL)
         thunar_list_model_insert_files (store, files);
 
+      /* and the entries of a virtual folder */
+      if (store->sort_virtual)
+        {
+          files = thunar_folder_get_entries (folder);
+          thunar_list_model_entries_added (folder, files, store);
+          g_list_free (files);
+        }
+
       /* connect signals to the new folder */
       g_signal_connect (G_OBJECT (store->folder), "destroy", G_CALLBACK (thunar_list_model_folder_destroy), store);
       g_signal_connect (G_OBJECT (store->folder), "error", G_CALLBACK (thunar_list_model_folder_error), store);
       g_signal_connect (G_OBJECT (store->folder), "files-added", G_CALLBACK (thunar_list_model_files_added), store);
       g_signal_connect (G_OBJECT (store->folder), "files-removed", G_CALLBACK (thunar_list_model_files_removed), store);
+      g_signal_connect (G_OBJECT (store->folder), "entries-added", G_CALLBACK (thunar_list_model_entries_added), store);
+      g_signal_connect (G_OBJECT (store->folder), "entries-removed", G_CALLBACK (thunar_list_model_entries_removed), store);
+    }
+  else
+    {
+      thunar_list_model_update_virtual (store);
     }
 
   /* notify listeners that we have a new folder */
@@ -2788,6 +4522,137 @@ thunar_list_model_set_folders_first (ThunarListModel *store,
 
 
 
+/**
+ * thunar_list_model_set_frame_clock:
+ * @store       : a #ThunarListModel.
+ * @frame_clock : the #GdkFrameClock of the view showing @store, or %NULL.
+ *
+ * Changed files are announced to the view in the update phase of
+ * @frame_clock, so each frame sees all changes since the previous
+ * one at once. Without a frame clock, e.g. while the view is not
+ * realized, they are announced from an idle source.
+ **/
+void
+thunar_list_model_set_frame_clock (ThunarListModel *store,
+                                   GdkFrameClock   *frame_clock)
+{
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+  _thunar_return_if_fail (frame_clock == NULL || GDK_IS_FRAME_CLOCK (frame_clock));
+
+  if (store->frame_clock == frame_clock)
+    return;
+
+  if (store->frame_clock != NULL)
+    {
+      g_signal_handler_disconnect (G_OBJECT (store->frame_clock), store->frame_clock_update_id);
+      g_object_unref (G_OBJECT (store->frame_clock));
+      store->frame_clock_update_id = 0;
+    }
+
+  store->frame_clock = frame_clock;
+
+  if (frame_clock != NULL)
+    {
+      g_object_ref (G_OBJECT (frame_clock));
+      store->frame_clock_update_id = g_signal_connect (G_OBJECT (frame_clock), "update",
+                                                       G_CALLBACK (thunar_list_model_frame_clock_update), store);
+
+      /* pending changes wait for the next frame now */
+      if (store->changed_rows_idle_id != 0)
+        {
+          g_source_remove (store->changed_rows_idle_id);
+          store->changed_rows_idle_id = 0;
+        }
+    }
+
+  if (g_hash_table_size (store->changed_rows) > 0)
+    thunar_list_model_queue_changed_rows (store);
+}
+
+
+
+/**
+ * thunar_list_model_set_visible_range:
+ * @store      : a #ThunarListModel.
+ * @start_path : the first row shown in the view, or %NULL.
+ * @end_path   : the last row shown in the view, or %NULL.
+ *
+ * The files of the rows of a very large folder are loaded when
+ * they are first shown, and unloaded when too many are loaded.
+ * The files of the rows between @start_path and @end_path are
+ * kept loaded.
+ **/
+void
+thunar_list_model_set_visible_range (ThunarListModel *store,
+                                     GtkTreePath     *start_path,
+                                     GtkTreePath     *end_path)
+{
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+
+  if (start_path != NULL && end_path != NULL
+      && gtk_tree_path_get_depth (start_path) > 0
+      && gtk_tree_path_get_depth (end_path) > 0)
+    {
+      store->visible_first = gtk_tree_path_get_indices (start_path)[0];
+      store->visible_last = gtk_tree_path_get_indices (end_path)[0];
+    }
+  else
+    {
+      store->visible_first = 0;
+      store->visible_last = -1;
+    }
+}
+
+
+
+/**
+ * thunar_list_model_set_pinned_paths:
+ * @store : a #ThunarListModel.
+ * @paths : a #GList of #GtkTreePath<!---->s.
+ *
+ * Keeps the files of the rows at @paths, usually the selected
+ * ones, loaded until the next call, even in very large folders.
+ * Only the first rows are pinned and loaded in the background,
+ * up to %THUNAR_LIST_MODEL_MAX_PINNED_ROWS.
+ **/
+void
+thunar_list_model_set_pinned_paths (ThunarListModel *store,
+                                    GList           *paths)
+{
+  ThunarListModelRow *row;
+  GList              *lp;
+  gint                index;
+  guint               n;
+
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+
+  for (n = 0; n < store->pinned_rows->len; ++n)
+    ((ThunarListModelRow *) g_ptr_array_index (store->pinned_rows, n))->pinned = FALSE;
+  g_ptr_array_set_size (store->pinned_rows, 0);
+
+  for (lp = paths; lp != NULL && store->pinned_rows->len < THUNAR_LIST_MODEL_MAX_PINNED_ROWS; lp = lp->next)
+    {
+      if (gtk_tree_path_get_depth (lp->data) < 1)
+        continue;
+
+      index = gtk_tree_path_get_indices (lp->data)[0];
+      if (index < 0 || (guint) index >= store->rows->len)
+        continue;
+
+      row = THUNAR_LIST_MODEL_ROW (store, index);
+      if (!row->pinned)
+        {
+          row->pinned = TRUE;
+          g_ptr_array_add (store->pinned_rows, row);
+
+          /* start loading the file, the row changes once it is loaded */
+          thunar_list_model_row_peek_file (store, row);
+        }
+    }
+}
+
+
+
 /**
  * thunar_list_model_get_show_hidden:
  * @store : a #ThunarListModel.
@@ -2812,13 +4677,12 @@ void
 thunar_list_model_set_show_hidden (ThunarListModel *store,
                                    gboolean         show_hidden)
 {
-  GtkTreePath   *path;
-  GtkTreeIter    iter;
-  ThunarFile    *file;
-  GSList        *lp;
-  GSequenceIter *row;
-  GSequenceIter *next;
-  GSequenceIter *end;
+  ThunarListModelRow *row;
+  GPtrArray          *batch = NULL;
+  GList              *files;
+  GList              *lp;
+  gboolean            has_handler;
+  guint               n;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
 
@@ -2828,58 +4692,88 @@ thunar_list_model_set_show_hidden (ThunarListModel *store,
 
   store->show_hidden = show_hidden;
 
+  /* views detach from the model while toggling, so most of the
+   * time there is nobody to notify about the single rows */
   if (store->show_hidden)
     {
-      for (lp = store->hidden; lp != NULL; lp = lp->next)
+      has_handler = g_signal_has_handler_pending (G_OBJECT (store), store->row_inserted_id, 0, FALSE);
+      if (G_LIKELY (!has_handler))
+        batch = g_ptr_array_sized_new (g_hash_table_size (store->hidden));
+
+      /* the set owns the references, which are passed on to the rows */
+      files = g_hash_table_get_keys (store->hidden);
+      g_hash_table_steal_all (store->hidden);
+      for (lp = files; lp != NULL; lp = lp->next)
         {
-          file = THUNAR_FILE (lp->data);
+          row = thunar_list_model_row_new (store, THUNAR_FILE (lp->data));
+          if (G_LIKELY (batch != NULL))
+            g_ptr_array_add (batch, row);
+          else
+            thunar_list_model_insert_row (store, row);
+        }
+      g_list_free (files);
 
-          /* insert file in the sorted position */
-          row = g_sequence_insert_sorted (store->rows, file,
-                                          thunar_list_model_cmp_func, store);
+      /* hidden entries of a virtual folder are not kept in the set */
+      if (store->sort_virtual)
+        {
+          files = thunar_folder_get_entries (store->folder);
+          for (lp = files; lp != NULL; lp = lp->next)
+            {
+              if (!((ThunarFolderEntry *) lp->data)->is_hidden)
+                continue;
 
-          GTK_TREE_ITER_INIT (iter, store->stamp, row);
+              row = thunar_list_model_row_new_for_entry (store, lp->data);
+              if (G_LIKELY (batch != NULL))
+                g_ptr_array_add (batch, row);
+              else
+                thunar_list_model_insert_row (store, row);
+            }
+          g_list_free (files);
+        }
 
-          /* tell the view about the new row */
-          path = gtk_tree_path_new_from_indices (g_sequence_iter_get_position (row), -1);
-          gtk_tree_model_row_inserted (GTK_TREE_MODEL (store), path, &iter);
-          gtk_tree_path_free (path);
+      /* merge the sorted hidden files into the rows in a single pass */
+      if (G_LIKELY (batch != NULL))
+        {
+          thunar_list_model_search_index_drop (store);
+          thunar_list_model_merge_rows (store, batch);
+          g_ptr_array_free (batch, TRUE);
         }
-      g_slist_free (store->hidden);
-      store->hidden = NULL;
     }
   else
     {
-      _thunar_assert (store->hidden == NULL);
+      _thunar_assert (g_hash_table_size (store->hidden) == 0);
 
-      /* remove all hidden files */
-      row = g_sequence_get_begin_iter (store->rows);
-      end = g_sequence_get_end_iter (store->rows);
+      has_handler = g_signal_has_handler_pending (G_OBJECT (store), store->row_deleted_id, 0, FALSE);
 
-      while (row != end)
+      /* remove all hidden files */
+      for (n = 0; n < store->rows->len;)
         {
-          next = g_sequence_iter_next (row);
-
-          file = g_sequence_get (row);
-          if (thunar_file_is_hidden (file))
+          row = THUNAR_LIST_MODEL_ROW (store, n);
+          if (row->entry != NULL ? !row->entry->is_hidden : !thunar_file_is_hidden (row->file))
             {
-              /* store file in the list */
-              store->hidden = g_slist_prepend (store->hidden, g_object_ref (file));
-
-              /* setup path for "row-deleted" */
-              path = gtk_tree_path_new_from_indices (g_sequence_iter_get_position (row), -1);
+              n++;
+              continue;
+            }
 
-              /* remove file from the model */
-              g_sequence_remove (row);
+          /* store file in the set, entries stay in the folder */
+          if (row->entry == NULL)
+            g_hash_table_add (store->hidden, g_object_ref (row->file));
 
-              /* notify the view(s) */
-              gtk_tree_model_row_deleted (GTK_TREE_MODEL (store), path);
-              gtk_tree_path_free (path);
+          /* remove the row right away if the view(s) need to
+           * be notified, otherwise drop them all in one go */
+          if (G_UNLIKELY (has_handler))
+            {
+              thunar_list_model_remove_row (store, n);
+            }
+          else
+            {
+              row->index = -1;
+              n++;
             }
-
-          row = next;
-          _thunar_assert (end == g_sequence_get_end_iter (store->rows));
         }
+
+      if (G_LIKELY (!has_handler))
+        thunar_list_model_remove_marked_rows (store);
     }
 
   /* notify listeners about the new setting */
@@ -3002,16 +4896,46 @@ thunar_list_model_set_folder_item_count (ThunarListModel         *store,
  * the returned object using #g_object_unref() when
  * you are done with it.
  *
- * Return value: the #ThunarFile.
+ * In virtual folders, the files of the rows are loaded in the
+ * background, so %NULL is returned until the row changed.
+ *
+ * Return value: the #ThunarFile or %NULL.
  **/
 ThunarFile*
 thunar_list_model_get_file (ThunarListModel *store,
                             GtkTreeIter     *iter)
+{
+  ThunarFile *file;
+
+  _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
+  _thunar_return_val_if_fail (iter->stamp == store->stamp, NULL);
+
+  file = thunar_list_model_row_peek_file (store, iter->user_data);
+  return (file != NULL) ? g_object_ref (file) : NULL;
+}
+
+
+
+/**
+ * thunar_list_model_get_location:
+ * @store : a #ThunarListModel.
+ * @iter  : a valid #GtkTreeIter for @store.
+ *
+ * Returns the location of the row referred to by @iter,
+ * which is known even if the file is not loaded yet. Free
+ * the returned object using #g_object_unref() when
+ * you are done with it.
+ *
+ * Return value: the #GFile of the row.
+ **/
+GFile*
+thunar_list_model_get_location (ThunarListModel *store,
+                                GtkTreeIter     *iter)
 {
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
   _thunar_return_val_if_fail (iter->stamp == store->stamp, NULL);
 
-  return g_object_ref (g_sequence_get (iter->user_data));
+  return thunar_list_model_row_get_location (store, iter->user_data);
 }
 
 
@@ -3029,7 +4953,7 @@ static gint
 thunar_list_model_get_num_files (ThunarListModel *store)
 {
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), 0);
-  return g_sequence_get_length (store->rows);
+  return store->rows->len;
 }
 
 
@@ -3056,27 +4980,29 @@ GList*
 thunar_list_model_get_paths_for_files (ThunarListModel *store,
                                        GList           *files)
 {
-  GList         *paths = NULL;
-  GSequenceIter *row;
-  GSequenceIter *end;
-  gint           i = 0;
+  ThunarListModelRow *row;
+  ThunarFolderEntry  *entry;
+  GList              *paths = NULL;
+  GList              *lp;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
 
-  row = g_sequence_get_begin_iter (store->rows);
-  end = g_sequence_get_end_iter (store->rows);
-
   /* find the rows for the given files */
-  while (row != end)
+  for (lp = files; lp != NULL; lp = lp->next)
     {
-      if (g_list_find (files, g_sequence_get (row)) != NULL)
+      row = g_hash_table_lookup (store->row_for_file, lp->data);
+
+      /* entries of virtual folders are found by name */
+      if (row == NULL && store->sort_virtual
+          && g_file_has_parent (thunar_file_get_file (lp->data), thunar_file_get_file (thunar_folder_get_corresponding_file (store->folder))))
         {
-          _thunar_assert (i == g_sequence_iter_get_position (row));
-          paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (i, -1));
+          entry = thunar_folder_lookup_entry (store->folder, thunar_file_get_basename (lp->data));
+          if (entry != NULL)
+            row = g_hash_table_lookup (store->row_for_entry, entry);
         }
 
-      row = g_sequence_iter_next (row);
-      i++;
+      if (row != NULL)
+        paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (thunar_list_model_row_get_index (store, row), -1));
     }
 
   return paths;
@@ -3107,16 +5033,14 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
                                          gboolean         case_sensitive,
                                          gboolean         match_diacritics)
 {
-  GPatternSpec  *pspec;
-  gchar         *normalized_pattern;
-  GList         *paths = NULL;
-  GSequenceIter *row;
-  GSequenceIter *end;
-  ThunarFile    *file;
-  const gchar   *display_name;
-  gchar         *normalized_display_name;
-  gboolean       name_matched;
-  gint           i = 0;
+  ThunarListModelRow *row;
+  GPatternSpec       *pspec;
+  gchar              *normalized_pattern;
+  GList              *paths = NULL;
+  const gchar        *display_name;
+  gchar              *normalized_display_name;
+  gboolean            name_matched;
+  guint               i;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
   _thunar_return_val_if_fail (g_utf8_validate (pattern, -1, NULL), NULL);
@@ -3126,27 +5050,18 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
   pspec = g_pattern_spec_new (normalized_pattern);
   g_free (normalized_pattern);
 
-  row = g_sequence_get_begin_iter (store->rows);
-  end = g_sequence_get_end_iter (store->rows);
-
   /* find all rows that match the given pattern */
-  while (row != end)
+  for (i = 0; i < store->rows->len; ++i)
     {
-      file = g_sequence_get (row);
-      display_name = thunar_file_get_display_name (file);
+      row = THUNAR_LIST_MODEL_ROW (store, i);
+      display_name = (row->entry != NULL) ? row->entry->display_name : thunar_file_get_display_name (row->file);
 
       normalized_display_name = thunar_g_utf8_normalize_for_search (display_name, !match_diacritics, !case_sensitive);
       name_matched = g_pattern_match_string (pspec, normalized_display_name);
       g_free (normalized_display_name);
 
       if (name_matched)
-        {
-          _thunar_assert (i == g_sequence_iter_get_position (row));
-          paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (i, -1));
-        }
-
-      row = g_sequence_iter_next (row);
-      i++;
+        paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (i, -1));
     }
 
   /* release the pattern */
@@ -3157,6 +5072,73 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
 
 
 
+/**
+ * thunar_list_model_search_equal:
+ * @model     : a #ThunarListModel.
+ * @column    : the search column, ignored since the name is used.
+ * @key       : the type-ahead text entered by the user.
+ * @iter      : a valid #GtkTreeIter for @model.
+ * @user_data : unused.
+ *
+ * Type-ahead comparison function for the views, which can be passed
+ * to gtk_tree_view_set_search_equal_func() and
+ * exo_icon_view_set_search_equal_func().
+ *
+ * The rows matching @key are looked up once per @key in an index of
+ * the casefolded names, so the views can walk the rows without
+ * comparing each name.
+ *
+ * Return value: %FALSE if the name of @iter starts with @key, %TRUE
+ *               otherwise, as expected by the views.
+ **/
+gboolean
+thunar_list_model_search_equal (GtkTreeModel *model,
+                                gint          column,
+                                const gchar  *key,
+                                GtkTreeIter  *iter,
+                                gpointer      user_data)
+{
+  ThunarListModel *store = THUNAR_LIST_MODEL (model);
+  gchar           *prefix;
+  gsize            length;
+  guint            position;
+
+  _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (model), TRUE);
+  _thunar_return_val_if_fail (iter->stamp == store->stamp, TRUE);
+  _thunar_return_val_if_fail (key != NULL, TRUE);
+
+  /* look up the range of matching rows, once for every new key */
+  if (!store->search_range_valid || g_strcmp0 (store->search_text, key) != 0)
+    {
+      thunar_list_model_search_index_build (store);
+
+      g_free (store->search_text);
+      store->search_text = g_strdup (key);
+
+      prefix = thunar_g_utf8_normalize_for_search (key, FALSE, TRUE);
+      if (G_LIKELY (prefix != NULL))
+        {
+          length = strlen (prefix);
+          store->search_lower = thunar_list_model_search_index_bound (store, prefix, length, FALSE);
+          store->search_upper = thunar_list_model_search_index_bound (store, prefix, length, TRUE);
+          g_free (prefix);
+        }
+      else
+        {
+          store->search_lower = store->search_upper = 0;
+        }
+      store->search_range_valid = TRUE;
+    }
+
+  if (store->search_lower == store->search_upper)
+    return TRUE;
+
+  position = thunar_list_model_row_get_search_pos (store, iter->user_data);
+  return (position < store->search_lower || position >= store->search_upper);
+}
+
+
+
 /**
  * thunar_list_model_get_statusbar_text_for_files:
  * @files                        : list of files for which a text is requested
@@ -3270,6 +5252,99 @@ thunar_list_model_get_statusbar_text_for_files (ThunarListModel *store,
 
 
 
+/**
+ * thunar_list_model_get_statusbar_text_for_rows:
+ * @store : a #ThunarListModel instance.
+ * @paths : the #GtkTreePath<!---->s of the rows, or %NULL for all rows.
+ *
+ * Generates the statusbar text for rows of a virtual folder,
+ * which only counts the folders and files.
+ *
+ * The caller is reponsible to free the returned text using
+ * g_free() when it's no longer needed.
+ *
+ * Return value: the statusbar text for @store.
+ **/
+static gchar*
+thunar_list_model_get_statusbar_text_for_rows (ThunarListModel *store,
+                                               GList           *paths)
+{
+  GList *text_list = NULL;
+  GList *lp;
+  gchar *text;
+  gint   folder_count = 0;
+  gint   non_folder_count = 0;
+  gint   index;
+  guint  n;
+
+  if (paths == NULL)
+    {
+      for (n = 0; n < store->rows->len; ++n)
+        {
+          if (THUNAR_LIST_MODEL_ROW (store, n)->is_directory)
+            folder_count++;
+          else
+            non_folder_count++;
+        }
+    }
+
+  for (lp = paths; lp != NULL; lp = lp->next)
+    {
+      index = gtk_tree_path_get_indices (lp->data)[0];
+      if (index < 0 || (guint) index >= store->rows->len)
+        continue;
+
+      if (THUNAR_LIST_MODEL_ROW (store, index)->is_directory)
+        folder_count++;
+      else
+        non_folder_count++;
+    }
+
+  if (folder_count > 0)
+    text_list = g_list_append (text_list, g_strdup_printf (ngettext ("%d folder", "%d folders", folder_count), folder_count));
+  if (non_folder_count > 0)
+    text_list = g_list_append (text_list, g_strdup_printf (ngettext ("%d file", "%d files", non_folder_count), non_folder_count));
+  if (text_list == NULL)
+    text_list = g_list_append (text_list, g_strdup_printf (_("0 items")));
+
+  text = thunar_util_strjoin_list (text_list, "  |  ");
+  g_list_free_full (text_list, g_free);
+  return text;
+}
+
+
+
+static GList*
+thunar_list_model_get_search_statistics (ThunarListModel *store)
+{
+  GList *text_list = NULL;
+  guint  n_visited;
+  guint  n_matched;
+  guint  n_skipped;
+
+  n_visited = g_atomic_int_get (&store->search_n_visited);
+  n_matched = g_atomic_int_get (&store->search_n_matched);
+  n_skipped = g_atomic_int_get (&store->search_n_skipped);
+
+  text_list = g_list_append (text_list, g_strdup_printf (ngettext ("%u item searched", "%u items searched", n_visited), n_visited));
+  text_list = g_list_append (text_list, g_strdup_printf (ngettext ("%u match", "%u matches", n_matched), n_matched));
+
+  if (n_skipped > 0)
+    text_list = g_list_append (text_list, g_strdup_printf (ngettext ("%u folder skipped", "%u folders skipped", n_skipped), n_skipped));
+
+  if (g_atomic_int_get (&store->search_truncated))
+    {
+      text_list = g_list_append (text_list, g_strdup_printf (ngettext ("Showing the first %u match, more results available",
+                                                                       "Showing the first %u matches, more results available",
+                                                                       store->search_limit),
+                                                             store->search_limit));
+    }
+
+  return text_list;
+}
+
+
+
 /**
  * thunar_list_model_get_statusbar_text:
  * @store          : a #ThunarListModel instance.
@@ -3293,25 +5368,25 @@ gchar*
 thunar_list_model_get_statusbar_text (ThunarListModel *store,
                                       GList           *selected_items)
 {
-  const gchar       *content_type;
-  const gchar       *original_path;
-  GtkTreeIter        iter;
-  ThunarFile        *file;
-  guint64            size;
-  GList             *lp;
-  GList             *text_list      = NULL;
-  gchar             *temp_string    = NULL;
-  gchar             *text           = "";
-  gint               height;
-  gint               width;
-  GSequenceIter     *row;
-  GSequenceIter     *end;
-  ThunarPreferences *preferences;
-  gboolean           show_image_size;
-  gboolean           show_file_size_binary_format;
-  GList             *relevant_files = NULL;
-  guint              active;
-  gboolean           show_size, show_size_in_bytes, show_filetype, show_display_name, show_last_modified;
+  const gchar        *content_type;
+  const gchar        *original_path;
+  GtkTreeIter         iter;
+  ThunarListModelRow *row;
+  ThunarFile         *file;
+  guint64             size;
+  GList              *lp;
+  GList              *text_list      = NULL;
+  gchar              *temp_string    = NULL;
+  gchar              *text           = "";
+  gint                height;
+  gint                width;
+  guint               n;
+  ThunarPreferences  *preferences;
+  gboolean            show_image_size;
+  gboolean            show_file_size_binary_format;
+  GList              *relevant_files = NULL;
+  guint               active;
+  gboolean            show_size, show_size_in_bytes, show_filetype, show_display_name, show_last_modified;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
 
@@ -3326,16 +5401,29 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
 
   if (selected_items == NULL) /* nothing selected */
     {
-      /* build a GList of all files */
-      end = g_sequence_get_end_iter (store->rows);
-      for (row = g_sequence_get_begin_iter (store->rows); row != end; row = g_sequence_iter_next (row))
+      /* try to determine a file for the current folder */
+      file = (store->folder != NULL) ? thunar_folder_get_corresponding_file (store->folder) : NULL;
+
+      if (G_UNLIKELY (store->sort_virtual))
         {
-          relevant_files = g_list_append (relevant_files, g_sequence_get (row));
+          /* only count the rows, summing up sizes would load every file */
+          temp_string = thunar_list_model_get_statusbar_text_for_rows (store, NULL);
+
+          /* the chosen sort column only applies once the folder gets smaller */
+          if (store->sort_func != thunar_file_compare_by_name)
+            {
+              text_list = g_list_append (text_list, temp_string);
+              temp_string = g_strdup (_("Sorted by name, the folder is too large for other sort orders"));
+            }
         }
+      else
+        {
+          /* build a GList of all files */
+          for (n = store->rows->len; n > 0; --n)
+            relevant_files = g_list_prepend (relevant_files, THUNAR_LIST_MODEL_ROW (store, n - 1)->file);
 
-      /* try to determine a file for the current folder */
-      file = (store->folder != NULL) ? thunar_folder_get_corresponding_file (store->folder) : NULL;
-      temp_string = thunar_list_model_get_statusbar_text_for_files (store, relevant_files, show_file_size_binary_format);
+          temp_string = thunar_list_model_get_statusbar_text_for_files (store, relevant_files, show_file_size_binary_format);
+        }
       text_list = g_list_append (text_list, temp_string);
 
       /* check if we can determine the amount of free space for the volume */
@@ -3348,6 +5436,10 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
           g_free (size_string);
         }
 
+      /* progress of the running or finished search */
+      if (store->search_terms != NULL)
+        text_list = g_list_concat (text_list, thunar_list_model_get_search_statistics (store));
+
       g_list_free (relevant_files);
     }
   else if (selected_items->next == NULL) /* only one item selected */
@@ -3355,101 +5447,120 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
       /* resolve the iter for the single path */
       gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, selected_items->data);
 
-      /* get the file for the given iter */
-      file = g_sequence_get (iter.user_data);
-
-      /* determine the content type of the file */
-      content_type = thunar_file_get_content_type (file);
-
-      if (show_display_name == TRUE)
+      /* get the file for the given iter, without waiting for it */
+      row = iter.user_data;
+      file = thunar_list_model_row_lookup_file (store, row);
+      if (G_UNLIKELY (file == NULL))
         {
-          temp_string = g_strdup_printf (_("\"%s\""), thunar_file_get_display_name (file));
+          /* the selection reloads the text once the file is loaded */
+          temp_string = g_strdup_printf (_("\"%s\""), row->entry->display_name);
           text_list = g_list_append (text_list, temp_string);
         }
-
-      if (thunar_file_is_regular (file) || G_UNLIKELY (thunar_file_is_symlink (file)))
+      else
         {
-          if (show_size == TRUE)
+          /* determine the content type of the file */
+          content_type = thunar_file_get_content_type (file);
+
+          if (show_display_name == TRUE)
             {
-              if (show_size_in_bytes == TRUE)
-                temp_string = thunar_file_get_size_string_long (file, show_file_size_binary_format);
-              else
-                temp_string = thunar_file_get_size_string_formatted (file, show_file_size_binary_format);
+              temp_string = g_strdup_printf (_("\"%s\""), thunar_file_get_display_name (file));
               text_list = g_list_append (text_list, temp_string);
             }
-        }
 
-      if (show_filetype == TRUE)
-        {
-          if (G_UNLIKELY (content_type != NULL && g_str_equal (content_type, "inode/symlink")))
-            temp_string = g_strdup (_("broken link"));
-          else if (G_UNLIKELY (thunar_file_is_symlink (file)))
-            temp_string = g_strdup_printf (_("link to %s"), thunar_file_get_symlink_target (file));
-          else if (G_UNLIKELY (thunar_file_get_kind (file) == G_FILE_TYPE_SHORTCUT))
-            temp_string = g_strdup (_("shortcut"));
-          else if (G_UNLIKELY (thunar_file_get_kind (file) == G_FILE_TYPE_MOUNTABLE))
-            temp_string = g_strdup (_("mountable"));
-          else
+          if (thunar_file_is_regular (file) || G_UNLIKELY (thunar_file_is_symlink (file)))
+            {
+              if (show_size == TRUE)
+                {
+                  if (show_size_in_bytes == TRUE)
+                    temp_string = thunar_file_get_size_string_long (file, show_file_size_binary_format);
+                  else
+                    temp_string = thunar_file_get_size_string_formatted (file, show_file_size_binary_format);
+                  text_list = g_list_append (text_list, temp_string);
+                }
+            }
+
+          if (show_filetype == TRUE)
             {
-              gchar *description = g_content_type_get_description (content_type);
-              temp_string = g_strdup_printf (_("%s"), description);
-              g_free (description);
+              if (G_UNLIKELY (content_type != NULL && g_str_equal (content_type, "inode/symlink")))
+                temp_string = g_strdup (_("broken link"));
+              else if (G_UNLIKELY (thunar_file_is_symlink (file)))
+                temp_string = g_strdup_printf (_("link to %s"), thunar_file_get_symlink_target (file));
+              else if (G_UNLIKELY (thunar_file_get_kind (file) == G_FILE_TYPE_SHORTCUT))
+                temp_string = g_strdup (_("shortcut"));
+              else if (G_UNLIKELY (thunar_file_get_kind (file) == G_FILE_TYPE_MOUNTABLE))
+                temp_string = g_strdup (_("mountable"));
+              else
+                {
+                  gchar *description = g_content_type_get_description (content_type);
+                  temp_string = g_strdup_printf (_("%s"), description);
+                  g_free (description);
+                }
+              text_list = g_list_append (text_list, temp_string);
             }
-          text_list = g_list_append (text_list, temp_string);
-        }
 
-      /* append the original path (if any) */
-      original_path = thunar_file_get_original_path (file);
-      if (G_UNLIKELY (original_path != NULL))
-        {
-          /* append the original path to the statusbar text */
-          gchar *original_path_string = g_filename_display_name (original_path);
-          temp_string = g_strdup_printf ("%s %s", _("Original Path:"), original_path_string);
-          text_list = g_list_append (text_list, temp_string);
-          g_free (original_path_string);
-        }
-      else if (thunar_file_is_local (file)
-               && thunar_file_is_regular (file)
-               && g_str_has_prefix (content_type, "image/")) /* bug #2913 */
-        {
-          /* check if the size should be visible in the statusbar, disabled by
-           * default to avoid high i/o  */
-          g_object_get (preferences, "misc-image-size-in-statusbar", &show_image_size, NULL);
-          if (show_image_size)
+          /* append the original path (if any) */
+          original_path = thunar_file_get_original_path (file);
+          if (G_UNLIKELY (original_path != NULL))
+            {
+              /* append the original path to the statusbar text */
+              gchar *original_path_string = g_filename_display_name (original_path);
+              temp_string = g_strdup_printf ("%s %s", _("Original Path:"), original_path_string);
+              text_list = g_list_append (text_list, temp_string);
+              g_free (original_path_string);
+            }
+          else if (thunar_file_is_local (file)
+                   && thunar_file_is_regular (file)
+                   && g_str_has_prefix (content_type, "image/")) /* bug #2913 */
             {
-              /* check if we can determine the dimension of this file (only for image files) */
-              gchar *file_path = g_file_get_path (thunar_file_get_file (file));
-              if (file_path != NULL && gdk_pixbuf_get_file_info (file_path, &width, &height) != NULL)
+              /* check if the size should be visible in the statusbar, disabled by
+               * default to avoid high i/o  */
+              g_object_get (preferences, "misc-image-size-in-statusbar", &show_image_size, NULL);
+              if (show_image_size)
                 {
-                  /* append the image dimensions to the statusbar text */
-                  temp_string = g_strdup_printf ("%s %dx%d", _("Image Size:"), width, height);
-                  text_list = g_list_append (text_list, temp_string);
+                  /* check if we can determine the dimension of this file (only for image files) */
+                  gchar *file_path = g_file_get_path (thunar_file_get_file (file));
+                  if (file_path != NULL && gdk_pixbuf_get_file_info (file_path, &width, &height) != NULL)
+                    {
+                      /* append the image dimensions to the statusbar text */
+                      temp_string = g_strdup_printf ("%s %dx%d", _("Image Size:"), width, height);
+                      text_list = g_list_append (text_list, temp_string);
+                    }
+                  g_free (file_path);
                 }
-              g_free (file_path);
             }
-        }
 
-      if (show_last_modified)
-        {
-          gchar *date_string = thunar_file_get_date_string (file, THUNAR_FILE_DATE_MODIFIED, store->date_style, store->date_custom_style);
-          temp_string = g_strdup_printf (_("Last Modified: %s"), date_string);
-          text_list = g_list_append (text_list, temp_string);
-          g_free (date_string);
+          if (show_last_modified)
+            {
+              gchar *date_string = thunar_file_get_date_string (file, THUNAR_FILE_DATE_MODIFIED, store->date_style, store->date_custom_style);
+              temp_string = g_strdup_printf (_("Last Modified: %s"), date_string);
+              text_list = g_list_append (text_list, temp_string);
+              g_free (date_string);
+            }
         }
     }
   else /* more than one item selected */
     {
       gchar *selected_string;
-      /* build GList of files from selection */
-      for (lp = selected_items; lp != NULL; lp = lp->next)
+
+      if (G_UNLIKELY (store->sort_virtual))
+        {
+          /* only count the selected rows, most files are not loaded */
+          selected_string = thunar_list_model_get_statusbar_text_for_rows (store, selected_items);
+        }
+      else
         {
-          gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, lp->data);
-          relevant_files = g_list_append (relevant_files, g_sequence_get (iter.user_data));
+          /* build GList of files from selection */
+          for (lp = selected_items; lp != NULL; lp = lp->next)
+            {
+              gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, lp->data);
+              relevant_files = g_list_prepend (relevant_files, thunar_list_model_get_file (store, &iter));
+            }
+          relevant_files = g_list_reverse (relevant_files);
+          selected_string = thunar_list_model_get_statusbar_text_for_files (store, relevant_files, show_file_size_binary_format);
         }
-      selected_string = thunar_list_model_get_statusbar_text_for_files (store, relevant_files, show_file_size_binary_format);
       temp_string = g_strdup_printf (_("Selection: %s"), selected_string);
       text_list = g_list_append (text_list, temp_string);
-      g_list_free (relevant_files);
+      thunar_g_list_free_full (relevant_files);
       g_free (selected_string);
     }
 
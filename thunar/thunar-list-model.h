@@ -53,6 +53,15 @@ void             thunar_list_model_set_folder             (ThunarListModel  *sto
 void             thunar_list_model_set_folders_first      (ThunarListModel  *store,
                                                            gboolean          folders_first);
 
+void             thunar_list_model_set_frame_clock        (ThunarListModel  *store,
+                                                           GdkFrameClock    *frame_clock);
+
+void             thunar_list_model_set_visible_range      (ThunarListModel  *store,
+                                                           GtkTreePath      *start_path,
+                                                           GtkTreePath      *end_path);
+void             thunar_list_model_set_pinned_paths       (ThunarListModel  *store,
+                                                           GList            *paths);
+
 gboolean         thunar_list_model_get_show_hidden        (ThunarListModel  *store);
 void             thunar_list_model_set_show_hidden        (ThunarListModel  *store,
                                                            gboolean          show_hidden);
@@ -63,6 +72,8 @@ void             thunar_list_model_set_file_size_binary   (ThunarListModel  *sto
 
 ThunarFile      *thunar_list_model_get_file               (ThunarListModel  *store,
                                                            GtkTreeIter      *iter);
+GFile           *thunar_list_model_get_location           (ThunarListModel  *store,
+                                                           GtkTreeIter      *iter);
 
 
 GList           *thunar_list_model_get_paths_for_files    (ThunarListModel  *store,
@@ -71,6 +82,11 @@ GList           *thunar_list_model_get_paths_for_pattern  (ThunarListModel  *sto
                                                            const gchar      *pattern,
                                                            gboolean          case_sensitive,
                                                            gboolean          match_diacritics);
+gboolean         thunar_list_model_search_equal           (GtkTreeModel     *model,
+                                                           gint              column,
+                                                           const gchar      *key,
+                                                           GtkTreeIter      *iter,
+                                                           gpointer          user_data);
 
 gchar           *thunar_list_model_get_statusbar_text     (ThunarListModel  *store,
                                                            GList            *selected_items);
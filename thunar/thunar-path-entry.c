@@ -1012,8 +1012,18 @@ thunar_path_entry_match_func (GtkEntryCompletion *completion,
     {
       /* check if the file is hidden */
       gtk_tree_model_get (model, iter, THUNAR_COLUMN_FILE, &file, -1);
-      matched = !thunar_file_is_hidden (file);
-      g_object_unref (G_OBJECT (file));
+      if (G_LIKELY (file != NULL))
+        {
+          matched = !thunar_file_is_hidden (file);
+          g_object_unref (G_OBJECT (file));
+        }
+      else
+        {
+          /* the file of a very large folder is still loading, go by its name */
+          gtk_tree_model_get (model, iter, THUNAR_COLUMN_FILE_NAME, &name, -1);
+          matched = (name != NULL && name[0] != '.' && !g_str_has_suffix (name, "~"));
+          g_free (name);
+        }
     }
   else
     {
@@ -1068,8 +1078,9 @@ thunar_path_entry_match_selected (GtkEntryCompletion *completion,
   /* determine the real name for the file */
   gtk_tree_model_get (model, iter, THUNAR_COLUMN_FILE_NAME, &real_name, -1);
 
-  /* append a slash if we have a folder here */
-  if (G_LIKELY (thunar_file_is_directory (file)))
+  /* append a slash if we have a folder here, files that are
+   * still loading are never folders (see ThunarFolderEntry) */
+  if (G_LIKELY (file != NULL && thunar_file_is_directory (file)))
     {
       tmp = g_strconcat (real_name, G_DIR_SEPARATOR_S, NULL);
       g_free (real_name);
@@ -1094,7 +1105,8 @@ thunar_path_entry_match_selected (GtkEntryCompletion *completion,
   gtk_editable_set_position (GTK_EDITABLE (path_entry), -1);
 
   /* cleanup */
-  g_object_unref (G_OBJECT (file));
+  if (G_LIKELY (file != NULL))
+    g_object_unref (G_OBJECT (file));
   g_free (real_name);
 
   return TRUE;
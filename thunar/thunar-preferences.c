@@ -113,9 +113,14 @@ enum
   PROP_MISC_CONFIRM_CLOSE_MULTIPLE_TABS,
   PROP_MISC_STATUS_BAR_ACTIVE_INFO,
   PROP_MISC_PARALLEL_COPY_MODE,
+  PROP_MISC_PARALLEL_COPY_MAX_JOBS,
   PROP_MISC_WINDOW_ICON,
   PROP_MISC_TRANSFER_USE_PARTIAL,
   PROP_MISC_TRANSFER_VERIFY_FILE,
+  PROP_MISC_TRANSFER_VERIFY_CHECKSUM,
+  PROP_MISC_TRANSFER_CHECK_CONFLICTS,
+  PROP_MISC_TRANSFER_DIRECT_IO,
+  PROP_MISC_TRANSFER_PRESERVE_LINKS,
   PROP_MISC_IMAGE_PREVIEW_FULL,
   PROP_SHORTCUTS_ICON_EMBLEMS,
   PROP_SHORTCUTS_ICON_SIZE,
@@ -127,6 +132,9 @@ enum
   PROP_MISC_COMPACT_VIEW_MAX_CHARS,
   PROP_MISC_HIGHLIGHTING_ENABLED,
   PROP_MISC_UNDO_REDO_HISTORY_SIZE,
+  PROP_MISC_FILE_WATCH_BUDGET,
+  PROP_MISC_VIRTUAL_LISTING_THRESHOLD,
+  PROP_MISC_SEARCH_RESULT_LIMIT,
   N_PROPERTIES,
 };
 
@@ -978,6 +986,21 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                          THUNAR_PARALLEL_COPY_MODE_ONLY_LOCAL,
                          EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-parallel-copy-max-jobs:
+   *
+   * Maximum number of copies running at the same time on one local
+   * device. A value of %0 allows one copy on spinning disks and four
+   * on solid state devices. Removable and network devices always
+   * handle one copy at a time.
+   **/
+  preferences_props[PROP_MISC_PARALLEL_COPY_MAX_JOBS] =
+      g_param_spec_uint ("misc-parallel-copy-max-jobs",
+                         "MiscParallelCopyMaxJobs",
+                         NULL,
+                         0u, G_MAXUINT, 0u,
+                         EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-change-window-icon:
    *
@@ -1016,6 +1039,59 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                        THUNAR_VERIFY_FILE_MODE_DISABLED,
                        EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-transfer-verify-checksum:
+   *
+   * The hash used to verify copied files, see misc-transfer-verify-file.
+   **/
+  preferences_props[PROP_MISC_TRANSFER_VERIFY_CHECKSUM] =
+    g_param_spec_enum ("misc-transfer-verify-checksum",
+                       "MiscTransferVerifyChecksum",
+                       NULL,
+                       THUNAR_TYPE_VERIFY_CHECKSUM,
+                       THUNAR_VERIFY_CHECKSUM_MD5,
+                       EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-transfer-check-conflicts:
+   *
+   * Whether to look for existing files before copying, and ask
+   * about all of them in one dialog instead of one at a time.
+   **/
+  preferences_props[PROP_MISC_TRANSFER_CHECK_CONFLICTS] =
+    g_param_spec_boolean ("misc-transfer-check-conflicts",
+                          "MiscTransferCheckConflicts",
+                          NULL,
+                          FALSE,
+                          EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-transfer-direct-io:
+   *
+   * Whether large local files are written with O_DIRECT, so copying
+   * them does not push other data out of the page cache. Large files
+   * are dropped from the cache after copying in any case.
+   **/
+  preferences_props[PROP_MISC_TRANSFER_DIRECT_IO] =
+    g_param_spec_boolean ("misc-transfer-direct-io",
+                          "MiscTransferDirectIo",
+                          NULL,
+                          FALSE,
+                          EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-transfer-preserve-links:
+   *
+   * Whether local files with several hard links are copied once and
+   * linked again in the destination, rather than copied for each link.
+   **/
+  preferences_props[PROP_MISC_TRANSFER_PRESERVE_LINKS] =
+    g_param_spec_boolean ("misc-transfer-preserve-links",
+                          "MiscTransferPreserveLinks",
+                          NULL,
+                          TRUE,
+                          EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-image-preview-mode:
    *
@@ -1190,6 +1266,50 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                         10,
                         EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-file-watch-budget:
+   *
+   * Maximum number of local directories which are monitored for changes
+   * at the same time. Once exceeded, the least recently used directories
+   * are polled instead. A value of %0 uses half of the system's inotify
+   * watch limit.
+   **/
+  preferences_props[PROP_MISC_FILE_WATCH_BUDGET] =
+      g_param_spec_uint ("misc-file-watch-budget",
+                         "MiscFileWatchBudget",
+                         NULL,
+                         0u, G_MAXUINT, 0u,
+                         EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-virtual-listing-threshold:
+   *
+   * Number of children above which a folder only loads its
+   * subfolders completely and lists the other files by name,
+   * loading them when they are displayed. A value of %0 always
+   * loads all files.
+   **/
+  preferences_props[PROP_MISC_VIRTUAL_LISTING_THRESHOLD] =
+      g_param_spec_uint ("misc-virtual-listing-threshold",
+                         "MiscVirtualListingThreshold",
+                         NULL,
+                         0u, G_MAXUINT, 500000u,
+                         EXO_PARAM_READWRITE);
+
+  /**
+   * ThunarPreferences:misc-search-result-limit:
+   *
+   * Maximum number of matches collected by a search before it
+   * stops and reports that more results are available. A value
+   * of %0 collects all matches.
+   **/
+  preferences_props[PROP_MISC_SEARCH_RESULT_LIMIT] =
+      g_param_spec_uint ("misc-search-result-limit",
+                         "MiscSearchResultLimit",
+                         NULL,
+                         0u, G_MAXUINT, 50000u,
+                         EXO_PARAM_READWRITE);
+
   /* install all properties */
   g_object_class_install_properties (gobject_class, N_PROPERTIES, preferences_props);
 }
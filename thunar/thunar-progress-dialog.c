@@ -30,6 +30,7 @@
 #include <thunar/thunar-progress-dialog.h>
 #include <thunar/thunar-progress-view.h>
 #include <thunar/thunar-transfer-job.h>
+#include <thunar/thunar-transfer-scheduler.h>
 
 
 
@@ -117,6 +118,15 @@ thunar_progress_dialog_init (ThunarProgressDialog *dialog)
 static void
 thunar_progress_dialog_dispose (GObject *object)
 {
+  ThunarProgressDialog *dialog = THUNAR_PROGRESS_DIALOG (object);
+  GList                *lp;
+
+  /* the scheduler must not call back once the dialog is gone */
+  for (lp = dialog->views_waiting; lp != NULL; lp = lp->next)
+    thunar_transfer_scheduler_remove (THUNAR_TRANSFER_JOB (thunar_progress_view_get_job (lp->data)));
+  g_list_free (dialog->views_waiting);
+  dialog->views_waiting = NULL;
+
   (*G_OBJECT_CLASS (thunar_progress_dialog_parent_class)->dispose) (object);
 }
 
@@ -194,6 +204,9 @@ thunar_progress_dialog_launch_view (ThunarProgressDialog *dialog,
   view_lp = g_list_find (dialog->views_waiting, view);
   if (view_lp != NULL)
     {
+      /* the user wants it to run, even if its devices are busy */
+      thunar_transfer_scheduler_start (THUNAR_TRANSFER_JOB (thunar_progress_view_get_job (view)));
+
       dialog->views_waiting = g_list_remove_link (dialog->views_waiting, view_lp);
       dialog->views         = g_list_concat (view_lp, dialog->views);
       thunar_progress_view_launch_job (THUNAR_PROGRESS_VIEW (view_lp->data));
@@ -212,37 +225,26 @@ thunar_progress_dialog_launch_view (ThunarProgressDialog *dialog,
 static void
 launch_waiting_jobs (ThunarProgressDialog *dialog)
 {
-  gboolean           launched     = FALSE;
-  GList             *lp           = NULL;
-  GList             *next         = NULL;
-  GList             *job_list;
-  ThunarTransferJob *transfer_job;
-
-  lp = dialog->views_waiting;
-  if (lp == NULL)
-    return;
-  job_list = thunar_progress_dialog_list_jobs (dialog);
-  while (lp != NULL)
+  GList *admitted;
+  GList *lp;
+  GList *view_lp;
+
+  admitted = thunar_transfer_scheduler_dequeue ();
+  for (lp = admitted; lp != NULL; lp = lp->next)
     {
-      next         = lp->next;
-      transfer_job = THUNAR_TRANSFER_JOB (thunar_progress_view_get_job (THUNAR_PROGRESS_VIEW (lp->data)));
-      if (thunar_transfer_job_can_start (transfer_job, job_list))
+      for (view_lp = dialog->views_waiting; view_lp != NULL; view_lp = view_lp->next)
         {
-          launched = TRUE;
-
-          /* Move the view to the running list, and then launch a job */
-          dialog->views_waiting = g_list_remove_link (dialog->views_waiting, lp);
-          dialog->views         = g_list_concat (lp, dialog->views);
-          thunar_progress_view_launch_job (THUNAR_PROGRESS_VIEW (lp->data));
-
-          job_list = g_list_prepend (job_list, lp->data);
+          if (thunar_progress_view_get_job (THUNAR_PROGRESS_VIEW (view_lp->data)) == lp->data)
+            {
+              /* Move the view to the running list, and then launch a job */
+              dialog->views_waiting = g_list_remove_link (dialog->views_waiting, view_lp);
+              dialog->views         = g_list_concat (view_lp, dialog->views);
+              thunar_progress_view_launch_job (THUNAR_PROGRESS_VIEW (view_lp->data));
+              break;
+            }
         }
-      lp = next;
     }
-  g_list_free (job_list);
-
-  if (launched == FALSE)
-    g_warning ("Waiting jobs cannot be launched");
+  g_list_free (admitted);
 }
 
 
@@ -251,11 +253,17 @@ static void
 thunar_progress_dialog_job_finished (ThunarProgressDialog *dialog,
                                      ThunarProgressView   *view)
 {
-  guint n_views;
+  ThunarJob *job;
+  guint      n_views;
 
   _thunar_return_if_fail (THUNAR_IS_PROGRESS_DIALOG (dialog));
   _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
 
+  /* free the devices of the job for the waiting ones */
+  job = thunar_progress_view_get_job (view);
+  if (THUNAR_IS_TRANSFER_JOB (job))
+    thunar_transfer_scheduler_remove (THUNAR_TRANSFER_JOB (job));
+
   /* remove the view from the list */
   dialog->views         = g_list_remove (dialog->views,         view);
   dialog->views_waiting = g_list_remove (dialog->views_waiting, view);
@@ -348,7 +356,6 @@ thunar_progress_dialog_add_job (ThunarProgressDialog *dialog,
 {
   GtkWidget *viewport;
   GtkWidget *view;
-  GList     *job_list;
 
   _thunar_return_if_fail (THUNAR_IS_PROGRESS_DIALOG (dialog));
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
@@ -364,19 +371,18 @@ thunar_progress_dialog_add_job (ThunarProgressDialog *dialog,
   if (dialog->views == NULL)
     gtk_window_set_icon_name (GTK_WINDOW (dialog), icon_name);
 
-  /* Check if the job can start */
-  job_list = thunar_progress_dialog_list_jobs (dialog);
-  if (!THUNAR_IS_TRANSFER_JOB (job)
-      || thunar_transfer_job_can_start (THUNAR_TRANSFER_JOB (job), job_list))
+  /* transfer jobs wait until their devices are free */
+  if (THUNAR_IS_TRANSFER_JOB (job))
     {
-      dialog->views = g_list_append (dialog->views, view);
-      thunar_progress_view_launch_job (THUNAR_PROGRESS_VIEW (view));
+      dialog->views_waiting = g_list_append (dialog->views_waiting, view);
+      thunar_transfer_scheduler_enqueue (THUNAR_TRANSFER_JOB (job), (ThunarTransferSchedulerFunc) launch_waiting_jobs, dialog);
+      launch_waiting_jobs (dialog);
     }
   else
     {
-      dialog->views_waiting = g_list_append (dialog->views_waiting, view);
+      dialog->views = g_list_append (dialog->views, view);
+      thunar_progress_view_launch_job (THUNAR_PROGRESS_VIEW (view));
     }
-  g_list_free (job_list);
 
   /* check if we need to wrap the views in a scroll window (starting
    * at SCROLLVIEW_THRESHOLD parallel operations */
@@ -58,6 +58,7 @@ static void              thunar_progress_view_set_property (GObject            *
 static void              thunar_progress_view_pause_job    (ThunarProgressView *view);
 static void              thunar_progress_view_unpause_job  (ThunarProgressView *view);
 static void              thunar_progress_view_cancel_job   (ThunarProgressView *view);
+static void              thunar_progress_view_throttle_job (ThunarProgressView *view);
 static ThunarJobResponse thunar_progress_view_ask          (ThunarProgressView *view,
                                                             const gchar        *message,
                                                             ThunarJobResponse   choices,
@@ -66,6 +67,9 @@ static ThunarJobResponse thunar_progress_view_ask_replace  (ThunarProgressView *
                                                             ThunarFile         *src_file,
                                                             ThunarFile         *dst_file,
                                                             ThunarJob          *job);
+static ThunarJobResponse thunar_progress_view_ask_conflicts (ThunarProgressView *view,
+                                                             GList              *conflicts,
+                                                             ThunarJob          *job);
 static void              thunar_progress_view_error        (ThunarProgressView *view,
                                                             GError             *error,
                                                             ExoJob             *job);
@@ -102,6 +106,9 @@ struct _ThunarProgressView
   GtkWidget *message_label;
   GtkWidget *pause_button;
   GtkWidget *unpause_button;
+  GtkWidget *throttle_button;
+  GtkWidget *byte_rate_button;
+  GtkWidget *file_rate_button;
 
   gboolean   launched;
 
@@ -193,6 +200,8 @@ thunar_progress_view_init (ThunarProgressView *view)
   GtkWidget *image;
   GtkWidget *label;
   GtkWidget *cancel_button;
+  GtkWidget *popover;
+  GtkWidget *grid;
   GtkWidget *vbox;
   GtkWidget *vbox2;
   GtkWidget *vbox3;
@@ -233,6 +242,46 @@ thunar_progress_view_init (ThunarProgressView *view)
   gtk_box_pack_start (GTK_BOX (vbox2), view->message_label, TRUE, TRUE, 0);
   gtk_widget_show (view->message_label);
 
+  /* limits for transfer jobs, which can be changed while they run */
+  grid = gtk_grid_new ();
+  gtk_grid_set_row_spacing (GTK_GRID (grid), 6);
+  gtk_grid_set_column_spacing (GTK_GRID (grid), 12);
+  gtk_container_set_border_width (GTK_CONTAINER (grid), 12);
+
+  label = gtk_label_new_with_mnemonic (_("Maximum _speed (MB/s):"));
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0f);
+  gtk_grid_attach (GTK_GRID (grid), label, 0, 0, 1, 1);
+
+  view->byte_rate_button = gtk_spin_button_new_with_range (0, 100000, 1);
+  gtk_widget_set_tooltip_text (view->byte_rate_button, _("0 means no limit"));
+  gtk_label_set_mnemonic_widget (GTK_LABEL (label), view->byte_rate_button);
+  g_signal_connect_swapped (view->byte_rate_button, "value-changed", G_CALLBACK (thunar_progress_view_throttle_job), view);
+  gtk_grid_attach (GTK_GRID (grid), view->byte_rate_button, 1, 0, 1, 1);
+
+  label = gtk_label_new_with_mnemonic (_("Maximum _files per second:"));
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0f);
+  gtk_grid_attach (GTK_GRID (grid), label, 0, 1, 1, 1);
+
+  view->file_rate_button = gtk_spin_button_new_with_range (0, 100000, 10);
+  gtk_widget_set_tooltip_text (view->file_rate_button, _("0 means no limit"));
+  gtk_label_set_mnemonic_widget (GTK_LABEL (label), view->file_rate_button);
+  g_signal_connect_swapped (view->file_rate_button, "value-changed", G_CALLBACK (thunar_progress_view_throttle_job), view);
+  gtk_grid_attach (GTK_GRID (grid), view->file_rate_button, 1, 1, 1, 1);
+
+  gtk_widget_show_all (grid);
+
+  view->throttle_button = gtk_menu_button_new ();
+  gtk_button_set_image (GTK_BUTTON (view->throttle_button),
+                        gtk_image_new_from_icon_name ("emblem-system-symbolic", GTK_ICON_SIZE_BUTTON));
+  gtk_button_set_relief (GTK_BUTTON (view->throttle_button), GTK_RELIEF_NONE);
+  gtk_widget_set_tooltip_text (view->throttle_button, _("Limit the speed of this operation"));
+  popover = gtk_popover_new (view->throttle_button);
+  gtk_container_add (GTK_CONTAINER (popover), grid);
+  gtk_menu_button_set_popover (GTK_MENU_BUTTON (view->throttle_button), popover);
+  gtk_box_pack_start (GTK_BOX (hbox), view->throttle_button, FALSE, FALSE, 0);
+  gtk_widget_set_can_focus (view->throttle_button, FALSE);
+  gtk_widget_hide (view->throttle_button);
+
   view->pause_button = gtk_button_new_from_icon_name ("media-playback-pause-symbolic", GTK_ICON_SIZE_BUTTON);
   gtk_button_set_relief (GTK_BUTTON (view->pause_button), GTK_RELIEF_NONE);
   g_signal_connect_swapped (view->pause_button, "clicked", G_CALLBACK (thunar_progress_view_pause_job), view);
@@ -454,6 +503,22 @@ thunar_progress_view_cancel_job (ThunarProgressView *view)
 
 
 
+static void
+thunar_progress_view_throttle_job (ThunarProgressView *view)
+{
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+
+  if (!THUNAR_IS_TRANSFER_JOB (view->job))
+    return;
+
+  g_object_set (G_OBJECT (view->job),
+                "max-byte-rate", (guint64) (gtk_spin_button_get_value (GTK_SPIN_BUTTON (view->byte_rate_button)) * 1000 * 1000),
+                "max-file-rate", (guint) gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (view->file_rate_button)),
+                NULL);
+}
+
+
+
 static ThunarJobResponse
 thunar_progress_view_ask (ThunarProgressView *view,
                           const gchar        *message,
@@ -507,6 +572,29 @@ thunar_progress_view_ask_replace (ThunarProgressView *view,
 
 
 
+static ThunarJobResponse
+thunar_progress_view_ask_conflicts (ThunarProgressView *view,
+                                    GList              *conflicts,
+                                    ThunarJob          *job)
+{
+  GtkWidget *window;
+
+  _thunar_return_val_if_fail (THUNAR_IS_PROGRESS_VIEW (view), THUNAR_JOB_RESPONSE_CANCEL);
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), THUNAR_JOB_RESPONSE_CANCEL);
+  _thunar_return_val_if_fail (view->job == job, THUNAR_JOB_RESPONSE_CANCEL);
+
+  /* be sure to display the corresponding dialog prior to opening the question view */
+  g_signal_emit_by_name (view, "need-attention");
+
+  /* determine the toplevel window of the view */
+  window = gtk_widget_get_toplevel (GTK_WIDGET (view));
+
+  return thunar_dialogs_show_job_ask_conflicts (window != NULL ? GTK_WINDOW (window) : NULL,
+                                                conflicts);
+}
+
+
+
 static void
 thunar_progress_view_error (ThunarProgressView *view,
                             GError             *error,
@@ -572,8 +660,11 @@ thunar_progress_view_percent (ThunarProgressView *view,
   _thunar_return_if_fail (THUNAR_IS_JOB (job));
   _thunar_return_if_fail (view->job == THUNAR_JOB (job));
 
-  /* update progressbar */
-  gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (view->progress_bar), percent / 100.0);
+  /* update progressbar, which is indeterminate until the size is known */
+  if (THUNAR_IS_TRANSFER_JOB (job) && thunar_transfer_job_is_counting (THUNAR_TRANSFER_JOB (job)))
+    gtk_progress_bar_pulse (GTK_PROGRESS_BAR (view->progress_bar));
+  else
+    gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (view->progress_bar), percent / 100.0);
 
   /* set progress text */
   if (THUNAR_IS_TRANSFER_JOB (job))
@@ -715,6 +806,12 @@ thunar_progress_view_set_job (ThunarProgressView *view,
         }
     }
 
+  /* only transfers can be throttled */
+  gtk_widget_set_visible (view->throttle_button, THUNAR_IS_TRANSFER_JOB (job));
+
+  if (THUNAR_IS_TRANSFER_JOB (job))
+    g_signal_connect_swapped (job, "ask-conflicts", G_CALLBACK (thunar_progress_view_ask_conflicts), view);
+
   g_object_notify (G_OBJECT (view), "job");
 }
 
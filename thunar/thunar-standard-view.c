@@ -258,6 +258,13 @@ static void                 thunar_standard_view_search_done                (Thu
 static void                 thunar_standard_view_sort_column_changed        (GtkTreeSortable          *tree_sortable,
                                                                              ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_loading_unbound            (gpointer                  user_data);
+static void                 thunar_standard_view_load_selection             (GTask                    *task,
+                                                                             gpointer                  source_object,
+                                                                             gpointer                  task_data,
+                                                                             GCancellable             *cancellable);
+static void                 thunar_standard_view_selection_loaded           (GObject                  *object,
+                                                                             GAsyncResult             *result,
+                                                                             gpointer                  user_data);
 static gboolean             thunar_standard_view_drag_scroll_timer          (gpointer                  user_data);
 static void                 thunar_standard_view_drag_scroll_timer_destroy  (gpointer                  user_data);
 static gboolean             thunar_standard_view_drag_timer                 (gpointer                  user_data);
@@ -274,6 +281,7 @@ static gboolean             thunar_standard_view_request_thumbnails_lazy    (gpo
 static void                 thunar_standard_view_thumbnail_mode_toggled     (ThunarStandardView       *standard_view,
                                                                              GParamSpec               *pspec,
                                                                              ThunarIconFactory        *icon_factory);
+static void                 thunar_standard_view_update_visible_range       (ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_scrolled                   (GtkAdjustment            *adjustment,
                                                                              ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_size_allocate              (ThunarStandardView       *standard_view,
@@ -361,6 +369,7 @@ struct _ThunarStandardViewPrivate
 
   /* #GList of currently selected #ThunarFile<!---->s */
   GList                  *selected_files;
+  GCancellable           *selection_cancellable;
   guint                   restore_selection_idle_id;
 
   /* support for generating thumbnails */
@@ -1020,6 +1029,13 @@ thunar_standard_view_dispose (GObject *object)
   /* cancel pending thumbnail sources and requests */
   thunar_standard_view_cancel_thumbnailing (standard_view);
 
+  /* stop loading the files of the selection */
+  if (G_UNLIKELY (standard_view->priv->selection_cancellable != NULL))
+    {
+      g_cancellable_cancel (standard_view->priv->selection_cancellable);
+      g_clear_object (&standard_view->priv->selection_cancellable);
+    }
+
   /* unregister the "loading" binding */
   if (G_UNLIKELY (standard_view->loading_binding != NULL))
     {
@@ -1321,6 +1337,9 @@ thunar_standard_view_realize (GtkWidget *widget)
 
   /* store sort information to keep indicators in menu in sync */
   thunar_standard_view_store_sort_column (standard_view);
+
+  /* let the model announce file changes once per frame */
+  thunar_list_model_set_frame_clock (standard_view->model, gtk_widget_get_frame_clock (widget));
 }
 
 
@@ -1330,6 +1349,9 @@ thunar_standard_view_unrealize (GtkWidget *widget)
 {
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (widget);
 
+  /* the frame clock goes away with the window */
+  thunar_list_model_set_frame_clock (standard_view->model, NULL);
+
   /* Disconnect from methods which make use of the icon factory */
   g_signal_handlers_disconnect_by_func (G_OBJECT (standard_view->model), thunar_standard_view_row_changed, standard_view);
   g_signal_handlers_disconnect_by_func (G_OBJECT (standard_view->preferences), thunar_standard_view_highlight_option_changed, standard_view);
@@ -1849,8 +1871,33 @@ static void
 thunar_standard_view_set_show_hidden (ThunarView *view,
                                       gboolean    show_hidden)
 {
-  THUNAR_STANDARD_VIEW (view)->priv->last_show_hidden = show_hidden;
-  thunar_list_model_set_show_hidden (THUNAR_STANDARD_VIEW (view)->model, show_hidden);
+  ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (view);
+  GtkWidget          *child = gtk_bin_get_child (GTK_BIN (standard_view));
+  GList              *selected_files;
+
+  standard_view->priv->last_show_hidden = show_hidden;
+
+  if (thunar_list_model_get_show_hidden (standard_view->model) == show_hidden)
+    return;
+
+  if (G_UNLIKELY (child == NULL))
+    {
+      thunar_list_model_set_show_hidden (standard_view->model, show_hidden);
+      return;
+    }
+
+  /* remember the selection, it is lost when disconnecting the model */
+  selected_files = thunar_g_list_copy_deep (standard_view->priv->selected_files);
+
+  /* toggling can add or remove lots of rows, so we temporarily disconnect
+   * the model from the view and let it refresh only once afterwards */
+  g_object_set (G_OBJECT (child), "model", NULL, NULL);
+  thunar_list_model_set_show_hidden (standard_view->model, show_hidden);
+  g_object_set (G_OBJECT (child), "model", standard_view->model, NULL);
+
+  /* restore the selection, which may have lost the now hidden files */
+  thunar_component_set_selected_files (THUNAR_COMPONENT (standard_view), selected_files);
+  thunar_g_list_free_full (selected_files);
 }
 
 
@@ -2087,6 +2134,16 @@ thunar_standard_view_get_visible_range (ThunarView  *view,
       gtk_tree_path_free (start_path);
       gtk_tree_path_free (end_path);
 
+      /* the rows of very large folders may still be loading */
+      if ((start_file != NULL && *start_file == NULL) || (end_file != NULL && *end_file == NULL))
+        {
+          if (start_file != NULL)
+            g_clear_object (start_file);
+          if (end_file != NULL)
+            g_clear_object (end_file);
+          return FALSE;
+        }
+
       return TRUE;
     }
 
@@ -2237,11 +2294,13 @@ thunar_standard_view_get_drop_file (ThunarStandardView *standard_view,
       gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, path);
       file = thunar_list_model_get_file (standard_view->model, &iter);
 
-      /* we can only drop to directories and executable files */
-      if (!thunar_file_is_directory (file) && !thunar_file_can_execute (file))
+      /* we can only drop to directories and executable files, files
+       * that are still loading are neither (see ThunarFolderEntry) */
+      if (file == NULL || (!thunar_file_is_directory (file) && !thunar_file_can_execute (file)))
         {
           /* drop to the folder instead */
-          g_object_unref (G_OBJECT (file));
+          if (file != NULL)
+            g_object_unref (G_OBJECT (file));
           gtk_tree_path_free (path);
           path = NULL;
         }
@@ -3603,8 +3662,11 @@ thunar_standard_view_row_changed (ThunarListModel    *model,
                                                standard_view->priv->current_directory))
     return;
 
-  /* queue a thumbnail request */
-  file = thunar_list_model_get_file (standard_view->model, iter);
+  /* queue a thumbnail request, unless the file is still loading */
+  gtk_tree_model_get (GTK_TREE_MODEL (model), iter, THUNAR_COLUMN_FILE, &file, -1);
+  if (G_UNLIKELY (file == NULL))
+    return;
+
   if (thunar_file_get_thumb_state (file) == THUNAR_FILE_THUMB_STATE_UNKNOWN)
     {
       thunar_standard_view_cancel_thumbnailing (standard_view);
@@ -3686,6 +3748,9 @@ thunar_standard_view_sort_column_changed (GtkTreeSortable    *tree_sortable,
   /* keep the currently selected files selected after the change */
   thunar_component_restore_selection (THUNAR_COMPONENT (standard_view));
 
+  /* very large folders mention that they ignore the sort column */
+  thunar_standard_view_update_statusbar_text (standard_view);
+
   /* determine the new sort column and sort order, and save them */
   if (gtk_tree_sortable_get_sort_column_id (tree_sortable, &sort_column, &sort_order))
     {
@@ -3989,9 +4054,11 @@ thunar_standard_view_request_thumbnails_real (ThunarStandardView *standard_view,
 
       while (valid_iter)
         {
-          /* prepend the file to the visible items list */
-          file = thunar_list_model_get_file (standard_view->model, &iter);
-          visible_files = g_list_prepend (visible_files, file);
+          /* prepend the file to the visible items list, files of very large
+           * folders that are still loading are queued from row_changed() */
+          gtk_tree_model_get (GTK_TREE_MODEL (standard_view->model), &iter, THUNAR_COLUMN_FILE, &file, -1);
+          if (G_LIKELY (file != NULL))
+            visible_files = g_list_prepend (visible_files, file);
 
           /* check if we've reached the end of the visible range */
           path = gtk_tree_model_get_path (GTK_TREE_MODEL (standard_view->model), &iter);
@@ -4076,6 +4143,27 @@ thunar_standard_view_thumbnail_mode_toggled (ThunarStandardView *standard_view,
 
 
 
+static void
+thunar_standard_view_update_visible_range (ThunarStandardView *standard_view)
+{
+  GtkTreePath *start_path;
+  GtkTreePath *end_path;
+
+  /* the model keeps the files of the shown rows loaded */
+  if ((*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_visible_range) (standard_view, &start_path, &end_path))
+    {
+      thunar_list_model_set_visible_range (standard_view->model, start_path, end_path);
+      gtk_tree_path_free (start_path);
+      gtk_tree_path_free (end_path);
+    }
+  else
+    {
+      thunar_list_model_set_visible_range (standard_view->model, NULL, NULL);
+    }
+}
+
+
+
 static void
 thunar_standard_view_scrolled (GtkAdjustment      *adjustment,
                                ThunarStandardView *standard_view)
@@ -4083,6 +4171,8 @@ thunar_standard_view_scrolled (GtkAdjustment      *adjustment,
   _thunar_return_if_fail (GTK_IS_ADJUSTMENT (adjustment));
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
+  thunar_standard_view_update_visible_range (standard_view);
+
   /* ignore adjustment changes when the view is still loading */
   if (thunar_view_get_loading (THUNAR_VIEW (standard_view)))
     return;
@@ -4099,6 +4189,8 @@ thunar_standard_view_size_allocate (ThunarStandardView *standard_view,
 {
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
+  thunar_standard_view_update_visible_range (standard_view);
+
   /* ignore size changes when the view is still loading */
   if (thunar_view_get_loading (THUNAR_VIEW (standard_view)))
     return;
@@ -4254,6 +4346,8 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
 {
   GtkTreeIter iter;
   GList      *lp, *selected_thunar_files;
+  GTask      *task;
+  gboolean    complete = TRUE;
 
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
@@ -4261,6 +4355,13 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
   if (standard_view->priv->active_search == TRUE)
     return;
 
+  /* stop loading the files of the previous selection */
+  if (G_UNLIKELY (standard_view->priv->selection_cancellable != NULL))
+    {
+      g_cancellable_cancel (standard_view->priv->selection_cancellable);
+      g_clear_object (&standard_view->priv->selection_cancellable);
+    }
+
   /* drop any existing "new-files" closure */
   if (G_UNLIKELY (standard_view->priv->new_files_closure != NULL))
     {
@@ -4274,6 +4375,10 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
 
   /* determine the new list of selected files (replacing GtkTreePath's with ThunarFile's) */
   selected_thunar_files = (*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items) (standard_view);
+
+  /* keep the files of the selected rows loaded in very large folders */
+  thunar_list_model_set_pinned_paths (standard_view->model, selected_thunar_files);
+
   for (lp = selected_thunar_files; lp != NULL; lp = lp->next)
     {
       /* determine the iterator for the path */
@@ -4284,6 +4389,26 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
 
       /* ...and replace it with the file */
       lp->data = thunar_list_model_get_file (standard_view->model, &iter);
+
+      /* rows of very large folders may not be loaded yet */
+      if (G_UNLIKELY (lp->data == NULL))
+        {
+          lp->data = thunar_list_model_get_location (standard_view->model, &iter);
+          complete = FALSE;
+        }
+    }
+
+  if (G_UNLIKELY (!complete))
+    {
+      /* load the missing files in a thread and publish the selection
+       * once it is complete, so no action applies to a part of it */
+      standard_view->priv->selection_cancellable = g_cancellable_new ();
+      task = g_task_new (standard_view, standard_view->priv->selection_cancellable, thunar_standard_view_selection_loaded, NULL);
+      g_task_set_task_data (task, selected_thunar_files, NULL);
+      g_task_run_in_thread (task, thunar_standard_view_load_selection);
+      g_object_unref (task);
+
+      selected_thunar_files = NULL;
     }
 
   /* and setup the new selected files list */
@@ -4298,6 +4423,73 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
 
 
 
+static void
+thunar_standard_view_load_selection (GTask        *task,
+                                     gpointer      source_object,
+                                     gpointer      task_data,
+                                     GCancellable *cancellable)
+{
+  GList      *files = task_data;
+  GList      *lp, *next;
+  ThunarFile *file;
+
+  /* replace the locations of the rows that were not loaded yet */
+  for (lp = files; lp != NULL; lp = next)
+    {
+      next = lp->next;
+
+      if (g_task_return_error_if_cancelled (task))
+        {
+          thunar_g_list_free_full (files);
+          return;
+        }
+
+      if (THUNAR_IS_FILE (lp->data))
+        continue;
+
+      /* files deleted in the meantime drop out of the selection */
+      file = thunar_file_get (lp->data, NULL);
+      g_object_unref (lp->data);
+      if (G_LIKELY (file != NULL))
+        lp->data = file;
+      else
+        files = g_list_delete_link (files, lp);
+    }
+
+  g_task_return_pointer (task, files, (GDestroyNotify) thunar_g_list_free_full);
+}
+
+
+
+static void
+thunar_standard_view_selection_loaded (GObject      *object,
+                                       GAsyncResult *result,
+                                       gpointer      user_data)
+{
+  ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (object);
+  GError             *error = NULL;
+  GList              *files;
+
+  /* a cancelled load belongs to a previous selection */
+  files = g_task_propagate_pointer (G_TASK (result), &error);
+  if (error != NULL)
+    {
+      g_error_free (error);
+      return;
+    }
+
+  g_clear_object (&standard_view->priv->selection_cancellable);
+
+  /* publish the complete selection */
+  thunar_g_list_free_full (standard_view->priv->selected_files);
+  standard_view->priv->selected_files = files;
+
+  thunar_standard_view_update_statusbar_text (standard_view);
+  g_object_notify_by_pspec (G_OBJECT (standard_view), standard_view_props[PROP_SELECTED_FILES]);
+}
+
+
+
 /**
  * thunar_standard_view_set_history:
  * @standard_view : a #ThunarStandardView instance.
@@ -4664,12 +4856,16 @@ thunar_standard_view_cell_layout_data_func (GtkCellLayout   *layout,
                                             GtkTreeIter     *iter,
                                             gpointer         data)
 {
-  ThunarFile  *file = THUNAR_FILE (thunar_list_model_get_file (THUNAR_LIST_MODEL (model), iter));
+  ThunarFile  *file = thunar_list_model_get_file (THUNAR_LIST_MODEL (model), iter);
   const gchar *background = NULL;
   const gchar *foreground = NULL;
 
-  background = thunar_file_get_metadata_setting (file, "highlight-color-background");
-  foreground = thunar_file_get_metadata_setting (file, "highlight-color-foreground");
+  /* rows that are still loading are drawn without highlight */
+  if (G_LIKELY (file != NULL))
+    {
+      background = thunar_file_get_metadata_setting (file, "highlight-color-background");
+      foreground = thunar_file_get_metadata_setting (file, "highlight-color-foreground");
+    }
 
   /* since this function is being used for both icon & name renderers;
    * we need to make sure the right properties are applied to the right renderers */
@@ -4698,5 +4894,6 @@ thunar_standard_view_cell_layout_data_func (GtkCellLayout   *layout,
   else
     g_warn_if_reached ();
 
-  g_object_unref (file);
+  if (G_LIKELY (file != NULL))
+    g_object_unref (file);
 }
@@ -0,0 +1,108 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Token bucket enforcing the rate limits of a transfer job: the bucket
+ * fills with the allowed rate, up to one second worth of copying, and
+ * what is about to be copied is taken from it. While that leaves the
+ * bucket empty, the copy has to wait until it is refilled.
+ *
+ * The bucket does not read the clock itself, the caller passes the
+ * current time, so it is independent of how and where the job waits.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-transfer-bucket.h>
+
+
+
+/**
+ * thunar_transfer_bucket_set_rate:
+ * @bucket : a #ThunarTransferBucket.
+ * @rate   : the units allowed per second, or %0 for no limit.
+ * @now    : the current time in microseconds.
+ *
+ * Sets the limit of @bucket, which starts empty.
+ **/
+void
+thunar_transfer_bucket_set_rate (ThunarTransferBucket *bucket,
+                                 guint64               rate,
+                                 gint64                now)
+{
+  _thunar_return_if_fail (bucket != NULL);
+
+  bucket->rate = rate;
+  bucket->level = 0;
+  bucket->update_time = now;
+}
+
+
+
+/**
+ * thunar_transfer_bucket_take:
+ * @bucket : a #ThunarTransferBucket.
+ * @amount : the units about to be copied.
+ *
+ * Takes @amount from @bucket, without waiting. See
+ * thunar_transfer_bucket_get_delay() for how long to wait then.
+ **/
+void
+thunar_transfer_bucket_take (ThunarTransferBucket *bucket,
+                             guint64               amount)
+{
+  _thunar_return_if_fail (bucket != NULL);
+
+  if (bucket->rate > 0)
+    bucket->level -= amount;
+}
+
+
+
+/**
+ * thunar_transfer_bucket_get_delay:
+ * @bucket : a #ThunarTransferBucket.
+ * @now    : the current time in microseconds.
+ *
+ * Refills @bucket for the time passed since the last call, and tells
+ * how long it takes until it is no longer empty.
+ *
+ * Return value: the microseconds to wait, %0 if the copy may go on.
+ **/
+gint64
+thunar_transfer_bucket_get_delay (ThunarTransferBucket *bucket,
+                                  gint64                now)
+{
+  _thunar_return_val_if_fail (bucket != NULL, 0);
+
+  if (bucket->rate == 0)
+    return 0;
+
+  bucket->level = MIN (bucket->level + (gdouble) (now - bucket->update_time) * bucket->rate / G_USEC_PER_SEC,
+                       (gdouble) bucket->rate);
+  bucket->update_time = now;
+
+  if (bucket->level >= 0)
+    return 0;
+
+  /* rounded up, so waiting that long is always enough */
+  return (gint64) (-bucket->level * G_USEC_PER_SEC / bucket->rate) + 1;
+}
@@ -0,0 +1,45 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THUNAR_TRANSFER_BUCKET_H__
+#define __THUNAR_TRANSFER_BUCKET_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarTransferBucket ThunarTransferBucket;
+
+struct _ThunarTransferBucket
+{
+  guint64 rate;                /* per second, 0 for no limit */
+  gdouble level;               /* negative while waiting */
+  gint64  update_time;         /* us, on the clock passed in */
+};
+
+void   thunar_transfer_bucket_set_rate  (ThunarTransferBucket *bucket,
+                                         guint64               rate,
+                                         gint64                now);
+void   thunar_transfer_bucket_take      (ThunarTransferBucket *bucket,
+                                         guint64               amount);
+gint64 thunar_transfer_bucket_get_delay (ThunarTransferBucket *bucket,
+                                         gint64                now);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_TRANSFER_BUCKET_H__ */
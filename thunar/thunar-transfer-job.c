@@ -27,20 +27,52 @@
 
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-io-copy.h>
 #include <thunar/thunar-io-scan-directory.h>
 #include <thunar/thunar-io-jobs-util.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-job-operation-history.h>
+#include <thunar/thunar-marshal.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-thumbnail-cache.h>
+#include <thunar/thunar-transfer-bucket.h>
 #include <thunar/thunar-transfer-job.h>
+#include <thunar/thunar-transfer-journal.h>
+#include <thunar/thunar-transfer-scheduler.h>
 
 
 
 /* seconds before we show the transfer rate + remaining time */
 #define MINIMUM_TRANSFER_TIME (2 * G_USEC_PER_SEC) /* 2 seconds */
 
+/* files up to this size are handed to the copy workers */
+#define MAXIMUM_WORKER_FILE_SIZE (4 * 1024 * 1024) /* 4 MiB */
+
+/* files queued per worker before waiting for results */
+#define MAXIMUM_WORKER_BACKLOG 4
+
+/* interrupted copies continue at a multiple of this, the
+ * data written last might not have reached the disk */
+#define RESUME_BLOCK_SIZE (1024 * 1024) /* 1 MiB */
+
+/* longest sleep while throttled, to follow changes of the limit */
+#define MAXIMUM_THROTTLE_DELAY (100 * 1000) /* 100 ms */
+
+/* what conflicts are told apart by, see thunar_transfer_job_find_conflicts() */
+#define CONFLICT_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED
+
+/* what files linked to each other are told apart by, see thunar_transfer_job_link_file() */
+#define LINK_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+  G_FILE_ATTRIBUTE_UNIX_DEVICE "," \
+  G_FILE_ATTRIBUTE_UNIX_INODE "," \
+  G_FILE_ATTRIBUTE_UNIX_NLINK
+
 
 
 /* Property identifiers */
@@ -51,11 +83,27 @@ enum
   PROP_PARALLEL_COPY_MODE,
   PROP_TRANSFER_USE_PARTIAL,
   PROP_TRANSFER_VERIFY_FILE,
+  PROP_TRANSFER_VERIFY_CHECKSUM,
+  PROP_TRANSFER_DIRECT_IO,
+  PROP_TRANSFER_PRESERVE_LINKS,
+  PROP_MAX_BYTE_RATE,
+  PROP_MAX_FILE_RATE,
+  PROP_CHECK_CONFLICTS,
+};
+
+
+
+/* Signal identifiers */
+enum
+{
+  ASK_CONFLICTS,
+  LAST_SIGNAL,
 };
 
 
 
-typedef struct _ThunarTransferNode ThunarTransferNode;
+typedef struct _ThunarTransferNode   ThunarTransferNode;
+typedef struct _ThunarTransferTask   ThunarTransferTask;
 
 
 
@@ -70,9 +118,26 @@ static void     thunar_transfer_job_set_property (GObject      *object,
                                                   GParamSpec   *pspec);
 
 static void     thunar_transfer_job_finalize     (GObject                *object);
+static gboolean thunar_transfer_job_transfer     (ExoJob                 *job,
+                                                  GError                **error);
 static gboolean thunar_transfer_job_execute      (ExoJob                 *job,
                                                   GError                **error);
 static void     thunar_transfer_node_free        (gpointer                data);
+static gboolean thunar_transfer_job_collect_node (ThunarTransferJob      *job,
+                                                  ThunarTransferNode     *node,
+                                                  gboolean                recursive,
+                                                  GError                **error);
+static gboolean thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
+                                                        GError            **error);
+static void     thunar_transfer_job_scan_file    (ThunarTransferJob      *job,
+                                                  GFile                  *file);
+static void     thunar_transfer_job_copy_node    (ThunarTransferJob      *job,
+                                                  ThunarJobOperation     *operation,
+                                                  ThunarTransferNode     *node,
+                                                  GFile                  *target_file,
+                                                  GFile                  *target_parent_file,
+                                                  GList                 **target_file_list_return,
+                                                  GError                **error);
 
 
 
@@ -87,11 +152,7 @@ struct _ThunarTransferJob
 
   ThunarTransferJobType   type;
   GList                  *source_node_list;
-  gchar                  *source_device_fs_id;
-  gboolean                is_source_device_local;
   GList                  *target_file_list;
-  gchar                  *target_device_fs_id;
-  gboolean                is_target_device_local;
 
   gint64                  start_time;              /* us(microseconds) */
   gint64                  last_update_time;        /* us */
@@ -100,6 +161,7 @@ struct _ThunarTransferJob
   guint64                 total_size;              /* byte */
   guint64                 total_progress;          /* byte */
   guint64                 file_progress;           /* byte */
+  guint64                 throttle_ahead;          /* byte, of the file charged to the limit */
   guint64                 transfer_rate;           /* byte/s */
 
   ThunarPreferences      *preferences;
@@ -107,6 +169,49 @@ struct _ThunarTransferJob
   ThunarParallelCopyMode  parallel_copy_mode;
   ThunarUsePartialMode    transfer_use_partial;
   ThunarVerifyFileMode    transfer_verify_file;
+  ThunarVerifyChecksum    transfer_verify_checksum;
+  gboolean                transfer_direct_io;
+  gboolean                transfer_preserve_links;
+
+  gint64                  verify_start_time;       /* us */
+  gint64                  verify_update_time;      /* us */
+
+  /* set when the scheduler runs the job next to others on its devices */
+  gint                    background;              /* atomic */
+
+  /* workers copying small files concurrently, see thunar_transfer_job_queue_task() */
+  GThreadPool            *worker_pool;
+  GAsyncQueue            *worker_results;
+  GHashTable             *worker_finished;         /* id -> task, out of order */
+  guint                   n_workers;
+  guint                   n_worker_tasks;          /* queued, running or out of order */
+  guint                   worker_next_id;
+  guint                   worker_collect_id;
+
+  /* sizes counted while copying, see thunar_transfer_job_start_scan() */
+  GThread                *scan_thread;
+  GCancellable           *scan_cancellable;
+  GList                  *scan_file_list;
+  GMutex                  scan_mutex;
+  GCond                   scan_cond;
+  guint64                 scan_size;               /* byte */
+  gint                    scan_running;            /* atomic */
+  gboolean                scan_verified;
+
+  /* progress of a copy, to continue it after an interruption */
+  ThunarTransferJournal  *journal;
+
+  /* limits set from the progress dialog, see thunar_transfer_job_throttle() */
+  GMutex                  throttle_mutex;
+  ThunarTransferBucket    byte_bucket;
+  ThunarTransferBucket    file_bucket;
+
+  /* conflicts resolved before copying, see thunar_transfer_job_check_conflicts() */
+  gboolean                check_conflicts;
+  GHashTable             *conflict_responses;
+
+  /* the copies of files with several links, see thunar_transfer_job_link_file() */
+  GHashTable             *link_targets;
 };
 
 struct _ThunarTransferNode
@@ -114,10 +219,29 @@ struct _ThunarTransferNode
   ThunarTransferNode *next;
   ThunarTransferNode *children;
   GFile              *source_file;
+  guint64             size;
+  GFileType           type;
+  guint32             n_links;
   gboolean            replace_confirmed;
   gboolean            rename_confirmed;
 };
 
+struct _ThunarTransferTask
+{
+  guint      id;           /* order of submission */
+  GFile     *source_file;
+  GFile     *target_file;
+  guint64    size;
+  GError    *error;
+
+  /* what the source is recorded with in the journal */
+  GFileInfo *source_info;
+};
+
+
+
+static guint transfer_job_signals[LAST_SIGNAL];
+
 
 
 G_DEFINE_TYPE (ThunarTransferJob, thunar_transfer_job, THUNAR_TYPE_JOB)
@@ -154,8 +278,8 @@ thunar_transfer_job_class_init (ThunarTransferJobClass *klass)
   /**
    * ThunarPropertiesDialog:parallel_copy_mode:
    *
-   * Whether to freeze this job if another job is transfering
-   * from the same device.
+   * Whether this job waits for other jobs transfering from or
+   * to the same devices, see thunar_transfer_scheduler_dequeue().
    **/
   g_object_class_install_property (gobject_class,
                                    PROP_PARALLEL_COPY_MODE,
@@ -193,6 +317,110 @@ thunar_transfer_job_class_init (ThunarTransferJobClass *klass)
                                                       THUNAR_TYPE_VERIFY_FILE_MODE,
                                                       THUNAR_VERIFY_FILE_MODE_DISABLED,
                                                       EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarPropertiesdialog:transfer_verify_checksum:
+   *
+   * The hash used to verify copied files
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_TRANSFER_VERIFY_CHECKSUM,
+                                   g_param_spec_enum ("transfer-verify-checksum",
+                                                      "TransferVerifyChecksum",
+                                                      NULL,
+                                                      THUNAR_TYPE_VERIFY_CHECKSUM,
+                                                      THUNAR_VERIFY_CHECKSUM_MD5,
+                                                      EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:transfer-direct-io:
+   *
+   * Whether large files are written with O_DIRECT, past the page cache.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_TRANSFER_DIRECT_IO,
+                                   g_param_spec_boolean ("transfer-direct-io",
+                                                         "TransferDirectIo",
+                                                         NULL,
+                                                         FALSE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:transfer-preserve-links:
+   *
+   * Whether files with several hard links are linked again in the
+   * destination instead of being copied once per link.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_TRANSFER_PRESERVE_LINKS,
+                                   g_param_spec_boolean ("transfer-preserve-links",
+                                                         "TransferPreserveLinks",
+                                                         NULL,
+                                                         TRUE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:max-byte-rate:
+   *
+   * The maximum number of bytes copied per second, or %0 for no
+   * limit. May be changed while the job is running.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_MAX_BYTE_RATE,
+                                   g_param_spec_uint64 ("max-byte-rate",
+                                                        "MaxByteRate",
+                                                        NULL,
+                                                        0, G_MAXUINT64, 0,
+                                                        EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:max-file-rate:
+   *
+   * The maximum number of files copied per second, or %0 for no
+   * limit. May be changed while the job is running.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_MAX_FILE_RATE,
+                                   g_param_spec_uint ("max-file-rate",
+                                                      "MaxFileRate",
+                                                      NULL,
+                                                      0, G_MAXUINT, 0,
+                                                      EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob:check-conflicts:
+   *
+   * Whether to look for existing files before copying, so all
+   * conflicts are resolved at once, see ThunarTransferJob::ask-conflicts.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_CHECK_CONFLICTS,
+                                   g_param_spec_boolean ("check-conflicts",
+                                                         "CheckConflicts",
+                                                         NULL,
+                                                         FALSE,
+                                                         EXO_PARAM_READWRITE));
+
+  /**
+   * ThunarTransferJob::ask-conflicts:
+   * @job       : a #ThunarTransferJob.
+   * @conflicts : a list of #ThunarTransferConflict<!---->s.
+   *
+   * Emitted before copying, with all the files that already exist
+   * in the destination. The handler sets the rule of each conflict;
+   * conflicts left at %THUNAR_CONFLICT_RULE_ASK are asked about
+   * while copying, like without this check.
+   *
+   * Return value: %THUNAR_JOB_RESPONSE_CANCEL to cancel the job.
+   **/
+  transfer_job_signals[ASK_CONFLICTS] =
+    g_signal_new (I_("ask-conflicts"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_NO_HOOKS | G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  _thunar_marshal_FLAGS__POINTER,
+                  THUNAR_TYPE_JOB_RESPONSE,
+                  1, G_TYPE_POINTER);
 }
 
 
@@ -213,14 +441,22 @@ thunar_transfer_job_init (ThunarTransferJob *job)
   g_object_bind_property (job->preferences, "misc-transfer-verify-file",
                           job,              "transfer-verify-file",
                           G_BINDING_SYNC_CREATE);
+  g_object_bind_property (job->preferences, "misc-transfer-verify-checksum",
+                          job,              "transfer-verify-checksum",
+                          G_BINDING_SYNC_CREATE);
+  g_object_bind_property (job->preferences, "misc-transfer-direct-io",
+                          job,              "transfer-direct-io",
+                          G_BINDING_SYNC_CREATE);
+  g_object_bind_property (job->preferences, "misc-transfer-preserve-links",
+                          job,              "transfer-preserve-links",
+                          G_BINDING_SYNC_CREATE);
+  g_object_bind_property (job->preferences, "misc-transfer-check-conflicts",
+                          job,              "check-conflicts",
+                          G_BINDING_SYNC_CREATE);
 
   job->type = 0;
   job->source_node_list = NULL;
-  job->source_device_fs_id = NULL;
-  job->is_source_device_local = FALSE;
   job->target_file_list = NULL;
-  job->target_device_fs_id = NULL;
-  job->is_target_device_local = FALSE;
   job->total_size = 0;
   job->total_progress = 0;
   job->file_progress = 0;
@@ -228,6 +464,28 @@ thunar_transfer_job_init (ThunarTransferJob *job)
   job->last_total_progress = 0;
   job->transfer_rate = 0;
   job->start_time = 0;
+  job->verify_start_time = 0;
+  job->verify_update_time = 0;
+  job->background = FALSE;
+  job->worker_pool = NULL;
+  job->worker_results = NULL;
+  job->worker_finished = NULL;
+  job->n_workers = 0;
+  job->n_worker_tasks = 0;
+  job->worker_next_id = 0;
+  job->worker_collect_id = 0;
+  job->scan_thread = NULL;
+  job->scan_cancellable = NULL;
+  job->scan_file_list = NULL;
+  job->scan_size = 0;
+  job->scan_running = FALSE;
+  job->scan_verified = FALSE;
+  job->journal = NULL;
+  job->conflict_responses = NULL;
+  job->link_targets = NULL;
+  g_mutex_init (&job->throttle_mutex);
+  g_mutex_init (&job->scan_mutex);
+  g_cond_init (&job->scan_cond);
 }
 
 
@@ -239,11 +497,18 @@ thunar_transfer_job_finalize (GObject *object)
 
   g_list_free_full (job->source_node_list, thunar_transfer_node_free);
 
-  g_free (job->source_device_fs_id);
-  g_free (job->target_device_fs_id);
-
   thunar_g_list_free_full (job->target_file_list);
 
+  if (job->conflict_responses != NULL)
+    g_hash_table_destroy (job->conflict_responses);
+
+  if (job->link_targets != NULL)
+    g_hash_table_destroy (job->link_targets);
+
+  g_mutex_clear (&job->scan_mutex);
+  g_cond_clear (&job->scan_cond);
+  g_mutex_clear (&job->throttle_mutex);
+
   g_object_unref (job->preferences);
 
   (*G_OBJECT_CLASS (thunar_transfer_job_parent_class)->finalize) (object);
@@ -251,6 +516,18 @@ thunar_transfer_job_finalize (GObject *object)
 
 
 
+static void
+thunar_transfer_job_set_rate (ThunarTransferJob    *job,
+                              ThunarTransferBucket *bucket,
+                              guint64               rate)
+{
+  g_mutex_lock (&job->throttle_mutex);
+  thunar_transfer_bucket_set_rate (bucket, rate, g_get_monotonic_time ());
+  g_mutex_unlock (&job->throttle_mutex);
+}
+
+
+
 static void
 thunar_transfer_job_get_property (GObject     *object,
                                   guint        prop_id,
@@ -273,6 +550,28 @@ thunar_transfer_job_get_property (GObject     *object,
     case PROP_TRANSFER_VERIFY_FILE:
       g_value_set_enum (value, job->transfer_verify_file);
       break;
+    case PROP_TRANSFER_VERIFY_CHECKSUM:
+      g_value_set_enum (value, job->transfer_verify_checksum);
+      break;
+    case PROP_TRANSFER_DIRECT_IO:
+      g_value_set_boolean (value, job->transfer_direct_io);
+      break;
+    case PROP_TRANSFER_PRESERVE_LINKS:
+      g_value_set_boolean (value, job->transfer_preserve_links);
+      break;
+    case PROP_MAX_BYTE_RATE:
+      g_mutex_lock (&job->throttle_mutex);
+      g_value_set_uint64 (value, job->byte_bucket.rate);
+      g_mutex_unlock (&job->throttle_mutex);
+      break;
+    case PROP_MAX_FILE_RATE:
+      g_mutex_lock (&job->throttle_mutex);
+      g_value_set_uint (value, job->file_bucket.rate);
+      g_mutex_unlock (&job->throttle_mutex);
+      break;
+    case PROP_CHECK_CONFLICTS:
+      g_value_set_boolean (value, job->check_conflicts);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -303,6 +602,24 @@ thunar_transfer_job_set_property (GObject      *object,
     case PROP_TRANSFER_VERIFY_FILE:
       job->transfer_verify_file = g_value_get_enum (value);
       break;
+    case PROP_TRANSFER_VERIFY_CHECKSUM:
+      job->transfer_verify_checksum = g_value_get_enum (value);
+      break;
+    case PROP_TRANSFER_DIRECT_IO:
+      job->transfer_direct_io = g_value_get_boolean (value);
+      break;
+    case PROP_TRANSFER_PRESERVE_LINKS:
+      job->transfer_preserve_links = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_BYTE_RATE:
+      thunar_transfer_job_set_rate (job, &job->byte_bucket, g_value_get_uint64 (value));
+      break;
+    case PROP_MAX_FILE_RATE:
+      thunar_transfer_job_set_rate (job, &job->file_bucket, g_value_get_uint (value));
+      break;
+    case PROP_CHECK_CONFLICTS:
+      job->check_conflicts = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -323,6 +640,68 @@ thunar_transfer_job_check_pause (ThunarTransferJob *job)
 
 
 
+/**
+ * thunar_transfer_job_throttle:
+ * @job    : a #ThunarTransferJob.
+ * @bucket : the byte or file bucket of @job.
+ * @amount : the bytes or files about to be copied.
+ *
+ * Enforces the rate limits of @job: @amount is taken from @bucket, and
+ * if that empties it, the calling thread waits until it is refilled.
+ * May be called from the copy workers.
+ **/
+static void
+thunar_transfer_job_throttle (ThunarTransferJob    *job,
+                              ThunarTransferBucket *bucket,
+                              guint64               amount)
+{
+  gint64 delay;
+
+  g_mutex_lock (&job->throttle_mutex);
+
+  thunar_transfer_bucket_take (bucket, amount);
+
+  while (!exo_job_is_cancelled (EXO_JOB (job))
+         && (delay = thunar_transfer_bucket_get_delay (bucket, g_get_monotonic_time ())) > 0)
+    {
+      /* wait in steps, the limit may be lifted in the meantime */
+      g_mutex_unlock (&job->throttle_mutex);
+      g_usleep (CLAMP (delay, 1000, MAXIMUM_THROTTLE_DELAY));
+      thunar_transfer_job_check_pause (job);
+      g_mutex_lock (&job->throttle_mutex);
+    }
+
+  g_mutex_unlock (&job->throttle_mutex);
+}
+
+
+
+/**
+ * thunar_transfer_job_throttle_chunk:
+ * @job    : a #ThunarTransferJob.
+ * @copied : the bytes of the current file copied so far.
+ * @size   : the size of the current file.
+ *
+ * Charges the next chunk of the current file to the byte limit before
+ * it is copied, so a copy never runs a whole chunk ahead of the limit.
+ **/
+static void
+thunar_transfer_job_throttle_chunk (ThunarTransferJob *job,
+                                    guint64            copied,
+                                    guint64            size)
+{
+  guint64 ahead;
+
+  ahead = MIN (copied + THUNAR_IO_COPY_CHUNK_SIZE, MAX (size, copied));
+  if (ahead > job->throttle_ahead)
+    {
+      thunar_transfer_job_throttle (job, &job->byte_bucket, ahead - job->throttle_ahead);
+      job->throttle_ahead = ahead;
+    }
+}
+
+
+
 static void
 thunar_transfer_job_progress (goffset  current_num_bytes,
                               goffset  total_num_bytes,
@@ -338,6 +717,14 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
 
   thunar_transfer_job_check_pause (job);
 
+  /* take the size counted so far, see thunar_transfer_job_start_scan() */
+  if (job->scan_thread != NULL)
+    {
+      g_mutex_lock (&job->scan_mutex);
+      job->total_size = job->scan_size;
+      g_mutex_unlock (&job->scan_mutex);
+    }
+
   if (G_LIKELY (job->total_size > 0))
     {
       /* update total progress */
@@ -346,8 +733,9 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
       /* update file progress */
       job->file_progress = current_num_bytes;
 
-      /* compute the new percentage after the progress we've made */
-      new_percentage = (job->total_progress * 100.0) / job->total_size;
+      /* compute the new percentage after the progress we've made, the
+       * copy may be ahead of the counting */
+      new_percentage = MIN ((job->total_progress * 100.0) / job->total_size, 100);
 
       /* get current time */
       current_time = g_get_real_time ();
@@ -381,16 +769,130 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
 
 
 
+static void
+thunar_transfer_job_copy_progress (goffset  current_num_bytes,
+                                   goffset  total_num_bytes,
+                                   gpointer user_data)
+{
+  ThunarTransferJob *job = user_data;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  /* wait before the next chunk is copied */
+  thunar_transfer_job_throttle_chunk (job, current_num_bytes, total_num_bytes);
+
+  thunar_transfer_job_progress (current_num_bytes, total_num_bytes, user_data);
+}
+
+
+
+static void
+thunar_transfer_job_verify_progress (goffset  current_num_bytes,
+                                     goffset  total_num_bytes,
+                                     gpointer user_data)
+{
+  ThunarTransferJob *job = user_data;
+  gint64             current_time;
+  gint64             expired_time;
+  guint64            hash_rate;
+  gchar             *hash_rate_str;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  thunar_transfer_job_check_pause (job);
+
+  /* notify callers not more then every 500ms */
+  current_time = g_get_real_time ();
+  if (current_time - job->verify_update_time < (500 * 1000))
+    return;
+
+  expired_time = current_time - job->verify_start_time;
+  if (expired_time <= 0)
+    return;
+
+  /* show the hashing throughput, the transfer rate is about the copying */
+  hash_rate = current_num_bytes / ((gfloat) expired_time / G_USEC_PER_SEC);
+  hash_rate_str = g_format_size_full (hash_rate, job->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
+  exo_job_info_message (EXO_JOB (job), _("Comparing checksums (%s/sec)..."), hash_rate_str);
+  g_free (hash_rate_str);
+
+  job->verify_update_time = current_time;
+}
+
+
+
+static gboolean
+thunar_transfer_job_collect_children (ThunarTransferJob  *job,
+                                      ThunarTransferNode *node,
+                                      gboolean            recursive,
+                                      GError            **error)
+{
+  ThunarTransferNode *child_node;
+  GError             *err = NULL;
+  GList              *file_list;
+  GList              *lp;
+
+  /* scan the directory for immediate children */
+  file_list = thunar_io_scan_directory (THUNAR_JOB (job), node->source_file,
+                                        G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                        FALSE, FALSE, FALSE, &err);
+
+  /* add children to the transfer node */
+  for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
+    {
+      thunar_transfer_job_check_pause (job);
+
+      /* allocate a new transfer node for the child */
+      child_node = g_slice_new0 (ThunarTransferNode);
+      child_node->source_file = g_object_ref (lp->data);
+      child_node->replace_confirmed = node->replace_confirmed;
+      child_node->rename_confirmed = FALSE;
+
+      /* hook the child node into the child list */
+      child_node->next = node->children;
+      node->children = child_node;
+
+      /* collect the child node */
+      thunar_transfer_job_collect_node (job, child_node, recursive, &err);
+    }
+
+  /* release the child files */
+  thunar_g_list_free_full (file_list);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_transfer_job_collect_node:
+ * @job       : a #ThunarTransferJob.
+ * @node      : the #ThunarTransferNode to collect.
+ * @recursive : whether to collect the whole tree below @node.
+ * @error     : return location for errors or %NULL.
+ *
+ * Queries the size and type of @node. If @recursive is %TRUE, the
+ * children of folders are collected as well and all sizes are added
+ * to the total size of @job. Otherwise the children are collected
+ * when the folder is copied, and the sizes are counted in the
+ * background, see thunar_transfer_job_start_scan().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ **/
 static gboolean
 thunar_transfer_job_collect_node (ThunarTransferJob  *job,
                                   ThunarTransferNode *node,
+                                  gboolean            recursive,
                                   GError            **error)
 {
-  ThunarTransferNode *child_node;
   GFileInfo          *info;
   GError             *err = NULL;
-  GList              *file_list;
-  GList              *lp;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
   _thunar_return_val_if_fail (node != NULL && G_IS_FILE (node->source_file), FALSE);
@@ -401,7 +903,8 @@ thunar_transfer_job_collect_node (ThunarTransferJob  *job,
 
   info = g_file_query_info (node->source_file,
                             G_FILE_ATTRIBUTE_STANDARD_SIZE ","
-                            G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                            G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                            G_FILE_ATTRIBUTE_UNIX_NLINK,
                             G_FILE_QUERY_INFO_NONE,
                             exo_job_get_cancellable (EXO_JOB (job)),
                             &err);
@@ -422,38 +925,17 @@ thunar_transfer_job_collect_node (ThunarTransferJob  *job,
         return FALSE;
     }
 
-  job->total_size += g_file_info_get_size (info);
-
-  /* check if we have a directory here */
-  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
-    {
-      /* scan the directory for immediate children */
-      file_list = thunar_io_scan_directory (THUNAR_JOB (job), node->source_file,
-                                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                            FALSE, FALSE, FALSE, &err);
-
-      /* add children to the transfer node */
-      for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
-        {
-          thunar_transfer_job_check_pause (job);
-
-          /* allocate a new transfer node for the child */
-          child_node = g_slice_new0 (ThunarTransferNode);
-          child_node->source_file = g_object_ref (lp->data);
-          child_node->replace_confirmed = node->replace_confirmed;
-          child_node->rename_confirmed = FALSE;
+  if (recursive)
+    job->total_size += g_file_info_get_size (info);
 
-          /* hook the child node into the child list */
-          child_node->next = node->children;
-          node->children = child_node;
-
-          /* collect the child node */
-          thunar_transfer_job_collect_node (job, child_node, &err);
-        }
+  /* remember what the copy workers need to know about the node */
+  node->size = g_file_info_get_size (info);
+  node->type = g_file_info_get_file_type (info);
+  node->n_links = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_NLINK);
 
-      /* release the child files */
-      thunar_g_list_free_full (file_list);
-    }
+  /* check if we have a directory here */
+  if (recursive && g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+    thunar_transfer_job_collect_children (job, node, TRUE, &err);
 
   /* release file info */
   g_object_unref (info);
@@ -469,76 +951,270 @@ thunar_transfer_job_collect_node (ThunarTransferJob  *job,
 
 
 
-static gboolean
-ttj_copy_file (ThunarTransferJob  *job,
-               ThunarJobOperation *operation,
-               GFile              *source_file,
-               GFile              *target_file,
-               GFileCopyFlags      copy_flags,
-               GError            **error)
+static void
+thunar_transfer_job_journal_begin (ThunarTransferJob *job,
+                                   GFile             *source_file,
+                                   GFile             *target_file)
 {
   GFileInfo *info;
-  GFileType  source_type;
-  GFileType  target_type;
-  gboolean   target_exists;
-  gboolean   use_partial;
-  gboolean   verify_file;
-  gboolean   add_to_operation = TRUE;
-  GError    *err = NULL;
-
-  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
-  _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
-  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-  /* reset the file progress */
-  job->file_progress = 0;
+  /* without the source, the copy is simply not continued */
+  info = g_file_query_info (source_file, THUNAR_TRANSFER_JOURNAL_ATTRIBUTES,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            exo_job_get_cancellable (EXO_JOB (job)), NULL);
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return FALSE;
-  thunar_transfer_job_check_pause (job);
+  thunar_transfer_journal_begin (job->journal, target_file, info);
+  if (info != NULL)
+    g_object_unref (info);
+}
 
-  source_type = g_file_query_file_type (source_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                        exo_job_get_cancellable (EXO_JOB (job)));
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return FALSE;
-  thunar_transfer_job_check_pause (job);
 
-  target_type = g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                        exo_job_get_cancellable (EXO_JOB (job)));
+static goffset
+thunar_transfer_job_get_resume_offset (ThunarTransferJob *job,
+                                       GFile             *source_file,
+                                       GFile             *target_file)
+{
+  GFileInfo *source_info = NULL;
+  GFileInfo *target_info = NULL;
+  goffset    offset = -1;
+
+  if (job->journal == NULL || !thunar_transfer_journal_is_resumed (job->journal))
+    return -1;
+
+  source_info = g_file_query_info (source_file,
+                                   G_FILE_ATTRIBUTE_STANDARD_TYPE "," THUNAR_TRANSFER_JOURNAL_ATTRIBUTES,
+                                   G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                   exo_job_get_cancellable (EXO_JOB (job)), NULL);
+
+  /* only files this copy left behind of a source that did not change
+   * since, everything else goes through the conflict handling */
+  if (source_info == NULL
+      || g_file_info_get_file_type (source_info) != G_FILE_TYPE_REGULAR
+      || !thunar_transfer_journal_is_partial (job->journal, target_file, source_info))
+    {
+      g_clear_object (&source_info);
+      return -1;
+    }
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return FALSE;
-  thunar_transfer_job_check_pause (job);
+  target_info = g_file_query_info (target_file,
+                                   G_FILE_ATTRIBUTE_STANDARD_TYPE "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                   G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                   exo_job_get_cancellable (EXO_JOB (job)), NULL);
 
-  /* check if the target is a symlink and we are in overwrite mode */
-  if (target_type == G_FILE_TYPE_SYMBOLIC_LINK && (copy_flags & G_FILE_COPY_OVERWRITE) != 0)
+  if (target_info != NULL && g_file_info_get_file_type (target_info) == G_FILE_TYPE_REGULAR)
     {
-      /* try to delete the symlink */
-      if (!g_file_delete (target_file, exo_job_get_cancellable (EXO_JOB (job)), &err))
+      /* continue where the copy stopped, other file systems
+       * can't write at an offset, so they copy it again */
+      if (g_file_is_native (target_file))
         {
-          g_propagate_error (error, err);
-          return FALSE;
+          offset = MIN (g_file_info_get_size (target_info), g_file_info_get_size (source_info));
+          offset -= offset % RESUME_BLOCK_SIZE;
+        }
+      else
+        {
+          offset = 0;
         }
     }
 
-  switch (job->transfer_use_partial)
-    {
-    case THUNAR_USE_PARTIAL_MODE_REMOTE_ONLY:
-      use_partial = !g_file_is_native (source_file) || !g_file_is_native (target_file);
-      break;
-    case THUNAR_USE_PARTIAL_MODE_ALWAYS:
-      use_partial = TRUE;
-      break;
-    default:
-      use_partial = FALSE;
-    }
+  g_clear_object (&source_info);
+  g_clear_object (&target_info);
 
-  /* try to copy the file */
-  thunar_g_file_copy (source_file, target_file, copy_flags, use_partial,
-                      exo_job_get_cancellable (EXO_JOB (job)),
-                      thunar_transfer_job_progress, job, &err);
+  return offset;
+}
+
+
+
+/**
+ * thunar_transfer_job_link_file:
+ * @job            : a #ThunarTransferJob.
+ * @source_file    : the regular #GFile to copy.
+ * @target_file    : the #GFile to create.
+ * @copy_flags     : the #GFileCopyFlags of the copy.
+ * @link_id_return : return location for the key of @source_file.
+ * @error          : return location for errors or %NULL.
+ *
+ * If @source_file is one of several hard links to the same data and
+ * another one was copied before, @target_file is created as a link to
+ * that copy instead, so the data is neither copied nor stored again.
+ *
+ * If @source_file has several links but none was copied yet, its
+ * (device, inode) key is returned in @link_id_return, to remember
+ * the copy under once it succeeded. It is %NULL otherwise.
+ *
+ * Return value: %TRUE if @target_file was linked, %FALSE if it has
+ *               to be copied or on error.
+ **/
+static gboolean
+thunar_transfer_job_link_file (ThunarTransferJob *job,
+                               GFile             *source_file,
+                               GFile             *target_file,
+                               GFileCopyFlags     copy_flags,
+                               gchar            **link_id_return,
+                               GError           **error)
+{
+  GCancellable *cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  GFileInfo    *info;
+  GFile        *link_target = NULL;
+  GError       *err = NULL;
+  gboolean      linked;
+  gchar        *link_id;
+  goffset       size;
+
+  *link_id_return = NULL;
+
+  /* links only exist within a local file system */
+  if (!g_file_is_native (source_file) || !g_file_is_native (target_file))
+    return FALSE;
+
+  info = g_file_query_info (source_file, LINK_ATTRIBUTES,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            cancellable, NULL);
+  if (info == NULL)
+    return FALSE;
+
+  if (g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_NLINK) < 2)
+    {
+      g_object_unref (info);
+      return FALSE;
+    }
+
+  link_id = g_strdup_printf ("%u:%" G_GUINT64_FORMAT,
+                             g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE),
+                             g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE));
+  size = g_file_info_get_size (info);
+  g_object_unref (info);
+
+  if (job->link_targets != NULL)
+    link_target = g_hash_table_lookup (job->link_targets, link_id);
+
+  /* the first of the links is copied */
+  if (link_target == NULL || g_file_equal (link_target, target_file))
+    {
+      *link_id_return = link_id;
+      return FALSE;
+    }
+  g_free (link_id);
+
+  linked = thunar_g_file_make_hard_link (target_file, link_target, &err);
+
+  if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_EXISTS))
+    {
+      /* the user is asked about conflicts like for copies, and
+       * directories are left to the copy to fail on as usual */
+      if ((copy_flags & G_FILE_COPY_OVERWRITE) == 0)
+        {
+          g_propagate_error (error, err);
+          return FALSE;
+        }
+
+      if (g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                  cancellable) != G_FILE_TYPE_DIRECTORY)
+        {
+          g_clear_error (&err);
+          if (!g_file_delete (target_file, cancellable, &err))
+            {
+              g_propagate_error (error, err);
+              return FALSE;
+            }
+
+          linked = thunar_g_file_make_hard_link (target_file, link_target, NULL);
+        }
+    }
+
+  /* other file systems, too many links and the like: copy the file */
+  g_clear_error (&err);
+
+  /* account the file like a copy, without throttling it */
+  if (linked)
+    thunar_transfer_job_progress (size, size, job);
+
+  return linked;
+}
+
+
+
+static gboolean
+ttj_copy_file (ThunarTransferJob  *job,
+               ThunarJobOperation *operation,
+               GFile              *source_file,
+               GFile              *target_file,
+               GFileCopyFlags      copy_flags,
+               GError            **error)
+{
+  GFileInfo *info;
+  GFileType  source_type = G_FILE_TYPE_UNKNOWN;
+  GFileType  target_type;
+  guint64    source_size = 0;
+  gboolean   target_exists;
+  gboolean   use_partial;
+  gboolean   verify_file;
+  gboolean   add_to_operation = TRUE;
+  gboolean   linked = FALSE;
+  goffset    resume_offset = -1;
+  gchar     *checksum = NULL;
+  gchar     *link_id = NULL;
+  GError    *err = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* reset the file progress */
+  job->file_progress = 0;
+  job->throttle_ahead = 0;
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return FALSE;
+  thunar_transfer_job_check_pause (job);
+
+  /* the size bounds what is charged to the limit before copying */
+  info = g_file_query_info (source_file,
+                            G_FILE_ATTRIBUTE_STANDARD_TYPE "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            exo_job_get_cancellable (EXO_JOB (job)), NULL);
+  if (info != NULL)
+    {
+      source_type = g_file_info_get_file_type (info);
+      if (source_type == G_FILE_TYPE_REGULAR)
+        source_size = g_file_info_get_size (info);
+      g_object_unref (info);
+    }
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return FALSE;
+  thunar_transfer_job_check_pause (job);
+
+  target_type = g_file_query_file_type (target_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                        exo_job_get_cancellable (EXO_JOB (job)));
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return FALSE;
+  thunar_transfer_job_check_pause (job);
+
+  /* check if the target is a symlink and we are in overwrite mode */
+  if (target_type == G_FILE_TYPE_SYMBOLIC_LINK && (copy_flags & G_FILE_COPY_OVERWRITE) != 0)
+    {
+      /* try to delete the symlink */
+      if (!g_file_delete (target_file, exo_job_get_cancellable (EXO_JOB (job)), &err))
+        {
+          g_propagate_error (error, err);
+          return FALSE;
+        }
+    }
+
+  switch (job->transfer_use_partial)
+    {
+    case THUNAR_USE_PARTIAL_MODE_REMOTE_ONLY:
+      use_partial = !g_file_is_native (source_file) || !g_file_is_native (target_file);
+      break;
+    case THUNAR_USE_PARTIAL_MODE_ALWAYS:
+      use_partial = TRUE;
+      break;
+    default:
+      use_partial = FALSE;
+    }
 
   switch (job->transfer_verify_file)
     {
@@ -552,15 +1228,61 @@ ttj_copy_file (ThunarTransferJob  *job,
       verify_file = FALSE;
     }
 
-  /* Only verify when the file is a regular file */
-  verify_file = verify_file && (g_file_query_file_type (source_file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, exo_job_get_cancellable (EXO_JOB (job))) == G_FILE_TYPE_REGULAR);
+  /* partial copies are written to the target directly */
+  if (!use_partial)
+    resume_offset = thunar_transfer_job_get_resume_offset (job, source_file, target_file);
+
+  /* partial copies not worth continuing are simply replaced */
+  if (resume_offset == 0)
+    copy_flags |= G_FILE_COPY_OVERWRITE;
+
+  /* files with several links are copied once, and linked to that copy then */
+  if (resume_offset <= 0 && source_type == G_FILE_TYPE_REGULAR && job->transfer_preserve_links)
+    linked = thunar_transfer_job_link_file (job, source_file, target_file, copy_flags, &link_id, &err);
+
+  if (resume_offset > 0)
+    {
+      /* account the data copied before, without throttling it */
+      thunar_transfer_job_progress (resume_offset, resume_offset, job);
+      job->throttle_ahead = resume_offset;
+      thunar_transfer_job_throttle_chunk (job, resume_offset, source_size);
+
+      /* continue the copy interrupted before */
+      thunar_io_copy_file_resume (source_file, target_file, resume_offset, copy_flags,
+                                  (GChecksumType) job->transfer_verify_checksum,
+                                  exo_job_get_cancellable (EXO_JOB (job)),
+                                  thunar_transfer_job_copy_progress, job,
+                                  verify_file ? &checksum : NULL, &err);
+    }
+  else if (!linked && err == NULL)
+    {
+      /* record which files are written, existing targets are not unless replaced */
+      if (job->journal != NULL && source_type == G_FILE_TYPE_REGULAR
+          && (target_type == G_FILE_TYPE_UNKNOWN || (copy_flags & G_FILE_COPY_OVERWRITE) != 0))
+        thunar_transfer_job_journal_begin (job, source_file, target_file);
+
+      /* wait before the first chunk is copied */
+      thunar_transfer_job_throttle_chunk (job, 0, source_size);
+
+      /* try to copy the file, regular files to verify are hashed while copying */
+      thunar_g_file_copy (source_file, target_file, copy_flags, use_partial,
+                          job->transfer_direct_io,
+                          (GChecksumType) job->transfer_verify_checksum,
+                          verify_file ? &checksum : NULL,
+                          exo_job_get_cancellable (EXO_JOB (job)),
+                          thunar_transfer_job_copy_progress, job, &err);
+    }
 
-  if (verify_file && err == NULL)
+  if (checksum != NULL && err == NULL)
     {
       gboolean is_equal;
       exo_job_info_message (EXO_JOB (job), _("Comparing checksums..."));
-      is_equal = thunar_g_file_compare_checksum (source_file, target_file,
-                                                 exo_job_get_cancellable (EXO_JOB (job)), &err);
+      job->verify_start_time = g_get_real_time ();
+      job->verify_update_time = job->verify_start_time;
+      is_equal = thunar_g_file_compare_checksum (target_file, checksum,
+                                                 (GChecksumType) job->transfer_verify_checksum,
+                                                 exo_job_get_cancellable (EXO_JOB (job)),
+                                                 thunar_transfer_job_verify_progress, job, &err);
 
       /* if the copied file is corrupted and yet no error*/
       if (!is_equal && err == NULL)
@@ -570,6 +1292,19 @@ ttj_copy_file (ThunarTransferJob  *job,
                              "Copied file does not match with the original");
         }
     }
+  g_free (checksum);
+
+  /* remember the copy, to link the other names of the file to it */
+  if (link_id != NULL && err == NULL)
+    {
+      if (job->link_targets == NULL)
+        job->link_targets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+      g_hash_table_insert (job->link_targets, link_id, g_object_ref (target_file));
+    }
+  else
+    {
+      g_free (link_id);
+    }
 
   /**
    * MR !127 notes:
@@ -677,148 +1412,971 @@ ttj_copy_file (ThunarTransferJob  *job,
 
           thunar_job_operation_add (operation, source_file, target_file);
         }
-      return TRUE;
+      return TRUE;
+    }
+}
+
+
+
+/**
+ * thunar_transfer_job_copy_file:
+ * @job                : a #ThunarTransferJob.
+ * @source_file        : the source #GFile to copy.
+ * @target_file        : the destination #GFile to copy to.
+ * @replace_confirmed  : whether the user has already confirmed that this file should replace an existing one
+ * @rename_confirmed   : whether the user has already confirmed that this file should be renamed to a new unique file name
+ * @error              : return location for errors or %NULL.
+ *
+ * Tries to copy @source_file to @target_file. The real destination is the
+ * return value and may differ from @target_file (e.g. if you try to copy
+ * the file "/foo/bar" into the same directory you'll end up with something
+ * like "/foo/copy of bar" instead of "/foo/bar"). If an existing file would
+ * be replaced, the user is asked to confirm replace or rename it unless
+ * @replace_confirmed or @rename_confirmed is TRUE.
+ *
+ * The return value is guaranteed to be %NULL on errors and @error will
+ * always be set in those cases. If the file is skipped, the return value
+ * will be @source_file.
+ *
+ * Return value: the destination #GFile to which @source_file was copied
+ *               or linked. The caller is reposible to release it with
+ *               g_object_unref() if no longer needed. It points to
+ *               @source_file if the file was skipped and will be %NULL
+ *               on error or cancellation.
+ **/
+static ThunarJobResponse
+thunar_transfer_job_get_conflict_response (ThunarTransferJob *job,
+                                           GFile             *target_file)
+{
+  if (job->conflict_responses == NULL)
+    return 0;
+
+  return GPOINTER_TO_UINT (g_hash_table_lookup (job->conflict_responses, target_file));
+}
+
+
+
+static GFile *
+thunar_transfer_job_copy_file (ThunarTransferJob     *job,
+                               ThunarJobOperation    *operation,
+                               GFile                 *source_file,
+                               GFile                 *target_file,
+                               gboolean               replace_confirmed,
+                               gboolean               rename_confirmed,
+                               GError               **error)
+{
+  ThunarJobResponse response;
+  GFile            *dest_file = target_file;
+  GFileCopyFlags    copy_flags = G_FILE_COPY_NONE;
+  GError           *err = NULL;
+  gint              n_rename = 0;
+  GFileType         source_type;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (source_file), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  /* abort on cancellation */
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return NULL;
+  thunar_transfer_job_check_pause (job);
+
+  source_type = g_file_query_file_type (source_file, G_FILE_QUERY_INFO_NONE,
+                                        exo_job_get_cancellable (EXO_JOB (job)));
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return NULL;
+  if (source_type != G_FILE_TYPE_REGULAR)
+    copy_flags |= G_FILE_COPY_NOFOLLOW_SYMLINKS;
+
+  /* various attempts to copy the file */
+  while (err == NULL)
+    {
+      GFile *target;
+
+      thunar_transfer_job_check_pause (job);
+
+      if (G_LIKELY (!g_file_equal (source_file, dest_file)))
+        target = g_object_ref (dest_file);
+      else
+        target = thunar_io_jobs_util_next_duplicate_file (THUNAR_JOB (job), source_file, THUNAR_NEXT_FILE_NAME_MODE_COPY, &err);
+
+      if (err == NULL)
+        {
+          /* try to copy the file from source file to the duplicate file */
+          if (ttj_copy_file (job, operation, source_file, target, copy_flags, &err))
+            return target;
+          else /* go to error case */
+            g_object_unref (target);
+        }
+
+      /* check if we can recover from this error */
+      if (err->domain == G_IO_ERROR && err->code == G_IO_ERROR_EXISTS)
+        {
+          /* reset the error */
+          g_clear_error (&err);
+
+          /* if necessary, ask the user whether to replace or rename the target file,
+           * unless that was decided for all conflicts before copying */
+          if (replace_confirmed)
+            response = THUNAR_JOB_RESPONSE_REPLACE;
+          else if (rename_confirmed)
+            response = THUNAR_JOB_RESPONSE_RENAME;
+          else
+            {
+              response = thunar_transfer_job_get_conflict_response (job, dest_file);
+              if (response == 0)
+                response = thunar_job_ask_replace (THUNAR_JOB (job), source_file,
+                                                   dest_file, &err);
+            }
+
+          if (err != NULL)
+            break;
+
+          /* add overwrite flag and retry if we should overwrite */
+          if (response == THUNAR_JOB_RESPONSE_REPLACE)
+            {
+              replace_confirmed = TRUE;
+              copy_flags |= G_FILE_COPY_OVERWRITE;
+              continue;
+            }
+          else if (response == THUNAR_JOB_RESPONSE_RENAME)
+            {
+              GFile *renamed_file;
+              renamed_file = thunar_io_jobs_util_next_renamed_file (THUNAR_JOB (job),
+                                                                    source_file,
+                                                                    dest_file,
+                                                                    ++n_rename, &err);
+              if (renamed_file != NULL)
+                {
+                  if (err != NULL)
+                    g_object_unref (renamed_file);
+                  else
+                    {
+                      dest_file = renamed_file;
+                      rename_confirmed = TRUE;
+                    }
+                }
+            }
+
+          /* tell the caller we skipped the file if the user
+           * doesn't want to retry/overwrite */
+          if (response == THUNAR_JOB_RESPONSE_SKIP)
+            return g_object_ref (source_file);
+        }
+    }
+
+  _thunar_assert (err != NULL);
+
+  g_propagate_error (error, err);
+  return NULL;
+}
+
+
+
+static guint
+thunar_transfer_job_count_workers (ThunarTransferJob *job)
+{
+  ThunarTransferNode *node;
+  GFile              *target_parent;
+  guint               n_workers;
+
+  if (job->type != THUNAR_TRANSFER_JOB_COPY
+      || job->source_node_list == NULL
+      || job->target_file_list == NULL)
+    return 0;
+
+  /* like the transfer scheduler, look at the first source and target */
+  node = job->source_node_list->data;
+  target_parent = g_file_get_parent (job->target_file_list->data);
+  if (G_UNLIKELY (target_parent == NULL))
+    return 0;
+
+  if (!g_file_is_native (node->source_file) || !g_file_is_native (target_parent))
+    {
+      /* gvfs handles the requests of a mount one after another anyway */
+      n_workers = 0;
+    }
+  else if (!thunar_g_file_is_on_local_device (node->source_file)
+           || !thunar_g_file_is_on_local_device (target_parent))
+    {
+      /* removable and network devices: hide the round trips, but don't flood them */
+      n_workers = 4;
+    }
+  else if (thunar_transfer_scheduler_is_rotational (node->source_file)
+           || thunar_transfer_scheduler_is_rotational (target_parent))
+    {
+      /* spinning disks lose more to seeking than they gain from concurrency */
+      n_workers = 2;
+    }
+  else
+    {
+      n_workers = CLAMP (g_get_num_processors (), 4, 16);
+    }
+
+  g_object_unref (target_parent);
+
+  return n_workers;
+}
+
+
+
+static void
+thunar_transfer_task_free (ThunarTransferTask *task)
+{
+  g_object_unref (task->source_file);
+  g_object_unref (task->target_file);
+  g_object_unref (task->source_info);
+  if (task->error != NULL)
+    g_error_free (task->error);
+  g_slice_free (ThunarTransferTask, task);
+}
+
+
+
+static void
+thunar_transfer_job_worker (gpointer data,
+                            gpointer user_data)
+{
+  ThunarTransferTask *task = data;
+  ThunarTransferJob  *job = THUNAR_TRANSFER_JOB (user_data);
+  GCancellable       *cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  gboolean            use_partial;
+  gboolean            verify_file;
+  gchar              *checksum = NULL;
+  gint                io_priority = -1;
+
+  thunar_transfer_job_check_pause (job);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, &task->error))
+    {
+      g_async_queue_push (job->worker_results, task);
+      return;
+    }
+
+  /* conflicts are resolved by the job itself, where the user can be asked */
+  if (g_file_query_exists (task->target_file, cancellable))
+    {
+      g_set_error_literal (&task->error, G_IO_ERROR, G_IO_ERROR_EXISTS, "Target file exists");
+      g_async_queue_push (job->worker_results, task);
+      return;
+    }
+
+  /* the pool threads are shared, so the priority only holds for this copy */
+  if (g_atomic_int_get (&job->background))
+    io_priority = thunar_transfer_scheduler_lower_io_priority ();
+
+  thunar_transfer_job_throttle (job, &job->byte_bucket, task->size);
+
+  if (job->journal != NULL)
+    thunar_transfer_journal_begin (job->journal, task->target_file, task->source_info);
+
+  /* workers only copy between native files, see thunar_transfer_job_count_workers() */
+  use_partial = (job->transfer_use_partial == THUNAR_USE_PARTIAL_MODE_ALWAYS);
+  verify_file = (job->transfer_verify_file == THUNAR_VERIFY_FILE_MODE_ALWAYS);
+
+  /* workers only get small files, which never bypass the page cache */
+  thunar_g_file_copy (task->source_file, task->target_file, G_FILE_COPY_NONE, use_partial, FALSE,
+                      (GChecksumType) job->transfer_verify_checksum, verify_file ? &checksum : NULL,
+                      cancellable, NULL, NULL, &task->error);
+
+  if (checksum != NULL && task->error == NULL
+      && !thunar_g_file_compare_checksum (task->target_file, checksum,
+                                          (GChecksumType) job->transfer_verify_checksum,
+                                          cancellable, NULL, NULL, &task->error)
+      && task->error == NULL)
+    {
+      task->error = g_error_new (G_FILE_ERROR,
+                                 G_FILE_ERROR_AGAIN,
+                                 "Copied file does not match with the original");
+    }
+  g_free (checksum);
+
+  /* the target did not exist before, so don't leave a broken copy behind
+   * when the job copies the file again */
+  if (task->error != NULL && !g_error_matches (task->error, G_IO_ERROR, G_IO_ERROR_EXISTS))
+    g_file_delete (task->target_file, NULL, NULL);
+
+  thunar_transfer_scheduler_restore_io_priority (io_priority);
+
+  g_async_queue_push (job->worker_results, task);
+}
+
+
+
+static void
+thunar_transfer_job_start_workers (ThunarTransferJob *job)
+{
+  _thunar_return_if_fail (job->worker_pool == NULL);
+
+  job->n_workers = thunar_transfer_job_count_workers (job);
+  if (job->n_workers < 2)
+    return;
+
+  job->worker_results = g_async_queue_new ();
+  job->worker_pool = g_thread_pool_new (thunar_transfer_job_worker, job,
+                                        job->n_workers, FALSE, NULL);
+  if (G_UNLIKELY (job->worker_pool == NULL))
+    {
+      g_clear_pointer (&job->worker_results, g_async_queue_unref);
+      return;
+    }
+
+  job->worker_finished = g_hash_table_new (g_direct_hash, g_direct_equal);
+  job->worker_next_id = 0;
+  job->worker_collect_id = 0;
+}
+
+
+
+static void
+thunar_transfer_job_finish_task (ThunarTransferJob    *job,
+                                 ThunarJobOperation   *operation,
+                                 ThunarTransferTask   *task,
+                                 ThunarThumbnailCache *thumbnail_cache,
+                                 GError              **error)
+{
+  ThunarTransferNode *node;
+
+  if (G_LIKELY (task->error == NULL))
+    {
+      /* account the whole file at once, the workers don't report progress */
+      job->file_progress = 0;
+      thunar_transfer_job_progress (task->size, task->size, job);
+      job->file_progress = 0;
+
+      thunar_thumbnail_cache_copy_file (thumbnail_cache, task->source_file, task->target_file);
+
+      if (job->journal != NULL)
+        thunar_transfer_journal_done (job->journal, task->target_file, task->source_info);
+
+      if (thunar_job_get_log_mode (THUNAR_JOB (job)) == THUNAR_OPERATION_LOG_OPERATIONS)
+        thunar_job_operation_add (operation, task->source_file, task->target_file);
+
+      return;
+    }
+
+  if (g_error_matches (task->error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_propagate_error (error, g_error_copy (task->error));
+      return;
+    }
+
+  /* copy the file again the regular way, which asks the user
+   * about conflicts and errors, one question at a time */
+  node = g_slice_new0 (ThunarTransferNode);
+  node->source_file = g_object_ref (task->source_file);
+  thunar_transfer_job_copy_node (job, operation, node, task->target_file, NULL, NULL, error);
+  thunar_transfer_node_free (node);
+}
+
+
+
+static void
+thunar_transfer_job_collect_tasks (ThunarTransferJob    *job,
+                                   ThunarJobOperation   *operation,
+                                   guint                 max_tasks,
+                                   ThunarThumbnailCache *thumbnail_cache,
+                                   GError              **error)
+{
+  ThunarTransferTask *task;
+  GError             *err = NULL;
+
+  if (job->worker_pool == NULL)
+    return;
+
+  for (;;)
+    {
+      /* only wait for the workers if too many files are queued */
+      if (job->n_worker_tasks > max_tasks)
+        task = g_async_queue_pop (job->worker_results);
+      else
+        task = g_async_queue_try_pop (job->worker_results);
+
+      if (task == NULL)
+        break;
+
+      /* handle the copies in the order they were queued, so questions
+       * about conflicts and errors come up in the order of the files */
+      g_hash_table_insert (job->worker_finished, GUINT_TO_POINTER (task->id), task);
+      while ((task = g_hash_table_lookup (job->worker_finished, GUINT_TO_POINTER (job->worker_collect_id))) != NULL)
+        {
+          g_hash_table_remove (job->worker_finished, GUINT_TO_POINTER (job->worker_collect_id));
+          job->worker_collect_id++;
+          job->n_worker_tasks--;
+
+          /* after an error, still record the copies that succeeded, so
+           * the journal and the undo log know every file left behind */
+          if (err == NULL || task->error == NULL)
+            thunar_transfer_job_finish_task (job, operation, task, thumbnail_cache, &err);
+
+          thunar_transfer_task_free (task);
+        }
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    g_propagate_error (error, err);
+}
+
+
+
+static gboolean
+thunar_transfer_job_queue_task (ThunarTransferJob    *job,
+                                ThunarJobOperation   *operation,
+                                ThunarTransferNode   *node,
+                                GFileInfo            *info,
+                                GFile                *target_file,
+                                ThunarThumbnailCache *thumbnail_cache,
+                                GError              **error)
+{
+  ThunarTransferTask *task;
+
+  /* only independent small files; everything else, in particular
+   * existing targets and everything the user was already asked about,
+   * is copied in order */
+  if (job->worker_pool == NULL
+      || node->children != NULL
+      || node->type != G_FILE_TYPE_REGULAR
+      || node->size > MAXIMUM_WORKER_FILE_SIZE
+      || (node->n_links > 1 && job->transfer_preserve_links)
+      || node->replace_confirmed
+      || node->rename_confirmed
+      || thunar_transfer_job_get_conflict_response (job, target_file) != 0
+      || !g_file_is_native (node->source_file)
+      || !g_file_is_native (target_file)
+      || thunar_g_file_is_desktop_file (node->source_file)
+      || g_file_query_exists (target_file, exo_job_get_cancellable (EXO_JOB (job))))
+    return FALSE;
+
+  /* handle finished copies, waiting if the workers fall behind */
+  thunar_transfer_job_collect_tasks (job, operation, job->n_workers * MAXIMUM_WORKER_BACKLOG,
+                                     thumbnail_cache, error);
+  if (error != NULL && *error != NULL)
+    return TRUE;
+
+  task = g_slice_new0 (ThunarTransferTask);
+  task->id = job->worker_next_id++;
+  task->source_file = g_object_ref (node->source_file);
+  task->target_file = g_object_ref (target_file);
+  task->size = node->size;
+  task->source_info = g_object_ref (info);
+
+  job->n_worker_tasks++;
+  g_thread_pool_push (job->worker_pool, task, NULL);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_transfer_job_stop_workers (ThunarTransferJob  *job,
+                                  ThunarJobOperation *operation,
+                                  GError            **error)
+{
+  ThunarThumbnailCache *thumbnail_cache;
+  ThunarApplication    *application;
+  GError               *err = NULL;
+
+  if (job->worker_pool == NULL)
+    return;
+
+  application = thunar_application_get ();
+  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+  g_object_unref (application);
+
+  /* wait for all queued files */
+  thunar_transfer_job_collect_tasks (job, operation, 0, thumbnail_cache, &err);
+
+  g_thread_pool_free (job->worker_pool, FALSE, TRUE);
+  job->worker_pool = NULL;
+  g_clear_pointer (&job->worker_results, g_async_queue_unref);
+  g_clear_pointer (&job->worker_finished, g_hash_table_destroy);
+
+  g_object_unref (thumbnail_cache);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      if (error != NULL && *error == NULL)
+        g_propagate_error (error, err);
+      else
+        g_error_free (err);
+    }
+}
+
+
+
+static void
+thunar_transfer_job_scan_add (ThunarTransferJob *job,
+                              guint64            size)
+{
+  g_mutex_lock (&job->scan_mutex);
+  job->scan_size += size;
+  g_mutex_unlock (&job->scan_mutex);
+}
+
+
+
+static void
+thunar_transfer_job_scan_children (ThunarTransferJob *job,
+                                   GFile             *file)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo       *info;
+  GFile           *child;
+  guint64          size = 0;
+
+  enumerator = g_file_enumerate_children (file,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          job->scan_cancellable, NULL);
+  if (enumerator == NULL)
+    return;
+
+  while ((info = g_file_enumerator_next_file (enumerator, job->scan_cancellable, NULL)) != NULL)
+    {
+      thunar_transfer_job_check_pause (job);
+
+      switch (g_file_info_get_file_type (info))
+        {
+        case G_FILE_TYPE_SYMBOLIC_LINK:
+          /* links to files are copied as files, see thunar_transfer_job_collect_node() */
+          child = g_file_enumerator_get_child (enumerator, info);
+          thunar_transfer_job_scan_file (job, child);
+          g_object_unref (child);
+          break;
+
+        case G_FILE_TYPE_DIRECTORY:
+          size += g_file_info_get_size (info);
+          child = g_file_enumerator_get_child (enumerator, info);
+          thunar_transfer_job_scan_children (job, child);
+          g_object_unref (child);
+          break;
+
+        default:
+          size += g_file_info_get_size (info);
+          break;
+        }
+
+      g_object_unref (info);
+    }
+
+  g_object_unref (enumerator);
+
+  /* add the sizes once per folder, not per file */
+  thunar_transfer_job_scan_add (job, size);
+}
+
+
+
+static void
+thunar_transfer_job_scan_file (ThunarTransferJob *job,
+                               GFile             *file)
+{
+  GFileInfo *info;
+
+  /* count like thunar_transfer_job_collect_node(), errors are reported when copying */
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                            G_FILE_QUERY_INFO_NONE,
+                            job->scan_cancellable, NULL);
+  if (info != NULL && g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR)
+    {
+      g_object_unref (info);
+      info = g_file_query_info (file,
+                                G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                job->scan_cancellable, NULL);
+    }
+
+  if (info == NULL)
+    return;
+
+  thunar_transfer_job_scan_add (job, g_file_info_get_size (info));
+
+  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+    thunar_transfer_job_scan_children (job, file);
+
+  g_object_unref (info);
+}
+
+
+
+static gpointer
+thunar_transfer_job_scan_thread (gpointer user_data)
+{
+  ThunarTransferJob *job = THUNAR_TRANSFER_JOB (user_data);
+  GList             *lp;
+
+  /* counting is not worth slowing down the copy itself */
+  thunar_transfer_scheduler_set_background ();
+
+  for (lp = job->scan_file_list; lp != NULL; lp = lp->next)
+    {
+      if (g_cancellable_is_cancelled (job->scan_cancellable))
+        break;
+
+      thunar_transfer_job_scan_file (job, lp->data);
+    }
+
+  g_mutex_lock (&job->scan_mutex);
+  g_atomic_int_set (&job->scan_running, FALSE);
+  g_cond_broadcast (&job->scan_cond);
+  g_mutex_unlock (&job->scan_mutex);
+
+  return NULL;
+}
+
+
+
+/**
+ * thunar_transfer_job_start_scan:
+ * @job : a #ThunarTransferJob.
+ *
+ * Starts counting the size of the source files in the background, so
+ * the copy does not have to wait for the whole source tree to be
+ * collected first, see thunar_transfer_job_collect_node(). Until the
+ * counting is finished, the progress is indeterminate and the free
+ * space on the destination is checked later, see
+ * thunar_transfer_job_check_scan().
+ *
+ * Small trees are usually counted before the copy starts.
+ **/
+static void
+thunar_transfer_job_start_scan (ThunarTransferJob *job)
+{
+  ThunarTransferNode *node;
+  GList              *lp;
+  gint64              end_time;
+
+  _thunar_return_if_fail (job->scan_thread == NULL);
+
+  for (lp = job->source_node_list; lp != NULL; lp = lp->next)
+    {
+      node = lp->data;
+      job->scan_file_list = g_list_prepend (job->scan_file_list, g_object_ref (node->source_file));
+    }
+
+  job->scan_cancellable = g_cancellable_new ();
+  job->scan_size = 0;
+  job->scan_verified = FALSE;
+  g_atomic_int_set (&job->scan_running, TRUE);
+
+  job->scan_thread = g_thread_new ("ThunarTransferJobScan", thunar_transfer_job_scan_thread, job);
+
+  /* give the counting a moment, to check the free space before copying */
+  end_time = g_get_monotonic_time () + 250 * G_TIME_SPAN_MILLISECOND;
+  g_mutex_lock (&job->scan_mutex);
+  while (g_atomic_int_get (&job->scan_running))
+    if (!g_cond_wait_until (&job->scan_cond, &job->scan_mutex, end_time))
+      break;
+  job->total_size = job->scan_size;
+  g_mutex_unlock (&job->scan_mutex);
+}
+
+
+
+static void
+thunar_transfer_job_stop_scan (ThunarTransferJob *job)
+{
+  if (job->scan_thread == NULL)
+    return;
+
+  /* the copy is done, stop counting if it is behind */
+  g_cancellable_cancel (job->scan_cancellable);
+  g_thread_join (job->scan_thread);
+  job->scan_thread = NULL;
+
+  job->total_size = MAX (job->scan_size, job->total_progress);
+
+  g_clear_object (&job->scan_cancellable);
+  thunar_g_list_free_full (job->scan_file_list);
+  job->scan_file_list = NULL;
+}
+
+
+
+/**
+ * thunar_transfer_job_check_scan:
+ * @job   : a #ThunarTransferJob.
+ * @error : return location for errors or %NULL.
+ *
+ * Checks the free space on the destination once all source files
+ * were counted, if this was not possible before copying.
+ **/
+static void
+thunar_transfer_job_check_scan (ThunarTransferJob *job,
+                                GError           **error)
+{
+  if (job->scan_thread == NULL
+      || job->scan_verified
+      || g_atomic_int_get (&job->scan_running))
+    return;
+
+  job->scan_verified = TRUE;
+
+  g_mutex_lock (&job->scan_mutex);
+  job->total_size = job->scan_size;
+  g_mutex_unlock (&job->scan_mutex);
+
+  /* stop copying if the user does not want to continue */
+  if (!thunar_transfer_job_verify_destination (job, error) && (error == NULL || *error == NULL))
+    exo_job_cancel (EXO_JOB (job));
+}
+
+
+
+static void
+thunar_transfer_job_open_journal (ThunarTransferJob *job)
+{
+  GError *err = NULL;
+  GList  *source_file_list = NULL;
+  GList  *lp;
+
+  for (lp = g_list_last (job->source_node_list); lp != NULL; lp = lp->prev)
+    source_file_list = g_list_prepend (source_file_list, ((ThunarTransferNode *) lp->data)->source_file);
+
+  job->journal = thunar_transfer_journal_open (source_file_list, job->target_file_list, &err);
+  if (G_UNLIKELY (job->journal == NULL))
+    {
+      /* copy anyway, it just can't be continued */
+      g_warning ("%s", err->message);
+      g_error_free (err);
+    }
+
+  g_list_free (source_file_list);
+}
+
+
+
+static gboolean
+thunar_transfer_job_is_done (ThunarTransferJob  *job,
+                             ThunarTransferNode *node,
+                             GFileInfo          *source_info,
+                             GFile              *target_file)
+{
+  GFileInfo *info;
+  gboolean   is_done;
+
+  /* folders are entered again, new files might have been added to them,
+   * and files are copied again if their source changed since */
+  if (job->journal == NULL
+      || node->type == G_FILE_TYPE_DIRECTORY
+      || !thunar_transfer_journal_is_done (job->journal, target_file, source_info))
+    return FALSE;
+
+  /* the copy might have been changed or removed in the meantime */
+  info = g_file_query_info (target_file,
+                            G_FILE_ATTRIBUTE_STANDARD_TYPE "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            exo_job_get_cancellable (EXO_JOB (job)), NULL);
+  if (info == NULL)
+    return FALSE;
+
+  is_done = (g_file_info_get_file_type (info) == node->type
+             && (node->type != G_FILE_TYPE_REGULAR || (guint64) g_file_info_get_size (info) == node->size));
+  g_object_unref (info);
+
+  if (is_done)
+    {
+      job->file_progress = 0;
+      thunar_transfer_job_progress (node->size, node->size, job);
+      job->file_progress = 0;
+    }
+
+  return is_done;
+}
+
+
+
+static void
+thunar_transfer_conflict_free (gpointer data)
+{
+  ThunarTransferConflict *conflict = data;
+
+  g_object_unref (conflict->source_file);
+  g_object_unref (conflict->target_file);
+  g_slice_free (ThunarTransferConflict, conflict);
+}
+
+
+
+static void
+thunar_transfer_job_find_conflicts (ThunarTransferJob *job,
+                                    GFile             *source_file,
+                                    GFileInfo         *source_info,
+                                    GFile             *target_file,
+                                    GFileInfo         *target_info,
+                                    GList            **conflicts_return,
+                                    GError           **error)
+{
+  ThunarTransferConflict *conflict;
+  GFileEnumerator        *enumerator;
+  GCancellable           *cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  GHashTable             *target_infos;
+  GFileInfo              *info;
+  GFileInfo              *child_target_info;
+  GFile                  *source_child;
+  GFile                  *target_child;
+  GError                 *err = NULL;
+
+  /* folders are merged, only what they contain can conflict */
+  if (g_file_info_get_file_type (source_info) != G_FILE_TYPE_DIRECTORY
+      || g_file_info_get_file_type (target_info) != G_FILE_TYPE_DIRECTORY)
+    {
+      conflict = g_slice_new0 (ThunarTransferConflict);
+      conflict->source_file = g_object_ref (source_file);
+      conflict->target_file = g_object_ref (target_file);
+      conflict->source_type = g_file_info_get_file_type (source_info);
+      conflict->target_type = g_file_info_get_file_type (target_info);
+      conflict->source_size = g_file_info_get_size (source_info);
+      conflict->target_size = g_file_info_get_size (target_info);
+      conflict->source_mtime = g_file_info_get_attribute_uint64 (source_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+      conflict->target_mtime = g_file_info_get_attribute_uint64 (target_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+      conflict->rule = THUNAR_CONFLICT_RULE_ASK;
+      *conflicts_return = g_list_prepend (*conflicts_return, conflict);
+      return;
+    }
+
+  /* list the target folder once, instead of looking up every file */
+  target_infos = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+  enumerator = g_file_enumerate_children (target_file, CONFLICT_ATTRIBUTES,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          cancellable, &err);
+  if (enumerator != NULL)
+    {
+      while ((info = g_file_enumerator_next_file (enumerator, cancellable, &err)) != NULL)
+        g_hash_table_insert (target_infos, (gpointer) g_file_info_get_name (info), info);
+      g_object_unref (enumerator);
+    }
+
+  /* nothing in common, unless the source folder is not empty */
+  if (err == NULL && g_hash_table_size (target_infos) > 0)
+    {
+      enumerator = g_file_enumerate_children (source_file, CONFLICT_ATTRIBUTES,
+                                              G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                              cancellable, &err);
+      while (enumerator != NULL && err == NULL
+             && (info = g_file_enumerator_next_file (enumerator, cancellable, &err)) != NULL)
+        {
+          child_target_info = g_hash_table_lookup (target_infos, g_file_info_get_name (info));
+          if (child_target_info != NULL)
+            {
+              source_child = g_file_get_child (source_file, g_file_info_get_name (info));
+              target_child = g_file_get_child (target_file, g_file_info_get_name (info));
+              thunar_transfer_job_find_conflicts (job, source_child, info, target_child, child_target_info,
+                                                  conflicts_return, &err);
+              g_object_unref (source_child);
+              g_object_unref (target_child);
+            }
+          g_object_unref (info);
+        }
+
+      if (enumerator != NULL)
+        g_object_unref (enumerator);
+    }
+
+  g_hash_table_destroy (target_infos);
+
+  /* unreadable folders are left to the copy, which reports the error */
+  if (err != NULL)
+    {
+      if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_propagate_error (error, err);
+      else
+        g_error_free (err);
     }
 }
 
 
 
-/**
- * thunar_transfer_job_copy_file:
- * @job                : a #ThunarTransferJob.
- * @source_file        : the source #GFile to copy.
- * @target_file        : the destination #GFile to copy to.
- * @replace_confirmed  : whether the user has already confirmed that this file should replace an existing one
- * @rename_confirmed   : whether the user has already confirmed that this file should be renamed to a new unique file name
- * @error              : return location for errors or %NULL.
- *
- * Tries to copy @source_file to @target_file. The real destination is the
- * return value and may differ from @target_file (e.g. if you try to copy
- * the file "/foo/bar" into the same directory you'll end up with something
- * like "/foo/copy of bar" instead of "/foo/bar"). If an existing file would
- * be replaced, the user is asked to confirm replace or rename it unless
- * @replace_confirmed or @rename_confirmed is TRUE.
- *
- * The return value is guaranteed to be %NULL on errors and @error will
- * always be set in those cases. If the file is skipped, the return value
- * will be @source_file.
- *
- * Return value: the destination #GFile to which @source_file was copied
- *               or linked. The caller is reposible to release it with
- *               g_object_unref() if no longer needed. It points to
- *               @source_file if the file was skipped and will be %NULL
- *               on error or cancellation.
- **/
-static GFile *
-thunar_transfer_job_copy_file (ThunarTransferJob     *job,
-                               ThunarJobOperation    *operation,
-                               GFile                 *source_file,
-                               GFile                 *target_file,
-                               gboolean               replace_confirmed,
-                               gboolean               rename_confirmed,
-                               GError               **error)
+static gboolean
+thunar_transfer_job_check_conflicts (ThunarTransferJob *job,
+                                     GError           **error)
 {
-  ThunarJobResponse response;
-  GFile            *dest_file = target_file;
-  GFileCopyFlags    copy_flags = G_FILE_COPY_NONE;
-  GError           *err = NULL;
-  gint              n_rename = 0;
-  GFileType         source_type;
+  ThunarTransferConflict *conflict;
+  ThunarTransferNode     *node;
+  ThunarJobResponse       response = 0;
+  GCancellable           *cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  GFileInfo              *source_info;
+  GFileInfo              *target_info;
+  GError                 *err = NULL;
+  GList                  *conflicts = NULL;
+  GList                  *sp;
+  GList                  *tp;
+  GList                  *lp;
+
+  exo_job_info_message (EXO_JOB (job), _("Checking for existing files..."));
+
+  for (sp = job->source_node_list, tp = job->target_file_list;
+       sp != NULL && tp != NULL && err == NULL;
+       sp = sp->next, tp = tp->next)
+    {
+      node = sp->data;
 
-  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
-  _thunar_return_val_if_fail (G_IS_FILE (source_file), NULL);
-  _thunar_return_val_if_fail (G_IS_FILE (target_file), NULL);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+      /* copies within the same folder get a new name anyway */
+      if (g_file_equal (node->source_file, tp->data))
+        continue;
 
-  /* abort on cancellation */
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return NULL;
-  thunar_transfer_job_check_pause (job);
+      target_info = g_file_query_info (tp->data, CONFLICT_ATTRIBUTES,
+                                       G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                       cancellable, NULL);
+      if (target_info == NULL)
+        continue;
 
-  source_type = g_file_query_file_type (source_file, G_FILE_QUERY_INFO_NONE,
-                                        exo_job_get_cancellable (EXO_JOB (job)));
+      source_info = g_file_query_info (node->source_file, CONFLICT_ATTRIBUTES,
+                                       G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                       cancellable, NULL);
+      if (source_info != NULL)
+        {
+          thunar_transfer_job_find_conflicts (job, node->source_file, source_info, tp->data, target_info,
+                                              &conflicts, &err);
+          g_object_unref (source_info);
+        }
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return NULL;
-  if (source_type != G_FILE_TYPE_REGULAR)
-    copy_flags |= G_FILE_COPY_NOFOLLOW_SYMLINKS;
+      g_object_unref (target_info);
+    }
 
-  /* various attempts to copy the file */
-  while (err == NULL)
+  if (err == NULL && conflicts != NULL)
     {
-      GFile *target;
-
-      thunar_transfer_job_check_pause (job);
-
-      if (G_LIKELY (!g_file_equal (source_file, dest_file)))
-        target = g_object_ref (dest_file);
-      else
-        target = thunar_io_jobs_util_next_duplicate_file (THUNAR_JOB (job), source_file, THUNAR_NEXT_FILE_NAME_MODE_COPY, &err);
+      conflicts = g_list_reverse (conflicts);
+      exo_job_emit (EXO_JOB (job), transfer_job_signals[ASK_CONFLICTS], 0, conflicts, &response);
 
-      if (err == NULL)
+      if (response == THUNAR_JOB_RESPONSE_CANCEL)
         {
-          /* try to copy the file from source file to the duplicate file */
-          if (ttj_copy_file (job, operation, source_file, target, copy_flags, &err))
-            return target;
-          else /* go to error case */
-            g_object_unref (target);
+          exo_job_cancel (EXO_JOB (job));
+          exo_job_set_error_if_cancelled (EXO_JOB (job), &err);
         }
-
-      /* check if we can recover from this error */
-      if (err->domain == G_IO_ERROR && err->code == G_IO_ERROR_EXISTS)
+      else
         {
-          /* reset the error */
-          g_clear_error (&err);
-
-          /* if necessary, ask the user whether to replace or rename the target file */
-          if (replace_confirmed)
-            response = THUNAR_JOB_RESPONSE_REPLACE;
-          else if (rename_confirmed)
-            response = THUNAR_JOB_RESPONSE_RENAME;
-          else
-            response = thunar_job_ask_replace (THUNAR_JOB (job), source_file,
-                                               dest_file, &err);
-
-          if (err != NULL)
-            break;
-
-          /* add overwrite flag and retry if we should overwrite */
-          if (response == THUNAR_JOB_RESPONSE_REPLACE)
-            {
-              replace_confirmed = TRUE;
-              copy_flags |= G_FILE_COPY_OVERWRITE;
-              continue;
-            }
-          else if (response == THUNAR_JOB_RESPONSE_RENAME)
+          /* remember the decisions, looked up once the files are copied */
+          job->conflict_responses = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                                           g_object_unref, NULL);
+          for (lp = conflicts; lp != NULL; lp = lp->next)
             {
-              GFile *renamed_file;
-              renamed_file = thunar_io_jobs_util_next_renamed_file (THUNAR_JOB (job),
-                                                                    source_file,
-                                                                    dest_file,
-                                                                    ++n_rename, &err);
-              if (renamed_file != NULL)
-                {
-                  if (err != NULL)
-                    g_object_unref (renamed_file);
-                  else
-                    {
-                      dest_file = renamed_file;
-                      rename_confirmed = TRUE;
-                    }
-                }
+              conflict = lp->data;
+              response = thunar_transfer_conflict_get_response (conflict);
+              if (response != 0)
+                g_hash_table_insert (job->conflict_responses, g_object_ref (conflict->target_file),
+                                     GUINT_TO_POINTER (response));
             }
-
-          /* tell the caller we skipped the file if the user
-           * doesn't want to retry/overwrite */
-          if (response == THUNAR_JOB_RESPONSE_SKIP)
-            return g_object_ref (source_file);
         }
     }
 
-  _thunar_assert (err != NULL);
+  g_list_free_full (conflicts, thunar_transfer_conflict_free);
 
-  g_propagate_error (error, err);
-  return NULL;
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
 
@@ -844,6 +2402,7 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
   const gchar          *fs_type;
   gboolean              should_use_copy_name;
   gboolean              use_fat_name_scheme;
+  gboolean              is_child_node = (target_file == NULL);
 
   _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
   _thunar_return_if_fail (node != NULL && G_IS_FILE (node->source_file));
@@ -899,9 +2458,15 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
 
   for (; err == NULL && node != NULL; node = node->next)
     {
-      /* query file info */
+      /* check the free space once the size is known */
+      thunar_transfer_job_check_scan (job, &err);
+      if (G_UNLIKELY (err != NULL))
+        break;
+
+      /* query file info, and what the journal records the source with */
       info = g_file_query_info (node->source_file,
-                                G_FILE_ATTRIBUTE_STANDARD_COPY_NAME "," G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
+                                G_FILE_ATTRIBUTE_STANDARD_COPY_NAME "," G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                THUNAR_TRANSFER_JOURNAL_ATTRIBUTES,
                                 G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
                                 exo_job_get_cancellable (EXO_JOB (job)),
                                 &err);
@@ -969,6 +2534,28 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
       /* update progress information */
       exo_job_info_message (EXO_JOB (job), "%s", g_file_info_get_display_name (info));
 
+      /* files copied before the copy was interrupted are done */
+      if (thunar_transfer_job_is_done (job, node, info, target_file))
+        {
+          if (!is_child_node && target_file_list_return != NULL)
+            *target_file_list_return = thunar_g_list_prepend_deep (*target_file_list_return, target_file);
+
+          g_clear_object (&target_file);
+          g_object_unref (info);
+          continue;
+        }
+
+      thunar_transfer_job_throttle (job, &job->file_bucket, 1);
+
+      /* small files within a folder are left to the copy workers */
+      if (is_child_node
+          && thunar_transfer_job_queue_task (job, operation, node, info, target_file, thumbnail_cache, &err))
+        {
+          g_clear_object (&target_file);
+          g_object_unref (info);
+          continue;
+        }
+
 retry_copy:
       thunar_transfer_job_check_pause (job);
 
@@ -989,8 +2576,12 @@ retry_copy:
                                                 node->source_file,
                                                 real_target_file);
 
+              /* collect the folder content now, unless done before copying */
+              if (node->type == G_FILE_TYPE_DIRECTORY && node->children == NULL)
+                thunar_transfer_job_collect_children (job, node, FALSE, &err);
+
               /* check if we have children to copy */
-              if (node->children != NULL)
+              if (err == NULL && node->children != NULL)
                 {
                   /* copy all children of this node */
                   thunar_transfer_job_copy_node (job, operation, node->children, NULL, real_target_file, NULL, &err);
@@ -1009,6 +2600,12 @@ retry_copy:
                   break;
                 }
 
+              /* files copied under another name are not found again when resuming */
+              if (job->journal != NULL
+                  && node->type != G_FILE_TYPE_DIRECTORY
+                  && g_file_equal (real_target_file, target_file))
+                thunar_transfer_journal_done (job->journal, target_file, info);
+
               /* add the real target file to the return list */
               if (G_LIKELY (target_file_list_return != NULL))
                 {
@@ -1109,7 +2706,7 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
     return TRUE;
 
   /* total size is nul, should be fine */
-  if (transfer_job->total_size == 0)
+  if (transfer_job->total_size <= transfer_job->total_progress)
     return TRUE;
 
   /* for all actions in thunar use the same target directory so
@@ -1148,9 +2745,10 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
   if (g_file_info_has_attribute (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE))
     {
       free_space = g_file_info_get_attribute_uint64 (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
-      if (transfer_job->total_size > free_space)
+      /* when verified while copying, part of the files are already there */
+      if (transfer_job->total_size - transfer_job->total_progress > free_space)
         {
-          size_string = g_format_size_full (transfer_job->total_size - free_space,
+          size_string = g_format_size_full (transfer_job->total_size - transfer_job->total_progress - free_space,
                                             transfer_job->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
           succeed = thunar_job_ask_no_size (THUNAR_JOB (transfer_job),
                                              _("Error while copying to \"%s\": %s more space is "
@@ -1418,198 +3016,114 @@ thunar_transfer_job_move_file (ExoJob                *job,
                             g_file_info_get_display_name (info));
 
       /* if this call fails to collect the node, err will be non-NULL and the loop will exit */
-      thunar_transfer_job_collect_node (transfer_job, node, error);
+      thunar_transfer_job_collect_node (transfer_job, node, TRUE, error);
     }
   return TRUE;
 }
 
 
 
-static gboolean
-thunar_transfer_job_device_id_in_job_list (const char *device_fs_id,
-                                           GList      *jobs)
+/**
+ * thunar_transfer_job_is_counting:
+ * @job : a #ThunarTransferJob.
+ *
+ * Whether the size of the files to copy is still being counted
+ * while copying, so the progress of @job is not yet known.
+ *
+ * Return value: %TRUE while counting, %FALSE otherwise.
+ **/
+gboolean
+thunar_transfer_job_is_counting (ThunarTransferJob *job)
 {
-  ThunarTransferJob *job;
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
 
-  for (GList *ljobs = jobs; device_fs_id != NULL && ljobs != NULL; ljobs = ljobs->next)
-    {
-      if (THUNAR_IS_TRANSFER_JOB (ljobs->data))
-        {
-          job = THUNAR_TRANSFER_JOB (ljobs->data);
-          if (g_strcmp0 (device_fs_id, job->source_device_fs_id) == 0)
-            return TRUE;
-          if (g_strcmp0 (device_fs_id, job->target_device_fs_id) == 0)
-            return TRUE;
-        }
-    }
-  return FALSE;
+  return g_atomic_int_get (&job->scan_running);
 }
 
 
 
-static void
-thunar_transfer_job_fill_source_device_info (ThunarTransferJob *transfer_job,
-                                             GFile             *file)
+/**
+ * thunar_transfer_conflict_get_response:
+ * @conflict : a #ThunarTransferConflict.
+ *
+ * Applies the rule of @conflict to the files in conflict.
+ *
+ * Return value: %THUNAR_JOB_RESPONSE_REPLACE, %THUNAR_JOB_RESPONSE_SKIP
+ *               or %THUNAR_JOB_RESPONSE_RENAME, or %0 to ask the user.
+ **/
+ThunarJobResponse
+thunar_transfer_conflict_get_response (const ThunarTransferConflict *conflict)
 {
-  /* query device filesystem id (unique string)
-   * The source exists and can be queried directly. */
-  GFileInfo *file_info = g_file_query_info (file,
-                                            G_FILE_ATTRIBUTE_ID_FILESYSTEM,
-                                            G_FILE_QUERY_INFO_NONE,
-                                            exo_job_get_cancellable (EXO_JOB (transfer_job)),
-                                            NULL);
-  if (file_info != NULL)
-    {
-      transfer_job->source_device_fs_id = g_strdup (g_file_info_get_attribute_string (file_info, G_FILE_ATTRIBUTE_ID_FILESYSTEM));
-      g_object_unref (file_info);
-    }
-  transfer_job->is_source_device_local = thunar_g_file_is_on_local_device (file);
-}
+  _thunar_return_val_if_fail (conflict != NULL, 0);
 
+  switch (conflict->rule)
+    {
+    case THUNAR_CONFLICT_RULE_REPLACE:
+      return THUNAR_JOB_RESPONSE_REPLACE;
 
-static void
-thunar_transfer_job_fill_target_device_info (ThunarTransferJob *transfer_job,
-                                             GFile             *file)
-{
-  /*
-   * To query the device id it should be done on an existing file/directory.
-   * Usually the target file does not exist yet and so the parent directory
-   * will be queried, and so on until reaching root directory if necessary.
-   * Normally it will end in the worst case to the mounted filesystem root,
-   * because that always exists. */
-  GFile     *target_file = g_object_ref (file); /* start with target file */
-  GFile     *target_parent;
-  GFileInfo *file_info;
-  while (target_file != NULL)
-    {
-      /* query device id */
-      file_info = g_file_query_info (target_file,
-                                     G_FILE_ATTRIBUTE_ID_FILESYSTEM,
-                                     G_FILE_QUERY_INFO_NONE,
-                                     exo_job_get_cancellable (EXO_JOB (transfer_job)),
-                                     NULL);
-      if (file_info != NULL)
-        {
-          transfer_job->target_device_fs_id = g_strdup (g_file_info_get_attribute_string (file_info, G_FILE_ATTRIBUTE_ID_FILESYSTEM));
-          g_object_unref (file_info);
-          break;
-        }
-      else /* target file or parent directory does not exist (yet) */
-        {
-          /* query the parent directory */
-          target_parent = g_file_get_parent (target_file);
-          g_object_unref (target_file);
-          target_file = target_parent;
-        }
+    case THUNAR_CONFLICT_RULE_REPLACE_NEWER:
+      return conflict->source_mtime > conflict->target_mtime ? THUNAR_JOB_RESPONSE_REPLACE : THUNAR_JOB_RESPONSE_SKIP;
+
+    case THUNAR_CONFLICT_RULE_REPLACE_LARGER:
+      return conflict->source_size > conflict->target_size ? THUNAR_JOB_RESPONSE_REPLACE : THUNAR_JOB_RESPONSE_SKIP;
+
+    case THUNAR_CONFLICT_RULE_SKIP:
+      return THUNAR_JOB_RESPONSE_SKIP;
+
+    case THUNAR_CONFLICT_RULE_RENAME:
+      return THUNAR_JOB_RESPONSE_RENAME;
+
+    default:
+      return 0;
     }
-  g_object_unref (target_file);
-  transfer_job->is_target_device_local = thunar_g_file_is_on_local_device (file);
 }
 
 
 
-static void
-thunar_transfer_job_determine_copy_behavior (ThunarTransferJob *transfer_job,
-                                             gboolean          *freeze_if_src_busy_p,
-                                             gboolean          *freeze_if_tgt_busy_p,
-                                             gboolean          *always_parallel_copy_p,
-                                             gboolean          *should_freeze_on_any_other_job_p)
+/**
+ * thunar_transfer_job_set_background:
+ * @job        : a #ThunarTransferJob which is not launched yet.
+ * @background : whether @job runs next to other jobs on its devices.
+ *
+ * Background jobs copy with a lower I/O priority, in the job thread
+ * and in the copy workers, so the jobs started before finish first.
+ **/
+void
+thunar_transfer_job_set_background (ThunarTransferJob *job,
+                                    gboolean           background)
 {
-  *freeze_if_src_busy_p = FALSE;
-  *freeze_if_tgt_busy_p = FALSE;
-  *should_freeze_on_any_other_job_p = FALSE;
-  if (transfer_job->parallel_copy_mode == THUNAR_PARALLEL_COPY_MODE_ALWAYS)
-    /* never freeze, always parallel copies */
-    *always_parallel_copy_p = TRUE;
-  else if (transfer_job->parallel_copy_mode == THUNAR_PARALLEL_COPY_MODE_ONLY_LOCAL)
-    {
-      /* always parallel copy if:
-       * - source device is local
-       * AND
-       * - target device is local
-       */
-      *always_parallel_copy_p = transfer_job->is_source_device_local && transfer_job->is_target_device_local;
-      *freeze_if_src_busy_p = ! transfer_job->is_source_device_local;
-      *freeze_if_tgt_busy_p = ! transfer_job->is_target_device_local;
-    }
-  else if (transfer_job->parallel_copy_mode == THUNAR_PARALLEL_COPY_MODE_ONLY_LOCAL_SAME_DEVICES)
-    {
-      /* always parallel copy if:
-       * - source and target device fs are identical
-       * AND
-       * - source device is local
-       * AND
-       * - target device is local
-       */
-      /* freeze copy if
-       * - src device fs ≠ tgt device fs and src or tgt appears in another job
-       * OR
-       * - src device is not local and src device appears in another job
-       * OR
-       * - tgt device is not local and tgt device appears in another job
-       */
-      if (g_strcmp0 (transfer_job->source_device_fs_id, transfer_job->target_device_fs_id) != 0)
-        {
-          *always_parallel_copy_p = FALSE;
-          /* freeze when either src or tgt device appears on another job */
-          *freeze_if_src_busy_p = TRUE;
-          *freeze_if_tgt_busy_p = TRUE;
-        }
-      else /* same as THUNAR_PARALLEL_COPY_MODE_ONLY_LOCAL */
-        {
-          *always_parallel_copy_p = transfer_job->is_source_device_local && transfer_job->is_target_device_local;
-          *freeze_if_src_busy_p = ! transfer_job->is_source_device_local;
-          *freeze_if_tgt_busy_p = ! transfer_job->is_target_device_local;
-        }
-    }
-  else /* THUNAR_PARALLEL_COPY_MODE_NEVER */
-    {
-      /* freeze copy if another transfer job is running */
-      *always_parallel_copy_p = FALSE;
-      *should_freeze_on_any_other_job_p = TRUE;
-    }
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  g_atomic_int_set (&job->background, background ? TRUE : FALSE);
 }
 
 
 
 /**
- * thunar_transfer_job_can_start:
- *
+ * thunar_transfer_job_get_endpoints:
+ * @job                : a #ThunarTransferJob.
+ * @source_file_return : return location for the first source file.
+ * @target_file_return : return location for the first target file.
  *
+ * Looks up the first file @job transfers and where it goes to, which
+ * tell the devices @job uses. Both are owned by @job, and %NULL if
+ * there is nothing to transfer.
  **/
-gboolean
-thunar_transfer_job_can_start (ThunarTransferJob *transfer_job,
-                               GList             *running_job_list)
+void
+thunar_transfer_job_get_endpoints (ThunarTransferJob *job,
+                                   GFile            **source_file_return,
+                                   GFile            **target_file_return)
 {
-  gboolean freeze_if_src_busy;
-  gboolean freeze_if_tgt_busy;
-  gboolean always_parallel_copy;
-  gboolean should_freeze_on_any_other_job;
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
 
-  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (transfer_job), FALSE);
-  _thunar_return_val_if_fail (!exo_job_is_cancelled (EXO_JOB (transfer_job)), TRUE);
+  *source_file_return = NULL;
+  *target_file_return = NULL;
 
-  /* no source node list nor target file list */
-  if (transfer_job->source_node_list == NULL || transfer_job->target_file_list == NULL)
-    return TRUE;
-  /* first source file */
-  thunar_transfer_job_fill_source_device_info (transfer_job, ((ThunarTransferNode*) transfer_job->source_node_list->data)->source_file);
-  /* first target file */
-  thunar_transfer_job_fill_target_device_info (transfer_job, G_FILE (transfer_job->target_file_list->data));
-  thunar_transfer_job_determine_copy_behavior (transfer_job,
-                                               &freeze_if_src_busy,
-                                               &freeze_if_tgt_busy,
-                                               &always_parallel_copy,
-                                               &should_freeze_on_any_other_job);
-
-  if (should_freeze_on_any_other_job && running_job_list != NULL)
-    return FALSE;
-  if (freeze_if_src_busy && thunar_transfer_job_device_id_in_job_list (transfer_job->source_device_fs_id, running_job_list))
-    return FALSE;
-  if (freeze_if_tgt_busy && thunar_transfer_job_device_id_in_job_list (transfer_job->target_device_fs_id, running_job_list))
-    return FALSE;
+  if (job->source_node_list == NULL || job->target_file_list == NULL)
+    return;
 
-  return TRUE;
+  *source_file_return = ((ThunarTransferNode *) job->source_node_list->data)->source_file;
+  *target_file_return = job->target_file_list->data;
 }
 
 
@@ -1617,6 +3131,27 @@ thunar_transfer_job_can_start (ThunarTransferJob *transfer_job,
 static gboolean
 thunar_transfer_job_execute (ExoJob  *job,
                              GError **error)
+{
+  ThunarTransferJob *transfer_job = THUNAR_TRANSFER_JOB (job);
+  gboolean           succeed;
+  gint               io_priority = -1;
+
+  /* the job runs in a shared pool thread, restore its priority when done */
+  if (g_atomic_int_get (&transfer_job->background))
+    io_priority = thunar_transfer_scheduler_lower_io_priority ();
+
+  succeed = thunar_transfer_job_transfer (job, error);
+
+  thunar_transfer_scheduler_restore_io_priority (io_priority);
+
+  return succeed;
+}
+
+
+
+static gboolean
+thunar_transfer_job_transfer (ExoJob  *job,
+                              GError **error)
 {
   ThunarThumbnailCache *thumbnail_cache;
   ThunarTransferNode   *node;
@@ -1696,7 +3231,8 @@ thunar_transfer_job_execute (ExoJob  *job,
         }
       else if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY)
         {
-          if (!thunar_transfer_job_collect_node (THUNAR_TRANSFER_JOB (job), node, &err))
+          /* the folders are collected while copying */
+          if (!thunar_transfer_job_collect_node (THUNAR_TRANSFER_JOB (job), node, FALSE, &err))
             break;
         }
 
@@ -1709,27 +3245,55 @@ thunar_transfer_job_execute (ExoJob  *job,
   /* continue if there were no errors yet */
   if (G_LIKELY (err == NULL))
     {
-      /* check destination */
-      if (!thunar_transfer_job_verify_destination (transfer_job, &err))
+      /* count the size of the copied folders while copying */
+      if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY)
+        thunar_transfer_job_start_scan (transfer_job);
+
+      /* check destination, unless the size is still being counted */
+      if (!g_atomic_int_get (&transfer_job->scan_running))
         {
-          if (err != NULL)
-            {
-              g_propagate_error (error, err);
-              return FALSE;
-            }
-          else
+          transfer_job->scan_verified = TRUE;
+
+          if (!thunar_transfer_job_verify_destination (transfer_job, &err))
             {
-              /* pretend nothing happened */
-              return TRUE;
+              thunar_transfer_job_stop_scan (transfer_job);
+
+              if (err != NULL)
+                {
+                  g_propagate_error (error, err);
+                  return FALSE;
+                }
+              else
+                {
+                  /* pretend nothing happened */
+                  return TRUE;
+                }
             }
         }
 
+      /* ask about all existing files at once, instead of one at a time while copying */
+      if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY
+          && transfer_job->check_conflicts
+          && !thunar_transfer_job_check_conflicts (transfer_job, &err))
+        {
+          thunar_transfer_job_stop_scan (transfer_job);
+          g_propagate_error (error, err);
+          return FALSE;
+        }
+
       /* transfer starts now */
       transfer_job->start_time = g_get_real_time ();
 
       if (log_operations && transfer_job->type == THUNAR_TRANSFER_JOB_COPY)
         operation = thunar_job_operation_new (THUNAR_JOB_OPERATION_KIND_COPY);
 
+      /* record the progress, so an interrupted copy can be continued */
+      if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY)
+        thunar_transfer_job_open_journal (transfer_job);
+
+      /* small files are copied concurrently, depending on the devices involved */
+      thunar_transfer_job_start_workers (transfer_job);
+
       /* perform the copy recursively for all source transfer nodes */
       for (sp = transfer_job->source_node_list, tp = transfer_job->target_file_list;
            sp != NULL && tp != NULL && err == NULL;
@@ -1738,6 +3302,18 @@ thunar_transfer_job_execute (ExoJob  *job,
           thunar_transfer_job_copy_node (transfer_job, operation, sp->data, tp->data, NULL,
                                          &new_files_list, &err);
         }
+
+      /* wait for the files still being copied */
+      thunar_transfer_job_stop_workers (transfer_job, operation, &err);
+
+      /* keep the journal unless the copy completed */
+      if (transfer_job->journal != NULL)
+        {
+          thunar_transfer_journal_close (transfer_job->journal, err == NULL);
+          transfer_job->journal = NULL;
+        }
+
+      thunar_transfer_job_stop_scan (transfer_job);
     }
 
   /* check if we failed */
@@ -1855,6 +3431,16 @@ thunar_transfer_job_get_status (ThunarTransferJob *job)
 
   status = g_string_sized_new (100);
 
+  /* the total size is unknown while counting */
+  if (thunar_transfer_job_is_counting (job))
+    {
+      total_progress_str = g_format_size_full (job->total_progress, job->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
+      g_string_append_printf (status, _("%s copied, counting files..."), total_progress_str);
+      g_free (total_progress_str);
+
+      return g_string_free (status, FALSE);
+    }
+
   /* transfer status like "22.6MB of 134.1MB" */
   total_size_str = g_format_size_full (job->total_size, job->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
   total_progress_str = g_format_size_full (job->total_progress, job->file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
@@ -21,7 +21,9 @@
 #ifndef __THUNAR_TRANSFER_JOB_H__
 #define __THUNAR_TRANSFER_JOB_H__
 
-#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <thunar/thunar-enum-types.h>
 
 G_BEGIN_DECLS
 
@@ -38,6 +40,47 @@ typedef enum /*< enum >*/
   THUNAR_TRANSFER_JOB_TRASH,
 } ThunarTransferJobType;
 
+/**
+ * ThunarConflictRule:
+ * @THUNAR_CONFLICT_RULE_ASK            : ask once the file is copied.
+ * @THUNAR_CONFLICT_RULE_REPLACE        : replace the existing file.
+ * @THUNAR_CONFLICT_RULE_REPLACE_NEWER  : replace the existing file if the source was modified later.
+ * @THUNAR_CONFLICT_RULE_REPLACE_LARGER : replace the existing file if the source is larger.
+ * @THUNAR_CONFLICT_RULE_SKIP           : keep the existing file.
+ * @THUNAR_CONFLICT_RULE_RENAME         : copy the source under another name.
+ *
+ * How a conflict found before copying is resolved.
+ **/
+typedef enum
+{
+  THUNAR_CONFLICT_RULE_ASK,
+  THUNAR_CONFLICT_RULE_REPLACE,
+  THUNAR_CONFLICT_RULE_REPLACE_NEWER,
+  THUNAR_CONFLICT_RULE_REPLACE_LARGER,
+  THUNAR_CONFLICT_RULE_SKIP,
+  THUNAR_CONFLICT_RULE_RENAME,
+} ThunarConflictRule;
+
+typedef struct _ThunarTransferConflict ThunarTransferConflict;
+
+/**
+ * ThunarTransferConflict:
+ *
+ * A file to be copied over an existing one, see ThunarTransferJob::ask-conflicts.
+ **/
+struct _ThunarTransferConflict
+{
+  GFile             *source_file;
+  GFile             *target_file;
+  GFileType          source_type;
+  GFileType          target_type;
+  guint64            source_size;
+  guint64            target_size;
+  guint64            source_mtime;
+  guint64            target_mtime;
+  ThunarConflictRule rule;
+};
+
 typedef struct _ThunarTransferJobPrivate ThunarTransferJobPrivate;
 typedef struct _ThunarTransferJobClass   ThunarTransferJobClass;
 typedef struct _ThunarTransferJob        ThunarTransferJob;
@@ -51,14 +94,21 @@ typedef struct _ThunarTransferJob        ThunarTransferJob;
 
 GType      thunar_transfer_job_get_type (void) G_GNUC_CONST;
 
-ThunarJob *thunar_transfer_job_new        (GList                *source_file_list,
-                                           GList                *target_file_list,
-                                           ThunarTransferJobType type) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+ThunarJob *thunar_transfer_job_new            (GList                *source_file_list,
+                                               GList                *target_file_list,
+                                               ThunarTransferJobType type) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+
+gchar     *thunar_transfer_job_get_status     (ThunarTransferJob    *job);
+
+gboolean   thunar_transfer_job_is_counting    (ThunarTransferJob    *job);
 
-gchar     *thunar_transfer_job_get_status (ThunarTransferJob    *job);
+void       thunar_transfer_job_get_endpoints  (ThunarTransferJob    *job,
+                                               GFile               **source_file_return,
+                                               GFile               **target_file_return);
+void       thunar_transfer_job_set_background (ThunarTransferJob    *job,
+                                               gboolean              background);
 
-gboolean   thunar_transfer_job_can_start  (ThunarTransferJob *transfer_job,
-                                           GList             *running_job_list);
+ThunarJobResponse thunar_transfer_conflict_get_response (const ThunarTransferConflict *conflict);
 
 G_END_DECLS
 
@@ -0,0 +1,640 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A transfer journal records the progress of a copy in the cache folder,
+ * so a copy interrupted by a crash or the end of the session continues
+ * where it stopped when the same files are copied to the same place again,
+ * be it from the user interface or through D-Bus.
+ *
+ * The journal is a text file named after a hash of the toplevel source
+ * and target files. Each line is one record, appended as the copy goes:
+ *
+ *   plan <source-uri> <target-uri> <source>  a toplevel file of the copy
+ *   begin <target-uri> <source>              a file is about to be written
+ *   done <target-uri> <source>               the file was copied completely
+ *
+ * where <source> is "<size> <mtime> <ctime> <inode>" of the source file
+ * at that time, with the times in microseconds, or all %0 if unknown.
+ *
+ * A file begun but not done is a partial copy made by the journaled copy
+ * itself, which may be replaced or continued without asking, and a file
+ * done is not copied again, but only as long as its source still is the
+ * one recorded. A journal whose toplevel sources were replaced by other
+ * files is not continued at all. Records are
+ * flushed to the kernel right away, which is enough to survive a crash of
+ * Thunar, but not of the system. The journal is removed once the copy
+ * completed, and journals not used for a while are purged.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#include <stdio.h>
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-transfer-journal.h>
+
+
+
+/* journals of copies not continued within this time are removed */
+#define MAXIMUM_JOURNAL_AGE (30 * 24 * 60 * 60) /* 30 days */
+
+
+
+typedef struct
+{
+  guint64 size;
+  guint64 mtime;
+  guint64 ctime;
+  guint64 inode;
+}
+ThunarTransferSource;
+
+typedef struct
+{
+  ThunarTransferSource source;
+  gboolean             done;
+}
+ThunarTransferRecord;
+
+struct _ThunarTransferJournal
+{
+  gchar      *path;
+  FILE       *stream;
+  gboolean    is_resumed;
+
+  /* target uri -> ThunarTransferRecord, as left by the interrupted copy */
+  GHashTable *records;
+
+  /* source uri -> ThunarTransferSource of the toplevel files planned */
+  GHashTable *plans;
+
+  /* the copy workers write records as well */
+  GMutex      mutex;
+};
+
+
+
+static void
+thunar_transfer_journal_purge (const gchar *directory)
+{
+  const gchar *name;
+  GStatBuf     statb;
+  gint64       now = g_get_real_time () / G_USEC_PER_SEC;
+  gchar       *path;
+  GDir        *dir;
+
+  dir = g_dir_open (directory, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      path = g_build_filename (directory, name, NULL);
+      if (g_stat (path, &statb) == 0 && now - statb.st_mtime > MAXIMUM_JOURNAL_AGE)
+        g_unlink (path);
+      g_free (path);
+    }
+
+  g_dir_close (dir);
+}
+
+
+
+static void
+thunar_transfer_source_init (ThunarTransferSource *source,
+                             GFileInfo            *info)
+{
+  memset (source, 0, sizeof (*source));
+  if (info == NULL)
+    return;
+
+  source->size = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
+  source->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+                  + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  source->ctime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_CHANGED) * G_USEC_PER_SEC
+                  + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_CHANGED_USEC);
+  source->inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+}
+
+
+
+static gboolean
+thunar_transfer_source_parse (ThunarTransferSource *source,
+                              gchar               **fields)
+{
+  if (g_strv_length (fields) != 4)
+    return FALSE;
+
+  source->size = g_ascii_strtoull (fields[0], NULL, 10);
+  source->mtime = g_ascii_strtoull (fields[1], NULL, 10);
+  source->ctime = g_ascii_strtoull (fields[2], NULL, 10);
+  source->inode = g_ascii_strtoull (fields[3], NULL, 10);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_transfer_source_equal (const ThunarTransferSource *recorded,
+                              GFileInfo                  *info)
+{
+  ThunarTransferSource source;
+
+  /* a source not known back then never counts as unchanged */
+  if (recorded->mtime == 0 || info == NULL)
+    return FALSE;
+
+  thunar_transfer_source_init (&source, info);
+
+  /* the change time catches writes which restored the modification
+   * time, the inode a file replaced by another one (file systems
+   * without inodes report 0 for both) */
+  return recorded->size == source.size
+         && recorded->mtime == source.mtime
+         && recorded->ctime == source.ctime
+         && recorded->inode == source.inode;
+}
+
+
+
+static ThunarTransferRecord *
+thunar_transfer_journal_get_record (ThunarTransferJournal *journal,
+                                    const gchar           *uri)
+{
+  ThunarTransferRecord *record;
+
+  record = g_hash_table_lookup (journal->records, uri);
+  if (record == NULL)
+    {
+      record = g_slice_new0 (ThunarTransferRecord);
+      g_hash_table_insert (journal->records, g_strdup (uri), record);
+    }
+
+  return record;
+}
+
+
+
+static void
+thunar_transfer_record_free (gpointer data)
+{
+  g_slice_free (ThunarTransferRecord, data);
+}
+
+
+
+static void
+thunar_transfer_source_free (gpointer data)
+{
+  g_slice_free (ThunarTransferSource, data);
+}
+
+
+
+static void
+thunar_transfer_journal_load (ThunarTransferJournal *journal,
+                              gchar                 *contents)
+{
+  ThunarTransferRecord *record;
+  ThunarTransferSource  source;
+  gchar                *line;
+  gchar                *end;
+  gchar               **fields;
+
+  for (line = contents; (end = strchr (line, '\n')) != NULL; line = end + 1)
+    {
+      /* a record is only complete with its newline, so the
+       * last one written before a crash is ignored here */
+      *end = '\0';
+
+      /* records of older versions lack the source and are ignored,
+       * so their files go through the usual conflict handling */
+      fields = g_strsplit (line, " ", 0);
+      if (g_strcmp0 (fields[0], "plan") == 0 && g_strv_length (fields) >= 3
+          && thunar_transfer_source_parse (&source, fields + 3))
+        {
+          g_hash_table_replace (journal->plans, g_strdup (fields[1]),
+                                g_slice_dup (ThunarTransferSource, &source));
+        }
+      else if ((g_strcmp0 (fields[0], "begin") == 0 || g_strcmp0 (fields[0], "done") == 0)
+               && g_strv_length (fields) >= 2
+               && thunar_transfer_source_parse (&source, fields + 2))
+        {
+          record = thunar_transfer_journal_get_record (journal, fields[1]);
+          record->source = source;
+          record->done = (fields[0][0] == 'd');
+        }
+      g_strfreev (fields);
+    }
+}
+
+
+
+static void
+thunar_transfer_journal_unref_info (gpointer data)
+{
+  if (data != NULL)
+    g_object_unref (data);
+}
+
+
+
+static gboolean
+thunar_transfer_journal_plans_match (ThunarTransferJournal *journal,
+                                     GList                 *source_file_list,
+                                     GList                 *source_info_list)
+{
+  ThunarTransferSource *plan;
+  ThunarTransferSource  source;
+  GList                *sp;
+  GList                *ip;
+  gchar                *uri;
+  gboolean              match = TRUE;
+
+  /* only the identity of the files counts here, the content of a
+   * folder and thus its times change when files are added to it */
+  for (sp = source_file_list, ip = source_info_list; match && sp != NULL; sp = sp->next, ip = ip->next)
+    {
+      uri = g_file_get_uri (sp->data);
+      plan = g_hash_table_lookup (journal->plans, uri);
+      g_free (uri);
+
+      thunar_transfer_source_init (&source, ip->data);
+      match = (plan != NULL && ip->data != NULL && plan->inode == source.inode);
+    }
+
+  return match;
+}
+
+
+
+static void
+thunar_transfer_journal_write (ThunarTransferJournal *journal,
+                               const gchar           *format,
+                               ...)
+{
+  va_list args;
+
+  if (G_UNLIKELY (journal->stream == NULL))
+    return;
+
+  va_start (args, format);
+  vfprintf (journal->stream, format, args);
+  va_end (args);
+
+  if (fflush (journal->stream) != 0)
+    {
+      /* stop journaling, the copy itself continues */
+      g_warning ("Failed to write transfer journal \"%s\": %s", journal->path, g_strerror (errno));
+      fclose (journal->stream);
+      journal->stream = NULL;
+    }
+}
+
+
+
+/**
+ * thunar_transfer_journal_open:
+ * @source_file_list : the toplevel #GFile<!---->s to copy.
+ * @target_file_list : the #GFile<!---->s to copy them to.
+ * @error            : return location for errors or %NULL.
+ *
+ * Opens the journal of copying @source_file_list to @target_file_list,
+ * and loads the progress recorded by an earlier copy of the same files
+ * that did not complete. The source files are queried for
+ * %THUNAR_TRANSFER_JOURNAL_ATTRIBUTES, so this blocks and is meant to
+ * be called from the thread of the copy.
+ *
+ * Return value: the #ThunarTransferJournal, or %NULL on error.
+ **/
+ThunarTransferJournal *
+thunar_transfer_journal_open (GList   *source_file_list,
+                              GList   *target_file_list,
+                              GError **error)
+{
+  ThunarTransferJournal *journal;
+  ThunarTransferSource   source;
+  GChecksum             *checksum;
+  GList                 *source_info_list = NULL;
+  GList                 *sp;
+  GList                 *tp;
+  GList                 *ip;
+  gchar                 *directory;
+  gchar                 *contents;
+  gchar                 *source_uri;
+  gchar                 *target_uri;
+  gchar                 *spec;
+
+  _thunar_return_val_if_fail (g_list_length (source_file_list) == g_list_length (target_file_list), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  directory = xfce_resource_save_location (XFCE_RESOURCE_CACHE, "Thunar/transfers/", TRUE);
+  if (G_UNLIKELY (directory == NULL))
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT,
+                   "Failed to create the transfer journal folder");
+      return NULL;
+    }
+
+  thunar_transfer_journal_purge (directory);
+
+  /* the same copy always ends up in the same journal */
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  for (sp = source_file_list, tp = target_file_list; sp != NULL; sp = sp->next, tp = tp->next)
+    {
+      source_uri = g_file_get_uri (sp->data);
+      target_uri = g_file_get_uri (tp->data);
+      g_checksum_update (checksum, (const guchar *) source_uri, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+      g_checksum_update (checksum, (const guchar *) target_uri, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+      g_free (source_uri);
+      g_free (target_uri);
+    }
+
+  spec = g_strconcat (g_checksum_get_string (checksum), ".journal", NULL);
+  g_checksum_free (checksum);
+
+  journal = g_slice_new0 (ThunarTransferJournal);
+  journal->path = g_build_filename (directory, spec, NULL);
+  journal->records = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, thunar_transfer_record_free);
+  journal->plans = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, thunar_transfer_source_free);
+  g_mutex_init (&journal->mutex);
+
+  g_free (directory);
+  g_free (spec);
+
+  for (sp = source_file_list; sp != NULL; sp = sp->next)
+    {
+      source_info_list = g_list_prepend (source_info_list,
+                                         g_file_query_info (sp->data, THUNAR_TRANSFER_JOURNAL_ATTRIBUTES,
+                                                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL, NULL));
+    }
+  source_info_list = g_list_reverse (source_info_list);
+
+  if (g_file_get_contents (journal->path, &contents, NULL, NULL))
+    {
+      thunar_transfer_journal_load (journal, contents);
+      g_free (contents);
+
+      /* other files under the same names, start over */
+      journal->is_resumed = thunar_transfer_journal_plans_match (journal, source_file_list, source_info_list);
+      if (!journal->is_resumed)
+        g_hash_table_remove_all (journal->records);
+    }
+
+  journal->stream = g_fopen (journal->path, journal->is_resumed ? "a" : "w");
+  if (G_UNLIKELY (journal->stream == NULL))
+    {
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                   "Failed to open transfer journal \"%s\": %s",
+                   journal->path, g_strerror (errno));
+      g_list_free_full (source_info_list, thunar_transfer_journal_unref_info);
+      thunar_transfer_journal_close (journal, FALSE);
+      return NULL;
+    }
+
+  if (!journal->is_resumed)
+    {
+      for (sp = source_file_list, tp = target_file_list, ip = source_info_list;
+           sp != NULL;
+           sp = sp->next, tp = tp->next, ip = ip->next)
+        {
+          source_uri = g_file_get_uri (sp->data);
+          target_uri = g_file_get_uri (tp->data);
+          thunar_transfer_source_init (&source, ip->data);
+          thunar_transfer_journal_write (journal, "plan %s %s %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+                                         " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT "\n",
+                                         source_uri, target_uri,
+                                         source.size, source.mtime, source.ctime, source.inode);
+          g_free (source_uri);
+          g_free (target_uri);
+        }
+    }
+
+  g_list_free_full (source_info_list, thunar_transfer_journal_unref_info);
+
+  return journal;
+}
+
+
+
+/**
+ * thunar_transfer_journal_close:
+ * @journal   : a #ThunarTransferJournal.
+ * @completed : whether the copy completed.
+ *
+ * Closes @journal, and removes it if the copy @completed, so
+ * copying the same files again starts over.
+ **/
+void
+thunar_transfer_journal_close (ThunarTransferJournal *journal,
+                               gboolean               completed)
+{
+  _thunar_return_if_fail (journal != NULL);
+
+  if (journal->stream != NULL)
+    fclose (journal->stream);
+
+  if (completed)
+    g_unlink (journal->path);
+
+  g_hash_table_destroy (journal->records);
+  g_hash_table_destroy (journal->plans);
+  g_mutex_clear (&journal->mutex);
+  g_free (journal->path);
+  g_slice_free (ThunarTransferJournal, journal);
+}
+
+
+
+/**
+ * thunar_transfer_journal_is_resumed:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Return value: %TRUE if @journal continues an interrupted copy.
+ **/
+gboolean
+thunar_transfer_journal_is_resumed (ThunarTransferJournal *journal)
+{
+  _thunar_return_val_if_fail (journal != NULL, FALSE);
+  return journal->is_resumed;
+}
+
+
+
+/**
+ * thunar_transfer_journal_is_done:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : a #GFile.
+ * @source_info : (nullable): the #GFileInfo of the source of @target_file
+ *                with %THUNAR_TRANSFER_JOURNAL_ATTRIBUTES.
+ *
+ * Return value: %TRUE if @target_file was copied completely from
+ *               the source @source_info describes.
+ **/
+gboolean
+thunar_transfer_journal_is_done (ThunarTransferJournal *journal,
+                                 GFile                 *target_file,
+                                 GFileInfo             *source_info)
+{
+  ThunarTransferRecord *record;
+  gboolean              is_done;
+  gchar                *uri;
+
+  _thunar_return_val_if_fail (journal != NULL, FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (source_info == NULL || G_IS_FILE_INFO (source_info), FALSE);
+
+  if (!journal->is_resumed)
+    return FALSE;
+
+  uri = g_file_get_uri (target_file);
+  record = g_hash_table_lookup (journal->records, uri);
+  is_done = (record != NULL && record->done && thunar_transfer_source_equal (&record->source, source_info));
+  g_free (uri);
+
+  return is_done;
+}
+
+
+
+/**
+ * thunar_transfer_journal_is_partial:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : a #GFile.
+ * @source_info : (nullable): the #GFileInfo of the source of @target_file
+ *                with %THUNAR_TRANSFER_JOURNAL_ATTRIBUTES.
+ *
+ * Looks up whether @target_file is a partial copy left by an earlier
+ * copy of the source @source_info describes, which may be continued
+ * or replaced without asking. Partial copies of a source that changed
+ * since are not, they are handled like any existing file.
+ *
+ * Return value: %TRUE if @target_file was begun but not done, and
+ *               the source is unchanged.
+ **/
+gboolean
+thunar_transfer_journal_is_partial (ThunarTransferJournal *journal,
+                                    GFile                 *target_file,
+                                    GFileInfo             *source_info)
+{
+  ThunarTransferRecord *record;
+  gboolean              is_partial;
+  gchar                *uri;
+
+  _thunar_return_val_if_fail (journal != NULL, FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), FALSE);
+  _thunar_return_val_if_fail (source_info == NULL || G_IS_FILE_INFO (source_info), FALSE);
+
+  if (!journal->is_resumed)
+    return FALSE;
+
+  uri = g_file_get_uri (target_file);
+  record = g_hash_table_lookup (journal->records, uri);
+  is_partial = (record != NULL && !record->done && thunar_transfer_source_equal (&record->source, source_info));
+  g_free (uri);
+
+  return is_partial;
+}
+
+
+
+static void
+thunar_transfer_journal_record (ThunarTransferJournal *journal,
+                                const gchar           *kind,
+                                GFile                 *target_file,
+                                GFileInfo             *source_info)
+{
+  ThunarTransferSource source;
+  gchar               *uri;
+
+  thunar_transfer_source_init (&source, source_info);
+
+  uri = g_file_get_uri (target_file);
+  g_mutex_lock (&journal->mutex);
+  thunar_transfer_journal_write (journal, "%s %s %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+                                 " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT "\n",
+                                 kind, uri, source.size, source.mtime, source.ctime, source.inode);
+  g_mutex_unlock (&journal->mutex);
+  g_free (uri);
+}
+
+
+
+/**
+ * thunar_transfer_journal_begin:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : the #GFile about to be written.
+ * @source_info : (nullable): the #GFileInfo of the source with
+ *                %THUNAR_TRANSFER_JOURNAL_ATTRIBUTES, or %NULL if
+ *                the copy should not be continued after an interruption.
+ *
+ * Records that @target_file is created or replaced now.
+ **/
+void
+thunar_transfer_journal_begin (ThunarTransferJournal *journal,
+                               GFile                 *target_file,
+                               GFileInfo             *source_info)
+{
+  _thunar_return_if_fail (journal != NULL);
+  _thunar_return_if_fail (G_IS_FILE (target_file));
+  _thunar_return_if_fail (source_info == NULL || G_IS_FILE_INFO (source_info));
+
+  thunar_transfer_journal_record (journal, "begin", target_file, source_info);
+}
+
+
+
+/**
+ * thunar_transfer_journal_done:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : the #GFile copied completely.
+ * @source_info : (nullable): the #GFileInfo of the source with
+ *                %THUNAR_TRANSFER_JOURNAL_ATTRIBUTES, or %NULL if
+ *                @target_file should be copied again after an
+ *                interruption.
+ *
+ * Records that @target_file does not need to be copied again, as
+ * long as its source does not change.
+ **/
+void
+thunar_transfer_journal_done (ThunarTransferJournal *journal,
+                              GFile                 *target_file,
+                              GFileInfo             *source_info)
+{
+  _thunar_return_if_fail (journal != NULL);
+  _thunar_return_if_fail (G_IS_FILE (target_file));
+  _thunar_return_if_fail (source_info == NULL || G_IS_FILE_INFO (source_info));
+
+  thunar_transfer_journal_record (journal, "done", target_file, source_info);
+}
@@ -0,0 +1,60 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THUNAR_TRANSFER_JOURNAL_H__
+#define __THUNAR_TRANSFER_JOURNAL_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* what a source is recorded with, for thunar_transfer_journal_begin() and friends */
+#define THUNAR_TRANSFER_JOURNAL_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC "," \
+  G_FILE_ATTRIBUTE_TIME_CHANGED "," \
+  G_FILE_ATTRIBUTE_TIME_CHANGED_USEC "," \
+  G_FILE_ATTRIBUTE_UNIX_INODE
+
+typedef struct _ThunarTransferJournal ThunarTransferJournal;
+
+ThunarTransferJournal *thunar_transfer_journal_open       (GList                 *source_file_list,
+                                                           GList                 *target_file_list,
+                                                           GError               **error);
+void                   thunar_transfer_journal_close      (ThunarTransferJournal *journal,
+                                                           gboolean               completed);
+
+gboolean               thunar_transfer_journal_is_resumed (ThunarTransferJournal *journal);
+gboolean               thunar_transfer_journal_is_done    (ThunarTransferJournal *journal,
+                                                           GFile                 *target_file,
+                                                           GFileInfo             *source_info);
+gboolean               thunar_transfer_journal_is_partial (ThunarTransferJournal *journal,
+                                                           GFile                 *target_file,
+                                                           GFileInfo             *source_info);
+
+void                   thunar_transfer_journal_begin      (ThunarTransferJournal *journal,
+                                                           GFile                 *target_file,
+                                                           GFileInfo             *source_info);
+void                   thunar_transfer_journal_done       (ThunarTransferJournal *journal,
+                                                           GFile                 *target_file,
+                                                           GFileInfo             *source_info);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_TRANSFER_JOURNAL_H__ */
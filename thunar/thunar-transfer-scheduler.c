@@ -0,0 +1,838 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The transfer scheduler decides when the transfer jobs shown in the
+ * progress dialog may run. Every job is mapped to the devices it reads
+ * from and writes to, where all partitions of a disk count as one device,
+ * and each device runs a limited number of jobs at the same time (see
+ * the settings misc-parallel-copy-mode and misc-parallel-copy-max-jobs).
+ *
+ * Waiting jobs are admitted in the order they were queued: a job that
+ * has to wait keeps later jobs from overtaking it on its devices, but
+ * not on other devices. While the devices of a waiting job are not known
+ * yet, it keeps all later jobs waiting that need a device. Jobs admitted
+ * next to other running ones copy with a lower I/O priority, so the
+ * earlier jobs finish first. The scheduler is only used from the main
+ * thread.
+ *
+ * Finding the device of a file takes a stat() and some lookups in /sys,
+ * which may block on slow or hung mounts, so the devices of a queued
+ * job are resolved in a worker thread, and the results are cached per
+ * mounted file system until a mount goes away.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#include <stdio.h>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#ifdef HAVE_SYS_SYSMACROS_H
+#include <sys/sysmacros.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <thunar/thunar-enum-types.h>
+#include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-preferences.h>
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-transfer-scheduler.h>
+
+
+
+/* jobs per local device if misc-parallel-copy-max-jobs is 0 */
+#define DEFAULT_MAX_JOBS_ROTATIONAL  1
+#define DEFAULT_MAX_JOBS_SOLID_STATE 4
+
+/* see linux/ioprio.h */
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_CLASS_BE    2
+#define IOPRIO_CLASS_IDLE  3
+#define IOPRIO_BE_LOWEST   7
+#define IOPRIO_WHO_PROCESS 1
+
+
+
+typedef struct _ThunarTransferDevice     ThunarTransferDevice;
+typedef struct _ThunarTransferDeviceInfo ThunarTransferDeviceInfo;
+typedef struct _ThunarTransferEntry      ThunarTransferEntry;
+typedef struct _ThunarTransferResolve    ThunarTransferResolve;
+
+struct _ThunarTransferDevice
+{
+  gchar                 *id;
+  gboolean               is_local;
+  gboolean               is_rotational;
+
+  /* running jobs reading from or writing to this device */
+  guint                  n_running;
+
+  /* set while a waiting job holds this device, see thunar_transfer_scheduler_dequeue() */
+  gboolean               is_blocked;
+
+  guint                  ref_count;
+};
+
+struct _ThunarTransferDeviceInfo
+{
+  gchar                 *id;
+  gboolean               is_local;
+  gboolean               is_rotational;
+};
+
+struct _ThunarTransferEntry
+{
+  ThunarTransferJob          *job;
+  ThunarParallelCopyMode      mode;
+  gboolean                    is_running;
+
+  /* %NULL if the job has no files to transfer */
+  ThunarTransferDevice       *source;
+  ThunarTransferDevice       *target;
+
+  /* set while the devices are resolved */
+  GCancellable               *cancellable;
+
+  ThunarTransferSchedulerFunc func;
+  gpointer                    user_data;
+};
+
+struct _ThunarTransferResolve
+{
+  ThunarTransferJob        *job;
+  GFile                    *source_file;
+  GFile                    *target_file;
+  ThunarTransferDeviceInfo *source;
+  ThunarTransferDeviceInfo *target;
+};
+
+
+
+static GHashTable     *devices;
+static GQueue          entries = G_QUEUE_INIT; /* in the order the jobs were queued */
+static guint           n_running;
+static GVolumeMonitor *volume_monitor;
+
+/* st_dev of a mounted file system -> ThunarTransferDeviceInfo, used by any thread */
+static GHashTable     *device_infos;
+G_LOCK_DEFINE_STATIC (device_infos);
+
+
+
+static gboolean
+thunar_transfer_scheduler_get_disk (dev_t  dev,
+                                    guint *major_return,
+                                    guint *minor_return)
+{
+#ifdef major
+  gchar   *contents = NULL;
+  gchar   *path;
+  gboolean succeed = FALSE;
+
+  *major_return = major (dev);
+  *minor_return = minor (dev);
+
+  /* file systems without a block device (tmpfs, network mounts) have no entry */
+  path = g_strdup_printf ("/sys/dev/block/%u:%u", *major_return, *minor_return);
+  if (g_file_test (path, G_FILE_TEST_IS_DIR))
+    {
+      succeed = TRUE;
+
+      /* partitions share the request queue of their disk, so use that one */
+      g_free (path);
+      path = g_strdup_printf ("/sys/dev/block/%u:%u/partition", *major_return, *minor_return);
+      if (g_file_test (path, G_FILE_TEST_EXISTS))
+        {
+          g_free (path);
+          path = g_strdup_printf ("/sys/dev/block/%u:%u/../dev", *major_return, *minor_return);
+          if (g_file_get_contents (path, &contents, NULL, NULL))
+            sscanf (contents, "%u:%u", major_return, minor_return);
+          g_free (contents);
+        }
+    }
+
+  g_free (path);
+
+  return succeed;
+#else
+  return FALSE;
+#endif
+}
+
+
+
+static void
+thunar_transfer_scheduler_device_info_free (gpointer data)
+{
+  ThunarTransferDeviceInfo *info = data;
+
+  g_free (info->id);
+  g_slice_free (ThunarTransferDeviceInfo, info);
+}
+
+
+
+static ThunarTransferDeviceInfo *
+thunar_transfer_scheduler_device_info_copy (const ThunarTransferDeviceInfo *info)
+{
+  ThunarTransferDeviceInfo *copy;
+
+  copy = g_slice_dup (ThunarTransferDeviceInfo, info);
+  copy->id = g_strdup (info->id);
+
+  return copy;
+}
+
+
+
+static ThunarTransferDeviceInfo *
+thunar_transfer_scheduler_resolve (GFile *file)
+{
+  ThunarTransferDeviceInfo *info = NULL;
+  GFileInfo                *file_info;
+  GFile                    *existing;
+  GFile                    *parent;
+  gboolean                  has_dev = FALSE;
+  gint64                   *key;
+  gint64                    dev = 0;
+  gchar                    *contents = NULL;
+  gchar                    *path;
+  gchar                    *scheme;
+  guint                     disk_major = 0;
+  guint                     disk_minor = 0;
+#ifdef HAVE_SYS_STAT_H
+  struct stat               statb;
+#endif
+
+  /* the target usually does not exist yet, so look at the closest
+   * existing folder, in the worst case the root of the mount */
+  existing = g_object_ref (file);
+  while (!g_file_query_exists (existing, NULL))
+    {
+      parent = g_file_get_parent (existing);
+      if (parent == NULL)
+        break;
+      g_object_unref (existing);
+      existing = parent;
+    }
+
+#ifdef HAVE_SYS_STAT_H
+  if (g_file_peek_path (existing) != NULL && stat (g_file_peek_path (existing), &statb) == 0)
+    {
+      has_dev = TRUE;
+      dev = statb.st_dev;
+
+      G_LOCK (device_infos);
+      if (device_infos != NULL && (info = g_hash_table_lookup (device_infos, &dev)) != NULL)
+        info = thunar_transfer_scheduler_device_info_copy (info);
+      G_UNLOCK (device_infos);
+
+      if (info != NULL)
+        {
+          g_object_unref (existing);
+          return info;
+        }
+    }
+#endif
+
+  info = g_slice_new0 (ThunarTransferDeviceInfo);
+  info->is_local = thunar_g_file_is_on_local_device (existing);
+
+  if (has_dev && thunar_transfer_scheduler_get_disk (dev, &disk_major, &disk_minor))
+    {
+      info->id = g_strdup_printf ("block:%u:%u", disk_major, disk_minor);
+
+      path = g_strdup_printf ("/sys/dev/block/%u:%u/queue/rotational", disk_major, disk_minor);
+      if (g_file_get_contents (path, &contents, NULL, NULL))
+        info->is_rotational = (contents[0] == '1');
+      g_free (contents);
+      g_free (path);
+    }
+  else
+    {
+      file_info = g_file_query_info (existing, G_FILE_ATTRIBUTE_ID_FILESYSTEM,
+                                     G_FILE_QUERY_INFO_NONE, NULL, NULL);
+      if (file_info != NULL && g_file_info_get_attribute_string (file_info, G_FILE_ATTRIBUTE_ID_FILESYSTEM) != NULL)
+        info->id = g_strconcat ("fs:", g_file_info_get_attribute_string (file_info, G_FILE_ATTRIBUTE_ID_FILESYSTEM), NULL);
+      else
+        {
+          scheme = g_file_get_uri_scheme (existing);
+          info->id = g_strconcat ("uri:", scheme, NULL);
+          g_free (scheme);
+        }
+      if (file_info != NULL)
+        g_object_unref (file_info);
+    }
+
+  g_object_unref (existing);
+
+  /* the lookups above are done without the lock, another
+   * thread resolving the same mount meanwhile does no harm */
+  if (has_dev)
+    {
+      key = g_new (gint64, 1);
+      *key = dev;
+
+      G_LOCK (device_infos);
+      if (device_infos == NULL)
+        device_infos = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free,
+                                              thunar_transfer_scheduler_device_info_free);
+      g_hash_table_replace (device_infos, key, thunar_transfer_scheduler_device_info_copy (info));
+      G_UNLOCK (device_infos);
+    }
+
+  return info;
+}
+
+
+
+static void
+thunar_transfer_scheduler_mount_removed (GVolumeMonitor *monitor,
+                                         GMount         *mount)
+{
+  /* another file system may be mounted with the same st_dev */
+  G_LOCK (device_infos);
+  if (device_infos != NULL)
+    g_hash_table_remove_all (device_infos);
+  G_UNLOCK (device_infos);
+}
+
+
+
+static ThunarTransferDevice *
+thunar_transfer_scheduler_get_device (const ThunarTransferDeviceInfo *info)
+{
+  ThunarTransferDevice *device;
+
+  if (devices == NULL)
+    devices = g_hash_table_new (g_str_hash, g_str_equal);
+
+  device = g_hash_table_lookup (devices, info->id);
+  if (device == NULL)
+    {
+      device = g_slice_new0 (ThunarTransferDevice);
+      device->id = g_strdup (info->id);
+      device->is_local = info->is_local;
+      device->is_rotational = info->is_rotational;
+      g_hash_table_insert (devices, device->id, device);
+    }
+
+  device->ref_count++;
+
+  return device;
+}
+
+
+
+static void
+thunar_transfer_scheduler_release_device (ThunarTransferDevice *device)
+{
+  if (--device->ref_count > 0)
+    return;
+
+  g_hash_table_remove (devices, device->id);
+  g_free (device->id);
+  g_slice_free (ThunarTransferDevice, device);
+}
+
+
+
+static guint
+thunar_transfer_scheduler_get_max_jobs (ThunarTransferDevice *device)
+{
+  ThunarPreferences *preferences;
+  guint              max_jobs;
+
+  /* removable and network devices are slow enough to be busy with one copy */
+  if (!device->is_local)
+    return 1;
+
+  preferences = thunar_preferences_get ();
+  g_object_get (G_OBJECT (preferences), "misc-parallel-copy-max-jobs", &max_jobs, NULL);
+  g_object_unref (preferences);
+
+  if (max_jobs > 0)
+    return max_jobs;
+
+  /* spinning disks lose more to seeking than they gain from concurrency */
+  return device->is_rotational ? DEFAULT_MAX_JOBS_ROTATIONAL : DEFAULT_MAX_JOBS_SOLID_STATE;
+}
+
+
+
+static gboolean
+thunar_transfer_scheduler_can_run (ThunarTransferEntry *entry)
+{
+  /* the devices are not known yet */
+  if (entry->cancellable != NULL)
+    return entry->mode == THUNAR_PARALLEL_COPY_MODE_ALWAYS;
+
+  if (entry->source == NULL || entry->mode == THUNAR_PARALLEL_COPY_MODE_ALWAYS)
+    return TRUE;
+
+  if (entry->mode == THUNAR_PARALLEL_COPY_MODE_NEVER)
+    return n_running == 0;
+
+  if (entry->source->is_blocked || entry->target->is_blocked)
+    return FALSE;
+
+  /* copies across devices wait until both of them are idle */
+  if (entry->mode == THUNAR_PARALLEL_COPY_MODE_ONLY_LOCAL_SAME_DEVICES
+      && entry->source != entry->target)
+    return entry->source->n_running == 0 && entry->target->n_running == 0;
+
+  return entry->source->n_running < thunar_transfer_scheduler_get_max_jobs (entry->source)
+         && (entry->target == entry->source
+             || entry->target->n_running < thunar_transfer_scheduler_get_max_jobs (entry->target));
+}
+
+
+
+static gboolean
+thunar_transfer_scheduler_needs_device (ThunarTransferEntry *entry)
+{
+  return entry->mode != THUNAR_PARALLEL_COPY_MODE_ALWAYS
+         && (entry->source != NULL || entry->cancellable != NULL);
+}
+
+
+
+static gboolean
+thunar_transfer_scheduler_is_busy (ThunarTransferEntry *entry)
+{
+  if (entry->source == NULL)
+    return n_running > 0;
+
+  return entry->source->n_running > 0 || entry->target->n_running > 0;
+}
+
+
+
+static void
+thunar_transfer_scheduler_run (ThunarTransferEntry *entry)
+{
+  entry->is_running = TRUE;
+  n_running++;
+
+  if (entry->source == NULL)
+    return;
+
+  entry->source->n_running++;
+  if (entry->target != entry->source)
+    entry->target->n_running++;
+}
+
+
+
+static ThunarTransferEntry *
+thunar_transfer_scheduler_lookup (ThunarTransferJob *job)
+{
+  GList *lp;
+
+  for (lp = entries.head; lp != NULL; lp = lp->next)
+    if (((ThunarTransferEntry *) lp->data)->job == job)
+      return lp->data;
+
+  return NULL;
+}
+
+
+
+static void
+thunar_transfer_scheduler_resolve_free (gpointer data)
+{
+  ThunarTransferResolve *resolve = data;
+
+  g_object_unref (resolve->job);
+  g_object_unref (resolve->source_file);
+  g_object_unref (resolve->target_file);
+  if (resolve->source != NULL)
+    thunar_transfer_scheduler_device_info_free (resolve->source);
+  if (resolve->target != NULL)
+    thunar_transfer_scheduler_device_info_free (resolve->target);
+  g_slice_free (ThunarTransferResolve, resolve);
+}
+
+
+
+static void
+thunar_transfer_scheduler_resolve_thread (GTask        *task,
+                                          gpointer      source_object,
+                                          gpointer      task_data,
+                                          GCancellable *cancellable)
+{
+  ThunarTransferResolve *resolve = task_data;
+
+  resolve->source = thunar_transfer_scheduler_resolve (resolve->source_file);
+  if (!g_cancellable_is_cancelled (cancellable))
+    resolve->target = thunar_transfer_scheduler_resolve (resolve->target_file);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+
+
+static void
+thunar_transfer_scheduler_resolve_ready (GObject      *object,
+                                         GAsyncResult *result,
+                                         gpointer      user_data)
+{
+  ThunarTransferResolve *resolve = g_task_get_task_data (G_TASK (result));
+  ThunarTransferEntry   *entry;
+
+  /* the job was removed meanwhile */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    return;
+
+  entry = thunar_transfer_scheduler_lookup (resolve->job);
+  _thunar_assert (entry != NULL);
+
+  entry->source = thunar_transfer_scheduler_get_device (resolve->source);
+  entry->target = thunar_transfer_scheduler_get_device (resolve->target);
+  g_clear_object (&entry->cancellable);
+
+  /* started by the user before its devices were known */
+  if (entry->is_running)
+    {
+      entry->source->n_running++;
+      if (entry->target != entry->source)
+        entry->target->n_running++;
+    }
+
+  if (entry->func != NULL)
+    (*entry->func) (entry->user_data);
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_enqueue:
+ * @job       : a #ThunarTransferJob which is not launched yet.
+ * @func      : (nullable): function to call once the devices of @job are known.
+ * @user_data : data to pass to @func.
+ *
+ * Queues @job to be admitted by thunar_transfer_scheduler_dequeue(),
+ * which should be called right after this, and again from @func.
+ *
+ * The devices of @job are resolved in the background, @func is not
+ * called if @job is removed before that finished.
+ **/
+void
+thunar_transfer_scheduler_enqueue (ThunarTransferJob          *job,
+                                   ThunarTransferSchedulerFunc func,
+                                   gpointer                    user_data)
+{
+  ThunarTransferResolve *resolve;
+  ThunarTransferEntry   *entry;
+  GFile                 *source_file;
+  GFile                 *target_file;
+  GTask                 *task;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (thunar_transfer_scheduler_lookup (job) == NULL);
+
+  entry = g_slice_new0 (ThunarTransferEntry);
+  entry->job = g_object_ref (job);
+  g_object_get (G_OBJECT (job), "parallel-copy-mode", &entry->mode, NULL);
+
+  entry->func = func;
+  entry->user_data = user_data;
+
+  thunar_transfer_job_get_endpoints (job, &source_file, &target_file);
+  if (source_file != NULL && target_file != NULL)
+    {
+      /* forget the cached devices of removed mounts */
+      if (volume_monitor == NULL)
+        {
+          volume_monitor = g_volume_monitor_get ();
+          g_signal_connect (volume_monitor, "mount-removed",
+                            G_CALLBACK (thunar_transfer_scheduler_mount_removed), NULL);
+        }
+
+      resolve = g_slice_new0 (ThunarTransferResolve);
+      resolve->job = g_object_ref (job);
+      resolve->source_file = g_object_ref (source_file);
+      resolve->target_file = g_object_ref (target_file);
+
+      entry->cancellable = g_cancellable_new ();
+      task = g_task_new (NULL, entry->cancellable, thunar_transfer_scheduler_resolve_ready, NULL);
+      g_task_set_task_data (task, resolve, thunar_transfer_scheduler_resolve_free);
+      g_task_run_in_thread (task, thunar_transfer_scheduler_resolve_thread);
+      g_object_unref (task);
+    }
+
+  g_queue_push_tail (&entries, entry);
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_dequeue:
+ *
+ * Admits the waiting jobs which fit on their devices now. The
+ * caller is responsible to launch them.
+ *
+ * The caller is responsible to free the returned list using
+ * g_list_free() when no longer needed.
+ *
+ * Return value: the list of #ThunarTransferJob<!---->s to launch.
+ **/
+GList *
+thunar_transfer_scheduler_dequeue (void)
+{
+  ThunarTransferEntry *entry;
+  GList               *admitted = NULL;
+  GList               *lp;
+  gboolean             resolving = FALSE;
+
+  for (lp = entries.head; lp != NULL; lp = lp->next)
+    {
+      entry = lp->data;
+      if (entry->is_running)
+        continue;
+
+      /* an earlier job might be waiting for the same devices */
+      if (resolving && thunar_transfer_scheduler_needs_device (entry))
+        continue;
+
+      if (thunar_transfer_scheduler_can_run (entry))
+        {
+          /* jobs sharing the disk with running ones yield to them */
+          thunar_transfer_job_set_background (entry->job, thunar_transfer_scheduler_is_busy (entry));
+          thunar_transfer_scheduler_run (entry);
+          admitted = g_list_prepend (admitted, entry->job);
+        }
+      else if (entry->mode == THUNAR_PARALLEL_COPY_MODE_NEVER)
+        {
+          /* nothing overtakes a job waiting for all others */
+          break;
+        }
+      else if (entry->cancellable != NULL)
+        {
+          /* the devices are not known yet, so hold back all of them */
+          resolving = TRUE;
+        }
+      else if (entry->source != NULL)
+        {
+          /* later jobs don't overtake this one on its devices */
+          entry->source->is_blocked = TRUE;
+          entry->target->is_blocked = TRUE;
+        }
+    }
+
+  for (lp = entries.head; lp != NULL; lp = lp->next)
+    {
+      entry = lp->data;
+      if (entry->source != NULL)
+        {
+          entry->source->is_blocked = FALSE;
+          entry->target->is_blocked = FALSE;
+        }
+    }
+
+  return g_list_reverse (admitted);
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_start:
+ * @job : a queued #ThunarTransferJob.
+ *
+ * Marks @job as running although its devices might be busy,
+ * because the user asked to start it right away.
+ **/
+void
+thunar_transfer_scheduler_start (ThunarTransferJob *job)
+{
+  ThunarTransferEntry *entry;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  entry = thunar_transfer_scheduler_lookup (job);
+  if (entry != NULL && !entry->is_running)
+    {
+      /* the user wants this one now, don't hold it back */
+      thunar_transfer_job_set_background (job, FALSE);
+      thunar_transfer_scheduler_run (entry);
+    }
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_remove:
+ * @job : a #ThunarTransferJob.
+ *
+ * Removes @job once it finished or was cancelled, and frees its
+ * devices for the waiting jobs. Does nothing if @job was not queued.
+ **/
+void
+thunar_transfer_scheduler_remove (ThunarTransferJob *job)
+{
+  ThunarTransferEntry *entry;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  entry = thunar_transfer_scheduler_lookup (job);
+  if (entry == NULL)
+    return;
+
+  if (entry->is_running)
+    {
+      n_running--;
+      if (entry->source != NULL)
+        {
+          entry->source->n_running--;
+          if (entry->target != entry->source)
+            entry->target->n_running--;
+        }
+    }
+
+  if (entry->source != NULL)
+    {
+      thunar_transfer_scheduler_release_device (entry->source);
+      thunar_transfer_scheduler_release_device (entry->target);
+    }
+
+  if (entry->cancellable != NULL)
+    {
+      g_cancellable_cancel (entry->cancellable);
+      g_object_unref (entry->cancellable);
+    }
+
+  g_queue_remove (&entries, entry);
+  g_object_unref (entry->job);
+  g_slice_free (ThunarTransferEntry, entry);
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_is_rotational:
+ * @file : a #GFile.
+ *
+ * Checks whether the disk @file is stored on has spinning platters.
+ * May be called from any thread.
+ *
+ * Return value: %TRUE for rotational disks, %FALSE otherwise.
+ **/
+gboolean
+thunar_transfer_scheduler_is_rotational (GFile *file)
+{
+  ThunarTransferDeviceInfo *info;
+  gboolean                  is_rotational;
+
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+
+  info = thunar_transfer_scheduler_resolve (file);
+  is_rotational = info->is_rotational;
+  thunar_transfer_scheduler_device_info_free (info);
+
+  return is_rotational;
+}
+
+
+
+static gint
+thunar_transfer_scheduler_set_io_priority (gint priority)
+{
+#if defined (__linux__) && defined (HAVE_SYS_SYSCALL_H) && defined (SYS_ioprio_set) && defined (SYS_ioprio_get)
+  gint previous;
+
+  /* with IOPRIO_WHO_PROCESS, 0 is the calling thread */
+  previous = syscall (SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0);
+  if (previous < 0 || syscall (SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, priority) != 0)
+    {
+      g_debug ("Failed to lower the I/O priority: %s", g_strerror (errno));
+      return -1;
+    }
+
+  return previous;
+#else
+  return -1;
+#endif
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_set_background:
+ *
+ * Moves the I/O of the calling thread to the idle class, so it only
+ * uses the disk while no other program does. Meant for work nobody
+ * waits for, like counting the files of a copy in advance, in threads
+ * of its own.
+ **/
+void
+thunar_transfer_scheduler_set_background (void)
+{
+  thunar_transfer_scheduler_set_io_priority (IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_lower_io_priority:
+ *
+ * Lowers the I/O priority of the calling thread to the lowest level of
+ * the best-effort class, for copies the scheduler runs next to others.
+ * Unlike the idle class, this never stalls the copy completely.
+ *
+ * Threads shared with other work, like those of GLib's thread pools,
+ * have to restore the priority with
+ * thunar_transfer_scheduler_restore_io_priority() when done.
+ *
+ * Return value: the previous I/O priority, or -1 if it was not changed.
+ **/
+gint
+thunar_transfer_scheduler_lower_io_priority (void)
+{
+  return thunar_transfer_scheduler_set_io_priority (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT | IOPRIO_BE_LOWEST);
+}
+
+
+
+/**
+ * thunar_transfer_scheduler_restore_io_priority:
+ * @previous : the value returned by thunar_transfer_scheduler_lower_io_priority().
+ *
+ * Restores the I/O priority of the calling thread.
+ **/
+void
+thunar_transfer_scheduler_restore_io_priority (gint previous)
+{
+#if defined (__linux__) && defined (HAVE_SYS_SYSCALL_H) && defined (SYS_ioprio_set)
+  if (previous >= 0)
+    syscall (SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, previous);
+#endif
+}
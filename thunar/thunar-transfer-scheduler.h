@@ -0,0 +1,42 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THUNAR_TRANSFER_SCHEDULER_H__
+#define __THUNAR_TRANSFER_SCHEDULER_H__
+
+#include <thunar/thunar-transfer-job.h>
+
+G_BEGIN_DECLS
+
+typedef void (*ThunarTransferSchedulerFunc) (gpointer user_data);
+
+void      thunar_transfer_scheduler_enqueue              (ThunarTransferJob          *job,
+                                                          ThunarTransferSchedulerFunc func,
+                                                          gpointer                    user_data);
+GList    *thunar_transfer_scheduler_dequeue              (void) G_GNUC_WARN_UNUSED_RESULT;
+void      thunar_transfer_scheduler_start                (ThunarTransferJob          *job);
+void      thunar_transfer_scheduler_remove               (ThunarTransferJob          *job);
+
+gboolean  thunar_transfer_scheduler_is_rotational        (GFile                      *file);
+void      thunar_transfer_scheduler_set_background       (void);
+gint      thunar_transfer_scheduler_lower_io_priority    (void);
+void      thunar_transfer_scheduler_restore_io_priority  (gint                        previous);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_TRANSFER_SCHEDULER_H__ */
@@ -745,6 +745,10 @@ thunar_util_next_new_file_name (ThunarFile            *dir,
           g_free (name);
         }
 
+      /* the other files of large folders are only indexed by name */
+      if (!found_duplicate && thunar_folder_lookup_entry (folder, new_name) != NULL)
+        found_duplicate = TRUE;
+
       if (!found_duplicate)
         break;
       g_free (new_name);
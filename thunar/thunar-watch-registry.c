@@ -0,0 +1,800 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The watch registry hands out file system watches for ThunarFile and
+ * ThunarFolder. All watches on the same directory share one GFileMonitor,
+ * and regular files share the monitor of their parent directory, so the
+ * number of kernel watches roughly equals the number of directories in
+ * use.
+ *
+ * Watches on local directories count against a budget (see the hidden
+ * setting misc-file-watch-budget). Once it is exhausted, the least
+ * recently used directory drops its monitor and is polled instead, and
+ * gets its monitor back as soon as there is room again. Each time this
+ * happens, the watch usage is logged as a debug message.
+ *
+ * Polling queries the files in a thread pool, without holding the
+ * registry lock, so a slow or hung mount neither stalls the other
+ * watches nor the user interface. The results are compared with the
+ * previous ones back in the main loop.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-watch-registry.h>
+
+
+
+/* budget used if the inotify limit cannot be determined */
+#define DEFAULT_WATCH_BUDGET 4096
+
+/* interval for polling locations that don't have a monitor */
+#define POLL_INTERVAL 5 /* seconds */
+
+/* threads querying polled locations, so one hung mount doesn't stop the others */
+#define POLL_THREADS 4
+
+/* poll stamp of files not queried yet, see thunar_watch_poll_finish() */
+#define POLL_STAMP_UNKNOWN G_MAXUINT64
+
+
+
+typedef struct _ThunarWatchLocation ThunarWatchLocation;
+
+struct _ThunarWatchLocation
+{
+  GFile        *location;
+  gboolean      is_native;
+
+  /* the shared monitor, or the poll source if degraded */
+  GFileMonitor *monitor;
+  guint         poll_id;
+  guint64       poll_stamp;
+  gboolean      poll_running;
+
+  /* tells apart locations allocated at the same address */
+  guint         serial;
+
+  /* link in either location_lru or location_polled */
+  GList         link;
+
+  GList        *watches;
+};
+
+struct _ThunarWatch
+{
+  ThunarWatchLocation *location;
+
+  /* the watched file, or %NULL for the whole location */
+  GFile               *file;
+  guint64              poll_stamp;
+
+  ThunarWatchFunc      func;
+  gpointer             user_data;
+
+  gint                 ref_count;
+};
+
+typedef struct
+{
+  ThunarWatch      *watch;
+  GFile            *event_file;
+  GFileMonitorEvent event_type;
+}
+ThunarWatchEvent;
+
+typedef struct
+{
+  /* only looked at under the lock, once known to be still registered */
+  ThunarWatchLocation *location;
+  guint                serial;
+
+  /* what to query, and the results */
+  GFile               *location_file;
+  guint64              location_stamp;
+  ThunarWatch        **watches;
+  guint64             *stamps;
+  guint                n_watches;
+}
+ThunarWatchPoll;
+
+
+
+static void     thunar_watch_location_changed    (GFileMonitor        *monitor,
+                                                  GFile               *event_file,
+                                                  GFile               *other_file,
+                                                  GFileMonitorEvent    event_type,
+                                                  gpointer             user_data);
+static gboolean thunar_watch_location_poll       (gpointer             user_data);
+static void     thunar_watch_location_queue_poll (ThunarWatchLocation *location);
+
+
+
+G_LOCK_DEFINE_STATIC (registry_mutex);
+
+static GHashTable  *locations;
+static GQueue       location_lru = G_QUEUE_INIT;    /* monitored local locations, least recently used first */
+static GQueue       location_polled = G_QUEUE_INIT; /* degraded local locations, least recently used first */
+static guint        location_serial;
+static guint        watch_budget;
+static guint        watch_count;
+static GThreadPool *poll_pool;
+
+
+
+static ThunarWatch *
+thunar_watch_ref (ThunarWatch *watch)
+{
+  g_atomic_int_inc (&watch->ref_count);
+  return watch;
+}
+
+
+
+static void
+thunar_watch_unref (ThunarWatch *watch)
+{
+  if (g_atomic_int_dec_and_test (&watch->ref_count))
+    {
+      if (watch->file != NULL)
+        g_object_unref (watch->file);
+      g_slice_free (ThunarWatch, watch);
+    }
+}
+
+
+
+static guint
+thunar_watch_registry_get_budget (void)
+{
+  gchar *contents;
+  guint  max_user_watches = 0;
+
+  if (watch_budget != 0)
+    return watch_budget;
+
+  /* by default, leave half of the inotify watches to other applications */
+  if (g_file_get_contents ("/proc/sys/fs/inotify/max_user_watches", &contents, NULL, NULL))
+    {
+      max_user_watches = g_ascii_strtoull (contents, NULL, 10);
+      g_free (contents);
+    }
+
+  if (max_user_watches == 0)
+    watch_budget = DEFAULT_WATCH_BUDGET;
+  else
+    watch_budget = MAX (max_user_watches / 2, 1);
+
+  return watch_budget;
+}
+
+
+
+static guint64
+thunar_watch_query_stamp (GFile *file)
+{
+  GFileInfo *info;
+  guint64    stamp;
+
+  /* stamp for change detection while polling, 0 if the file is gone.
+   * This may block on slow mounts, so never call it with the lock held */
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            NULL, NULL);
+  if (info == NULL)
+    return 0;
+
+  stamp = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+          + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  g_object_unref (info);
+
+  return MAX (stamp, 1);
+}
+
+
+
+static gboolean
+thunar_watch_location_connect (ThunarWatchLocation *location,
+                               GCancellable        *cancellable,
+                               GError             **error)
+{
+  _thunar_return_val_if_fail (location->monitor == NULL, FALSE);
+
+  location->monitor = g_file_monitor (location->location,
+                                      G_FILE_MONITOR_WATCH_MOUNTS | G_FILE_MONITOR_WATCH_MOVES,
+                                      cancellable, error);
+  if (G_UNLIKELY (location->monitor == NULL))
+    return FALSE;
+
+  g_signal_connect (location->monitor, "changed", G_CALLBACK (thunar_watch_location_changed), location);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_watch_location_disconnect (ThunarWatchLocation *location)
+{
+  if (location->monitor != NULL)
+    {
+      g_signal_handlers_disconnect_matched (location->monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, location);
+      g_file_monitor_cancel (location->monitor);
+      g_object_unref (location->monitor);
+      location->monitor = NULL;
+    }
+
+  if (location->poll_id != 0)
+    {
+      g_source_remove (location->poll_id);
+      location->poll_id = 0;
+    }
+}
+
+
+
+static void
+thunar_watch_location_free (gpointer data)
+{
+  ThunarWatchLocation *location = data;
+
+  _thunar_return_if_fail (location->watches == NULL);
+
+  /* unlink from the lru queues */
+  if (location->is_native)
+    {
+      if (location->monitor == NULL)
+        g_queue_unlink (&location_polled, &location->link);
+      else
+        g_queue_unlink (&location_lru, &location->link);
+    }
+
+  thunar_watch_location_disconnect (location);
+
+  g_object_unref (location->location);
+  g_slice_free (ThunarWatchLocation, location);
+}
+
+
+
+static void
+thunar_watch_location_degrade (ThunarWatchLocation *location)
+{
+  GList *lp;
+  gchar *name;
+
+  _thunar_return_if_fail (location->monitor != NULL);
+
+  g_queue_unlink (&location_lru, &location->link);
+
+  thunar_watch_location_disconnect (location);
+
+  /* remember the current state right away, to notice changes */
+  location->poll_stamp = POLL_STAMP_UNKNOWN;
+  for (lp = location->watches; lp != NULL; lp = lp->next)
+    ((ThunarWatch *) lp->data)->poll_stamp = POLL_STAMP_UNKNOWN;
+
+  location->poll_id = g_timeout_add_seconds (POLL_INTERVAL, thunar_watch_location_poll, location);
+  g_queue_push_tail_link (&location_polled, &location->link);
+  thunar_watch_location_queue_poll (location);
+
+  name = g_file_get_parse_name (location->location);
+  g_debug ("Watch budget of %u exhausted, polling \"%s\" instead", thunar_watch_registry_get_budget (), name);
+  g_free (name);
+}
+
+
+
+static gboolean
+thunar_watch_location_promote (ThunarWatchLocation *location)
+{
+  _thunar_return_val_if_fail (location->poll_id != 0, FALSE);
+
+  g_source_remove (location->poll_id);
+  location->poll_id = 0;
+
+  if (!thunar_watch_location_connect (location, NULL, NULL))
+    {
+      /* keep polling */
+      location->poll_id = g_timeout_add_seconds (POLL_INTERVAL, thunar_watch_location_poll, location);
+      return FALSE;
+    }
+
+  g_queue_unlink (&location_polled, &location->link);
+  g_queue_push_tail_link (&location_lru, &location->link);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_watch_registry_rebalance (void)
+{
+  guint budget = thunar_watch_registry_get_budget ();
+  guint n_polled = location_polled.length;
+
+  /* degrade the least recently used locations to polling */
+  while (location_lru.length > budget)
+    thunar_watch_location_degrade (location_lru.head->data);
+
+  /* and give the most recently used ones their monitor back */
+  while (location_lru.length < budget && location_polled.tail != NULL)
+    if (!thunar_watch_location_promote (location_polled.tail->data))
+      break;
+
+  /* report the usage whenever the budget takes effect */
+  if (location_polled.length != n_polled)
+    {
+      g_debug ("%u watches on %u monitored and %u polled locations (budget %u)",
+               watch_count, g_hash_table_size (locations) - location_polled.length,
+               location_polled.length, budget);
+    }
+}
+
+
+
+static void
+thunar_watch_location_touch (ThunarWatchLocation *location)
+{
+  if (!location->is_native)
+    return;
+
+  if (location->monitor != NULL)
+    {
+      /* move to the most recently used end */
+      g_queue_unlink (&location_lru, &location->link);
+      g_queue_push_tail_link (&location_lru, &location->link);
+    }
+  else
+    {
+      /* a location in use again takes over the slot of the least recently used one */
+      if (thunar_watch_location_promote (location))
+        thunar_watch_registry_rebalance ();
+    }
+}
+
+
+
+static gboolean
+thunar_watch_matches (ThunarWatch *watch,
+                      GFile       *event_file,
+                      GFile       *other_file)
+{
+  if (watch->file == NULL)
+    return TRUE;
+
+  return g_file_equal (watch->file, event_file)
+         || (other_file != NULL && g_file_equal (watch->file, other_file));
+}
+
+
+
+static void
+thunar_watch_location_changed (GFileMonitor     *monitor,
+                               GFile            *event_file,
+                               GFile            *other_file,
+                               GFileMonitorEvent event_type,
+                               gpointer          user_data)
+{
+  ThunarWatchLocation *location = user_data;
+  ThunarWatch         *watch;
+  GList               *watches = NULL;
+  GList               *lp;
+
+  _thunar_return_if_fail (G_IS_FILE_MONITOR (monitor));
+  _thunar_return_if_fail (G_IS_FILE (event_file));
+
+  /* collect the interested watches, callbacks may remove watches */
+  G_LOCK (registry_mutex);
+  for (lp = location->watches; lp != NULL; lp = lp->next)
+    if (thunar_watch_matches (lp->data, event_file, other_file))
+      watches = g_list_prepend (watches, thunar_watch_ref (lp->data));
+  G_UNLOCK (registry_mutex);
+
+  for (lp = g_list_reverse (watches); lp != NULL; lp = lp->next)
+    {
+      watch = lp->data;
+      if (G_LIKELY (watch->func != NULL))
+        (watch->func) (event_file, other_file, event_type, watch->user_data);
+      thunar_watch_unref (watch);
+    }
+
+  g_list_free (watches);
+}
+
+
+
+static ThunarWatchEvent *
+thunar_watch_event_new (ThunarWatch      *watch,
+                        GFile            *event_file,
+                        guint64           old_stamp,
+                        guint64           new_stamp)
+{
+  ThunarWatchEvent *event;
+
+  event = g_slice_new (ThunarWatchEvent);
+  event->watch = thunar_watch_ref (watch);
+  event->event_file = g_object_ref (event_file);
+
+  if (new_stamp == 0)
+    event->event_type = G_FILE_MONITOR_EVENT_DELETED;
+  else if (old_stamp == 0)
+    event->event_type = G_FILE_MONITOR_EVENT_CREATED;
+  else if (watch->file == NULL)
+    event->event_type = G_FILE_MONITOR_EVENT_CHANGED;
+  else
+    event->event_type = G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT;
+
+  return event;
+}
+
+
+
+static void
+thunar_watch_poll_free (ThunarWatchPoll *poll)
+{
+  guint n;
+
+  for (n = 0; n < poll->n_watches; ++n)
+    thunar_watch_unref (poll->watches[n]);
+
+  g_object_unref (poll->location_file);
+  g_free (poll->watches);
+  g_free (poll->stamps);
+  g_slice_free (ThunarWatchPoll, poll);
+}
+
+
+
+static gboolean
+thunar_watch_poll_finish (gpointer data)
+{
+  ThunarWatchPoll     *poll = data;
+  ThunarWatchLocation *location;
+  ThunarWatchEvent    *event;
+  ThunarWatch         *watch;
+  GList               *events = NULL;
+  GList               *lp;
+  guint                n;
+
+  G_LOCK (registry_mutex);
+
+  /* the location may have been released or have got its monitor back meanwhile */
+  location = locations != NULL ? g_hash_table_lookup (locations, poll->location_file) : NULL;
+  if (location != poll->location || location->serial != poll->serial)
+    location = NULL;
+
+  if (location != NULL)
+    location->poll_running = FALSE;
+
+  if (location != NULL && location->monitor == NULL)
+    {
+      for (n = 0; n < poll->n_watches; ++n)
+        {
+          /* skip watches removed while polling */
+          watch = poll->watches[n];
+          if (watch->func == NULL || watch->location != location)
+            continue;
+
+          if (watch->file == NULL)
+            {
+              /* a directory's mtime only changes if entries are added, removed or
+               * renamed; watches on the whole location are told to rescan then */
+              if (location->poll_stamp != POLL_STAMP_UNKNOWN && poll->location_stamp != location->poll_stamp)
+                events = g_list_prepend (events, thunar_watch_event_new (watch, location->location, location->poll_stamp, poll->location_stamp));
+            }
+          else
+            {
+              /* files are polled individually, as changing their contents leaves the directory alone */
+              if (watch->poll_stamp != POLL_STAMP_UNKNOWN && poll->stamps[n] != watch->poll_stamp)
+                events = g_list_prepend (events, thunar_watch_event_new (watch, watch->file, watch->poll_stamp, poll->stamps[n]));
+              watch->poll_stamp = poll->stamps[n];
+            }
+        }
+
+      location->poll_stamp = poll->location_stamp;
+    }
+
+  G_UNLOCK (registry_mutex);
+
+  for (lp = g_list_reverse (events); lp != NULL; lp = lp->next)
+    {
+      event = lp->data;
+      if (G_LIKELY (event->watch->func != NULL))
+        (event->watch->func) (event->event_file, NULL, event->event_type, event->watch->user_data);
+      thunar_watch_unref (event->watch);
+      g_object_unref (event->event_file);
+      g_slice_free (ThunarWatchEvent, event);
+    }
+
+  g_list_free (events);
+  thunar_watch_poll_free (poll);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_watch_poll_run (gpointer data,
+                       gpointer user_data)
+{
+  ThunarWatchPoll *poll = data;
+  guint            n;
+
+  /* query without the lock, the watches and files are referenced by the poll */
+  poll->location_stamp = thunar_watch_query_stamp (poll->location_file);
+  for (n = 0; n < poll->n_watches; ++n)
+    if (poll->watches[n]->file != NULL)
+      poll->stamps[n] = thunar_watch_query_stamp (poll->watches[n]->file);
+
+  /* compare in the main loop, where the watch functions are called */
+  g_idle_add (thunar_watch_poll_finish, poll);
+}
+
+
+
+static void
+thunar_watch_location_queue_poll (ThunarWatchLocation *location)
+{
+  ThunarWatchPoll *poll;
+  GList           *lp;
+  guint            n;
+
+  /* a location on a slow mount is not queried again before it answered */
+  if (location->poll_running)
+    return;
+
+  if (G_UNLIKELY (poll_pool == NULL))
+    {
+      poll_pool = g_thread_pool_new (thunar_watch_poll_run, NULL, POLL_THREADS, FALSE, NULL);
+      if (G_UNLIKELY (poll_pool == NULL))
+        return;
+    }
+
+  /* snapshot of what to query, the lock is not held while querying */
+  poll = g_slice_new0 (ThunarWatchPoll);
+  poll->location = location;
+  poll->serial = location->serial;
+  poll->location_file = g_object_ref (location->location);
+  poll->n_watches = g_list_length (location->watches);
+  poll->watches = g_new (ThunarWatch *, poll->n_watches);
+  poll->stamps = g_new0 (guint64, poll->n_watches);
+  for (lp = location->watches, n = 0; lp != NULL; lp = lp->next, ++n)
+    poll->watches[n] = thunar_watch_ref (lp->data);
+
+  location->poll_running = TRUE;
+  g_thread_pool_push (poll_pool, poll, NULL);
+}
+
+
+
+static gboolean
+thunar_watch_location_poll (gpointer user_data)
+{
+  ThunarWatchLocation *location = user_data;
+
+  G_LOCK (registry_mutex);
+
+  /* the location got its monitor back in the meantime */
+  if (G_UNLIKELY (location->monitor != NULL))
+    {
+      G_UNLOCK (registry_mutex);
+      return FALSE;
+    }
+
+  thunar_watch_location_queue_poll (location);
+
+  G_UNLOCK (registry_mutex);
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_watch_registry_add:
+ * @file         : the #GFile to watch.
+ * @is_directory : whether @file should be watched including its children.
+ * @cancellable  : a #GCancellable or %NULL.
+ * @func         : the function called for changes.
+ * @user_data    : user data for @func.
+ * @error        : return location for errors or %NULL.
+ *
+ * Starts watching @file for changes. Local files that are not
+ * directories share the watch on their parent directory, and
+ * only receive the events that concern them.
+ *
+ * Return value: a #ThunarWatch to pass to thunar_watch_registry_remove(),
+ *               or %NULL if @file could not be watched.
+ **/
+ThunarWatch *
+thunar_watch_registry_add (GFile           *file,
+                           gboolean         is_directory,
+                           GCancellable    *cancellable,
+                           ThunarWatchFunc  func,
+                           gpointer         user_data,
+                           GError         **error)
+{
+  ThunarWatchLocation *location;
+  ThunarWatch         *watch;
+  GFile               *location_file = NULL;
+  GFile               *filter = NULL;
+
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (func != NULL, NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  /* files share the watch on their parent directory */
+  if (!is_directory && g_file_is_native (file))
+    location_file = g_file_get_parent (file);
+
+  if (location_file != NULL)
+    filter = file;
+  else
+    location_file = g_object_ref (file);
+
+  G_LOCK (registry_mutex);
+
+  if (G_UNLIKELY (locations == NULL))
+    locations = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, NULL, thunar_watch_location_free);
+
+  location = g_hash_table_lookup (locations, location_file);
+  if (location == NULL)
+    {
+      location = g_slice_new0 (ThunarWatchLocation);
+      location->location = g_object_ref (location_file);
+      location->is_native = g_file_is_native (location_file);
+      location->serial = ++location_serial;
+      location->link.data = location;
+
+      if (!thunar_watch_location_connect (location, cancellable, error))
+        {
+          G_UNLOCK (registry_mutex);
+          g_object_unref (location->location);
+          g_slice_free (ThunarWatchLocation, location);
+          g_object_unref (location_file);
+          return NULL;
+        }
+
+      g_hash_table_insert (locations, location->location, location);
+
+      /* only local watches are limited */
+      if (location->is_native)
+        {
+          g_queue_push_tail_link (&location_lru, &location->link);
+          thunar_watch_registry_rebalance ();
+        }
+    }
+  else
+    {
+      thunar_watch_location_touch (location);
+    }
+
+  watch = g_slice_new0 (ThunarWatch);
+  watch->location = location;
+  watch->file = filter != NULL ? g_object_ref (filter) : NULL;
+  watch->func = func;
+  watch->user_data = user_data;
+  watch->ref_count = 1;
+
+  location->watches = g_list_prepend (location->watches, watch);
+  watch_count++;
+
+  /* a polled location learns the state of the new file on its next poll */
+  if (location->poll_id != 0)
+    {
+      watch->poll_stamp = POLL_STAMP_UNKNOWN;
+      thunar_watch_location_queue_poll (location);
+    }
+
+  G_UNLOCK (registry_mutex);
+
+  g_object_unref (location_file);
+
+  return watch;
+}
+
+
+
+/**
+ * thunar_watch_registry_remove:
+ * @watch : a #ThunarWatch.
+ *
+ * Stops @watch. Its function won't be called anymore after this,
+ * and the shared monitor is released once it has no more watches.
+ **/
+void
+thunar_watch_registry_remove (ThunarWatch *watch)
+{
+  ThunarWatchLocation *location;
+
+  _thunar_return_if_fail (watch != NULL);
+
+  G_LOCK (registry_mutex);
+
+  location = watch->location;
+  location->watches = g_list_remove (location->watches, watch);
+  watch->func = NULL;
+  watch_count--;
+
+  /* release the location, which may leave room for a polled one */
+  if (location->watches == NULL)
+    {
+      g_hash_table_remove (locations, location->location);
+      thunar_watch_registry_rebalance ();
+    }
+
+  G_UNLOCK (registry_mutex);
+
+  thunar_watch_unref (watch);
+}
+
+
+
+/**
+ * thunar_watch_registry_set_budget:
+ * @budget : the maximum number of monitored local locations, or 0
+ *           for half of the system's inotify watch limit.
+ *
+ * Changes the watch budget, degrading or restoring monitors as needed.
+ **/
+void
+thunar_watch_registry_set_budget (guint budget)
+{
+  G_LOCK (registry_mutex);
+
+  watch_budget = budget;
+  thunar_watch_registry_rebalance ();
+
+  G_UNLOCK (registry_mutex);
+}
+
+
+
+/**
+ * thunar_watch_registry_get_usage:
+ * @n_monitored : return location for the number of monitored locations or %NULL.
+ * @n_polled    : return location for the number of polled locations or %NULL.
+ * @n_watches   : return location for the number of watches or %NULL.
+ *
+ * Reports the current watch usage, for diagnostics.
+ **/
+void
+thunar_watch_registry_get_usage (guint *n_monitored,
+                                 guint *n_polled,
+                                 guint *n_watches)
+{
+  G_LOCK (registry_mutex);
+
+  if (n_monitored != NULL)
+    *n_monitored = locations != NULL ? g_hash_table_size (locations) - location_polled.length : 0;
+  if (n_polled != NULL)
+    *n_polled = location_polled.length;
+  if (n_watches != NULL)
+    *n_watches = watch_count;
+
+  G_UNLOCK (registry_mutex);
+}
@@ -0,0 +1,58 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Thunar development team
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THUNAR_WATCH_REGISTRY_H__
+#define __THUNAR_WATCH_REGISTRY_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarWatch ThunarWatch;
+
+/**
+ * ThunarWatchFunc:
+ * @event_file : the #GFile the event occurred on.
+ * @other_file : the other #GFile for move events, or %NULL.
+ * @event_type : the #GFileMonitorEvent.
+ * @user_data  : the user data passed to thunar_watch_registry_add().
+ *
+ * Called for every change reported for a watched location, in the
+ * same way as the #GFileMonitor::changed signal.
+ **/
+typedef void (*ThunarWatchFunc) (GFile            *event_file,
+                                 GFile            *other_file,
+                                 GFileMonitorEvent event_type,
+                                 gpointer          user_data);
+
+ThunarWatch *thunar_watch_registry_add        (GFile           *file,
+                                               gboolean         is_directory,
+                                               GCancellable    *cancellable,
+                                               ThunarWatchFunc  func,
+                                               gpointer         user_data,
+                                               GError         **error);
+void         thunar_watch_registry_remove     (ThunarWatch     *watch);
+
+void         thunar_watch_registry_set_budget (guint            budget);
+void         thunar_watch_registry_get_usage  (guint           *n_monitored,
+                                               guint           *n_polled,
+                                               guint           *n_watches);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_WATCH_REGISTRY_H__ */